@@ -0,0 +1,212 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <print>
+#include <vector>
+
+/*
+ * mecs_bench: runs each benchmark on a grid of configurations and writes the results as JSON
+ *   --filter <text>       only run the benchmarks whose name contains text
+ *   --max-entities <n>    skip the configurations with more than n entities (default 10M)
+ *   --repetitions <n>     how many times each configuration is run (default 5)
+ *   --seed <n>            seed used to fragment the worlds (default 42)
+ *   --batched-flush       create the worlds with MecsWorldFlags_BatchedFlush
+ *   --out <path>          write the JSON to path instead of stdout
+ */
+
+namespace bench {
+
+const char* layoutName(Layout layout)
+{
+    switch (layout) {
+    case Layout::ePacked:
+        return "packed";
+    case Layout::eFragmented:
+        return "fragmented";
+    }
+    return "unknown";
+}
+
+namespace {
+
+    constexpr MecsSize kEntityCounts[] = { 1'000, 10'000, 100'000, 1'000'000, 10'000'000 };
+    constexpr MecsSize kArchetypeCounts[] = { 1, 10, 100, 1'000, 10'000 };
+    // The number of entities used when sweeping over the archetype counts
+    constexpr MecsSize kArchetypeSweepEntities = 100'000;
+
+    struct Options {
+        const char* filter = nullptr;
+        MecsSize maxEntities = 10'000'000;
+        MecsSize repetitions = 5;
+        MecsU32 seed = 42;
+        int worldFlags = MecsWorldFlags_None;
+        const char* outPath = nullptr;
+    };
+
+    struct Result {
+        const char* name;
+        Config config;
+        MecsSize numItems;
+        double minNs;
+        double medianNs;
+        double meanNs;
+    };
+
+    bool parseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++) {
+            const bool hasValue = i + 1 < argc;
+            if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+                options.filter = argv[++i];
+            } else if (strcmp(argv[i], "--max-entities") == 0 && hasValue) {
+                options.maxEntities = std::strtoull(argv[++i], nullptr, 10);
+            } else if (strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+                options.repetitions = std::max<MecsSize>(1, std::strtoull(argv[++i], nullptr, 10));
+            } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+                options.seed = static_cast<MecsU32>(std::strtoul(argv[++i], nullptr, 10));
+            } else if (strcmp(argv[i], "--batched-flush") == 0) {
+                options.worldFlags |= MecsWorldFlags_BatchedFlush;
+            } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+                options.outPath = argv[++i];
+            } else {
+                std::println(stderr, "Unknown or incomplete option {}", argv[i]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // An entity count sweep with a single archetype, followed by an archetype count sweep
+    std::vector<Config> makeConfigs(const Options& options)
+    {
+        std::vector<Config> configs;
+        auto addConfig = [&](MecsSize numEntities, MecsSize numArchetypes) {
+            if (numEntities > options.maxEntities || numArchetypes > numEntities) { return; }
+            for (Layout layout : { Layout::ePacked, Layout::eFragmented }) {
+                const bool duplicate = std::ranges::any_of(configs, [&](const Config& config) {
+                    return config.numEntities == numEntities && config.numArchetypes == numArchetypes && config.layout == layout;
+                });
+                if (!duplicate) {
+                    configs.push_back({ numEntities, numArchetypes, layout, options.worldFlags });
+                }
+            }
+        };
+        for (MecsSize numEntities : kEntityCounts) {
+            addConfig(numEntities, 1);
+        }
+        for (MecsSize numArchetypes : kArchetypeCounts) {
+            addConfig(std::min(kArchetypeSweepEntities, options.maxEntities), numArchetypes);
+        }
+        return configs;
+    }
+
+    Result runBenchmark(const Benchmark& benchmark, const Config& config, const Options& options)
+    {
+        std::vector<double> samples;
+        MecsSize numItems = 0;
+        for (MecsSize i = 0; i < options.repetitions; i++) {
+            State state(config, options.seed);
+            benchmark.run(state);
+            MECS_ASSERT(state.measured() && "The benchmark did not call measure()");
+            samples.push_back(state.elapsedNs());
+            numItems = state.numItems();
+        }
+        std::ranges::sort(samples);
+        double total = 0.0;
+        for (double sample : samples) {
+            total += sample;
+        }
+        return Result {
+            .name = benchmark.name,
+            .config = config,
+            .numItems = numItems,
+            .minNs = samples.front(),
+            .medianNs = samples[samples.size() / 2],
+            .meanNs = total / static_cast<double>(samples.size()),
+        };
+    }
+
+    void writeJson(std::ostream& out, const std::vector<Result>& results, const Options& options)
+    {
+        out << "{\n";
+        out << "  \"context\": {\n";
+#if defined(__clang__)
+        out << "    \"compiler\": \"clang " << __clang_version__ << "\",\n";
+#elif defined(__GNUC__)
+        out << "    \"compiler\": \"gcc " << __VERSION__ << "\",\n";
+#elif defined(_MSC_VER)
+        out << "    \"compiler\": \"msvc " << _MSC_VER << "\",\n";
+#endif
+#ifdef NDEBUG
+        out << "    \"assertions\": false,\n";
+#else
+        out << "    \"assertions\": true,\n";
+#endif
+        out << "    \"repetitions\": " << options.repetitions << ",\n";
+        out << "    \"seed\": " << options.seed << ",\n";
+        out << "    \"world_flags\": " << options.worldFlags << "\n";
+        out << "  },\n";
+        out << "  \"benchmarks\": [";
+        for (MecsSize i = 0; i < results.size(); i++) {
+            const Result& result = results[i];
+            const double nsPerItem = result.numItems > 0 ? result.medianNs / static_cast<double>(result.numItems) : 0.0;
+            out << (i == 0 ? "\n" : ",\n");
+            out << "    {"
+                << "\"name\": \"" << result.name << "\", "
+                << "\"entities\": " << result.config.numEntities << ", "
+                << "\"archetypes\": " << result.config.numArchetypes << ", "
+                << "\"layout\": \"" << layoutName(result.config.layout) << "\", "
+                << "\"items\": " << result.numItems << ", "
+                << "\"min_ns\": " << result.minNs << ", "
+                << "\"median_ns\": " << result.medianNs << ", "
+                << "\"mean_ns\": " << result.meanNs << ", "
+                << "\"ns_per_item\": " << nsPerItem << "}";
+        }
+        out << "\n  ]\n";
+        out << "}\n";
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    using namespace bench;
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<Config> configs = makeConfigs(options);
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : worldBenchmarks()) {
+        if (options.filter != nullptr && strstr(benchmark.name, options.filter) == nullptr) {
+            continue;
+        }
+        for (const Config& config : configs) {
+            const Result result = runBenchmark(benchmark, config, options);
+            // Progress goes to stderr, so that stdout only contains the JSON
+            std::println(stderr, "{} entities={} archetypes={} layout={}: {} ns median, {} ns/item",
+                result.name, config.numEntities, config.numArchetypes, layoutName(config.layout),
+                static_cast<MecsU64>(result.medianNs), result.numItems > 0 ? result.medianNs / static_cast<double>(result.numItems) : 0.0);
+            results.push_back(result);
+        }
+    }
+
+    if (options.outPath != nullptr) {
+        std::ofstream out(options.outPath);
+        if (!out) {
+            std::println(stderr, "Could not open {}", options.outPath);
+            return EXIT_FAILURE;
+        }
+        writeJson(out, results, options);
+    } else {
+        writeJson(std::cout, results, options);
+    }
+    return EXIT_SUCCESS;
+}
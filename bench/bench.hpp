@@ -0,0 +1,77 @@
+#pragma once
+
+#include "mecs/base.h"
+
+#include <chrono>
+#include <span>
+
+namespace bench {
+
+enum class Layout {
+    // The entities are spawned in order and never destroyed: the archetype rows follow the entity IDs
+    ePacked,
+    // Half of the entities are destroyed at random and spawned again: entity slots and rows are shuffled
+    eFragmented,
+};
+
+const char* layoutName(Layout layout);
+
+struct Config {
+    MecsSize numEntities;
+    // The entities are spread evenly across this many archetypes
+    MecsSize numArchetypes;
+    Layout layout;
+    int worldFlags;
+};
+
+// Handed to each benchmark run: the benchmark sets up its world, then times the interesting part with measure()
+class State {
+public:
+    State(const Config& config, MecsU32 seed)
+        : mConfig(config)
+        , mSeed(seed)
+    {
+    }
+
+    template <typename F>
+    void measure(MecsSize numItems, F&& func)
+    {
+        MECS_ASSERT(!mMeasured && "measure() must be called once per run");
+        const auto begin = std::chrono::steady_clock::now();
+        func();
+        const auto end = std::chrono::steady_clock::now();
+        mElapsedNs = std::chrono::duration<double, std::nano>(end - begin).count();
+        mNumItems = numItems;
+        mMeasured = true;
+    }
+
+    [[nodiscard]]
+    const Config& config() const { return mConfig; }
+    [[nodiscard]]
+    MecsU32 seed() const { return mSeed; }
+    [[nodiscard]]
+    bool measured() const { return mMeasured; }
+    [[nodiscard]]
+    double elapsedNs() const { return mElapsedNs; }
+    [[nodiscard]]
+    MecsSize numItems() const { return mNumItems; }
+
+private:
+    Config mConfig;
+    MecsU32 mSeed;
+    bool mMeasured { false };
+    double mElapsedNs { 0.0 };
+    MecsSize mNumItems { 0 };
+};
+
+using BenchmarkFn = void (*)(State& state);
+
+struct Benchmark {
+    const char* name;
+    BenchmarkFn run;
+};
+
+// Defined in world.cc
+std::span<const Benchmark> worldBenchmarks();
+
+}
@@ -0,0 +1,289 @@
+#include "bench.hpp"
+#include "mecs/iterator.h"
+#include "mecs/registry.h"
+#include "mecs/world.h"
+#include "mecshpp/mecs.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+struct Position {
+    float x;
+    float y;
+    float z;
+};
+
+struct Velocity {
+    float x;
+    float y;
+    float z;
+};
+
+struct Health {
+    float value;
+};
+
+MECS_RTTI_SIMPLE(Position);
+MECS_RTTI_SIMPLE(Velocity);
+MECS_RTTI_SIMPLE(Health);
+
+namespace bench {
+
+namespace {
+
+    // 2^14 combinations of tags, enough for the 10k archetypes benchmarks
+    constexpr MecsSize kNumTags = 14;
+    constexpr const char* kTagNames[kNumTags] = {
+        "Tag0", "Tag1", "Tag2", "Tag3", "Tag4", "Tag5", "Tag6",
+        "Tag7", "Tag8", "Tag9", "Tag10", "Tag11", "Tag12", "Tag13",
+    };
+
+    // The registry is shared by all the benchmarks, as the RTTI registrations are global
+    class Fixture {
+    public:
+        static Fixture& get()
+        {
+            static Fixture fixture;
+            return fixture;
+        }
+
+        // Each archetype has a Position, a Velocity and the tags matching the bits of archetypeIndex
+        MecsPrefabID prefab(MecsSize archetypeIndex)
+        {
+            while (mPrefabs.size() <= archetypeIndex) {
+                const MecsSize index = mPrefabs.size();
+                MecsRegistry* reg = registry.getHandle();
+                const MecsPrefabID prefabID = mecsRegistryCreatePrefab(reg);
+                mecsRegistryPrefabAddComponent(reg, prefabID, position);
+                mecsRegistryPrefabAddComponent(reg, prefabID, velocity);
+                for (MecsSize tag = 0; tag < kNumTags; tag++) {
+                    if ((index & (1ULL << tag)) != 0) {
+                        mecsRegistryPrefabAddComponent(reg, prefabID, tags[tag]);
+                    }
+                }
+                mPrefabs.push_back(prefabID);
+            }
+            return mPrefabs[archetypeIndex];
+        }
+
+        mecs::Registry registry;
+        MecsComponentID position;
+        MecsComponentID velocity;
+        MecsComponentID health;
+        MecsComponentID tags[kNumTags];
+
+    private:
+        Fixture()
+            : registry(MecsRegistryCreateInfo {})
+        {
+            position = registry.addRegistration<Position>().id();
+            velocity = registry.addRegistration<Velocity>().id();
+            health = registry.addRegistration<Health>().id();
+            for (MecsSize tag = 0; tag < kNumTags; tag++) {
+                ComponentInfo info {};
+                info.typeID = 0xBE7C400 + tag;
+                info.name = kTagNames[tag];
+                info.size = sizeof(MecsU32);
+                info.align = alignof(MecsU32);
+                tags[tag] = mecsRegistryAddRegistration(registry.getHandle(), &info);
+            }
+        }
+
+        std::vector<MecsPrefabID> mPrefabs;
+    };
+
+    MecsWorldCreateInfo makeWorldInfo(const State& state)
+    {
+        MecsWorldCreateInfo worldInfo {};
+        worldInfo.worldFlags = state.config().worldFlags;
+        return worldInfo;
+    }
+
+    // Spawns the entities of the configuration, returns them in spawn order
+    std::vector<MecsEntityID> populate(MecsWorld* world, const State& state)
+    {
+        Fixture& fixture = Fixture::get();
+        const Config& config = state.config();
+
+        std::vector<MecsEntityID> entities;
+        entities.reserve(config.numEntities);
+        for (MecsSize i = 0; i < config.numEntities; i++) {
+            entities.push_back(mecsWorldSpawnEntityPrefab(world, fixture.prefab(i % config.numArchetypes), nullptr));
+        }
+        mecsWorldFlushEvents(world, nullptr);
+
+        if (config.layout == Layout::eFragmented) {
+            std::mt19937 rng(state.seed());
+            std::shuffle(entities.begin(), entities.end(), rng);
+            const MecsSize numDestroyed = config.numEntities / 2;
+            for (MecsSize i = 0; i < numDestroyed; i++) {
+                mecsWorldDestroyEntity(world, entities[i]);
+            }
+            mecsWorldFlushEvents(world, nullptr);
+            for (MecsSize i = 0; i < numDestroyed; i++) {
+                entities[i] = mecsWorldSpawnEntityPrefab(world, fixture.prefab(i % config.numArchetypes), nullptr);
+            }
+            mecsWorldFlushEvents(world, nullptr);
+        }
+        return entities;
+    }
+
+    void onEntityAdded_Counter(void* data, void*, MecsEntityID)
+    {
+        (*static_cast<MecsSize*>(data))++;
+    }
+
+    void systemRun_Nop(void*, void*, MecsIterator*)
+    {
+    }
+
+    void benchSpawnPrefab(State& state)
+    {
+        Fixture& fixture = Fixture::get();
+        const Config& config = state.config();
+        const MecsWorldCreateInfo worldInfo = makeWorldInfo(state);
+        MecsWorld* world = mecsWorldCreate(fixture.registry.getHandle(), &worldInfo);
+        for (MecsSize i = 0; i < config.numArchetypes; i++) {
+            fixture.prefab(i);
+        }
+
+        MecsSize numSpawned = config.numEntities;
+        if (config.layout == Layout::eFragmented) {
+            // Spawn into the holes left by the destroyed entities
+            std::vector<MecsEntityID> entities = populate(world, state);
+            numSpawned = config.numEntities / 2;
+            for (MecsSize i = 0; i < numSpawned; i++) {
+                mecsWorldDestroyEntity(world, entities[i]);
+            }
+            mecsWorldFlushEvents(world, nullptr);
+        }
+
+        state.measure(numSpawned, [&]() {
+            for (MecsSize i = 0; i < numSpawned; i++) {
+                mecsWorldSpawnEntityPrefab(world, fixture.prefab(i % config.numArchetypes), nullptr);
+            }
+        });
+        mecsWorldFree(world);
+    }
+
+    void benchAddComponent(State& state)
+    {
+        Fixture& fixture = Fixture::get();
+        const MecsWorldCreateInfo worldInfo = makeWorldInfo(state);
+        MecsWorld* world = mecsWorldCreate(fixture.registry.getHandle(), &worldInfo);
+        const std::vector<MecsEntityID> entities = populate(world, state);
+
+        state.measure(entities.size(), [&]() {
+            for (MecsEntityID entity : entities) {
+                mecsWorldAddComponent(world, entity, fixture.health);
+            }
+        });
+        mecsWorldFree(world);
+    }
+
+    void benchFlushEvents(State& state)
+    {
+        Fixture& fixture = Fixture::get();
+        const MecsWorldCreateInfo worldInfo = makeWorldInfo(state);
+        MecsWorld* world = mecsWorldCreate(fixture.registry.getHandle(), &worldInfo);
+
+        // A system that's interested in the component added to each entity
+        MecsSize numAdded = 0;
+        MecsScheduleID schedule = mecsWorldDefineSchedule(world, nullptr);
+        MecsComponentID components[] = { fixture.position, fixture.health };
+        MecsIteratorFilter filters[] = { MecsIteratorFilter::Access, MecsIteratorFilter::Access };
+        MecsDefineSystemInfo systemInfo {};
+        systemInfo.numComponents = 2;
+        systemInfo.pComponents = components;
+        systemInfo.pFilters = filters;
+        systemInfo.systemData = &numAdded;
+        systemInfo.onEntityAdded = onEntityAdded_Counter;
+        systemInfo.systemRun = systemRun_Nop;
+        mecsWorldDefineSystem(world, &systemInfo, schedule);
+
+        const std::vector<MecsEntityID> entities = populate(world, state);
+        for (MecsEntityID entity : entities) {
+            mecsWorldAddComponent(world, entity, fixture.health);
+        }
+
+        state.measure(entities.size(), [&]() {
+            mecsWorldFlushEvents(world, nullptr);
+        });
+        MECS_ASSERT(numAdded == entities.size());
+        mecsWorldFree(world);
+    }
+
+    void benchIterate(State& state)
+    {
+        Fixture& fixture = Fixture::get();
+        const MecsWorldCreateInfo worldInfo = makeWorldInfo(state);
+        MecsWorld* world = mecsWorldCreate(fixture.registry.getHandle(), &worldInfo);
+        const std::vector<MecsEntityID> entities = populate(world, state);
+
+        MecsIterator* iterator = mecsWorldAcquireIterator(world);
+        mecsIterComponent(iterator, fixture.position, 0);
+        mecsIterComponent(iterator, fixture.velocity, 1);
+        mecsIteratorFinalize(iterator);
+
+        state.measure(entities.size(), [&]() {
+            mecsIteratorBegin(iterator);
+            while (mecsIteratorAdvance(iterator)) {
+                Position* position = static_cast<Position*>(mecsIteratorGetArgument(iterator, 0));
+                const Velocity* velocity = static_cast<const Velocity*>(mecsIteratorGetArgument(iterator, 1));
+                position->x += velocity->x;
+                position->y += velocity->y;
+                position->z += velocity->z;
+            }
+        });
+        mecsWorldReleaseIterator(world, iterator);
+        mecsWorldFree(world);
+    }
+
+    void benchIterateForEach(State& state)
+    {
+        Fixture& fixture = Fixture::get();
+        mecs::World world(fixture.registry, makeWorldInfo(state));
+        const std::vector<MecsEntityID> entities = populate(world.getHandle(), state);
+
+        auto iterator = world.acquireIterator<Position&, Velocity&>();
+        state.measure(entities.size(), [&]() {
+            iterator.forEach([](Position& position, Velocity& velocity) {
+                position.x += velocity.x;
+                position.y += velocity.y;
+                position.z += velocity.z;
+            });
+        });
+    }
+
+    void benchDuplicateEntity(State& state)
+    {
+        Fixture& fixture = Fixture::get();
+        const MecsWorldCreateInfo worldInfo = makeWorldInfo(state);
+        MecsWorld* world = mecsWorldCreate(fixture.registry.getHandle(), &worldInfo);
+        const std::vector<MecsEntityID> entities = populate(world, state);
+
+        state.measure(entities.size(), [&]() {
+            for (MecsEntityID entity : entities) {
+                mecsWorldDuplicateEntity(world, world, entity);
+            }
+        });
+        mecsWorldFree(world);
+    }
+
+    constexpr Benchmark kBenchmarks[] = {
+        { "spawn_prefab", benchSpawnPrefab },
+        { "add_component", benchAddComponent },
+        { "flush_events", benchFlushEvents },
+        { "iterate", benchIterate },
+        { "iterate_foreach", benchIterateForEach },
+        { "duplicate_entity", benchDuplicateEntity },
+    };
+}
+
+std::span<const Benchmark> worldBenchmarks()
+{
+    return kBenchmarks;
+}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "base.h"
+#include "defines.h"
+
+MECS_EXTERNCPP()
+
+/// A tracking allocator forwards all the allocations to a backing allocator, and keeps the current and peak bytes
+/// of each MecsAllocationTag: pass the allocators returned by mecsTrackingAllocatorGetAllocators() as
+/// pTaggedAllocators of a registry or a world.
+/// The same tracking allocator can be shared by worlds updated on different threads
+
+// If backingAllocator is null or has no memAlloc, an internal allocator is used
+MECS_API MecsTrackingAllocator* mecsTrackingAllocatorCreate(const MecsAllocator* backingAllocator);
+
+// Everything allocated through the tracking allocator must have been freed already
+MECS_API void mecsTrackingAllocatorFree(MecsTrackingAllocator* allocator);
+
+// Fills outAllocators with MecsAllocationTag_Count allocators, one for each MecsAllocationTag
+MECS_API void mecsTrackingAllocatorGetAllocators(MecsTrackingAllocator* allocator, MecsAllocator* outAllocators);
+MECS_API void mecsTrackingAllocatorGetStats(MecsTrackingAllocator* allocator, MecsAllocationTag tag, MecsAllocationStats* outStats);
+
+// The stats of all the categories together: the peak is the highest total reached, not the sum of the peaks
+MECS_API void mecsTrackingAllocatorGetTotalStats(MecsTrackingAllocator* allocator, MecsAllocationStats* outStats);
+
+MECS_API const char* mecsAllocationTagName(MecsAllocationTag tag);
+
+MECS_ENDEXTERNCPP()
@@ -20,6 +20,8 @@
 #define MECS_COUNTER __COUNTER__
 
 #define MECS_COMPONENTINFO(T) { .typeID = MECS_COUNTER, .name = #T, .size = sizeof(T), .align = MECS_ALIGN_OF(T) }
+// A tag has no data, it only marks the entities that have it
+#define MECS_TAGINFO(T) { .typeID = MECS_COUNTER, .name = #T, .size = 0, .align = 1 }
 
 #define MECS_REGISTER_COMPONENT(reg, T)                          \
     static MecsComponentID Component_##T = MECS_INVALID;         \
@@ -28,6 +30,22 @@
         Component_##T = mecsRegistryAddRegistration(reg, &info); \
     } while (0)
 
+#define MECS_REGISTER_TAG(reg, T)                                \
+    static MecsComponentID Component_##T = MECS_INVALID;         \
+    do {                                                         \
+        ComponentInfo info = MECS_TAGINFO(T);                    \
+        Component_##T = mecsRegistryAddRegistration(reg, &info); \
+    } while (0)
+
+// A sparse component lives outside of the archetypes, see MecsComponentStorage_Sparse
+#define MECS_REGISTER_SPARSE_COMPONENT(reg, T)                   \
+    static MecsComponentID Component_##T = MECS_INVALID;         \
+    do {                                                         \
+        ComponentInfo info = MECS_COMPONENTINFO(T);              \
+        info.storage = MecsComponentStorage_Sparse;              \
+        Component_##T = mecsRegistryAddRegistration(reg, &info); \
+    } while (0)
+
 MECS_EXTERNCPP()
 /// NOLINTBEGIN
 
@@ -41,10 +59,14 @@ typedef MecsU32 MecsPrefabID;
 typedef MecsU32 MecsComponentID;
 typedef MecsU32 MecsSystemID;
 typedef MecsU32 MecsScheduleID;
+typedef MecsU32 MecsObserverID;
 
 typedef struct MECS_API MecsRegistry_t MecsRegistry;
 typedef struct MECS_API MecsWorld_t MecsWorld;
 typedef struct MECS_API MecsWorldIterator_t MecsIterator;
+typedef struct MECS_API MecsTraceRecorder_t MecsTraceRecorder;
+typedef struct MECS_API MecsTrackingAllocator_t MecsTrackingAllocator;
+typedef struct MECS_API MecsWorldSnapshot_t MecsWorldSnapshot;
 
 typedef void* (*PFNMecsMalloc)(void* userData, MecsSize size, MecsSize align);
 typedef void* (*PFNMecsRealloc)(void* userData, void* old, MecsSize oldSize, MecsSize align,
@@ -57,8 +79,24 @@ typedef void (*PFNMecsComponentCopy)(const void* source, void* dest,
 typedef void (*PFNMecsComponentMove)(void* source, void* dest,
     MecsSize byteSize);
 typedef void (*PFNMecsComponentDestroy)(void* mem);
+// Both return how many bytes were written or read: anything less than size is treated as a failure
+typedef MecsSize (*PFNMecsWrite)(void* userData, const void* data, MecsSize size);
+typedef MecsSize (*PFNMecsRead)(void* userData, void* data, MecsSize size);
+
+typedef struct MecsWriter_t {
+    PFNMecsWrite write;
+    void* userData;
+} MecsWriter;
+
+typedef struct MecsReader_t {
+    PFNMecsRead read;
+    void* userData;
+} MecsReader;
+
 typedef void (*PFNMecsComponentSetup)(MecsWorld* world, MecsEntityID entity, void* mem, void* userData);
 typedef void (*PFNMecsComponentTeardown)(MecsWorld* world, MecsEntityID entity, void* mem, void* userData);
+typedef bool (*PFNMecsComponentSerialize)(const void* mem, const MecsWriter* writer);
+typedef bool (*PFNMecsComponentDeserialize)(void* mem, const MecsReader* reader);
 
 typedef struct MecsAllocator {
     // If null, will use an internal malloc function
@@ -73,12 +111,81 @@ typedef struct MecsAllocator {
     void* userData;
 } MecsAllocator;
 
+// The category of each allocation made by mecs, see pTaggedAllocators
+typedef enum MecsAllocationTag_t {
+    // World bookkeeping: the world itself, archetypes, schedules, systems and flush scratch storage
+    MecsAllocationTag_World,
+    // The component columns of the archetypes, along with their row to entity column, and the sparse components
+    MecsAllocationTag_ArchetypeColumns,
+    // The entity table of the worlds
+    MecsAllocationTag_Entities,
+    // The events waiting for mecsWorldFlushEvents()
+    MecsAllocationTag_Events,
+    MecsAllocationTag_Iterators,
+    // The registry itself and its component registrations
+    MecsAllocationTag_Registry,
+    // The prefabs and their component instances
+    MecsAllocationTag_Prefabs,
+    // Component, entity, schedule and system names
+    MecsAllocationTag_Strings,
+    // The allocations made through the allocator returned by mecsWorldGetAllocator()
+    MecsAllocationTag_User,
+    MecsAllocationTag_Count,
+} MecsAllocationTag;
+
 typedef struct MecsRegistryCreateInfo {
     MecsAllocator memAllocator;
+
+    // Can be null, otherwise an array of MecsAllocationTag_Count allocators indexed by MecsAllocationTag:
+    // the allocations of each category go through the matching allocator, unless its memAlloc is null
+    // in which case memAllocator is used
+    const MecsAllocator* pTaggedAllocators;
 } MecsRegistryCreateInfo;
 
+typedef enum MecsWorldFlags_t {
+    MecsWorldFlags_None = 0,
+    // mecsWorldFlushEvents groups the pending events by archetype transition, and resolves which systems
+    // gain or lose an entity once per transition instead of once per event.
+    // Spawned entities are processed first, then added components, changed entities, removed components
+    // and finally destroyed entities: callbacks belonging to different transitions may run in a different
+    // order than the one the events were pushed in
+    MecsWorldFlags_BatchedFlush = 0x01,
+} MecsWorldFlags;
+
+typedef enum MecsWorldCloneFlags_t {
+    MecsWorldCloneFlags_None = 0,
+    // mecsWorldClone() pushes the events mecsWorldDuplicateEntity() would push for each cloned entity, so that the
+    // component setup callbacks run at the next mecsWorldFlushEvents(). By default the systems are handed the
+    // cloned entities without calling the setup callbacks
+    MecsWorldCloneFlags_EntityEvents = 0x01,
+    // The columns of the components without copy, move and destroy callbacks are shared by the two worlds instead of
+    // being copied: a column is copied the first time either world modifies it, that is when it is accessed through
+    // mecsWorldEntityGetComponent(), an iterator with the Access filter or when an entity leaves its archetype.
+    // The components must only be read through the Read filter until then
+    MecsWorldCloneFlags_CopyOnWrite = 0x02,
+} MecsWorldCloneFlags;
+
+// Where the instances of a component are stored
+typedef enum MecsComponentStorage_t {
+    // A column in each archetype holding the component: iterating it is fast, but adding or removing it moves the
+    // entity to another archetype
+    MecsComponentStorage_Archetype = 0,
+    // A sparse set indexed by entity, outside of the archetypes: adding or removing the component doesn't move the
+    // entity, at the cost of a lookup for each entity when iterating it. Suited for markers that are toggled often.
+    // Sparse components don't take part in the archetype of an entity: the systems are not notified when they are
+    // added or removed, and they are not written in world snapshots
+    MecsComponentStorage_Sparse,
+} MecsComponentStorage;
+
 typedef struct MecsWorldCreateInfo {
     MecsAllocator memAllocator;
+
+    // A combination of MecsWorldFlags
+    int worldFlags;
+
+    // Can be null, see MecsRegistryCreateInfo::pTaggedAllocators
+    // When both this and memAllocator are unset, the world uses the allocators of the registry
+    const MecsAllocator* pTaggedAllocators;
 } MecsWorldCreateInfo;
 typedef struct ComponentInfo {
     // Must be unique for all different types
@@ -87,7 +194,8 @@ typedef struct ComponentInfo {
     // Must not be null and unique all registered types
     const char* name;
 
-    // Must be greater than zero
+    // Zero for a tag: tags take part in the archetype of the entities, but have no column in the archetype storage.
+    // All the rows of a tag point to the same memory, which must not be written
     MecsSize size;
 
     // Must be greater than zero
@@ -114,6 +222,17 @@ typedef struct ComponentInfo {
     // Can  be null, points to the default value of this component
     const void* defaultInstance;
 
+    // Can be null, called to write an instance of this component when a world is serialized.
+    // When null the bytes of the component are written as they are, so the component must be trivially copyable
+    PFNMecsComponentSerialize serialize;
+
+    // Can be null, must be set if serialize is set: called on an initialized instance to read back
+    // what serialize wrote
+    PFNMecsComponentDeserialize deserialize;
+
+    // MecsComponentStorage_Archetype when zero-initialized
+    MecsComponentStorage storage;
+
 } ComponentInfo;
 
 typedef struct MecsEntityInfo {
@@ -132,19 +251,37 @@ enum MecsIteratorFilter {
     Access, // Retrieves a pointer to the component
     With, // Only checks if the entity has the component, retrieval returns nullptr
     Not, // Only selects entities without this component, retrieval returns nullptr
+    Read, // Like Access, but the component must not be modified: a column shared by a copy-on-write clone is not copied
 };
 
 typedef void (*PFNMecsOnEntityAdded)(void*, void*, MecsEntityID);
 typedef void (*PFNMecsSystemRun)(void*, void*, MecsIterator*);
 typedef void (*PFNMEcsOnEntityRemoved)(void*, void*, MecsEntityID);
+typedef void (*PFNMecsOnEntitiesAdded)(void*, void*, const MecsEntityID*, MecsSize);
+typedef void (*PFNMecsOnEntitiesRemoved)(void*, void*, const MecsEntityID*, MecsSize);
+// Returns whether the system should run, see MecsDefineSystemInfo::runCondition
+typedef bool (*PFNMecsSystemRunCondition)(void* systemData, void* updateData, MecsWorld* world);
+// Returns a negative value when the component lhs goes before rhs, see mecsIteratorSortBy()
+typedef int (*PFNMecsCompareComponents)(const void* lhs, const void* rhs, void* userData);
+// Returns the group of the archetype made of the components, see mecsIteratorGroupBy()
+typedef MecsU64 (*PFNMecsArchetypeGroup)(const MecsComponentID* components, MecsSize numComponents, void* userData);
 
 typedef enum MecsSystemFlags_t {
     MecsSystemFlags_None = 0,
-    // This system is not allowed to run in parallel with other systems
-    // Not used at the moment (all systems run sequentially in order of insertion)
+    // This system is not allowed to run in parallel with other systems, see mecsWorldSystemsConflict()
+    // Systems still run sequentially in order of insertion
     MecsSystemFlags_Exclusive = 0x01,
 } MecsSystemFlags;
 
+typedef enum MecsSystemRunConditions_t {
+    MecsSystemRunConditions_None = 0,
+    // The system only runs when its iterator matches an archetype with at least one entity
+    MecsSystemRunConditions_HasEntities = 0x01,
+    // The system only runs when one of its resources changed since its previous run (see mecsWorldGetResourceVersion()),
+    // it must have at least one resource
+    MecsSystemRunConditions_ResourcesChanged = 0x02,
+} MecsSystemRunConditions;
+
 typedef struct MecsDefineSystemInfo_t {
 
     // How many components this system will match
@@ -156,7 +293,7 @@ typedef struct MecsDefineSystemInfo_t {
     // An array of numComponents elements with the filters applyed to the components in pComponents
     MecsIteratorFilter* pFilters;
 
-    // Reserved for future use
+    // A combination of MecsSystemFlags
     int systemFlags;
 
     // Private data for the system
@@ -179,12 +316,194 @@ typedef struct MecsDefineSystemInfo_t {
     // either because the entity is despawned or because the entity lost a component that matched
     // the system's component set.
     PFNMEcsOnEntityRemoved onEntityRemoved;
+
+    // Can be null, batched variant of onEntityAdded: when set it's called instead of onEntityAdded
+    // with all the entities added to the system during a flush (or, when the system is added to the world,
+    // with the entities of each archetype already matching the system's component set).
+    // The array is only valid for the duration of the call
+    PFNMecsOnEntitiesAdded onEntitiesAdded;
+
+    // Can be null, batched variant of onEntityRemoved: when set it's called instead of onEntityRemoved
+    // with all the entities removed from the system during a flush.
+    // The entities might already be destroyed by the time this is called, so only their IDs should be used.
+    // The array is only valid for the duration of the call
+    PFNMecsOnEntitiesRemoved onEntitiesRemoved;
+
+    // Can be null, reported to the trace hooks
+    const char* systemName;
+
+    // How many resources this system uses, see mecsWorldAddResource()
+    MecsU32 numResources;
+
+    // An array of numResources elements with the components of the resources
+    MecsComponentID* pResources;
+
+    // An array of numResources elements: Access for the resources this system writes, Read for the ones it only reads
+    MecsIteratorFilter* pResourceFilters;
+
+    // The system runs once every runInterval runs of its schedule, starting from the first one. 0 and 1 run it every time
+    MecsU32 runInterval;
+
+    // A combination of MecsSystemRunConditions. The run interval and the conditions are checked before the iterator of the
+    // system is begun: a system that doesn't run costs nothing but the checks
+    int runConditions;
+
+    // Can be null, checked after runConditions: the system is skipped when it returns false
+    PFNMecsSystemRunCondition runCondition;
 } MecsDefineSystemInfo;
 
 typedef struct MecsDefineScheduleInfo_t {
     // Can be null
     const char* scheduleName;
+
+    // The seconds between two runs of the schedule in mecsWorldUpdateSchedule(), 0 to run it once for each update
+    double fixedTimestep;
+
+    // The most runs a single mecsWorldUpdateSchedule() can make to catch up with a fixed timestep, the time left behind
+    // is dropped. 0 for no limit
+    MecsU32 maxCatchUpRuns;
 } MecsDefineScheduleInfo;
 
+typedef enum MecsObserverEvent_t {
+    // The component was added to the entities, after its setup
+    MecsObserverEvent_Added,
+    // The component is about to be removed from the entities or the entities are being destroyed, before its teardown
+    MecsObserverEvent_Removed,
+    // The component was reported as changed with mecsWorldEntityComponentChanged()
+    MecsObserverEvent_Changed,
+} MecsObserverEvent;
+
+// Receives count entities with their instances of the observed component, the arrays are only valid for the duration of
+// the call. The instances must not be modified: a column shared by a copy-on-write clone is not copied, use
+// mecsWorldEntityGetComponent() to write them
+typedef void (*PFNMecsObserve)(void* observerData, void* updateData, const MecsEntityID* pEntities, void* const* pComponents, MecsSize count);
+
+typedef struct MecsDefineObserverInfo_t {
+    // The component whose events are observed
+    MecsComponentID component;
+
+    MecsObserverEvent event;
+
+    // Private data for the observer
+    void* observerData;
+
+    // Cannot be null
+    PFNMecsObserve observe;
+} MecsDefineObserverInfo;
+
+typedef enum MecsTraceScope_t {
+    // A call to mecsWorldRunSchedule()
+    MecsTraceScope_Schedule,
+    // A system running inside a schedule
+    MecsTraceScope_System,
+    // A call to mecsWorldFlushEvents()
+    MecsTraceScope_Flush,
+    // A part of mecsWorldFlushEvents(), named after what it processes
+    MecsTraceScope_FlushPhase,
+} MecsTraceScope;
+
+typedef struct MecsTraceEvent_t {
+    MecsTraceScope scope;
+
+    // The schedule, system or flush phase name, can be null for unnamed schedules and systems
+    const char* name;
+
+    // MECS_INVALID for the flush scopes
+    MecsScheduleID schedule;
+
+    // MECS_INVALID unless scope is MecsTraceScope_System
+    MecsSystemID system;
+
+    // Schedule: the systems run
+    // System: the entities matched by the system's iterator
+    // Flush and FlushPhase: the events processed, or the notified systems for the notification phase
+    MecsSize numItems;
+} MecsTraceEvent;
+
+// The event is only valid for the duration of the call
+typedef void (*PFNMecsTraceBegin)(void* userData, const MecsTraceEvent* event);
+typedef void (*PFNMecsTraceEnd)(void* userData, const MecsTraceEvent* event);
+
+// Every begin is matched by an end with the same event, and the scopes nest:
+// a system scope is always inside a schedule scope, a flush phase scope inside a flush scope
+typedef struct MecsTraceHooks_t {
+    // Can be null
+    PFNMecsTraceBegin begin;
+
+    // Can be null
+    PFNMecsTraceEnd end;
+
+    void* userData;
+} MecsTraceHooks;
+
+// Returned by mecsTrackingAllocatorGetStats()
+typedef struct MecsAllocationStats_t {
+    // Bytes currently allocated, and the highest value it reached
+    MecsSize currentBytes;
+    MecsSize peakBytes;
+
+    // Live allocations, and all the allocations made so far (reallocations included)
+    MecsSize numAllocations;
+    MecsSize totalAllocations;
+} MecsAllocationStats;
+
+// Returned by mecsWorldGetStats(), a snapshot of the world: it's not updated when the world changes
+// All the byte counts are the bytes allocated through the world's allocator
+typedef struct MecsWorldStats_t {
+    MecsSize numEntities;
+
+    MecsSize numArchetypes;
+
+    // Archetypes without any row, e.g. left behind by entities that moved to another archetype
+    MecsSize numEmptyArchetypes;
+
+    // Rows used and allocated across all the archetypes
+    MecsSize numRows;
+    MecsSize rowCapacity;
+
+    // Bytes allocated by the component columns of all the archetypes
+    MecsSize columnBytes;
+
+    // Bytes allocated for everything else: entities, archetype bookkeeping, events, iterators, schedules and systems
+    MecsSize metadataBytes;
+
+    MecsSize numAcquiredIterators;
+
+    // Released iterators kept around to be acquired again
+    MecsSize numReusableIterators;
+
+    // Events waiting for the next mecsWorldFlushEvents()
+    MecsSize numPendingEvents;
+
+    MecsSize numSchedules;
+    MecsSize numSystems;
+} MecsWorldStats;
+
+// Returned by mecsWorldGetArchetypeStats()
+typedef struct MecsArchetypeStats_t {
+    MecsSize numComponents;
+    MecsSize numRows;
+    MecsSize rowCapacity;
+
+    // Bytes allocated by the component columns of the archetype
+    MecsSize columnBytes;
+} MecsArchetypeStats;
+
+// Returned by mecsWorldGetComponentStats()
+typedef struct MecsComponentStats_t {
+    // The name the component was registered with
+    const char* name;
+
+    // How many archetypes include the component
+    MecsSize numArchetypes;
+
+    // How many entities have the component, and how many could have it without growing the columns
+    MecsSize numInstances;
+    MecsSize instanceCapacity;
+
+    // Bytes allocated by the columns of the component across all the archetypes
+    MecsSize columnBytes;
+} MecsComponentStats;
+
 /// NOLINTEND
 MECS_ENDEXTERNCPP()
@@ -6,13 +6,57 @@
 MECS_EXTERNCPP()
 
 MECS_API void mecsIterComponent(MecsIterator* iterator, MecsComponentID component, MecsSize argIndex);
+// The sparse components (see MecsComponentStorage_Sparse) don't select archetypes: mecsIteratorAdvance() checks them
+// for each entity of the archetypes matching the other arguments
 MECS_API void mecsIterComponentFilter(MecsIterator* iterator, MecsComponentID component, MecsIteratorFilter filter, MecsSize argIndex);
 MECS_API void mecsIteratorFinalize(MecsIterator* iterator);
 MECS_API void mecsIteratorBegin(MecsIterator* iterator);
+// Skips the entities whose Access, Read or With components are disabled (see
+// mecsWorldSetComponentEnabled()), disabling a Not component doesn't make an entity match
 MECS_API bool mecsIteratorAdvance(MecsIterator* iterator);
 MECS_API void* mecsIteratorGetArgument(MecsIterator* iterator, MecsSize argIndex);
 MECS_API MecsWorld* mecsIteratorGetWorld(MecsIterator* iterator);
 MECS_API MecsEntityID mecsIteratorGetEntity(MecsIterator* iterator);
+
+// Moves to the next matching archetype with at least one entity, returning its number of entities or 0 when there
+// are no archetypes left. The entities of the archetype are then accessed in bulk with mecsIteratorGetColumn() and
+// mecsIteratorGetEntities(), which stay valid as long as no entity is added to or removed from the archetype.
+// Must not be mixed with mecsIteratorAdvance() between two calls to mecsIteratorBegin(), nor used by an iterator with
+// sparse arguments
+MECS_API MecsSize mecsIteratorAdvanceArchetype(MecsIterator* iterator);
+// Whether some arguments are sparse components, see mecsIteratorAdvanceArchetype()
+MECS_API bool mecsIteratorHasSparseArguments(MecsIterator* iterator);
+// The components of argIndex for all the entities of the current archetype, or NULL for With and Not arguments.
+// Tags have no column: the pointer is the same for all the rows
+MECS_API void* mecsIteratorGetColumn(MecsIterator* iterator, MecsSize argIndex);
+MECS_API const MecsEntityID* mecsIteratorGetEntities(MecsIterator* iterator);
+// One bit per entity of the current archetype (bit i % 32 of the word i / 32) set when its Access, Read and With
+// components are all enabled, or NULL when they are for all the entities. The bulk accessors don't skip the disabled
+// entities by themselves. Computed by mecsIteratorAdvanceArchetype(): enabling or disabling a component afterwards
+// isn't reflected until the next archetype
+MECS_API const MecsU32* mecsIteratorGetEnabledRows(MecsIterator* iterator);
 MECS_API MecsSize mecsUtilIteratorCount(MecsIterator* iterator);
 
+// Orders the matching archetypes by the group func returns for their components, lowest first: the entities of a group
+// are visited together, and the archetypes of the same group keep the order they were matched in. The archetypes
+// created afterwards are inserted at the end of their group. Pass a null func to stop grouping.
+// Must not be called between mecsIteratorBegin() and the end of the iteration
+MECS_API void mecsIteratorGroupBy(MecsIterator* iterator, PFNMecsArchetypeGroup func, void* userData);
+// Keeps the rows of each matching archetype sorted by compare, called on the instances of component, which must be an
+// Access, Read or With argument. The rows are sorted in place by mecsIteratorBegin(): only the rows added, moved or
+// changed since the previous sort are sorted again and merged with the others. A row is changed by
+// mecsWorldEntityChanged(), or by getting component with mecsWorldEntityGetComponent() or an Access argument, writing
+// through a Read argument isn't noticed. Getting the Access column with mecsIteratorGetColumn() copies the keys of the
+// archetype, and the next sort only sorts again the rows whose key bytes differ from the copy. An archetype sorted by another iterator in a different way is sorted again from
+// scratch. Pass a null compare to stop sorting.
+// Moving the rows invalidates the columns and rows of the other iterators that are iterating the same archetypes
+MECS_API void mecsIteratorSortBy(MecsIterator* iterator, MecsComponentID component, PFNMecsCompareComponents compare, void* userData);
+// Visits the entities level by level, see mecsWorldEntitySetParent(): all the roots first, then their children and so
+// on, so that a parent is always visited before its children. mecsIteratorBegin() keeps the rows of each archetype
+// sorted by depth and then by parent, like mecsIteratorSortBy() does, so each level is a contiguous run of rows with the
+// siblings next to each other. The archetypes created while iterating are only visited from the next
+// mecsIteratorBegin(). Can't be combined with mecsIteratorSortBy(), and must be advanced with mecsIteratorAdvance()
+MECS_API void mecsIteratorSetHierarchyOrder(MecsIterator* iterator, bool hierarchyOrder);
+MECS_API bool mecsIteratorIsHierarchyOrdered(MecsIterator* iterator);
+
 MECS_ENDEXTERNCPP()
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "allocator.h" // IWYU pragma: export
 #include "base.h" // IWYU pragma: export
 #include "iterator.h" // IWYU pragma: export
 #include "registry.h" // IWYU pragma: export
+#include "serialize.h" // IWYU pragma: export
+#include "trace.h" // IWYU pragma: export
 #include "world.h" // IWYU pragma: export
\ No newline at end of file
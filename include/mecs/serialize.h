@@ -0,0 +1,64 @@
+#pragma once
+
+#include "base.h"
+#include "defines.h"
+
+MECS_EXTERNCPP()
+
+/// Snapshots
+/// A snapshot holds the entities of a world (IDs, names, prefabs) and their components, written archetype by archetype
+/// one column at a time. The components without a serialize callback are written as raw bytes, so a snapshot can only
+/// be read on a machine with the same endianness and the same component layouts.
+/// Components are matched by typeID when a snapshot is read, so the reading world can come from another registry,
+/// as long as it registered the same components.
+/// The sparse components (see MecsComponentStorage_Sparse) live outside of the archetypes, they're not written.
+/// Neither are the parent/child links (see mecsWorldEntitySetParent()): the restored entities are all roots.
+/// The resources of the world (see mecsWorldAddResource()) aren't entities and aren't written either.
+/// The components disabled with mecsWorldSetComponentEnabled() are written like the others and come back enabled
+
+// The world must not have pending events. Returns false if the writer or a component serialize callback failed
+MECS_API bool mecsWorldSerialize(MecsWorld* world, const MecsWriter* writer);
+
+// Restores the entities of a snapshot into world, which must not have any entity nor pending events: the entities keep
+// the IDs they had in the serialized world. Component setup callbacks are not called, while the systems of the world
+// are handed the restored entities at the next mecsWorldFlushEvents().
+// Returns false if the snapshot is malformed or a component is missing from the registry, leaving the world empty
+MECS_API bool mecsWorldDeserialize(MecsWorld* world, const MecsReader* reader);
+
+// The large columns of a snapshot written to a file are page aligned, so that the file can be mapped
+MECS_API bool mecsWorldSerializeToFile(MecsWorld* world, const char* path);
+MECS_API bool mecsWorldDeserializeFromFile(MecsWorld* world, const char* path);
+
+// Like mecsWorldDeserializeFromFile(), but the file is mapped copy-on-write instead of being read: the archetypes whose
+// components have no serialize callback use the mapped columns as they are, so their load time does not depend on their
+// size and the unmodified pages are shared by all the processes mapping the same file.
+// A column is copied out of the mapping the first time it grows, the mapping is released when the world is freed
+MECS_API bool mecsWorldDeserializeMappedFile(MecsWorld* world, const char* path);
+
+/// Deltas
+/// A delta holds what changed in a world since a MecsWorldSnapshot was taken: the destroyed and spawned entities,
+/// the removed and added components and, for the components found in both, the range of bytes that changed. The
+/// components with a serialize callback are compared by what it writes, and written whole when that changed.
+/// A delta can be applied to another world built from the same registry which holds the same entities as the snapshot,
+/// e.g. a replica that applied all the previous deltas. Like snapshots, deltas don't track the sparse components
+/// nor the parent/child links: the entities of the replica keep the parents they had before. The resources aren't
+/// tracked either, each world keeps its own. Enabling or disabling a component isn't a change: the added components
+/// and the spawned entities are enabled in the replica
+
+// Copies the entities and the components of world, which must not have pending events
+MECS_API MecsWorldSnapshot* mecsWorldSnapshotCreate(MecsWorld* world);
+MECS_API void mecsWorldSnapshotFree(MecsWorldSnapshot* snapshot);
+
+// Replaces the content of the snapshot with the current state of world, reusing the memory of the snapshot
+MECS_API void mecsWorldSnapshotUpdate(MecsWorldSnapshot* snapshot, MecsWorld* world);
+
+// Writes what changed in world since the snapshot was taken or updated, the world must not have pending events.
+// Returns false if the writer or a component serialize callback failed
+MECS_API bool mecsWorldWriteDelta(MecsWorld* world, const MecsWorldSnapshot* snapshot, const MecsWriter* writer);
+
+// Applies a delta to world, which must not have pending events: the destroyed entities and the removed components are
+// flushed right away (notifying the systems), the other changes are notified by the next mecsWorldFlushEvents().
+// Returns false if the delta is malformed or does not match the entities of world, which is then only partially updated
+MECS_API bool mecsWorldApplyDelta(MecsWorld* world, const MecsReader* reader, void* updateData);
+
+MECS_ENDEXTERNCPP()
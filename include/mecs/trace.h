@@ -0,0 +1,29 @@
+#pragma once
+
+#include "base.h"
+#include "defines.h"
+
+MECS_EXTERNCPP()
+
+/// A recorder collects the scopes reported through its hooks, and writes them in the Chrome trace event format
+/// (loadable by chrome://tracing or https://ui.perfetto.dev)
+/// Pass the hooks returned by mecsTraceRecorderGetHooks() to mecsWorldSetTraceHooks(): the same recorder can trace
+/// multiple worlds, as long as they are not updated concurrently
+
+// If allocator is null or has no memAlloc, an internal allocator is used
+MECS_API MecsTraceRecorder* mecsTraceRecorderCreate(const MecsAllocator* allocator);
+
+// The recorder must not be used by any world anymore
+MECS_API void mecsTraceRecorderFree(MecsTraceRecorder* recorder);
+MECS_API MecsTraceHooks mecsTraceRecorderGetHooks(MecsTraceRecorder* recorder);
+
+// The number of scopes that ended since the recorder was created or cleared
+MECS_API MecsSize mecsTraceRecorderGetNumEvents(MecsTraceRecorder* recorder);
+
+// Forgets the recorded scopes, must not be called while a traced scope is running
+MECS_API void mecsTraceRecorderClear(MecsTraceRecorder* recorder);
+
+// Writes the recorded scopes as a JSON object, returns false if the file could not be written
+MECS_API bool mecsTraceRecorderWriteChromeTrace(MecsTraceRecorder* recorder, const char* path);
+
+MECS_ENDEXTERNCPP()
@@ -10,12 +10,21 @@ MECS_API void mecsWorldFree(MecsWorld* world);
 MECS_API MecsAllocator mecsWorldGetAllocator(MecsWorld* world);
 MECS_API MecsEntityID mecsWorldSpawnEntity(MecsWorld* world, const MecsEntityInfo* entityInfo);
 MECS_API MecsEntityID mecsWorldDuplicateEntity(MecsWorld* world, MecsWorld* destinationWorld, MecsEntityID entity);
+// Copies all the entities of world into destinationWorld, which must come from the same registry and must not have
+// entities: the entities keep their IDs, and the columns of the components without a copy callback are copied at once.
+// Neither world can have pending events, cloneFlags is a combination of MecsWorldCloneFlags
+MECS_API void mecsWorldClone(MecsWorld* world, MecsWorld* destinationWorld, int cloneFlags);
 MECS_API MecsEntityID mecsWorldSpawnEntityPrefab(MecsWorld* world, MecsPrefabID prefabID, const MecsEntityInfo* entityInfo);
 MECS_API bool mecsWorldEntityHasComponent(MecsWorld* world, MecsEntityID entity, MecsComponentID component);
 MECS_API void* mecsWorldEntityGetComponent(MecsWorld* world, MecsEntityID entity, MecsComponentID component);
 MECS_API MecsSize mecsWorldEntityGetNumComponents(MecsWorld* world, MecsEntityID entity);
 MECS_API MecsPrefabID mecsWorldEntityGetPrefabID(MecsWorld* world, MecsEntityID entity);
 MECS_API MecsComponentID mecsWorldEntityGetComponentByIndex(MecsWorld* world, MecsEntityID entity, MecsSize index);
+// A disabled component stays on the entity, but the iterators skip the entity as if it didn't have it: no system is
+// notified and the entity doesn't change archetype, so toggling it is just a bit flip. The component must have been added
+// by a flush, and can't be sparse. Removing the component drops the bit, the snapshots and deltas don't keep it
+MECS_API void mecsWorldSetComponentEnabled(MecsWorld* world, MecsEntityID entity, MecsComponentID component, bool enabled);
+MECS_API bool mecsWorldIsComponentEnabled(MecsWorld* world, MecsEntityID entity, MecsComponentID component);
 MECS_API void* mecsWorldAddComponent(MecsWorld* world, MecsEntityID entity, MecsComponentID component);
 MECS_API void mecsWorldRemoveComponent(MecsWorld* world, MecsEntityID entity, MecsComponentID componentInstance);
 MECS_API void mecsWorldDestroyEntity(MecsWorld* world, MecsEntityID entityID);
@@ -28,7 +37,66 @@ MECS_API void mecsWorldReleaseIterator(MecsWorld* world, MecsIterator* iterator)
 /// A schedule is a group of systems that can be run
 MECS_API MecsScheduleID mecsWorldDefineSchedule(MecsWorld* world, const MecsDefineScheduleInfo* scheduleInfo);
 MECS_API void mecsWorldRunSchedule(MecsWorld* world, MecsScheduleID scheduleID, void* updateData);
+/// Advances the clock of the schedule by deltaSeconds and runs it as many times as its fixed timestep fits in the time
+/// accumulated so far, up to maxCatchUpRuns (see MecsDefineScheduleInfo). A schedule without a fixed timestep runs once.
+/// Returns the number of runs
+MECS_API MecsU32 mecsWorldUpdateSchedule(MecsWorld* world, MecsScheduleID scheduleID, double deltaSeconds, void* updateData);
+/// How far the clock of a fixed timestep schedule is between its last run and the next one, from 0 to 1: used to
+/// interpolate what the schedule simulates. 0 for the schedules without a fixed timestep
+MECS_API double mecsWorldGetScheduleInterpolation(MecsWorld* world, MecsScheduleID scheduleID);
 MECS_API MecsSystemID mecsWorldDefineSystem(MecsWorld* world, const MecsDefineSystemInfo* systemInfo, MecsScheduleID scheduleID);
+/// Whether the two systems can't run at the same time: one of them writes (Access) a component or a resource the other
+/// one reads or writes, or one of them is MecsSystemFlags_Exclusive
+MECS_API bool mecsWorldSystemsConflict(MecsWorld* world, MecsScheduleID scheduleA, MecsSystemID systemA, MecsScheduleID scheduleB, MecsSystemID systemB);
+
+/// Observers
+/// An observer is called by mecsWorldFlushEvents() with all the entities that had an event of its component, instead of
+/// one call per entity like the setup and teardown of the component. The Added and Changed events are delivered at the
+/// end of the flush, or earlier when a removal follows them, so that an observer never gets a component after its
+/// removal. The Removed events are delivered before the components are torn down: together for each phase of a
+/// batched flush (see MecsWorldFlags_BatchedFlush), otherwise one at a time.
+/// The observers must not spawn nor destroy entities, or add and remove components
+MECS_API MecsObserverID mecsWorldDefineObserver(MecsWorld* world, const MecsDefineObserverInfo* observerInfo);
+/// Reports the component of the entity as changed to the MecsObserverEvent_Changed observers at the next flush,
+/// once for each call
+MECS_API void mecsWorldEntityComponentChanged(MecsWorld* world, MecsEntityID entity, MecsComponentID component);
+
+/// Resources
+/// A resource is an instance of a registered component owned by the world instead of an entity, at most one for each
+/// component: it's found by the component ID in O(1) and it's never part of an archetype, so it's not iterated.
+/// The resources are copied by mecsWorldClone(), but not by the snapshots nor the deltas
+/// Initializes the resource like a new component and returns it, the world must not have it yet. Tags can't be resources
+MECS_API void* mecsWorldAddResource(MecsWorld* world, MecsComponentID component);
+/// NULL when the world doesn't have the resource. The resource counts as changed, see mecsWorldGetResourceVersion()
+MECS_API void* mecsWorldGetResource(MecsWorld* world, MecsComponentID component);
+/// Like mecsWorldGetResource(), for the resources that are only read
+MECS_API const void* mecsWorldReadResource(MecsWorld* world, MecsComponentID component);
+/// Increases each time the resource is added or got with mecsWorldGetResource(), 0 if the world never had it. The versions
+/// of all the resources of a world grow from the same counter
+MECS_API MecsU64 mecsWorldGetResourceVersion(MecsWorld* world, MecsComponentID component);
+MECS_API bool mecsWorldHasResource(MecsWorld* world, MecsComponentID component);
+MECS_API void mecsWorldRemoveResource(MecsWorld* world, MecsComponentID component);
+
+/// Hierarchy
+/// An entity can be the child of another one (the ChildOf relationship): the children are destroyed with their parent,
+/// and the iterators set with mecsIteratorSetHierarchyOrder() visit the parents before their children.
+/// The links take effect immediately. They're copied by mecsWorldClone(), but not by mecsWorldDuplicateEntity(), the
+/// snapshots nor the deltas
+/// Pass MECS_INVALID as the parent to make the entity a root again. An entity cannot become the child of its descendants
+MECS_API void mecsWorldEntitySetParent(MecsWorld* world, MecsEntityID child, MecsEntityID parent);
+/// MECS_INVALID for the roots
+MECS_API MecsEntityID mecsWorldEntityGetParent(MecsWorld* world, MecsEntityID entity);
+MECS_API MecsSize mecsWorldEntityGetNumChildren(MecsWorld* world, MecsEntityID entity);
+/// The children are walked from the first child through the next siblings, until MECS_INVALID
+MECS_API MecsEntityID mecsWorldEntityGetFirstChild(MecsWorld* world, MecsEntityID entity);
+MECS_API MecsEntityID mecsWorldEntityGetNextSibling(MecsWorld* world, MecsEntityID entity);
+/// The number of ancestors of the entity, 0 for the roots
+MECS_API MecsU32 mecsWorldEntityGetDepth(MecsWorld* world, MecsEntityID entity);
+
+/// Tracing
+/// The hooks are called around each schedule, system and flush of the world, see MecsTraceHooks
+/// Pass null to stop tracing, the hooks are copied
+MECS_API void mecsWorldSetTraceHooks(MecsWorld* world, const MecsTraceHooks* hooks);
 
 /// Utilities
 
@@ -48,4 +116,17 @@ MECS_API MecsEntityID mecsWorldEntityIndexToID(MecsWorld* world, MecsU32 entityI
 
 MECS_API MecsRegistry* mecsWorldGetRegistry(MecsWorld* world);
 
+/// Statistics
+
+/// @brief Fills outStats with the entity, archetype, memory and event counts of the world
+MECS_API void mecsWorldGetStats(MecsWorld* world, MecsWorldStats* outStats);
+/// @brief Fills outStats with the row counts and memory of an archetype
+/// @param archetypeIndex must be less than MecsWorldStats::numArchetypes
+MECS_API void mecsWorldGetArchetypeStats(MecsWorld* world, MecsSize archetypeIndex, MecsArchetypeStats* outStats);
+/// @brief Retrieves the component of an archetype at the given index
+/// @param index must be less than MecsArchetypeStats::numComponents
+MECS_API MecsComponentID mecsWorldGetArchetypeComponentByIndex(MecsWorld* world, MecsSize archetypeIndex, MecsSize index);
+/// @brief Fills outStats with the memory used by a component across all the archetypes of the world
+MECS_API void mecsWorldGetComponentStats(MecsWorld* world, MecsComponentID component, MecsComponentStats* outStats);
+
 MECS_ENDEXTERNCPP()
@@ -7,7 +7,11 @@
 #include "mecs/world.h"
 #include "mecshpp/base.hpp"
 #include "mecshpp/mecsrtti.hpp"
+#include "mecshpp/serializer.hpp"
 
+#include <bit>
+#include <functional>
+#include <span>
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
@@ -30,33 +34,123 @@ struct With { };
 template <typename T>
 struct Not { };
 
+// A world resource as an iterator argument (see mecsWorldAddResource()), fetched once per archetype: Res only reads the
+// resource, ResMut may write it. A system declares the resources of its arguments like its components, see
+// mecsWorldSystemsConflict(). The world must have the resource when the iterator is advanced
+template <typename T>
+class Res {
+public:
+    explicit Res(const T* resource)
+        : mResource(resource)
+    {
+    }
+    const T& operator*() const { return *mResource; }
+    const T* operator->() const { return mResource; }
+
+private:
+    const T* mResource;
+};
+
+template <typename T>
+class ResMut {
+public:
+    explicit ResMut(T* resource)
+        : mResource(resource)
+    {
+    }
+    T& operator*() const { return *mResource; }
+    T* operator->() const { return mResource; }
+
+private:
+    T* mResource;
+};
+
+// A list of components known at compile time: a Registry built from a list registers its components before any other,
+// so that the ID of each component is its index in the list
+template <typename... Ts>
+struct ComponentList {
+    constexpr static MecsSize kCount = sizeof...(Ts);
+
+    template <typename T>
+    constexpr static bool contains()
+    {
+        return (std::is_same_v<T, Ts> || ...);
+    }
+
+    template <typename T>
+        requires(contains<T>())
+    constexpr static ComponentID idOf()
+    {
+        constexpr bool kMatches[] = { std::is_same_v<T, Ts>... };
+        MecsU32 index = 0;
+        while (!kMatches[index]) {
+            index++;
+        }
+        return { index };
+    }
+};
+
+// Specialized by MECS_STATIC_COMPONENTS for the components whose ID is known at compile time
+template <typename T>
+struct StaticComponentID {
+    constexpr static bool kIsStatic = false;
+};
+
+template <typename T>
+concept HasStaticComponentID = StaticComponentID<T>::kIsStatic;
+
+// Gives the components of List, a mecs::ComponentList, their index in the list as ID at compile time.
+// Like the RTTI macros it must be used at global scope and visible wherever the components are used, and the registries
+// must be built from the list: mecs::Registry registry(List {}, registryInfo)
+#define MECS_STATIC_COMPONENTS(List)                                                \
+    template <typename T>                                                           \
+        requires(List::template contains<T>())                                      \
+    struct mecs::StaticComponentID<T> {                                             \
+        constexpr static bool kIsStatic = true;                                     \
+        constexpr static mecs::ComponentID kID = List::template idOf<T>();          \
+    }
+
 template <typename T>
     requires(HasRTTI<T>)
 struct RegistrationInfo {
     inline static mecs::ComponentID mComponentId {};
-    static mecs::ComponentID init(MecsRegistry* reg)
+    static mecs::ComponentID init(MecsRegistry* reg, MecsComponentStorage storage = MecsComponentStorage_Archetype)
     {
         const auto& rtti = rttiOf<T>();
         const ComponentInfo componentInfo {
             .typeID = rtti.typeID,
             .name = rtti.name,
-            .size = rtti.size,
+            // Empty types are registered as tags, without a column
+            .size = std::is_empty_v<T> ? 0 : rtti.size,
             .align = rtti.align,
             .init = rtti.init,
-            .copy = rtti.copy,
-            .move = rtti.move,
-            .destroy = rtti.destroy,
+            // Without callbacks the trivially copyable components are copied with memcpy, in bulk when possible
+            .copy = rtti.triviallyCopyable ? nullptr : rtti.copy,
+            .move = rtti.triviallyCopyable ? nullptr : rtti.move,
+            .destroy = rtti.triviallyCopyable ? nullptr : rtti.destroy,
             .setup = rtti.setup,
             .teardown = rtti.teardown,
             .defaultInstance = rtti.defaultValue,
+            // The trivially copyable components are written as they are, so that they can be mapped from a file
+            .serialize = rtti.triviallyCopyable ? nullptr : detail::serializeComponent<T>,
+            .deserialize = rtti.triviallyCopyable ? nullptr : detail::deserializeComponent<T>,
+            .storage = storage,
         };
         mComponentId = { mecsRegistryAddRegistration(reg, &componentInfo) };
+        if constexpr (HasStaticComponentID<T>) {
+            MECS_ASSERT(mComponentId == StaticComponentID<T>::kID && "A component with a static ID must be registered through the ComponentList it belongs to");
+        }
         return mComponentId;
     }
-    static ComponentID getComponentID()
+    // Folds to a constant for the components with a static ID
+    constexpr static ComponentID getComponentID()
     {
-        MECS_ASSERT(mComponentId.isValid());
-        return mComponentId;
+        if constexpr (HasStaticComponentID<T>) {
+            return StaticComponentID<T>::kID;
+        } else {
+            MECS_ASSERT(mComponentId.isValid());
+            return mComponentId;
+        }
     }
 };
 namespace detail {
@@ -79,6 +173,14 @@ namespace detail {
         {
             return { mecsIteratorGetEntity(iterator) };
         }
+        static const RawType* getColumn(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return reinterpret_cast<const RawType*>(mecsIteratorGetEntities(iterator));
+        }
+        static RawType fromColumn(const RawType* column, MecsSize row)
+        {
+            return column[row];
+        }
     };
 
     template <typename T>
@@ -92,9 +194,17 @@ namespace detail {
         {
             mecsIterComponentFilter(iterator, RegistrationInfo<RawType>::getComponentID().id(), MecsIteratorFilter::Access, argIndex);
         }
-        static RawType& getArgument(MecsIterator* iterator, MecsSize argIndex)
+        static Pointer getArgument(MecsIterator* iterator, MecsSize argIndex)
         {
-            return *reinterpret_cast<RawType*>(mecsIteratorGetArgument(iterator, argIndex));
+            return reinterpret_cast<Pointer>(mecsIteratorGetArgument(iterator, argIndex));
+        }
+        static Pointer getColumn(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return reinterpret_cast<Pointer>(mecsIteratorGetColumn(iterator, argIndex));
+        }
+        static Pointer fromColumn(Pointer column, MecsSize row)
+        {
+            return std::is_empty_v<RawType> ? column : column + row;
         }
     };
 
@@ -104,14 +214,22 @@ namespace detail {
         using Pointer = const T*;
         constexpr static bool kIsConst = true;
         constexpr static bool kIsComponent = true;
-        constexpr static MecsIteratorFilter kFilterType = MecsIteratorFilter::Access;
+        constexpr static MecsIteratorFilter kFilterType = MecsIteratorFilter::Read;
         static void addArgument(MecsIterator* iterator, MecsSize argIndex)
         {
-            mecsIterComponentFilter(iterator, RegistrationInfo<RawType>::getComponentID().id(), MecsIteratorFilter::Access, argIndex);
+            mecsIterComponentFilter(iterator, RegistrationInfo<RawType>::getComponentID().id(), MecsIteratorFilter::Read, argIndex);
         }
-        static RawType& getArgument(MecsIterator* iterator, MecsSize argIndex)
+        static Pointer getArgument(MecsIterator* iterator, MecsSize argIndex)
         {
-            return *reinterpret_cast<RawType*>(mecsIteratorGetArgument(iterator, argIndex));
+            return reinterpret_cast<Pointer>(mecsIteratorGetArgument(iterator, argIndex));
+        }
+        static Pointer getColumn(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return reinterpret_cast<Pointer>(mecsIteratorGetColumn(iterator, argIndex));
+        }
+        static Pointer fromColumn(Pointer column, MecsSize row)
+        {
+            return std::is_empty_v<RawType> ? column : column + row;
         }
     };
 
@@ -130,6 +248,14 @@ namespace detail {
         {
             return *reinterpret_cast<RawType*>(mecsIteratorGetArgument(iterator, argIndex));
         }
+        static Pointer getColumn(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return reinterpret_cast<Pointer>(mecsIteratorGetColumn(iterator, argIndex));
+        }
+        static auto& fromColumn(Pointer column, MecsSize row)
+        {
+            return std::is_empty_v<RawType> ? *column : column[row];
+        }
     };
 
     template <typename T>
@@ -138,15 +264,23 @@ namespace detail {
         using Pointer = const T*;
         constexpr static bool kIsConst = true;
         constexpr static bool kIsComponent = true;
-        constexpr static MecsIteratorFilter kFilterType = MecsIteratorFilter::Access;
+        constexpr static MecsIteratorFilter kFilterType = MecsIteratorFilter::Read;
         static void addArgument(MecsIterator* iterator, MecsSize argIndex)
         {
-            mecsIterComponentFilter(iterator, RegistrationInfo<RawType>::getComponentID().id(), MecsIteratorFilter::Access, argIndex);
+            mecsIterComponentFilter(iterator, RegistrationInfo<RawType>::getComponentID().id(), MecsIteratorFilter::Read, argIndex);
         }
         static RawType& getArgument(MecsIterator* iterator, MecsSize argIndex)
         {
             return *reinterpret_cast<RawType*>(mecsIteratorGetArgument(iterator, argIndex));
         }
+        static Pointer getColumn(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return reinterpret_cast<Pointer>(mecsIteratorGetColumn(iterator, argIndex));
+        }
+        static auto& fromColumn(Pointer column, MecsSize row)
+        {
+            return std::is_empty_v<RawType> ? *column : column[row];
+        }
     };
 
     template <typename T>
@@ -165,6 +299,14 @@ namespace detail {
         {
             return {};
         }
+        static Pointer getColumn(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return nullptr;
+        }
+        static With<T> fromColumn(Pointer column, MecsSize row)
+        {
+            return {};
+        }
     };
     template <typename T>
     struct ParameterInfo<Not<T>> {
@@ -182,21 +324,104 @@ namespace detail {
         {
             return {};
         }
+        static Pointer getColumn(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return nullptr;
+        }
+        static Not<T> fromColumn(Pointer column, MecsSize row)
+        {
+            return {};
+        }
+    };
+
+    template <typename T>
+    struct ParameterInfo<Res<T>> {
+        using RawType = T;
+        using Pointer = const T*;
+        constexpr static bool kIsConst = true;
+        constexpr static bool kIsComponent = false;
+        constexpr static bool kIsResource = true;
+        constexpr static MecsIteratorFilter kFilterType = MecsIteratorFilter::Read;
+        static void addArgument(MecsIterator* iterator, MecsSize argIndex)
+        {
+        }
+        static Res<T> getArgument(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return Res<T> { getColumn(iterator, argIndex) };
+        }
+        static Pointer getColumn(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return static_cast<Pointer>(mecsWorldReadResource(mecsIteratorGetWorld(iterator), RegistrationInfo<T>::getComponentID().id()));
+        }
+        static Res<T> fromColumn(Pointer column, MecsSize row)
+        {
+            return Res<T> { column };
+        }
+    };
+
+    template <typename T>
+    struct ParameterInfo<ResMut<T>> {
+        using RawType = T;
+        using Pointer = T*;
+        constexpr static bool kIsConst = false;
+        constexpr static bool kIsComponent = false;
+        constexpr static bool kIsResource = true;
+        constexpr static MecsIteratorFilter kFilterType = MecsIteratorFilter::Access;
+        static void addArgument(MecsIterator* iterator, MecsSize argIndex)
+        {
+        }
+        static ResMut<T> getArgument(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return ResMut<T> { getColumn(iterator, argIndex) };
+        }
+        static Pointer getColumn(MecsIterator* iterator, MecsSize argIndex)
+        {
+            return static_cast<Pointer>(mecsWorldGetResource(mecsIteratorGetWorld(iterator), RegistrationInfo<T>::getComponentID().id()));
+        }
+        static ResMut<T> fromColumn(Pointer column, MecsSize row)
+        {
+            return ResMut<T> { column };
+        }
+    };
+
+    template <typename A>
+    concept ResourceParameter = ParameterInfo<A>::kIsResource;
+
+    // The resources among the arguments of a system, see MecsDefineSystemInfo::pResources
+    template <typename... Args>
+    struct ResourceAccess {
+        std::array<MecsComponentID, sizeof...(Args)> resources {};
+        std::array<MecsIteratorFilter, sizeof...(Args)> filters {};
+        MecsU32 count = 0;
     };
 
+    template <typename... Args>
+    ResourceAccess<Args...> queryResourceAccess()
+    {
+        ResourceAccess<Args...> access;
+        ([&] {
+            if constexpr (ResourceParameter<Args>) {
+                access.resources[access.count] = RegistrationInfo<typename ParameterInfo<Args>::RawType>::getComponentID().id();
+                access.filters[access.count] = ParameterInfo<Args>::kFilterType;
+                access.count++;
+            }
+        }(), ...);
+        return access;
+    }
+
     template<typename... Args>
     constexpr MecsSize countComponents()
     {
         return sizeof...(Args);
     }
     template<MecsSize S>
-    void addComponentIDs(std::array<MecsComponentID, S>&, size_t)
+    constexpr void addComponentIDs(std::array<MecsComponentID, S>&, size_t)
     {
 
     }
 
     template<MecsSize S, typename A>
-    void addComponentIDs(std::array<MecsComponentID, S>& outArray, size_t idx)
+    constexpr void addComponentIDs(std::array<MecsComponentID, S>& outArray, size_t idx)
     {
         if constexpr (ParameterInfo<A>::kIsComponent) {
             outArray[idx] = RegistrationInfo<typename ParameterInfo<A>::RawType>::getComponentID().id();
@@ -207,7 +432,7 @@ namespace detail {
 
     template<MecsSize S, typename A, typename... Rest>
         requires (sizeof...(Rest) > 0)
-    void addComponentIDs(std::array<MecsComponentID, S>& outArray, size_t idx)
+    constexpr void addComponentIDs(std::array<MecsComponentID, S>& outArray, size_t idx)
     {
 
         if constexpr (ParameterInfo<A>::kIsComponent) {
@@ -247,6 +472,16 @@ namespace detail {
     }
 }
 
+// The component IDs of a query, MECS_INVALID for the arguments that are not components.
+// Evaluated at compile time when all the components have a static ID
+template <typename... Args>
+constexpr std::array<MecsComponentID, sizeof...(Args)> queryComponentIDs()
+{
+    std::array<MecsComponentID, sizeof...(Args)> componentIDs {};
+    detail::addComponentIDs<sizeof...(Args), Args...>(componentIDs, 0);
+    return componentIDs;
+}
+
 namespace detail {
     template <typename... Args, std::size_t... I>
     void initIterator(MecsIterator* iterator, std::index_sequence<I...> idx)
@@ -260,6 +495,31 @@ namespace detail {
         return { detail::ParameterInfo<Args>::getArgument(iterator, I)... };
     }
 
+    template <typename... Args, std::size_t... I>
+    auto getIteratorColumns(MecsIterator* iterator, std::index_sequence<I...> idx)
+    {
+        return std::tuple { detail::ParameterInfo<Args>::getColumn(iterator, I)... };
+    }
+
+    template <typename... Args, typename Columns, std::size_t... I, typename Func>
+    void callColumnsHelper(const Columns& columns, MecsSize rows, const MecsU32* enabledRows, Func&& func, std::index_sequence<I...> idx)
+    {
+        if (enabledRows == nullptr) {
+            for (MecsSize row = 0; row < rows; row++) {
+                func(detail::ParameterInfo<Args>::fromColumn(std::get<I>(columns), row)...);
+            }
+            return;
+        }
+        // Some entities have disabled components: only visit the set bits, see mecsIteratorGetEnabledRows()
+        constexpr MecsSize kRowsPerWord = sizeof(MecsU32) * 8;
+        for (MecsSize word = 0; word * kRowsPerWord < rows; word++) {
+            for (MecsU32 bits = enabledRows[word]; bits != 0; bits &= bits - 1) {
+                const MecsSize row = word * kRowsPerWord + std::countr_zero(bits);
+                func(detail::ParameterInfo<Args>::fromColumn(std::get<I>(columns), row)...);
+            }
+        }
+    }
+
     template <typename... Args, std::size_t... I, typename Func>
     void callFuncHelper(const std::tuple<Args...>& values, Func&& func, std::index_sequence<I...> idx)
     {
@@ -275,6 +535,82 @@ namespace detail {
     template<typename S, typename Run, typename A, typename R>
     struct SystemBinderHelper;
 
+    template<typename S>
+    concept HasEntitiesAdded = requires(S& system, World& world, std::span<const EntityID> entities)
+    {
+        {system.onEntitiesAdded(world, entities)};
+    };
+
+    template<typename S>
+    concept HasEntitiesRemoved = requires(S& system, World& world, std::span<const EntityID> entities)
+    {
+        {system.onEntitiesRemoved(world, entities)};
+    };
+
+    static_assert(sizeof(EntityID) == sizeof(MecsEntityID) && alignof(EntityID) == alignof(MecsEntityID));
+
+    // Binds S::onEntitiesAdded and S::onEntitiesRemoved when S has them,
+    // these are called instead of onEntityAdded/onEntityRemoved with all the entities of a flush
+    template<typename S>
+    constexpr void bindBatchedCallbacks(MecsDefineSystemInfo& info)
+    {
+        if constexpr(HasEntitiesAdded<S>) {
+            info.onEntitiesAdded = [](void* sysData, void* updateData, const MecsEntityID* pEntities, MecsSize numEntities) {
+                S& sys = *static_cast<S*>(sysData);
+                World& world = *static_cast<World*>(updateData);
+                sys.onEntitiesAdded(world, std::span<const EntityID>(reinterpret_cast<const EntityID*>(pEntities), numEntities));
+            };
+        } else {
+            info.onEntitiesAdded = nullptr;
+        }
+        if constexpr(HasEntitiesRemoved<S>) {
+            info.onEntitiesRemoved = [](void* sysData, void* updateData, const MecsEntityID* pEntities, MecsSize numEntities) {
+                S& sys = *static_cast<S*>(sysData);
+                World& world = *static_cast<World*>(updateData);
+                sys.onEntitiesRemoved(world, std::span<const EntityID>(reinterpret_cast<const EntityID*>(pEntities), numEntities));
+            };
+        } else {
+            info.onEntitiesRemoved = nullptr;
+        }
+    }
+
+    template<typename S>
+    concept HasRunInterval = requires { {S::kRunInterval} -> std::convertible_to<MecsU32>; };
+
+    template<typename S>
+    concept HasRunConditions = requires { {S::kRunConditions} -> std::convertible_to<int>; };
+
+    template<typename S>
+    concept HasShouldRun = requires(S& system, World& world)
+    {
+        {system.shouldRun(world)} -> std::convertible_to<bool>;
+    };
+
+    // Binds S::kRunInterval, S::kRunConditions and S::shouldRun when S has them, see MecsDefineSystemInfo::runInterval
+    template<typename S>
+    constexpr void bindRunConditions(MecsDefineSystemInfo& info)
+    {
+        if constexpr(HasRunInterval<S>) {
+            info.runInterval = S::kRunInterval;
+        } else {
+            info.runInterval = 0;
+        }
+        if constexpr(HasRunConditions<S>) {
+            info.runConditions = S::kRunConditions;
+        } else {
+            info.runConditions = MecsSystemRunConditions_None;
+        }
+        if constexpr(HasShouldRun<S>) {
+            info.runCondition = [](void* sysData, void* updateData, MecsWorld*) -> bool {
+                S& sys = *static_cast<S*>(sysData);
+                World& world = *static_cast<World*>(updateData);
+                return sys.shouldRun(world);
+            };
+        } else {
+            info.runCondition = nullptr;
+        }
+    }
+
     template<typename S = void>
     struct BasicSystemHelper {
         constexpr static bool kValue = false;
@@ -295,13 +631,13 @@ namespace detail {
         template<
             void(S::*systemRun)(World&, Iterator<Args...>&),
             void(S::*onEntityAdded)(World&, EntityID) = nullptr,
-            void(S::*onEntityRemoved)(World&, EntityID) = nullptr>
+            void(S::*onEntityRemoved)(World&, EntityID) = nullptr,
+            bool kBindBatched = false>
         constexpr static MecsSystemID bind(MecsWorld* world, S* base, MecsScheduleID scheduleID)
         {
             constexpr MecsSize kNumComponents = detail::countComponents<Args...>();
-            std::array<MecsComponentID, kNumComponents> componentIDs;
+            std::array<MecsComponentID, kNumComponents> componentIDs = queryComponentIDs<Args...>();
             std::array<MecsIteratorFilter, kNumComponents> filters;
-            detail::addComponentIDs<kNumComponents, Args...>(componentIDs, 0);
             detail::addFilter<kNumComponents, Args...>(filters, 0);
 
             MecsDefineSystemInfo info;
@@ -327,6 +663,12 @@ namespace detail {
             } else {
                 info.onEntityRemoved = nullptr;
             }
+            if constexpr(kBindBatched) {
+                bindBatchedCallbacks<S>(info);
+            } else {
+                info.onEntitiesAdded = nullptr;
+                info.onEntitiesRemoved = nullptr;
+            }
 
             info.systemRun = [](void* sysData, void* updateData, MecsIterator* iterator) {
                 S& sys = *static_cast<S*>(sysData);
@@ -337,6 +679,12 @@ namespace detail {
             };
 
             info.systemFlags = 0;
+            info.systemName = nullptr;
+            auto resources = detail::queryResourceAccess<Args...>();
+            info.numResources = resources.count;
+            info.pResources = resources.resources.data();
+            info.pResourceFilters = resources.filters.data();
+            bindRunConditions<S>(info);
 
             return mecsWorldDefineSystem(world, &info, scheduleID);
         }
@@ -350,13 +698,13 @@ namespace detail {
         void*> {
 
         template<
-            void(S::*systemRun)(World&, Iterator<Args...>&)>
+            void(S::*systemRun)(World&, Iterator<Args...>&),
+            bool kBindBatched = false>
         constexpr static MecsSystemID bind(MecsWorld* world, S* base, MecsScheduleID scheduleID)
         {
             constexpr MecsSize kNumComponents = detail::countComponents<Args...>();
-            std::array<MecsComponentID, kNumComponents> componentIDs;
+            std::array<MecsComponentID, kNumComponents> componentIDs = queryComponentIDs<Args...>();
             std::array<MecsIteratorFilter, kNumComponents> filters;
-            detail::addComponentIDs<kNumComponents, Args...>(componentIDs, 0);
             detail::addFilter<kNumComponents, Args...>(filters, 0);
 
             MecsDefineSystemInfo info;
@@ -366,6 +714,12 @@ namespace detail {
             info.systemData = reinterpret_cast<void*>(base);
             info.onEntityAdded = nullptr;
             info.onEntityRemoved = nullptr;
+            if constexpr(kBindBatched) {
+                bindBatchedCallbacks<S>(info);
+            } else {
+                info.onEntitiesAdded = nullptr;
+                info.onEntitiesRemoved = nullptr;
+            }
 
             info.systemRun = [](void* sysData, void* updateData, MecsIterator* iterator) {
                 S& sys = *static_cast<S*>(sysData);
@@ -376,27 +730,33 @@ namespace detail {
             };
 
             info.systemFlags = 0;
+            info.systemName = nullptr;
+            auto resources = detail::queryResourceAccess<Args...>();
+            info.numResources = resources.count;
+            info.pResources = resources.resources.data();
+            info.pResourceFilters = resources.filters.data();
+            bindRunConditions<S>(info);
 
             return mecsWorldDefineSystem(world, &info, scheduleID);
         }
     };
 
-    template<typename S, auto systemRun, auto onEntityAdded, auto onEntityRemoved>
+    template<typename S, auto systemRun, auto onEntityAdded, auto onEntityRemoved, bool kBindBatched = false>
     constexpr static MecsSystemID bindStaticSystem(MecsWorld* world, S* base, MecsScheduleID scheduleID)
     {
         return SystemBinderHelper<
             S,
             decltype(systemRun),
             decltype(onEntityAdded),
-            decltype(onEntityRemoved)>::template bind<systemRun, onEntityAdded, onEntityRemoved>(world, base, scheduleID);
+            decltype(onEntityRemoved)>::template bind<systemRun, onEntityAdded, onEntityRemoved, kBindBatched>(world, base, scheduleID);
     }
 
-    template<typename S, auto systemRun>
+    template<typename S, auto systemRun, bool kBindBatched = false>
     constexpr static MecsSystemID bindStaticSystem(MecsWorld* world, S* base, MecsScheduleID scheduleID)
     {
         return SystemBinderHelper<
             S,
-            decltype(systemRun), void*, void*>::template bind<systemRun>(world, base, scheduleID);
+            decltype(systemRun), void*, void*>::template bind<systemRun, kBindBatched>(world, base, scheduleID);
     }
 }
 
@@ -588,6 +948,13 @@ class MECS_API ServiceRegistry {
 class MECS_API Registry {
 public:
     Registry(const MecsRegistryCreateInfo& registryInfo = {});
+    // Registers the components of the list first and in order, see MECS_STATIC_COMPONENTS
+    template <typename... Ts>
+    explicit Registry(ComponentList<Ts...>, const MecsRegistryCreateInfo& registryInfo = {})
+        : Registry(registryInfo)
+    {
+        (addRegistration<Ts>(), ...);
+    }
     ~Registry();
 
     MECS_CONSTRUCTORS(Registry)
@@ -621,9 +988,9 @@ class MECS_API Registry {
 
     template <typename T>
         requires(HasRTTI<T>)
-    ComponentID addRegistration()
+    ComponentID addRegistration(MecsComponentStorage storage = MecsComponentStorage_Archetype)
     {
-        return RegistrationInfo<T>::init(mHandle);
+        return RegistrationInfo<T>::init(mHandle, storage);
     }
 
     template <typename F>
@@ -683,6 +1050,10 @@ class MECS_API World {
 
     ScheduleID defineSchedule(const MecsDefineScheduleInfo& info);
     void runSchedule(ScheduleID scheduleID);
+    // Runs the schedule as many times as its fixed timestep allows, see mecsWorldUpdateSchedule()
+    MecsU32 updateSchedule(ScheduleID scheduleID, double deltaSeconds);
+    [[nodiscard]]
+    double getScheduleInterpolation(ScheduleID scheduleID) const;
 
     template <typename S, auto Run, auto Add, auto Remove>
     MecsSystemID addSystem(S* system, ScheduleID scheduleID)
@@ -696,28 +1067,62 @@ class MECS_API World {
         return mecs::detail::bindStaticSystem<S, Run>(mHandle, system, scheduleID.mID);
     }
 
+    // S::onEntitiesAdded(World&, std::span<const EntityID>) and S::onEntitiesRemoved(World&, std::span<const EntityID>)
+    // are detected too, and when present they receive all the entities of a flush at once
     template<BasicSystem S>
     MecsSystemID addSystem(S* system, ScheduleID scheduleID)
     {
         if constexpr(HasEntityAdded<S>) {
-            return mecs::detail::bindStaticSystem<S, &S::systemRun, &S::onEntityAdded, &S::onEntityRemoved>(mHandle, system, scheduleID.mID);
+            return mecs::detail::bindStaticSystem<S, &S::systemRun, &S::onEntityAdded, &S::onEntityRemoved, true>(mHandle, system, scheduleID.mID);
         } else {
-            return mecs::detail::bindStaticSystem<S, &S::systemRun>(mHandle, system, scheduleID.mID);
+            return mecs::detail::bindStaticSystem<S, &S::systemRun, true>(mHandle, system, scheduleID.mID);
         }
     }
 
+    // O::observe(World&, std::span<const EntityID>, std::span<T* const>) is called with the entities of a flush at once,
+    // see mecsWorldDefineObserver()
+    template <typename T, typename O>
+    MecsObserverID addObserver(MecsObserverEvent event, O* observer)
+    {
+        MecsDefineObserverInfo info {};
+        info.component = RegistrationInfo<T>::getComponentID().id();
+        info.event = event;
+        info.observerData = observer;
+        info.observe = [](void* observerData, void* updateData, const MecsEntityID* pEntities, void* const* pComponents, MecsSize count) {
+            O& obs = *static_cast<O*>(observerData);
+            World& world = *static_cast<World*>(updateData);
+            obs.observe(world, std::span<const EntityID>(reinterpret_cast<const EntityID*>(pEntities), count), std::span<T* const>(reinterpret_cast<T* const*>(pComponents), count));
+        };
+        return mecsWorldDefineObserver(mHandle, &info);
+    }
+
     EntityBuilder spawnEntity(const MecsEntityInfo& entityInfo = {});
     EntityBuilder spawnEntityPrefab(PrefabID prefab, const MecsEntityInfo& entityInfo = {});
     EntityBuilder duplicateEntity(World& destinationWorld, EntityID sourceEntity);
     EntityBuilder duplicateEntity(EntityID sourceEntity) { return duplicateEntity(*this, sourceEntity); }
+
+    // See mecsWorldClone()
+    void clone(World& destinationWorld, int cloneFlags = MecsWorldCloneFlags_None);
     void entityAddComponent(EntityID entity, ComponentID component);
     [[nodiscard]]
     bool entityHasComponent(EntityID entity, ComponentID component) const;
     [[nodiscard]]
     void* entityGetComponent(EntityID entity, ComponentID component) const;
     void entityRemoveComponent(EntityID entity, ComponentID component);
+    // See mecsWorldSetComponentEnabled()
+    void entitySetComponentEnabled(EntityID entity, ComponentID component, bool enabled);
+    // See mecsWorldEntitySetParent(), an invalid parent makes the entity a root
+    void entitySetParent(EntityID child, EntityID parent);
+    [[nodiscard]]
+    EntityID entityGetParent(EntityID entity) const;
+    [[nodiscard]]
+    MecsSize entityGetNumChildren(EntityID entity) const;
+    [[nodiscard]]
+    bool entityIsComponentEnabled(EntityID entity, ComponentID component) const;
     PrefabID entityGetPrefabID(EntityID entity) const;
     void entityChanged(EntityID entity);
+    // See mecsWorldEntityComponentChanged()
+    void entityComponentChanged(EntityID entity, ComponentID component);
     [[nodiscard]]
     MecsSize entityGetNumComponents(EntityID entity) const;
     [[nodiscard]]
@@ -725,6 +1130,17 @@ class MECS_API World {
     void destroyEntity(EntityID entity);
     void flushEvents();
 
+    // See mecsWorldAddResource()
+    void* addResource(ComponentID component);
+    [[nodiscard]]
+    void* getResource(ComponentID component);
+    [[nodiscard]]
+    bool hasResource(ComponentID component) const;
+    void removeResource(ComponentID component);
+    // See mecsWorldSystemsConflict()
+    [[nodiscard]]
+    bool systemsConflict(ScheduleID scheduleA, MecsSystemID systemA, ScheduleID scheduleB, MecsSystemID systemB) const;
+
     template <typename T>
     [[nodiscard]]
     bool entityHasComponent(EntityID entity) const
@@ -751,6 +1167,54 @@ class MECS_API World {
         return entityRemoveComponent(entity, RegistrationInfo<T>::getComponentID());
     }
 
+    template <typename T>
+    void entitySetComponentEnabled(EntityID entity, bool enabled)
+    {
+        entitySetComponentEnabled(entity, RegistrationInfo<T>::getComponentID(), enabled);
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    bool entityIsComponentEnabled(EntityID entity) const
+    {
+        return entityIsComponentEnabled(entity, RegistrationInfo<T>::getComponentID());
+    }
+
+    template <typename T>
+    void entityComponentChanged(EntityID entity)
+    {
+        entityComponentChanged(entity, RegistrationInfo<T>::getComponentID());
+    }
+
+    template <typename T, typename... Args>
+    T& addResource(Args&&... args)
+    {
+        T* resource = static_cast<T*>(addResource(RegistrationInfo<T>::getComponentID()));
+        *resource = T(std::forward<Args>(args)...);
+        return *resource;
+    }
+
+    // Null when the world doesn't have the resource
+    template <typename T>
+    [[nodiscard]]
+    T* getResource()
+    {
+        return static_cast<T*>(getResource(RegistrationInfo<T>::getComponentID()));
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    bool hasResource() const
+    {
+        return hasResource(RegistrationInfo<T>::getComponentID());
+    }
+
+    template <typename T>
+    void removeResource()
+    {
+        removeResource(RegistrationInfo<T>::getComponentID());
+    }
+
     template <typename... Args>
     Iterator<Args...> acquireIterator()
     {
@@ -763,6 +1227,56 @@ class MECS_API World {
         return mHandle;
     }
 
+    [[nodiscard]]
+    MecsWorldStats getStats() const
+    {
+        MecsWorldStats stats;
+        mecsWorldGetStats(mHandle, &stats);
+        return stats;
+    }
+
+    // Pass nullptr to stop tracing
+    void setTraceHooks(const MecsTraceHooks* hooks)
+    {
+        mecsWorldSetTraceHooks(mHandle, hooks);
+    }
+
+    bool serialize(const MecsWriter& writer)
+    {
+        return mecsWorldSerialize(mHandle, &writer);
+    }
+
+    // The world must not have any entity, see mecsWorldDeserialize()
+    bool deserialize(const MecsReader& reader)
+    {
+        return mecsWorldDeserialize(mHandle, &reader);
+    }
+
+    bool serializeToFile(const char* path)
+    {
+        return mecsWorldSerializeToFile(mHandle, path);
+    }
+
+    bool deserializeFromFile(const char* path)
+    {
+        return mecsWorldDeserializeFromFile(mHandle, path);
+    }
+
+    bool deserializeMappedFile(const char* path)
+    {
+        return mecsWorldDeserializeMappedFile(mHandle, path);
+    }
+
+    bool writeDelta(const MecsWorldSnapshot* snapshot, const MecsWriter& writer)
+    {
+        return mecsWorldWriteDelta(mHandle, snapshot, &writer);
+    }
+
+    bool applyDelta(const MecsReader& reader, void* updateData = nullptr)
+    {
+        return mecsWorldApplyDelta(mHandle, &reader, updateData);
+    }
+
     template <typename T>
     void registerService(T service)
     {
@@ -833,14 +1347,48 @@ class Iterator {
         return World { mecsIteratorGetWorld(mHandle) };
     }
 
+    // The columns of the arguments are fetched once per archetype, then func is called in a plain loop over them.
+    // func may destroy entities, since that's deferred, but must not add nor remove components of the entities being
+    // iterated or spawn entities into their archetype: iterate with begin()/advance()/get() to do that.
+    // The iterators with sparse components check each entity, and the iterators in hierarchy order visit the rows level by
+    // level, so they're advanced one entity at a time
     template <typename Func>
     void forEach(Func&& func)
     {
         begin();
-        while (advance()) {
-            auto value = get();
-            detail::callFuncHelper(value, func, std::make_index_sequence<sizeof...(Args)>());
+        if (mecsIteratorHasSparseArguments(mHandle) || mecsIteratorIsHierarchyOrdered(mHandle)) {
+            while (advance()) {
+                auto value = get();
+                detail::callFuncHelper(value, func, std::make_index_sequence<sizeof...(Args)>());
+            }
+            return;
         }
+        while (const MecsSize rows = mecsIteratorAdvanceArchetype(mHandle)) {
+            const auto columns = detail::getIteratorColumns<Args...>(mHandle, std::make_index_sequence<sizeof...(Args)>());
+            detail::callColumnsHelper<Args...>(columns, rows, mecsIteratorGetEnabledRows(mHandle), func, std::make_index_sequence<sizeof...(Args)>());
+        }
+    }
+
+    // See mecsIteratorSetHierarchyOrder()
+    void hierarchyOrder(bool enabled = true)
+    {
+        mecsIteratorSetHierarchyOrder(mHandle, enabled);
+    }
+
+    // See mecsIteratorGroupBy()
+    void groupBy(PFNMecsArchetypeGroup func, void* userData = nullptr)
+    {
+        mecsIteratorGroupBy(mHandle, func, userData);
+    }
+
+    // See mecsIteratorSortBy(), Less is a default constructible comparator of T like std::less<T> or a struct comparing
+    // one of its fields
+    template <typename T, typename Less = std::less<T>>
+    void sortBy()
+    {
+        mecsIteratorSortBy(mHandle, RegistrationInfo<T>::getComponentID().id(), [](const void* lhs, const void* rhs, void*) -> int {
+            return Less {}(*static_cast<const T*>(lhs), *static_cast<const T*>(rhs)) ? -1 : 0;
+        }, nullptr);
     }
 
     TupleType first()
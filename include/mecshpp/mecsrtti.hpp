@@ -54,6 +54,7 @@
         rttiI.kind = RttiKind::eStruct;                                                       \
         rttiI.size = sizeof(MecsCurrentT);                                                    \
         rttiI.align = alignof(MecsCurrentT);                                                  \
+        rttiI.triviallyCopyable = std::is_trivially_copyable_v<MecsCurrentT>;                 \
         rttiI.init = ::mecs::detail::init<MecsCurrentT>;                                      \
         rttiI.copy = ::mecs::detail::copy<MecsCurrentT>;                                      \
         rttiI.move = ::mecs::detail::move<MecsCurrentT>;                                      \
@@ -102,6 +103,7 @@
             rttiI.kind = RttiKind::eEnum;                                                                                    \
             rttiI.size = sizeof(MecsCurrentT);                                                                               \
             rttiI.align = alignof(MecsCurrentT);                                                                             \
+            rttiI.triviallyCopyable = std::is_trivially_copyable_v<MecsCurrentT>;                                            \
             rttiI.init = ::mecs::detail::init<MecsCurrentT>;                                                                 \
             rttiI.copy = ::mecs::detail::copy<MecsCurrentT>;                                                                 \
             rttiI.move = ::mecs::detail::move<MecsCurrentT>;                                                                 \
@@ -142,6 +144,7 @@
                 rttiI.kind = RttiKind::eField;                                                  \
                 rttiI.size = sizeof(MecsCurrentT);                                              \
                 rttiI.align = alignof(MecsCurrentT);                                            \
+                rttiI.triviallyCopyable = std::is_trivially_copyable_v<MecsCurrentT>;           \
                 rttiI.init = ::mecs::detail::init<MecsCurrentT>;                                \
                 rttiI.copy = ::mecs::detail::copy<MecsCurrentT>;                                \
                 rttiI.move = ::mecs::detail::move<MecsCurrentT>;                                \
@@ -210,6 +213,8 @@ struct RTTI {
     MecsSize customRttiKind;
     MecsSize size;
     MecsSize align;
+    // When set, the type can be copied with memcpy (see mecs::Serializer)
+    bool triviallyCopyable;
     PFNMecsComponentInit init;
     PFNMecsComponentCopy copy;
     PFNMecsComponentMove move;
@@ -511,6 +516,7 @@ struct RTTIDefine<std::vector<T>> {
             res.kind = RttiKind::eVec;
             res.size = sizeof(std::vector<T>);
             res.align = alignof(std::vector<T>);
+            res.triviallyCopyable = false;
             res.init = ::mecs::detail::init<std::vector<T>>;
             res.copy = ::mecs::detail::copy<std::vector<T>>;
             res.move = ::mecs::detail::move<std::vector<T>>;
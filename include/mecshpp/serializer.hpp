@@ -0,0 +1,89 @@
+#pragma once
+
+#include "mecs/base.h"
+#include "mecshpp/mecsrtti.hpp"
+
+#include <span>
+#include <vector>
+
+namespace mecs {
+
+enum class SerializeOpKind : MecsU8 {
+    // Copies size bytes starting at offset
+    eBytes,
+    // A std::string at offset, written as a MecsU32 length followed by its characters
+    eString,
+    // A std::vector at offset, written as a MecsU32 count followed by its elements
+    eVec,
+};
+
+struct SerializeOp {
+    SerializeOpKind kind;
+    MecsSize offset;
+
+    // eBytes: the number of bytes to copy, eVec: the size of an element
+    MecsSize size;
+
+    // eVec only: the ops of an element, stored in the same list.
+    // When packed the elements are trivially copyable and the whole vector is copied at once
+    const RTTIVec* vec;
+    MecsU32 firstOp;
+    MecsU32 numOps;
+    bool packed;
+};
+
+// Writes the values of a type with a compact binary format, driven by its RTTI.
+// The RTTI is walked once when the Serializer is built, producing a flat list of ops: the contiguous trivially copyable
+// members are merged into a single copy, so that writing a value is a loop over a handful of ops.
+// Only the members declared with MECS_RTTI_STRUCT_MEMBER are written, and the format holds no type information:
+// it can only be read back by a Serializer built from the same type
+class Serializer {
+public:
+    explicit Serializer(const RTTI& rtti);
+
+    bool serialize(const void* value, const MecsWriter& writer) const;
+
+    // value must be initialized, deserialize reads the members straight from the reader without buffering
+    bool deserialize(void* value, const MecsReader& reader) const;
+
+    // The ops of the serialized type, the ops of the vector elements are not included
+    std::span<const SerializeOp> ops() const;
+
+private:
+    struct OpRange {
+        MecsU32 first;
+        MecsU32 count;
+    };
+
+    OpRange compile(const RTTI& rtti);
+    void flatten(const RTTI& rtti, MecsSize offset, std::vector<SerializeOp>& outOps);
+
+    bool write(OpRange range, const void* value, const MecsWriter& writer) const;
+    bool read(OpRange range, void* value, const MecsReader& reader) const;
+
+    std::vector<SerializeOp> mOps;
+    OpRange mRoot {};
+};
+
+template <typename T>
+    requires(HasRTTI<T>)
+const Serializer& serializerOf()
+{
+    static const Serializer gSerializer(rttiOf<T>());
+    return gSerializer;
+}
+
+namespace detail {
+    template <typename T>
+    bool serializeComponent(const void* mem, const MecsWriter* writer)
+    {
+        return serializerOf<T>().serialize(mem, *writer);
+    }
+
+    template <typename T>
+    bool deserializeComponent(void* mem, const MecsReader* reader)
+    {
+        return serializerOf<T>().deserialize(mem, *reader);
+    }
+}
+}
@@ -0,0 +1,223 @@
+#include "mecs/allocator.h"
+#include "collections.h"
+#include "mecs/base.h"
+#include "private.h"
+
+#include <atomic>
+
+namespace {
+
+// Stored right before each allocation, since memFree does not receive the size of the allocation
+struct AllocationHeader {
+    MecsSize size;
+    MecsU32 tag;
+    MecsU32 offset; // From the start of the backing allocation to the returned pointer
+};
+
+struct AllocationCounters {
+    std::atomic<MecsSize> currentBytes { 0 };
+    std::atomic<MecsSize> peakBytes { 0 };
+    std::atomic<MecsSize> numAllocations { 0 };
+    std::atomic<MecsSize> totalAllocations { 0 };
+
+    void add(MecsSize bytes)
+    {
+        const MecsSize current = currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        MecsSize peak = peakBytes.load(std::memory_order_relaxed);
+        while (current > peak && !peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) { }
+        numAllocations.fetch_add(1, std::memory_order_relaxed);
+        totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void remove(MecsSize bytes)
+    {
+        currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        numAllocations.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void read(MecsAllocationStats* outStats) const
+    {
+        outStats->currentBytes = currentBytes.load(std::memory_order_relaxed);
+        outStats->peakBytes = peakBytes.load(std::memory_order_relaxed);
+        outStats->numAllocations = numAllocations.load(std::memory_order_relaxed);
+        outStats->totalAllocations = totalAllocations.load(std::memory_order_relaxed);
+    }
+};
+
+// The userData of the allocator of each tag
+struct TrackedCategory {
+    MecsTrackingAllocator* allocator;
+    MecsAllocationTag tag;
+};
+
+}
+
+struct MecsTrackingAllocator_t {
+    MecsAllocator backingAllocator;
+    TrackedCategory categories[MecsAllocationTag_Count];
+    AllocationCounters counters[MecsAllocationTag_Count];
+    AllocationCounters total;
+};
+
+namespace {
+
+MecsSize mecsHeaderOffset(MecsSize align)
+{
+    return std::max<MecsSize>(sizeof(AllocationHeader), align);
+}
+
+AllocationHeader* mecsHeaderOf(void* ptr)
+{
+    return reinterpret_cast<AllocationHeader*>(static_cast<char*>(ptr) - sizeof(AllocationHeader));
+}
+
+void mecsTrackAllocation(MecsTrackingAllocator* allocator, MecsAllocationTag tag, MecsSize size)
+{
+    allocator->counters[tag].add(size);
+    allocator->total.add(size);
+}
+
+void mecsUntrackAllocation(MecsTrackingAllocator* allocator, const AllocationHeader& header)
+{
+    allocator->counters[header.tag].remove(header.size);
+    allocator->total.remove(header.size);
+}
+
+// Writes the header at the start of the backing allocation, returns the pointer handed out to mecs
+void* mecsPlaceHeader(void* block, MecsSize size, MecsAllocationTag tag, MecsSize offset)
+{
+    void* ptr = static_cast<char*>(block) + offset;
+    *mecsHeaderOf(ptr) = AllocationHeader {
+        .size = size,
+        .tag = static_cast<MecsU32>(tag),
+        .offset = static_cast<MecsU32>(offset),
+    };
+    return ptr;
+}
+
+void* mecsTrackingMalloc(void* userData, MecsSize size, MecsSize align)
+{
+    const auto* category = static_cast<const TrackedCategory*>(userData);
+    const MecsAllocator& backing = category->allocator->backingAllocator;
+    const MecsSize offset = mecsHeaderOffset(align);
+    void* block = backing.memAlloc(backing.userData, offset + size, std::max(align, alignof(AllocationHeader)));
+    if (block == nullptr) { return nullptr; }
+
+    mecsTrackAllocation(category->allocator, category->tag, size);
+    return mecsPlaceHeader(block, size, category->tag, offset);
+}
+
+// The header records the size of the old allocation, so oldSize isn't needed
+void* mecsTrackingRealloc(void* userData, void* old, [[maybe_unused]] MecsSize oldSize, MecsSize align, MecsSize newSize)
+{
+    if (old == nullptr) {
+        return mecsTrackingMalloc(userData, newSize, align);
+    }
+
+    const auto* category = static_cast<const TrackedCategory*>(userData);
+    const MecsAllocator& backing = category->allocator->backingAllocator;
+    const AllocationHeader header = *mecsHeaderOf(old);
+    MECS_ASSERT(header.offset == mecsHeaderOffset(align) && "Reallocating with a different alignment");
+
+    void* oldBlock = static_cast<char*>(old) - header.offset;
+    void* block = backing.memRealloc(backing.userData, oldBlock, header.offset + header.size, std::max(align, alignof(AllocationHeader)), header.offset + newSize);
+    if (block == nullptr) { return nullptr; }
+
+    mecsUntrackAllocation(category->allocator, header);
+    mecsTrackAllocation(category->allocator, category->tag, newSize);
+    return mecsPlaceHeader(block, newSize, category->tag, header.offset);
+}
+
+void mecsTrackingFree(void* userData, void* ptr)
+{
+    if (ptr == nullptr) { return; }
+
+    const auto* category = static_cast<const TrackedCategory*>(userData);
+    const MecsAllocator& backing = category->allocator->backingAllocator;
+    const AllocationHeader header = *mecsHeaderOf(ptr);
+    // The header knows the category the memory was allocated for, even if it's freed through another one
+    mecsUntrackAllocation(category->allocator, header);
+    backing.memFree(backing.userData, static_cast<char*>(ptr) - header.offset);
+}
+
+}
+
+MecsTrackingAllocator* mecsTrackingAllocatorCreate(const MecsAllocator* backingAllocator)
+{
+    const MecsAllocator backing = backingAllocator != nullptr && backingAllocator->memAlloc != nullptr ? *backingAllocator : kDefaultAllocator;
+    auto* allocator = mecsAlloc<MecsTrackingAllocator>(backing);
+    allocator->backingAllocator = backing;
+    for (MecsSize tag = 0; tag < MecsAllocationTag_Count; tag++) {
+        allocator->categories[tag] = TrackedCategory {
+            .allocator = allocator,
+            .tag = static_cast<MecsAllocationTag>(tag),
+        };
+    }
+    return allocator;
+}
+
+void mecsTrackingAllocatorFree(MecsTrackingAllocator* allocator)
+{
+    if (allocator == nullptr) {
+        return;
+    }
+    MECS_ASSERT(allocator->total.numAllocations.load() == 0 && "Freeing a tracking allocator that still owns some memory");
+    const MecsAllocator backing = allocator->backingAllocator;
+    mecsFree(backing, allocator);
+}
+
+void mecsTrackingAllocatorGetAllocators(MecsTrackingAllocator* allocator, MecsAllocator* outAllocators)
+{
+    MECS_ASSERT(allocator != nullptr && "Cannot pass a null allocator");
+    MECS_ASSERT(outAllocators != nullptr && "outAllocators must not be null");
+    for (MecsSize tag = 0; tag < MecsAllocationTag_Count; tag++) {
+        outAllocators[tag] = MecsAllocator {
+            .memAlloc = mecsTrackingMalloc,
+            .memRealloc = mecsTrackingRealloc,
+            .memFree = mecsTrackingFree,
+            .userData = &allocator->categories[tag],
+        };
+    }
+}
+
+void mecsTrackingAllocatorGetStats(MecsTrackingAllocator* allocator, MecsAllocationTag tag, MecsAllocationStats* outStats)
+{
+    MECS_ASSERT(allocator != nullptr && "Cannot pass a null allocator");
+    MECS_ASSERT(tag < MecsAllocationTag_Count && "Invalid allocation tag");
+    MECS_ASSERT(outStats != nullptr && "outStats must not be null");
+    allocator->counters[tag].read(outStats);
+}
+
+void mecsTrackingAllocatorGetTotalStats(MecsTrackingAllocator* allocator, MecsAllocationStats* outStats)
+{
+    MECS_ASSERT(allocator != nullptr && "Cannot pass a null allocator");
+    MECS_ASSERT(outStats != nullptr && "outStats must not be null");
+    allocator->total.read(outStats);
+}
+
+const char* mecsAllocationTagName(MecsAllocationTag tag)
+{
+    switch (tag) {
+    case MecsAllocationTag_World:
+        return "world";
+    case MecsAllocationTag_ArchetypeColumns:
+        return "archetype columns";
+    case MecsAllocationTag_Entities:
+        return "entities";
+    case MecsAllocationTag_Events:
+        return "events";
+    case MecsAllocationTag_Iterators:
+        return "iterators";
+    case MecsAllocationTag_Registry:
+        return "registry";
+    case MecsAllocationTag_Prefabs:
+        return "prefabs";
+    case MecsAllocationTag_Strings:
+        return "strings";
+    case MecsAllocationTag_User:
+        return "user";
+    case MecsAllocationTag_Count:
+        break;
+    }
+    return "unknown";
+}
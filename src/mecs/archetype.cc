@@ -1,6 +1,7 @@
 #include "collections.h"
 #include "mecs/base.h"
 #include "private.h"
+#include <cstddef>
 #include <cstring>
 
 void mecsDefaultInit(void*) { }
@@ -11,14 +12,26 @@ void mecsDefaultMove(const void* source, void* dest, MecsSize size)
 
 void mecsDefaultDestroy(void*) { }
 
+// The tags (components with size 0) have no column, all their rows point here
+alignas(std::max_align_t) static MecsU8 gTagInstance[1];
+
+void* mecsTagInstance()
+{
+    return gTagInstance;
+}
+
 RowStorage::RowStorage(BitSet componentSet, MecsWorld* world)
     : mCmponentSet(std::move(componentSet))
     , mRegistry(world->registry)
 {
     MECS_ASSERT(world->registry);
     mCmponentSet.forEach([&](MecsComponentID componentID) {
-        mStorages.ensureSize(world->memAllocator, componentID + 1);
+        mStorages.ensureSize(world->allocators[MecsAllocationTag_ArchetypeColumns], componentID + 1);
         const ComponentInfo& info = mRegistry->components[componentID];
+        if (info.size == 0) {
+            return;
+        }
+        mColumnSet.set(world->allocators[MecsAllocationTag_ArchetypeColumns], componentID, true);
         mStorages[componentID] = MecsVecUnmanaged(ElementInfo {
             .size=info.size,
             .align=info.align,
@@ -35,31 +48,34 @@ void* RowStorage::getRowComponent(MecsComponentID component, MecsSize row) const
 {
     MECS_ASSERT(hasComponent(component));
     MECS_ASSERT(mStorages.isValid(component));
+    MECS_ASSERT(row < mCount);
 
+    if (!mColumnSet.test(component)) {
+        return gTagInstance;
+    }
     MecsVecUnmanaged& storage = mStorages[component];
-    MECS_ASSERT(mTakenRows.test(row));
     return storage.at(row);
 }
 
 MecsSize RowStorage::allocateRow(const MecsAllocator& alloc)
 {
-    MecsSize rowIndex = 0;
-    if (mFreeIndices.count() > 0) {
-        rowIndex = mFreeIndices.pop();
-    } else {
-        rowIndex = mCapacity++;
-        mCmponentSet.forEach([&](MecsComponentID component) {
+    const MecsSize rowIndex = mCount;
+    if (mCount == mCapacity) {
+        // Grow all the columns at once, so that the next allocations are just a bump of mCount
+        const MecsSize newCapacity = growCount(mCapacity);
+        mColumnSet.forEach([&](MecsComponentID component) {
             ComponentInfo& info = mRegistry->components[component];
             MecsVecUnmanaged& storage = getStorage(component);
-            storage.push(alloc, nullptr, info);
+            storage.reserve(alloc, newCapacity, info);
         });
+        mCapacity = newCapacity;
     }
-    MECS_ASSERT(!mTakenRows.test(rowIndex));
-    mTakenRows.set(alloc, rowIndex, true);
-    mCmponentSet.forEach([&](MecsComponentID component) {
+
+    mColumnSet.forEach([&](MecsComponentID component) {
         ComponentInfo& info = mRegistry->components[component];
-        if (!info.init) { return; }
         MecsVecUnmanaged& storage = getStorage(component);
+        storage.push(alloc, nullptr, info);
+        if (!info.init) { return; }
         void* componentPtr = storage.at(rowIndex);
         info.init(componentPtr);
     });
@@ -68,19 +84,120 @@ MecsSize RowStorage::allocateRow(const MecsAllocator& alloc)
     return rowIndex;
 }
 
+MecsSize RowStorage::allocateRows(const MecsAllocator& alloc, MecsSize count)
+{
+    const MecsSize firstRow = mCount;
+    if (mCount + count > mCapacity) {
+        const MecsSize newCapacity = std::max(growCount(mCapacity), mCount + count);
+        mColumnSet.forEach([&](MecsComponentID component) {
+            ComponentInfo& info = mRegistry->components[component];
+            getStorage(component).reserve(alloc, newCapacity, info);
+        });
+        mCapacity = newCapacity;
+    }
+
+    mColumnSet.forEach([&](MecsComponentID component) {
+        ComponentInfo& info = mRegistry->components[component];
+        MecsVecUnmanaged& storage = getStorage(component);
+        storage.pushZeroed(alloc, count, info);
+        if (!info.init) { return; }
+        for (MecsSize row = firstRow; row < firstRow + count; row++) {
+            info.init(storage.at(row));
+        }
+    });
+
+    mCount += count;
+    return firstRow;
+}
+
+// Appends the count first rows of source to dest
+void mecsAppendColumnRows(const MecsAllocator& alloc, const ComponentInfo& info, MecsVecUnmanaged& dest, const MecsVecUnmanaged& source, MecsSize count)
+{
+    if (info.copy == nullptr) {
+        dest.pushRange(alloc, source.at(0), count, info);
+        return;
+    }
+    // The copy callback expects an initialized destination, see RowStorage::copyRow()
+    const MecsSize firstRow = dest.pushZeroed(alloc, count, info);
+    for (MecsSize row = 0; row < count; row++) {
+        void* destPtr = dest.at(firstRow + row);
+        if (info.init) { info.init(destPtr); }
+        info.copy(source.at(row), destPtr, info.size);
+    }
+}
+
+MecsSize RowStorage::appendRows(const MecsAllocator& alloc, const RowStorage& source)
+{
+    MECS_ASSERT(mCmponentSet == source.mCmponentSet && "The storages must have the same components");
+    const MecsSize firstRow = mCount;
+    const MecsSize count = source.rows();
+    if (count == 0) {
+        return firstRow;
+    }
+    if (mCount + count > mCapacity) {
+        const MecsSize newCapacity = std::max(growCount(mCapacity), mCount + count);
+        mColumnSet.forEach([&](MecsComponentID component) {
+            ComponentInfo& info = mRegistry->components[component];
+            getStorage(component).reserve(alloc, newCapacity, info);
+        });
+        mCapacity = newCapacity;
+    }
+
+    mColumnSet.forEach([&](MecsComponentID component) {
+        mecsAppendColumnRows(alloc, mRegistry->components[component], getStorage(component), source.getStorage(component), count);
+    });
+
+    mCount += count;
+    copyDisabledRows(alloc, source, firstRow);
+    return firstRow;
+}
+
+void RowStorage::shareRows(const MecsAllocator& alloc, RowStorage& source, const MecsAllocator& sourceAlloc)
+{
+    MECS_ASSERT(mCmponentSet == source.mCmponentSet && "The storages must have the same components");
+    MECS_ASSERT(mCount == 0 && "Only an empty storage can share the rows of another one");
+    const MecsSize count = source.rows();
+    if (count == 0) {
+        return;
+    }
+
+    mColumnSet.forEach([&](MecsComponentID component) {
+        ComponentInfo& info = mRegistry->components[component];
+        MecsVecUnmanaged& storage = getStorage(component);
+        if (info.copy == nullptr && info.move == nullptr && info.destroy == nullptr) {
+            storage.share(alloc, source.getStorage(component), sourceAlloc, info);
+        } else {
+            storage.reserve(alloc, count, info);
+            mecsAppendColumnRows(alloc, info, storage, source.getStorage(component), count);
+        }
+    });
+    mCount = count;
+    mCapacity = count;
+    copyDisabledRows(alloc, source, 0);
+}
+
+void RowStorage::unshareColumn(const MecsAllocator& alloc, MecsComponentID component)
+{
+    MecsVecUnmanaged& storage = getStorage(component);
+    if (storage.isShared()) {
+        storage.unshare(alloc, mRegistry->components[component]);
+    }
+}
+
 MecsSize RowStorage::freeRow(const MecsAllocator& alloc, MecsSize row)
 {
-    MECS_ASSERT(mTakenRows.test(row));
+    MECS_ASSERT(row < mCount);
 
     // Copy the last row to the current row
     // There's no need to do that if there's only one row left
     // or we're removing the last row itself
     if (mCount > 1 && row < mCount - 1) {
-        mCmponentSet.forEach([&](MecsComponentID component) {
+        mColumnSet.forEach([&](MecsComponentID component) {
             ComponentInfo& reg = mRegistry->components[component];
             MecsVecUnmanaged& storage = getStorage(component);
+            storage.unshare(alloc, reg);
             void* current = storage.at(row);
-            void* last = storage.at(storage.count() - 1);
+            void* last = storage.at(mCount - 1);
             if (reg.copy) {
                 reg.copy(last, current, reg.size);
             } else {
@@ -89,27 +206,82 @@ MecsSize RowStorage::freeRow(const MecsAllocator& alloc, MecsSize row)
         });
     }
 
+    // Same for the enable bits: the bit of the last row replaces the bit of the current row
+    if (mNumDisabledRows > 0) {
+        const MecsSize lastRow = mCount - 1;
+        for (MecsComponentID component = 0; component < mDisabledRows.count(); component++) {
+            BitSet& disabled = mDisabledRows[component];
+            if (disabled.test(row)) {
+                disabled.set(alloc, row, false);
+                mNumDisabledRows--;
+            }
+            if (row < lastRow && disabled.test(lastRow)) {
+                disabled.set(alloc, lastRow, false);
+                disabled.set(alloc, row, true);
+            }
+        }
+    }
+
     // Deinitialize the last row (either it was the only one, or it got copied to the current row)
-    mCmponentSet.forEach([&](MecsComponentID component) {
+    mColumnSet.forEach([&](MecsComponentID component) {
         ComponentInfo& reg = mRegistry->components[component];
-        if (!reg.destroy) {
-            return;
-        }
         MecsVecUnmanaged& storage = getStorage(component);
-        void* last = storage.at(mCount - 1);
-        reg.destroy(last);
+        if (reg.destroy) {
+            reg.destroy(storage.at(mCount - 1));
+        }
+        storage.pop(nullptr);
     });
-    
-    // Mark the old row as reusable
-    mTakenRows.set(alloc, mCount - 1, false);
-    mFreeIndices.push(alloc, mCount - 1);
+
     mCount--;
     return mCount;
 }
 
-void RowStorage::copyRow(MecsSize sourceRow, RowStorage& dest, MecsSize destRow)
+void RowStorage::swapRows(const MecsAllocator& alloc, MecsSize lhs, MecsSize rhs)
 {
-    mCmponentSet.forEach([&](MecsComponentID component) {
+    MECS_ASSERT(lhs < mCount && rhs < mCount);
+    mColumnSet.forEach([&](MecsComponentID component) {
+        ComponentInfo& reg = mRegistry->components[component];
+        MecsVecUnmanaged& storage = getStorage(component);
+        storage.unshare(alloc, reg);
+        char* lhsPtr = storage.at(lhs);
+        char* rhsPtr = storage.at(rhs);
+        if (reg.copy == nullptr) {
+            // Like the rows moved by freeRow() the components are plain bytes, swapped a chunk at a time
+            MecsU8 chunk[64];
+            for (MecsSize offset = 0; offset < reg.size; offset += sizeof(chunk)) {
+                const MecsSize size = std::min<MecsSize>(sizeof(chunk), reg.size - offset);
+                memcpy(chunk, lhsPtr + offset, size);
+                memcpy(lhsPtr + offset, rhsPtr + offset, size);
+                memcpy(rhsPtr + offset, chunk, size);
+            }
+            return;
+        }
+
+        // The copy callback expects an initialized destination
+        MecsU8* temp = mecsCallocAligned<MecsU8>(alloc, reg.size, reg.align);
+        memset(temp, 0, reg.size);
+        if (reg.init) { reg.init(temp); }
+        reg.copy(lhsPtr, temp, reg.size);
+        reg.copy(rhsPtr, lhsPtr, reg.size);
+        reg.copy(temp, rhsPtr, reg.size);
+        if (reg.destroy) { reg.destroy(temp); }
+        mecsFree(alloc, temp);
+    });
+
+    for (MecsComponentID component = 0; mNumDisabledRows > 0 && component < mDisabledRows.count(); component++) {
+        BitSet& disabled = mDisabledRows[component];
+        const bool lhsDisabled = disabled.test(lhs);
+        const bool rhsDisabled = disabled.test(rhs);
+        if (lhsDisabled != rhsDisabled) {
+            disabled.set(alloc, lhs, rhsDisabled);
+            disabled.set(alloc, rhs, lhsDisabled);
+        }
+    }
+}
+
+void RowStorage::copyRow(const MecsAllocator& alloc, MecsSize sourceRow, RowStorage& dest, MecsSize destRow)
+{
+    mColumnSet.forEach([&](MecsComponentID component) {
         if (!dest.hasComponent(component)) {
             return;
         }
@@ -123,6 +295,48 @@ void RowStorage::copyRow(MecsSize sourceRow, RowStorage& dest, MecsSize destRow)
             memcpy(destPtr, source, reg.size);
         }
     });
+
+    for (MecsComponentID component = 0; mNumDisabledRows > 0 && component < mDisabledRows.count(); component++) {
+        if (mDisabledRows[component].test(sourceRow) && dest.hasComponent(component)) {
+            dest.setRowEnabled(alloc, component, destRow, false);
+        }
+    }
+}
+
+void RowStorage::setRowEnabled(const MecsAllocator& alloc, MecsComponentID component, MecsSize row, bool enabled)
+{
+    MECS_ASSERT(hasComponent(component));
+    MECS_ASSERT(row < mCount);
+    if (isRowEnabled(component, row) == enabled) {
+        return;
+    }
+
+    mDisabledRows.ensureSize(alloc, component + 1);
+    mDisabledRows[component].set(alloc, row, !enabled);
+    if (enabled) {
+        mNumDisabledRows--;
+    } else {
+        mNumDisabledRows++;
+    }
+}
+
+bool RowStorage::isRowEnabled(MecsComponentID component, MecsSize row) const
+{
+    return !mDisabledRows.isValid(component) || !mDisabledRows[component].test(row);
+}
+
+BitSet::Word RowStorage::disabledRows(MecsComponentID component, MecsSize word) const
+{
+    return mDisabledRows.isValid(component) ? mDisabledRows[component].word(word) : 0;
+}
+
+void RowStorage::copyDisabledRows(const MecsAllocator& alloc, const RowStorage& source, MecsSize firstRow)
+{
+    for (MecsComponentID component = 0; source.mNumDisabledRows > 0 && component < source.mDisabledRows.count(); component++) {
+        source.mDisabledRows[component].forEach([&](MecsSize row) {
+            setRowEnabled(alloc, component, firstRow + row, false);
+        });
+    }
 }
 
 void RowStorage::destroy(const MecsAllocator& alloc)
@@ -131,12 +345,17 @@ void RowStorage::destroy(const MecsAllocator& alloc)
         freeRow(alloc, mCount - 1);
     }
     mCmponentSet.destroy(alloc);
-    mTakenRows.destroy(alloc);
+    mColumnSet.destroy(alloc);
     mStorages.forEach([&](MecsVecUnmanaged& vec) {
         vec.destroy(alloc);
     });
     mStorages.destroy(alloc);
-    mFreeIndices.destroy(alloc);
+    mDisabledRows.forEach([&](BitSet& disabled) {
+        disabled.destroy(alloc);
+    });
+    mDisabledRows.destroy(alloc);
+    mNumDisabledRows = 0;
+    mCapacity = 0;
 }
 
 MecsSize RowStorage::rows() const
@@ -144,6 +363,26 @@ MecsSize RowStorage::rows() const
     return mCount;
 }
 
+MecsSize RowStorage::capacity() const
+{
+    return mCapacity;
+}
+
+MecsSize RowStorage::columnBytes(MecsComponentID component) const
+{
+    MECS_ASSERT(hasComponent(component));
+    return getStorage(component).allocatedBytes();
+}
+
+MecsSize RowStorage::metadataBytes() const
+{
+    MecsSize bytes = mCmponentSet.allocatedBytes() + mColumnSet.allocatedBytes() + mStorages.allocatedBytes() + mDisabledRows.allocatedBytes();
+    for (MecsComponentID component = 0; component < mDisabledRows.count(); component++) {
+        bytes += mDisabledRows[component].allocatedBytes();
+    }
+    return bytes;
+}
+
 MecsVecUnmanaged& RowStorage::getStorage(const MecsComponentID component) const
 {
     return mStorages[component];
@@ -14,11 +14,15 @@ MecsVecUnmanaged::MecsVecUnmanaged(MecsVecUnmanaged&& rhs) noexcept
     , mCount(rhs.mCount)
     , mCapacity(rhs.mCapacity)
     , mData(rhs.mData)
+    , mBorrowed(rhs.mBorrowed)
+    , mShared(rhs.mShared)
 {
     rhs.mElementInfo = {};
     rhs.mCapacity = {};
     rhs.mCount = {};
     rhs.mData = nullptr;
+    rhs.mBorrowed = false;
+    rhs.mShared = nullptr;
 }
 MecsVecUnmanaged& MecsVecUnmanaged::operator=(MecsVecUnmanaged&& rhs) noexcept
 {
@@ -26,11 +30,15 @@ MecsVecUnmanaged& MecsVecUnmanaged::operator=(MecsVecUnmanaged&& rhs) noexcept
     mCount = rhs.mCount;
     mCapacity = rhs.mCapacity;
     mData = rhs.mData;
+    mBorrowed = rhs.mBorrowed;
+    mShared = rhs.mShared;
 
     rhs.mElementInfo = {};
     rhs.mCapacity = {};
     rhs.mCount = {};
     rhs.mData = nullptr;
+    rhs.mBorrowed = false;
+    rhs.mShared = nullptr;
     return *this;
 }
 
@@ -58,6 +66,34 @@ MecsSize MecsVecUnmanaged::push(const MecsAllocator& allocator, void* value, con
     }
     return elementIndex;
 }
+MecsSize MecsVecUnmanaged::pushZeroed(const MecsAllocator& allocator, MecsSize count, const ComponentInfo& componentInfo)
+{
+    MECS_ASSERT(allocator.memAlloc != nullptr);
+    MECS_ASSERT(mElementInfo.size == componentInfo.size);
+    const MecsSize firstIndex = mCount;
+    if (mCount + count > mCapacity) {
+        grow(allocator, std::max(growCount(mCapacity), mCount + count), componentInfo);
+    }
+    if (count > 0) {
+        memset(mData + (firstIndex * mElementInfo.size), 0, count * mElementInfo.size);
+    }
+    mCount += count;
+    return firstIndex;
+}
+MecsSize MecsVecUnmanaged::pushRange(const MecsAllocator& allocator, const void* data, MecsSize count, const ComponentInfo& componentInfo)
+{
+    MECS_ASSERT(allocator.memAlloc != nullptr);
+    MECS_ASSERT(mElementInfo.size == componentInfo.size);
+    const MecsSize firstIndex = mCount;
+    if (mCount + count > mCapacity) {
+        grow(allocator, std::max(growCount(mCapacity), mCount + count), componentInfo);
+    }
+    if (count > 0) {
+        memcpy(mData + (firstIndex * mElementInfo.size), data, count * mElementInfo.size);
+    }
+    mCount += count;
+    return firstIndex;
+}
 void MecsVecUnmanaged::pop(void* valuePtr)
 {
     MECS_ASSERT(mCount > 0);
@@ -82,6 +118,17 @@ void MecsVecUnmanaged::resize(const MecsAllocator& allocator, MecsSize newSize)
         destroy(allocator);
     }
 
+    if (mBorrowed) {
+        char* newData = mecsCallocAligned<char>(allocator, newSize * mElementInfo.size, mElementInfo.align);
+        mecsMemCpy(mData, std::min(mCount, newSize) * mElementInfo.size, newData, newSize * mElementInfo.size);
+        releaseShared();
+        mData = newData;
+        mBorrowed = false;
+        mCapacity = newSize;
+        mCount = newSize;
+        return;
+    }
+
     char* newData = mecsRellocAligned(allocator, mData, mCapacity * mElementInfo.size, newSize * mElementInfo.size, mElementInfo.align);
     mData = newData;
 
@@ -91,21 +138,32 @@ void MecsVecUnmanaged::resize(const MecsAllocator& allocator, MecsSize newSize)
 
 void MecsVecUnmanaged::destroy(const MecsAllocator& allocator)
 {
-    mecsFree<char>(allocator, mData);
+    if (!mBorrowed) {
+        mecsFree<char>(allocator, mData);
+    } else {
+        releaseShared();
+    }
     mData = nullptr;
+    mBorrowed = false;
     mCount = 0;
     mCapacity = 0;
 }
 
-void MecsVecUnmanaged::grow(const MecsAllocator& allocator, MecsSize size, const ComponentInfo& componentInfo)
+void MecsVecUnmanaged::reserve(const MecsAllocator& allocator, MecsSize newCapacity, const ComponentInfo& componentInfo)
+{
+    if (newCapacity <= mCapacity) {
+        return;
+    }
+    grow(allocator, newCapacity, componentInfo);
+}
+
+void MecsVecUnmanaged::grow(const MecsAllocator& allocator, MecsSize newCapacity, const ComponentInfo& componentInfo)
 {
     MECS_ASSERT(allocator.memAlloc != nullptr);
-    MecsSize newCount = 1;
+    // Borrowed elements are copied even when the capacity does not change, see unshare()
+    MECS_ASSERT(newCapacity > mCapacity || (mBorrowed && newCapacity == mCapacity));
 
-    if (mCapacity > 0) {
-        newCount = mCapacity + size;
-    }
-    char* newData = mecsCallocAligned<char>(allocator, newCount * mElementInfo.size, mElementInfo.align);
+    char* newData = mecsCallocAligned<char>(allocator, newCapacity * mElementInfo.size, mElementInfo.align);
     if (componentInfo.init != nullptr) {
         for (MecsSize i = 0; i < mCount; i ++) {
             componentInfo.init(static_cast<char*>(newData + (i * mElementInfo.size)));
@@ -125,11 +183,66 @@ void MecsVecUnmanaged::grow(const MecsAllocator& allocator, MecsSize size, const
         }
     }
 
-    mecsFree(allocator, mData);
-
+    // Borrowed memory belongs to someone else, it's only left behind
+    if (!mBorrowed) {
+        mecsFree(allocator, mData);
+    } else {
+        releaseShared();
+    }
 
-    mCapacity = newCount;
+    mCapacity = newCapacity;
     mData = newData;
+    mBorrowed = false;
+}
+
+void MecsVecUnmanaged::borrow(const MecsAllocator& allocator, char* data, MecsSize count)
+{
+    MECS_ASSERT(data != nullptr && reinterpret_cast<uintptr_t>(data) % mElementInfo.align == 0 && "Borrowed memory must be aligned to the element alignment");
+    destroy(allocator);
+    mData = data;
+    mCount = count;
+    mCapacity = count;
+    mBorrowed = true;
+}
+
+void MecsVecUnmanaged::share(const MecsAllocator& allocator, MecsVecUnmanaged& source, const MecsAllocator& sourceAllocator, const ComponentInfo& componentInfo)
+{
+    MECS_ASSERT(this != &source);
+    MECS_ASSERT(componentInfo.copy == nullptr && componentInfo.move == nullptr && componentInfo.destroy == nullptr && "Only the elements copied with memcpy can be shared");
+    MECS_ASSERT(source.mCount > 0);
+    if (source.mBorrowed && source.mShared == nullptr) {
+        // The elements belong to someone else (e.g. a mapped file) which might not outlive this vector
+        source.grow(sourceAllocator, source.mCapacity, componentInfo);
+    }
+    if (source.mShared == nullptr) {
+        source.mShared = mecsAlloc<MecsSharedColumn>(sourceAllocator);
+        source.mShared->refCount = 1;
+        source.mShared->allocator = sourceAllocator;
+        source.mShared->data = source.mData;
+        source.mBorrowed = true;
+        source.mCapacity = source.mCount;
+    }
+
+    destroy(allocator);
+    mShared = source.mShared;
+    mShared->refCount.fetch_add(1);
+    mData = source.mData;
+    mCount = source.mCount;
+    mCapacity = source.mCount;
+    mBorrowed = true;
+}
+
+void MecsVecUnmanaged::releaseShared()
+{
+    if (mShared == nullptr) {
+        return;
+    }
+    if (mShared->refCount.fetch_sub(1) == 1) {
+        const MecsAllocator allocator = mShared->allocator;
+        mecsFree<char>(allocator, mShared->data);
+        mecsFree(allocator, mShared);
+    }
+    mShared = nullptr;
 }
 
 MecsU32 getIndexFromGenArenaIndex(GenIndex index)
@@ -10,6 +10,7 @@
 #include <type_traits>
 
 #include <algorithm>
+#include <atomic>
 #include <utility>
 
 template <typename T, typename... Args>
@@ -129,6 +130,19 @@ class MecsVec {
         return mCount;
     }
 
+    [[nodiscard]]
+    MecsSize capacity() const
+    {
+        return mCapacity;
+    }
+
+    // The bytes allocated by the vec itself, not including what the elements may own
+    [[nodiscard]]
+    MecsSize allocatedBytes() const
+    {
+        return mCapacity * sizeof(T);
+    }
+
     [[nodiscard]]
     bool empty() const
     {
@@ -148,7 +162,7 @@ class MecsVec {
         return at(mCount - 1);
     }
     [[nodiscard]]
-    bool contains(const T& value)
+    bool contains(const T& value) const
     {
         for (MecsSize i = 0; i < count(); i++) {
             if (at(i) == value) { return true; }
@@ -325,6 +339,14 @@ class MecsVec {
 
 using MecsMoveFunc = void (*)(const void* source, void* dest, size_t numElements);
 
+// The memory of a column shared by the worlds cloned with MecsWorldCloneFlags_CopyOnWrite.
+// Each vector sharing the memory holds a reference, the last one to release it frees the memory
+struct MecsSharedColumn {
+    std::atomic<MecsSize> refCount;
+    MecsAllocator allocator;
+    char* data;
+};
+
 class MecsVecUnmanaged {
 public:
     MecsVecUnmanaged() = default;
@@ -351,9 +373,41 @@ class MecsVecUnmanaged {
         return index < mCount;
     }
 
+    [[nodiscard]]
+    MecsSize capacity() const
+    {
+        return mCapacity;
+    }
+
+    // Borrowed memory is not counted
+    [[nodiscard]]
+    MecsSize allocatedBytes() const
+    {
+        return mBorrowed ? 0 : mCapacity * mElementInfo.size;
+    }
+
+    [[nodiscard]]
+    bool isBorrowed() const
+    {
+        return mBorrowed;
+    }
+
+    [[nodiscard]]
+    bool isShared() const
+    {
+        return mShared != nullptr;
+    }
+
     MecsSize push(const MecsAllocator& allocator, void* value, const ComponentInfo& componentInfo);
+    // Appends count zeroed elements, returns the index of the first one
+    MecsSize pushZeroed(const MecsAllocator& allocator, MecsSize count, const ComponentInfo& componentInfo);
+    // Appends count elements copied with memcpy from data, returns the index of the first one
+    MecsSize pushRange(const MecsAllocator& allocator, const void* data, MecsSize count, const ComponentInfo& componentInfo);
     void pop(void* valuePtr);
 
+    // Grows the storage so that it can hold at least newCapacity elements without reallocating
+    void reserve(const MecsAllocator& allocator, MecsSize newCapacity, const ComponentInfo& componentInfo);
+
     [[nodiscard]]
     char* at(MecsSize index) const;
 
@@ -361,6 +415,23 @@ class MecsVecUnmanaged {
 
     void destroy(const MecsAllocator& allocator);
 
+    // Uses count initialized elements owned by someone else (e.g. a mapped file), which must outlive the vector.
+    // The memory is never freed nor reallocated: the elements are copied to the allocator the first time the vector grows
+    void borrow(const MecsAllocator& allocator, char* data, MecsSize count);
+
+    // Makes this vector use the elements of source, which must have been allocated by sourceAllocator: from now on both
+    // vectors borrow the elements, and the first one to grow or unshare() them gets its own copy.
+    // Only the elements without copy, move and destroy callbacks can be shared
+    void share(const MecsAllocator& allocator, MecsVecUnmanaged& source, const MecsAllocator& sourceAllocator, const ComponentInfo& componentInfo);
+
+    // Called before modifying the elements: copies them if they're shared
+    void unshare(const MecsAllocator& allocator, const ComponentInfo& componentInfo)
+    {
+        if (mShared != nullptr) {
+            grow(allocator, std::max(mCapacity, static_cast<MecsSize>(1)), componentInfo);
+        }
+    }
+
     void* operator[](auto index) const { return at(static_cast<MecsSize>(index)); }
 
     ~MecsVecUnmanaged()
@@ -369,20 +440,31 @@ class MecsVecUnmanaged {
     }
 
 private:
-    void grow(const MecsAllocator& allocator, MecsSize size, const ComponentInfo& componentInfo);
+    void grow(const MecsAllocator& allocator, MecsSize newCapacity, const ComponentInfo& componentInfo);
+    void releaseShared();
     ElementInfo mElementInfo;
     MecsSize mCount { 0 };
     MecsSize mCapacity { 0 };
     char* mData { nullptr };
+    bool mBorrowed { false };
+    MecsSharedColumn* mShared { nullptr };
 };
 
 class BitSet {
 public:
     using Word = MecsU32;
+    constexpr static MecsSize kBitsPerWord = sizeof(Word) * 8;
     void set(const MecsAllocator& allocator, MecsSize slot, bool value);
     [[nodiscard]]
     bool test(MecsSize slot) const;
 
+    // The bits [index * kBitsPerWord, (index + 1) * kBitsPerWord), the words past the end are zero
+    [[nodiscard]]
+    Word word(MecsSize index) const
+    {
+        return mWords.isValid(index) ? mWords[index] : 0;
+    }
+
     void destroy(const MecsAllocator& allocator);
     void clear();
 
@@ -398,6 +480,12 @@ class BitSet {
     [[nodiscard]]
     MecsSize count() const;
 
+    [[nodiscard]]
+    MecsSize allocatedBytes() const
+    {
+        return mWords.allocatedBytes();
+    }
+
     template <typename F>
     void forEach(F&& func) const
     {
@@ -437,6 +525,11 @@ class GenArena {
     {
         return mCount;
     }
+    [[nodiscard]]
+    MecsSize allocatedBytes() const
+    {
+        return mEntries.allocatedBytes() + mFreeIndices.allocatedBytes();
+    }
     GenIndex push(const MecsAllocator& allocator, T value)
     {
         MecsSize index;
@@ -543,6 +636,80 @@ class GenArena {
         return entry.tagGeneration.taken;
     }
 
+    // The entries below are used to save and restore the arena, free entries included,
+    // so that the restored arena hands out the same indices and generations
+    [[nodiscard]]
+    MecsSize numEntries() const
+    {
+        return mEntries.count();
+    }
+
+    [[nodiscard]]
+    const Entry& entryAt(MecsSize index) const
+    {
+        return mEntries.at(index);
+    }
+
+    [[nodiscard]]
+    const MecsVec<MecsSize>& freeIndices() const
+    {
+        return mFreeIndices;
+    }
+
+    // Appends an entry: a taken entry holds value, a free one must also be passed to restoreFreeIndex()
+    void restoreEntry(const MecsAllocator& allocator, EntryGeneration tagGeneration, T value)
+    {
+        mEntries.push(allocator, Entry { std::move(value), tagGeneration });
+        if (tagGeneration.taken) {
+            mCount += 1;
+        }
+    }
+
+    void restoreFreeIndex(const MecsAllocator& allocator, MecsSize index)
+    {
+        MECS_ASSERT(index < mEntries.count() && !mEntries.at(index).tagGeneration.taken);
+        mFreeIndices.push(allocator, index);
+    }
+
+    // Replaces the (empty) arena with a copy of other, free entries included: cloneValue(T&) is called on each copied value
+    template <typename F>
+    void cloneFrom(const MecsAllocator& allocator, const GenArena& other, F&& cloneValue)
+    {
+        MECS_ASSERT(mCount == 0 && "Only an empty arena can be cloned into");
+        destroy(allocator);
+        mEntries.resize(allocator, other.mEntries.count());
+        for (MecsSize i = 0; i < other.mEntries.count(); i++) {
+            mEntries[i] = other.mEntries[i];
+            if (mEntries[i].tagGeneration.taken) { cloneValue(mEntries[i].value); }
+        }
+        mFreeIndices.resize(allocator, other.mFreeIndices.count());
+        for (MecsSize i = 0; i < other.mFreeIndices.count(); i++) {
+            mFreeIndices[i] = other.mFreeIndices[i];
+        }
+        mCount = other.mCount;
+    }
+
+    // Takes the free entry at index, giving it the passed generation: the arena grows if index is past its end.
+    // Used to replicate the entries of another arena, the order of the free entries is not preserved
+    GenIndex pushAt(const MecsAllocator& allocator, MecsSize index, MecsU32 generation, T value)
+    {
+        while (mEntries.count() <= index) {
+            mFreeIndices.push(allocator, mEntries.count());
+            mEntries.push(allocator, Entry { T {}, { 0, false } });
+        }
+        Entry& entry = mEntries.at(index);
+        MECS_ASSERT(!entry.tagGeneration.taken && "The entry is already taken");
+        mFreeIndices.remove(index);
+        entry.tagGeneration = { generation, true };
+        entry.value = std::move(value);
+        mCount += 1;
+
+        TaggedGenIndex versIndex;
+        versIndex.version.index = index;
+        versIndex.version.generation = generation;
+        return versIndex.index;
+    }
+
     MecsEntityID idAtIndex(MecsU32 index)
     {
         MECS_ASSERT(index < mEntries.count());
@@ -634,6 +801,19 @@ class SparseSet {
         return mDense.count();
     }
 
+    // Calls func(entry, value) for each entry, in insertion order unless some were removed
+    template <typename F>
+    void forEach(F&& func) const
+    {
+        mDense.forEach([&](const Key& key) { func(key.index, key.v); });
+    }
+
+    [[nodiscard]]
+    MecsSize allocatedBytes() const
+    {
+        return mSparse.allocatedBytes() + mDense.allocatedBytes();
+    }
+
 private:
     MecsVec<MecsSize> mSparse;
     MecsVec<Key> mDense {};
@@ -0,0 +1,572 @@
+#include "collections.h"
+#include "mecs/base.h"
+#include "mecs/serialize.h"
+#include "private.h"
+#include "stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+/*
+Delta layout, all the values are in the byte order of the machine that wrote the delta:
+    header:      magic[8], u32 version, u32 byte order mark
+    components:  u32 count, u64 typeID for each component of the registry
+    destroyed:   u32 count, u32 entity ID for each destroyed entity
+    spawned:     u32 count, then for each spawned entity: u32 index, u32 generation, u32 prefabID, u8 entityFlags
+    removed:     u32 count, then for each removed component: u32 entity ID, u32 component
+    added:       u32 count, then for each added component: u32 entity ID, u32 component, the value
+    changed:     u32 count, then for each changed component: u32 entity ID, u32 component, u32 offset, u32 length
+                 followed by the changed bytes, or by the value if length is MECS_INVALID
+A value is written by the component serialize callback, or as raw bytes if the component has none.
+The components of the spawned entities are written as added components.
+The snapshots keep what the serialize callback writes for the components that have one, since their raw bytes may
+only hold pointers (e.g. a std::string): their changes are found by comparing those
+*/
+
+namespace {
+
+constexpr char kDeltaMagic[8] = { 'M', 'E', 'C', 'S', 'D', 'L', 'T', 'A' };
+constexpr MecsU32 kDeltaVersion = 1;
+
+struct SnapshotEntity {
+    MecsU32 generation;
+    bool taken;
+    MecsU8 entityFlags;
+    MecsPrefabID prefabID;
+    MecsU32 archetype; // Index in MecsWorldSnapshot::archetypes, MECS_INVALID if the entity is not taken
+    MecsU32 row;
+};
+
+// The copy of a world archetype, its columns are sorted by component
+struct SnapshotArchetype {
+    MecsU32 firstColumn;
+    MecsU32 numColumns;
+};
+
+struct SnapshotColumn {
+    MecsComponentID component;
+    MecsSize size;
+    // Where the first row of the column starts in MecsWorldSnapshot::data, or in MecsWorldSnapshot::serializedOffsets if serialized
+    MecsSize dataOffset;
+    bool serialized; // The component has a serialize callback
+};
+
+// A component added to or removed from an entity
+struct DeltaComponentRef {
+    MecsEntityID entity;
+    MecsComponentID component;
+};
+
+struct DeltaChange {
+    MecsEntityID entity;
+    MecsComponentID component;
+    MecsU32 offset;
+    MecsU32 length; // MECS_INVALID if the whole value is written by the component serialize callback
+};
+
+struct DeltaSpawn {
+    MecsU32 index;
+    MecsU32 generation;
+    MecsPrefabID prefabID;
+    MecsU8 entityFlags;
+};
+
+}
+
+struct MecsWorldSnapshot_t {
+    MecsAllocator memAllocator;
+    MecsRegistry* registry;
+    MecsVec<SnapshotEntity> entities; // Indexed by entity index
+    MecsVec<SnapshotArchetype> archetypes;
+    MecsVec<SnapshotColumn> columns;
+    MecsVec<MecsU8> data;
+    // The value of row r of a serialized column is in serializedData, from serializedOffsets[dataOffset + r] to serializedOffsets[dataOffset + r + 1]
+    MecsVec<MecsU8> serializedData;
+    MecsVec<MecsSize> serializedOffsets;
+};
+
+namespace {
+
+// Appends the components of an archetype to outComponents, sorted by ID
+void mecsSortedArchetypeComponents(const MecsAllocator& allocator, const Archetype& archetype, MecsVec<MecsComponentID>& outComponents)
+{
+    const MecsSize first = outComponents.count();
+    archetype.componentIDs.forEach([&](MecsComponentID component) {
+        outComponents.push(allocator, component);
+    });
+    if (outComponents.count() > first + 1) {
+        std::sort(&outComponents[first], &outComponents[first] + (outComponents.count() - first));
+    }
+}
+
+MecsU32 mecsPackEntityID(MecsU32 index, MecsU32 generation)
+{
+    TaggedGenIndex tagIndex;
+    tagIndex.version.index = index;
+    tagIndex.version.generation = generation;
+    return tagIndex.index;
+}
+
+const MecsU8* mecsSnapshotValue(const MecsWorldSnapshot* snapshot, const SnapshotColumn& column, MecsU32 row)
+{
+    return &snapshot->data[column.dataOffset + (row * column.size)];
+}
+
+// A MecsWriter appending to a MecsVec, for the values kept by the snapshots
+struct ByteSink {
+    MecsAllocator allocator;
+    MecsVec<MecsU8>* bytes;
+
+    static MecsSize write(void* userData, const void* data, MecsSize size)
+    {
+        auto* sink = static_cast<ByteSink*>(userData);
+        if (size == 0) { return 0; }
+        const MecsSize offset = sink->bytes->count();
+        sink->bytes->resize(sink->allocator, offset + size);
+        memcpy(sink->bytes->atPtr(offset), data, size);
+        return size;
+    }
+};
+
+// Appends what the serialize callback of the component writes for value to bytes
+bool mecsSerializeValue(const MecsAllocator& allocator, const ComponentInfo& info, const void* value, MecsVec<MecsU8>& bytes)
+{
+    ByteSink sink { .allocator = allocator, .bytes = &bytes };
+    const MecsWriter writer { .write = &ByteSink::write, .userData = &sink };
+    return info.serialize(value, &writer);
+}
+
+bool mecsWriteDeltaValue(const ComponentInfo& info, const void* value, SnapshotWriter& out)
+{
+    if (info.serialize == nullptr) {
+        return out.write(value, info.size);
+    }
+    if (!info.serialize(value, out.writer())) {
+        out.fail();
+    }
+    return !out.failed();
+}
+
+bool mecsReadDeltaValue(const ComponentInfo& info, void* value, SnapshotReader& in)
+{
+    if (info.serialize == nullptr) {
+        return in.read(value, info.size);
+    }
+    return info.deserialize != nullptr && info.deserialize(value, in.reader()) && !in.failed();
+}
+
+// Returns the entity only if entityID refers to a live entity of world
+MecsEntity* mecsDeltaEntity(MecsWorld* world, MecsEntityID entityID)
+{
+    const MecsU32 index = getIndexFromGenArenaIndex(entityID);
+    if (index >= world->entities.numEntries() || !world->entities.entryAt(index).tagGeneration.taken) {
+        return nullptr;
+    }
+    MecsEntity* entity = world->entities.at(entityID);
+    return entity != nullptr && entity->status != EntityStatus::eDestroying ? entity : nullptr;
+}
+
+bool mecsDeltaHasComponent(MecsWorld* world, const MecsEntity* entity, MecsComponentID component)
+{
+    return component < world->registry->components.count() && world->archetypes[entity->archetype].storage.hasComponent(component);
+}
+
+// What changed between the snapshot and the world, collected before being written because each section starts with its count
+struct DeltaBuilder {
+    MecsVec<MecsEntityID> destroyed;
+    MecsVec<DeltaSpawn> spawned;
+    MecsVec<DeltaComponentRef> removed;
+    MecsVec<DeltaComponentRef> added;
+    MecsVec<DeltaChange> changed;
+    // Where the serialized values of the world are written to be compared with the ones of the snapshot
+    MecsVec<MecsU8> serializedValue;
+
+    // The components of each world archetype sorted by ID, the ones of an archetype start at sortedComponentsOffsets[archetype]
+    MecsVec<MecsComponentID> sortedComponents;
+    MecsVec<MecsSize> sortedComponentsOffsets;
+
+    void destroy(const MecsAllocator& allocator)
+    {
+        destroyed.destroy(allocator);
+        spawned.destroy(allocator);
+        removed.destroy(allocator);
+        added.destroy(allocator);
+        changed.destroy(allocator);
+        serializedValue.destroy(allocator);
+        sortedComponents.destroy(allocator);
+        sortedComponentsOffsets.destroy(allocator);
+    }
+};
+
+// Compares the components of an entity found in both the snapshot and the world
+void mecsDiffEntityComponents(const MecsWorld* world, const MecsWorldSnapshot* snapshot, const SnapshotEntity& oldEntity,
+    MecsEntityID entityID, const MecsEntity& entity, DeltaBuilder& delta)
+{
+    const MecsAllocator& allocator = snapshot->memAllocator;
+    const Archetype& archetype = world->archetypes[entity.archetype];
+    const MecsSize newComponents = delta.sortedComponentsOffsets[entity.archetype];
+    const MecsSize numNew = archetype.componentIDs.count();
+    const SnapshotArchetype& oldArchetype = snapshot->archetypes[oldEntity.archetype];
+
+    MecsSize n = 0;
+    MecsSize o = 0;
+    while (n < numNew || o < oldArchetype.numColumns) {
+        const SnapshotColumn* column = o < oldArchetype.numColumns ? &snapshot->columns[oldArchetype.firstColumn + o] : nullptr;
+        const MecsComponentID newComponent = n < numNew ? delta.sortedComponents[newComponents + n] : MECS_INVALID;
+        if (column == nullptr || (newComponent != MECS_INVALID && newComponent < column->component)) {
+            delta.added.push(allocator, DeltaComponentRef { .entity = entityID, .component = newComponent });
+            n++;
+            continue;
+        }
+        if (newComponent == MECS_INVALID || column->component < newComponent) {
+            delta.removed.push(allocator, DeltaComponentRef { .entity = entityID, .component = column->component });
+            o++;
+            continue;
+        }
+
+        const ComponentInfo& info = world->registry->components[newComponent];
+        if (info.size == 0) {
+            // Tags have no value that could change
+            n++;
+            o++;
+            continue;
+        }
+        const auto* newValue = static_cast<const MecsU8*>(archetype.storage.getRowComponent(newComponent, entity.archetypeRow));
+        if (column->serialized) {
+            // The whole value is written again when what the serialize callback writes changed
+            const MecsSize oldBegin = snapshot->serializedOffsets[column->dataOffset + oldEntity.row];
+            const MecsSize oldLength = snapshot->serializedOffsets[column->dataOffset + oldEntity.row + 1] - oldBegin;
+            delta.serializedValue.clear();
+            const bool serialized = mecsSerializeValue(allocator, info, newValue, delta.serializedValue);
+            if (!serialized || delta.serializedValue.count() != oldLength
+                || (oldLength > 0 && memcmp(snapshot->serializedData.atPtr(oldBegin), delta.serializedValue.atPtr(0), oldLength) != 0)) {
+                delta.changed.push(allocator, DeltaChange { .entity = entityID, .component = newComponent, .offset = 0, .length = MECS_INVALID });
+            }
+            n++;
+            o++;
+            continue;
+        }
+        const auto* oldValue = mecsSnapshotValue(snapshot, *column, oldEntity.row);
+        if (memcmp(oldValue, newValue, info.size) != 0) {
+            MecsU32 first = 0;
+            MecsU32 last = static_cast<MecsU32>(info.size) - 1;
+            while (oldValue[first] == newValue[first]) { first++; }
+            while (oldValue[last] == newValue[last]) { last--; }
+            delta.changed.push(allocator, DeltaChange {
+                .entity = entityID,
+                .component = newComponent,
+                .offset = first,
+                .length = last - first + 1,
+            });
+        }
+        n++;
+        o++;
+    }
+}
+
+void mecsCollectDelta(MecsWorld* world, const MecsWorldSnapshot* snapshot, DeltaBuilder& delta)
+{
+    const MecsAllocator& allocator = snapshot->memAllocator;
+    world->archetypes.forEach([&](const Archetype& archetype) {
+        delta.sortedComponentsOffsets.push(allocator, delta.sortedComponents.count());
+        mecsSortedArchetypeComponents(allocator, archetype, delta.sortedComponents);
+    });
+
+    const MecsSize numEntries = std::max(world->entities.numEntries(), snapshot->entities.count());
+    for (MecsSize index = 0; index < numEntries; index++) {
+        const SnapshotEntity* oldEntity = index < snapshot->entities.count() && snapshot->entities[index].taken ? &snapshot->entities[index] : nullptr;
+        const auto* entry = index < world->entities.numEntries() && world->entities.entryAt(index).tagGeneration.taken ? &world->entities.entryAt(index) : nullptr;
+        const bool sameEntity = oldEntity != nullptr && entry != nullptr && oldEntity->generation == entry->tagGeneration.generation;
+        if (oldEntity != nullptr && !sameEntity) {
+            delta.destroyed.push(allocator, mecsPackEntityID(static_cast<MecsU32>(index), oldEntity->generation));
+        }
+        if (entry == nullptr) {
+            continue;
+        }
+
+        const MecsEntityID entityID = mecsPackEntityID(static_cast<MecsU32>(index), entry->tagGeneration.generation);
+        if (sameEntity) {
+            mecsDiffEntityComponents(world, snapshot, *oldEntity, entityID, entry->value, delta);
+            continue;
+        }
+        delta.spawned.push(allocator, DeltaSpawn {
+            .index = static_cast<MecsU32>(index),
+            .generation = entry->tagGeneration.generation,
+            .prefabID = entry->value.prefabID,
+            .entityFlags = entry->value.entityFlags,
+        });
+        const MecsSize components = delta.sortedComponentsOffsets[entry->value.archetype];
+        for (MecsSize i = 0; i < world->archetypes[entry->value.archetype].componentIDs.count(); i++) {
+            delta.added.push(allocator, DeltaComponentRef { .entity = entityID, .component = delta.sortedComponents[components + i] });
+        }
+    }
+}
+
+bool mecsWriteDeltaComponentRefs(const MecsVec<DeltaComponentRef>& refs, SnapshotWriter& out)
+{
+    out.writeValue(static_cast<MecsU32>(refs.count()));
+    refs.forEach([&](const DeltaComponentRef& ref) {
+        out.writeValue(ref.entity);
+        out.writeValue(ref.component);
+    });
+    return !out.failed();
+}
+
+}
+
+MecsWorldSnapshot* mecsWorldSnapshotCreate(MecsWorld* world)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    auto* snapshot = mecsAlloc<MecsWorldSnapshot>(world->allocators[MecsAllocationTag_World]);
+    snapshot->memAllocator = world->allocators[MecsAllocationTag_World];
+    snapshot->registry = world->registry;
+    mecsWorldSnapshotUpdate(snapshot, world);
+    return snapshot;
+}
+
+void mecsWorldSnapshotFree(MecsWorldSnapshot* snapshot)
+{
+    if (snapshot == nullptr) {
+        return;
+    }
+    const MecsAllocator allocator = snapshot->memAllocator;
+    snapshot->entities.destroy(allocator);
+    snapshot->archetypes.destroy(allocator);
+    snapshot->columns.destroy(allocator);
+    snapshot->data.destroy(allocator);
+    snapshot->serializedData.destroy(allocator);
+    snapshot->serializedOffsets.destroy(allocator);
+    mecsFree(allocator, snapshot);
+}
+
+void mecsWorldSnapshotUpdate(MecsWorldSnapshot* snapshot, MecsWorld* world)
+{
+    MECS_ASSERT(snapshot != nullptr && "Cannot pass a null snapshot");
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(snapshot->registry == world->registry && "The snapshot was taken from a world of another registry");
+    MECS_ASSERT(world->newEvents.empty() && "The events must be flushed before taking a snapshot");
+    const MecsAllocator& allocator = snapshot->memAllocator;
+    const MecsRegistry* registry = world->registry;
+
+    snapshot->entities.clear();
+    snapshot->archetypes.clear();
+    snapshot->columns.clear();
+    snapshot->serializedData.clear();
+    snapshot->serializedOffsets.clear();
+    for (MecsSize index = 0; index < world->entities.numEntries(); index++) {
+        const auto& entry = world->entities.entryAt(index);
+        snapshot->entities.push(allocator, SnapshotEntity {
+            .generation = entry.tagGeneration.generation,
+            .taken = entry.tagGeneration.taken,
+            .entityFlags = entry.tagGeneration.taken ? entry.value.entityFlags : MecsU8 { 0 },
+            .prefabID = entry.tagGeneration.taken ? entry.value.prefabID : MECS_INVALID,
+            .archetype = MECS_INVALID,
+            .row = 0,
+        });
+    }
+
+    // Lay out the columns first, so that the data is sized once
+    MecsSize dataSize = 0;
+    MecsVec<MecsComponentID> sortedComponents;
+    world->archetypes.forEach([&](const Archetype& archetype) {
+        const MecsSize rows = archetype.storage.rows();
+        if (rows == 0) { return; }
+        sortedComponents.clear();
+        mecsSortedArchetypeComponents(allocator, archetype, sortedComponents);
+        const auto archetypeIndex = static_cast<MecsU32>(snapshot->archetypes.push(allocator, SnapshotArchetype {
+            .firstColumn = static_cast<MecsU32>(snapshot->columns.count()),
+            .numColumns = static_cast<MecsU32>(sortedComponents.count()),
+        }));
+        sortedComponents.forEach([&](MecsComponentID component) {
+            const ComponentInfo& info = registry->components[component];
+            if (info.serialize != nullptr && info.size > 0) {
+                // Serialized right away, one offset for each row and one for the end of the last
+                const MecsSize firstOffset = snapshot->serializedOffsets.count();
+                snapshot->columns.push(allocator, SnapshotColumn { .component = component, .size = info.size, .dataOffset = firstOffset, .serialized = true });
+                for (MecsSize row = 0; row < rows; row++) {
+                    snapshot->serializedOffsets.push(allocator, snapshot->serializedData.count());
+                    mecsSerializeValue(allocator, info, archetype.storage.getRowComponent(component, row), snapshot->serializedData);
+                }
+                snapshot->serializedOffsets.push(allocator, snapshot->serializedData.count());
+                return;
+            }
+            snapshot->columns.push(allocator, SnapshotColumn { .component = component, .size = info.size, .dataOffset = dataSize, .serialized = false });
+            dataSize += rows * info.size;
+        });
+        for (MecsSize row = 0; row < rows; row++) {
+            SnapshotEntity& entity = snapshot->entities[getIndexFromGenArenaIndex(archetype.rowToEntity[row])];
+            entity.archetype = archetypeIndex;
+            entity.row = static_cast<MecsU32>(row);
+        }
+    });
+    sortedComponents.destroy(allocator);
+
+    if (snapshot->data.count() != dataSize) {
+        snapshot->data.resize(allocator, dataSize);
+    }
+    MecsSize archetypeIndex = 0;
+    world->archetypes.forEach([&](const Archetype& archetype) {
+        const MecsSize rows = archetype.storage.rows();
+        if (rows == 0) { return; }
+        const SnapshotArchetype& snapshotArchetype = snapshot->archetypes[archetypeIndex++];
+        for (MecsU32 c = 0; c < snapshotArchetype.numColumns; c++) {
+            const SnapshotColumn& column = snapshot->columns[snapshotArchetype.firstColumn + c];
+            if (column.size == 0 || column.serialized) { continue; }
+            memcpy(&snapshot->data[column.dataOffset], archetype.storage.getRowComponent(column.component, 0), rows * column.size);
+        }
+    });
+}
+
+bool mecsWorldWriteDelta(MecsWorld* world, const MecsWorldSnapshot* snapshot, const MecsWriter* writer)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(snapshot != nullptr && "Cannot pass a null snapshot");
+    MECS_ASSERT(writer != nullptr && writer->write != nullptr && "Cannot pass a null writer");
+    MECS_ASSERT(snapshot->registry == world->registry && "The snapshot was taken from a world of another registry");
+    MECS_ASSERT(world->newEvents.empty() && "The events must be flushed before writing a delta");
+    const MecsRegistry* registry = world->registry;
+
+    DeltaBuilder delta;
+    mecsCollectDelta(world, snapshot, delta);
+
+    SnapshotWriter out(*writer, world->allocators[MecsAllocationTag_World]);
+    out.write(kDeltaMagic, sizeof(kDeltaMagic));
+    out.writeValue(kDeltaVersion);
+    out.writeValue(kByteOrderMark);
+    out.writeValue(static_cast<MecsU32>(registry->components.count()));
+    registry->components.forEach([&](const MecsComponentInfoInternal& info) {
+        out.writeValue(static_cast<MecsU64>(info.typeID));
+    });
+
+    out.writeValue(static_cast<MecsU32>(delta.destroyed.count()));
+    delta.destroyed.forEach([&](MecsEntityID entity) {
+        out.writeValue(entity);
+    });
+    out.writeValue(static_cast<MecsU32>(delta.spawned.count()));
+    delta.spawned.forEach([&](const DeltaSpawn& spawn) {
+        out.writeValue(spawn.index);
+        out.writeValue(spawn.generation);
+        out.writeValue(spawn.prefabID);
+        out.writeValue(spawn.entityFlags);
+    });
+    mecsWriteDeltaComponentRefs(delta.removed, out);
+
+    out.writeValue(static_cast<MecsU32>(delta.added.count()));
+    for (MecsSize i = 0; i < delta.added.count() && !out.failed(); i++) {
+        const DeltaComponentRef& ref = delta.added[i];
+        out.writeValue(ref.entity);
+        out.writeValue(ref.component);
+        mecsWriteDeltaValue(registry->components[ref.component], mecsWorldEntityReadComponent(world, ref.entity, ref.component), out);
+    }
+
+    out.writeValue(static_cast<MecsU32>(delta.changed.count()));
+    for (MecsSize i = 0; i < delta.changed.count() && !out.failed(); i++) {
+        const DeltaChange& change = delta.changed[i];
+        out.writeValue(change.entity);
+        out.writeValue(change.component);
+        out.writeValue(change.offset);
+        out.writeValue(change.length);
+        const auto* value = static_cast<const MecsU8*>(mecsWorldEntityReadComponent(world, change.entity, change.component));
+        if (change.length == MECS_INVALID) {
+            mecsWriteDeltaValue(registry->components[change.component], value, out);
+        } else {
+            out.write(value + change.offset, change.length);
+        }
+    }
+
+    delta.destroy(snapshot->memAllocator);
+    return out.flush();
+}
+
+bool mecsWorldApplyDelta(MecsWorld* world, const MecsReader* reader, void* updateData)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(reader != nullptr && reader->read != nullptr && "Cannot pass a null reader");
+    MECS_ASSERT(world->newEvents.empty() && "The events must be flushed before applying a delta");
+    const MecsRegistry* registry = world->registry;
+
+    SnapshotReader in(*reader, world->allocators[MecsAllocationTag_World]);
+    char magic[sizeof(kDeltaMagic)] = {};
+    MecsU32 version = 0;
+    MecsU32 byteOrderMark = 0;
+    MecsU32 numComponents = 0;
+    bool valid = in.read(magic, sizeof(magic)) && in.readValue(version) && in.readValue(byteOrderMark) && in.readValue(numComponents)
+        && memcmp(magic, kDeltaMagic, sizeof(magic)) == 0 && version == kDeltaVersion && byteOrderMark == kByteOrderMark
+        && numComponents == registry->components.count();
+    for (MecsU32 c = 0; c < numComponents && valid; c++) {
+        MecsU64 typeID = 0;
+        valid = in.readValue(typeID) && typeID == registry->components[c].typeID;
+    }
+
+    // The destroyed entities and the removed components are flushed first, so that the spawned entities can take their slots
+    MecsU32 count = 0;
+    valid = valid && in.readValue(count);
+    for (MecsU32 i = 0; i < count && valid; i++) {
+        MecsEntityID entityID = MECS_INVALID;
+        valid = in.readValue(entityID) && mecsDeltaEntity(world, entityID) != nullptr;
+        if (valid) {
+            mecsWorldDestroyEntity(world, entityID);
+        }
+    }
+
+    MecsVec<DeltaSpawn> spawned;
+    valid = valid && in.readValue(count);
+    for (MecsU32 i = 0; i < count && valid; i++) {
+        DeltaSpawn spawn {};
+        valid = in.readValue(spawn.index) && in.readValue(spawn.generation) && in.readValue(spawn.prefabID) && in.readValue(spawn.entityFlags);
+        if (valid) {
+            spawned.push(world->allocators[MecsAllocationTag_World], spawn);
+        }
+    }
+
+    valid = valid && in.readValue(count);
+    for (MecsU32 i = 0; i < count && valid; i++) {
+        DeltaComponentRef ref {};
+        valid = in.readValue(ref.entity) && in.readValue(ref.component);
+        const MecsEntity* entity = valid ? mecsDeltaEntity(world, ref.entity) : nullptr;
+        valid = entity != nullptr && mecsDeltaHasComponent(world, entity, ref.component);
+        if (valid) {
+            mecsWorldRemoveComponent(world, ref.entity, ref.component);
+        }
+    }
+    mecsWorldFlushEvents(world, updateData);
+
+    for (MecsSize i = 0; i < spawned.count() && valid; i++) {
+        const DeltaSpawn& spawn = spawned[i];
+        valid = spawn.index >= world->entities.numEntries() || !world->entities.entryAt(spawn.index).tagGeneration.taken;
+        if (valid) {
+            mecsWorldSpawnEntityAt(world, spawn.index, spawn.generation, spawn.prefabID, spawn.entityFlags);
+        }
+    }
+    spawned.destroy(world->allocators[MecsAllocationTag_World]);
+
+    valid = valid && in.readValue(count);
+    for (MecsU32 i = 0; i < count && valid; i++) {
+        DeltaComponentRef ref {};
+        valid = in.readValue(ref.entity) && in.readValue(ref.component);
+        const MecsEntity* entity = valid ? mecsDeltaEntity(world, ref.entity) : nullptr;
+        valid = entity != nullptr && ref.component < registry->components.count() && !mecsDeltaHasComponent(world, entity, ref.component);
+        if (valid) {
+            void* value = mecsWorldAddComponent(world, ref.entity, ref.component);
+            valid = mecsReadDeltaValue(registry->components[ref.component], value, in);
+        }
+    }
+
+    valid = valid && in.readValue(count);
+    for (MecsU32 i = 0; i < count && valid; i++) {
+        DeltaChange change {};
+        valid = in.readValue(change.entity) && in.readValue(change.component) && in.readValue(change.offset) && in.readValue(change.length);
+        const MecsEntity* entity = valid ? mecsDeltaEntity(world, change.entity) : nullptr;
+        valid = entity != nullptr && mecsDeltaHasComponent(world, entity, change.component);
+        if (!valid) { continue; }
+
+        const ComponentInfo& info = registry->components[change.component];
+        auto* value = static_cast<MecsU8*>(mecsWorldEntityGetComponent(world, change.entity, change.component));
+        if (change.length == MECS_INVALID) {
+            valid = mecsReadDeltaValue(info, value, in);
+        } else {
+            valid = change.offset <= info.size && change.length <= info.size - change.offset && in.read(value + change.offset, change.length);
+        }
+    }
+    return valid;
+}
@@ -3,6 +3,9 @@
 
 #include "private.h"
 
+#include <algorithm>
+#include <bit>
+
 void mecsIterComponent(MecsIterator* iterator, MecsComponentID component, MecsSize argIndex)
 {
     mecsIterComponentFilter(iterator, component, MecsIteratorFilter::Access, argIndex);
@@ -14,18 +17,55 @@ void mecsIterComponentFilter(MecsIterator* iterator, MecsComponentID component,
     MecsWorld* world = iterator->world;
     MECS_ASSERT(world);
 
-    iterator->componentSet.set(world->memAllocator, component, false);
+    iterator->componentSet.set(world->allocators[MecsAllocationTag_Iterators], component, false);
+    iterator->sparseArguments.remove(argIndex);
 
-    if (filter == MecsIteratorFilter::Access || filter == MecsIteratorFilter::With) {
-        iterator->componentSet.set(world->memAllocator, component, true);
-    }
-    if (filter == MecsIteratorFilter::Not) {
-        iterator->blacklistComponentSet.set(world->memAllocator, component, true);
+    if (mecsIsSparseComponent(world->registry, component)) {
+        // The sparse components don't select archetypes, they're checked for each entity by mecsIteratorAdvance()
+        iterator->sparseArguments.push(world->allocators[MecsAllocationTag_Iterators], argIndex);
+    } else if (filter == MecsIteratorFilter::Access || filter == MecsIteratorFilter::Read || filter == MecsIteratorFilter::With) {
+        iterator->componentSet.set(world->allocators[MecsAllocationTag_Iterators], component, true);
+    } else if (filter == MecsIteratorFilter::Not) {
+        iterator->blacklistComponentSet.set(world->allocators[MecsAllocationTag_Iterators], component, true);
     }
-    iterator->components.ensureSize(world->memAllocator, argIndex + 1);
+    iterator->components.ensureSize(world->allocators[MecsAllocationTag_Iterators], argIndex + 1);
     iterator->components[argIndex] = { .argumentID = component, .filter = filter };
     iterator->dirty = true;
 }
+MecsU64 mecsIteratorArchetypeGroup(const MecsIterator* iterator, ArchetypeID archetypeID)
+{
+    const MecsVec<MecsComponentID>& components = iterator->world->archetypes[archetypeID].componentIDs;
+    return iterator->groupBy(components.empty() ? nullptr : components.atPtr(0), components.count(), iterator->groupByUserData);
+}
+
+// Computes the groups of the archetypes and orders them by group, see mecsIteratorGroupBy()
+void mecsIteratorGroupArchetypes(MecsIterator* iterator)
+{
+    const MecsAllocator& alloc = iterator->world->allocators[MecsAllocationTag_Iterators];
+    iterator->archetypeGroups.clear();
+    if (iterator->groupBy == nullptr || iterator->archetypes.empty()) {
+        return;
+    }
+
+    struct GroupedArchetype {
+        MecsU64 group;
+        ArchetypeID archetype;
+    };
+    MecsVec<GroupedArchetype> grouped;
+    for (MecsSize i = 0; i < iterator->archetypes.count(); i++) {
+        grouped.push(alloc, { .group = mecsIteratorArchetypeGroup(iterator, iterator->archetypes[i]), .archetype = iterator->archetypes[i] });
+    }
+    std::stable_sort(grouped.atPtr(0), grouped.atPtr(0) + grouped.count(), [](const GroupedArchetype& lhs, const GroupedArchetype& rhs) {
+        return lhs.group < rhs.group;
+    });
+    iterator->archetypeGroups.resize(alloc, grouped.count());
+    for (MecsSize i = 0; i < grouped.count(); i++) {
+        iterator->archetypes[i] = grouped[i].archetype;
+        iterator->archetypeGroups[i] = grouped[i].group;
+    }
+    grouped.destroy(alloc);
+}
+
 void mecsIteratorFinalize(MecsIterator* iterator)
 {
     MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
@@ -40,7 +80,7 @@ void mecsIteratorFinalize(MecsIterator* iterator)
 
     if (iterator->components.count() == 0) {
         // Iterator iterates on all entities
-        iterator->archetypes.ensureSize(world->memAllocator, world->archetypes.count());
+        iterator->archetypes.ensureSize(world->allocators[MecsAllocationTag_Iterators], world->archetypes.count());
         for (MecsSize i = 0; i < count; i++) {
             const Archetype& archetype = world->archetypes[i];
             iterator->archetypes[i] = i;
@@ -52,10 +92,11 @@ void mecsIteratorFinalize(MecsIterator* iterator)
                 continue;
             }
             if (iterator->componentSet.contains(archetype.storage.bitset())) {
-                iterator->archetypes.push(world->memAllocator, i);
+                iterator->archetypes.push(world->allocators[MecsAllocationTag_Iterators], i);
             }
         }
     }
+    mecsIteratorGroupArchetypes(iterator);
 }
 void mecsIteratorBegin(MecsIterator* iterator)
 {
@@ -64,40 +105,204 @@ void mecsIteratorBegin(MecsIterator* iterator)
     MECS_ASSERT(world);
     iterator->currentArchetype = 0;
     iterator->currentRow = 0;
+
+    if (iterator->sortCompare != nullptr) {
+        MECS_ASSERT(iterator->componentSet.test(iterator->sortComponent) && "An iterator can only be sorted by one of its Access, Read or With components");
+        for (MecsSize i = 0; i < iterator->archetypes.count(); i++) {
+            mecsArchetypeSortRows(world, world->archetypes[iterator->archetypes[i]], iterator->sortComponent, iterator->sortCompare, iterator->sortUserData);
+        }
+    }
+    if (iterator->hierarchyOrder) {
+        iterator->currentDepth = 0;
+        iterator->hierarchyCursors.clear();
+        iterator->hierarchyCursors.ensureSize(world->allocators[MecsAllocationTag_Iterators], iterator->archetypes.count());
+        for (MecsSize i = 0; i < iterator->archetypes.count(); i++) {
+            mecsArchetypeSortRows(world, world->archetypes[iterator->archetypes[i]], MECS_INVALID, mecsCompareHierarchyRows, world);
+        }
+    }
 }
-bool mecsIteratorAdvance(MecsIterator* iterator)
+
+void mecsIteratorAddArchetype(MecsIterator* iterator, ArchetypeID archetypeID)
+{
+    const MecsAllocator& alloc = iterator->world->allocators[MecsAllocationTag_Iterators];
+    if (iterator->groupBy == nullptr) {
+        iterator->archetypes.pushUnique(alloc, archetypeID);
+        return;
+    }
+    if (iterator->archetypes.contains(archetypeID)) {
+        return;
+    }
+
+    const MecsU64 group = mecsIteratorArchetypeGroup(iterator, archetypeID);
+    MecsSize index = iterator->archetypes.count();
+    while (index > 0 && iterator->archetypeGroups[index - 1] > group) {
+        index--;
+    }
+    iterator->archetypes.push(alloc, archetypeID);
+    iterator->archetypeGroups.push(alloc, group);
+    std::rotate(iterator->archetypes.atPtr(index), iterator->archetypes.atPtr(iterator->archetypes.count() - 1), iterator->archetypes.atPtr(0) + iterator->archetypes.count());
+    std::rotate(iterator->archetypeGroups.atPtr(index), iterator->archetypeGroups.atPtr(iterator->archetypeGroups.count() - 1), iterator->archetypeGroups.atPtr(0) + iterator->archetypeGroups.count());
+
+    // The archetype being iterated keeps being the current one
+    if (index < iterator->currentArchetype || (index == iterator->currentArchetype && iterator->currentRow > 0)) {
+        iterator->currentArchetype++;
+    }
+    // Past the last row: an archetype created while iterating in hierarchy order is only visited from the next begin
+    if (index < iterator->hierarchyCursors.count()) {
+        iterator->hierarchyCursors.push(alloc, ~MecsSize(0));
+        std::rotate(iterator->hierarchyCursors.atPtr(index), iterator->hierarchyCursors.atPtr(iterator->hierarchyCursors.count() - 1), iterator->hierarchyCursors.atPtr(0) + iterator->hierarchyCursors.count());
+    }
+}
+
+void mecsIteratorGroupBy(MecsIterator* iterator, PFNMecsArchetypeGroup func, void* userData)
 {
     MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
-    MECS_ASSERT(iterator->status == IteratorStatus::eIterating && "Cannot advance an iterator that hasn't begun");
+    if (iterator->groupBy == func && iterator->groupByUserData == userData) {
+        return;
+    }
+    iterator->groupBy = func;
+    iterator->groupByUserData = userData;
+    if (iterator->status == IteratorStatus::eIterating) {
+        mecsIteratorGroupArchetypes(iterator);
+    }
+}
+
+void mecsIteratorSetHierarchyOrder(MecsIterator* iterator, bool hierarchyOrder)
+{
+    MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
+    MECS_ASSERT((!hierarchyOrder || iterator->sortCompare == nullptr) && "A sorted iterator cannot be in hierarchy order");
+    iterator->hierarchyOrder = hierarchyOrder;
+}
+
+bool mecsIteratorIsHierarchyOrdered(MecsIterator* iterator)
+{
+    MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
+    return iterator->hierarchyOrder;
+}
+
+void mecsIteratorSortBy(MecsIterator* iterator, MecsComponentID component, PFNMecsCompareComponents compare, void* userData)
+{
+    MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
+    MECS_ASSERT((compare == nullptr || !iterator->hierarchyOrder) && "An iterator in hierarchy order cannot be sorted");
+    MECS_ASSERT((compare == nullptr || !mecsIsSparseComponent(iterator->world->registry, component)) && "The rows cannot be sorted by a sparse component");
+    iterator->sortComponent = compare != nullptr ? component : MECS_INVALID;
+    iterator->sortCompare = compare;
+    iterator->sortUserData = userData;
+}
+// One bit for each of the rows [word * BitSet::kBitsPerWord, (word + 1) * BitSet::kBitsPerWord) of the storage whose
+// Access, Read and With components are all enabled. The Not components only exclude archetypes, disabling them changes
+// nothing
+BitSet::Word mecsIteratorEnabledRows(const MecsIterator* iterator, const RowStorage& storage, MecsSize word)
+{
+    BitSet::Word disabled = 0;
+    iterator->componentSet.forEach([&](MecsComponentID component) {
+        disabled |= storage.disabledRows(component, word);
+    });
+    return ~disabled;
+}
 
-    if (iterator->archetypes.count() == 0) {
-        return false;
+// The first row starting from row whose arguments are all enabled, or storage.rows() when there's none. A whole word of
+// rows is skipped at once when its arguments are disabled
+MecsSize mecsIteratorNextEnabledRow(const MecsIterator* iterator, const RowStorage& storage, MecsSize row)
+{
+    for (MecsSize word = row / BitSet::kBitsPerWord; word * BitSet::kBitsPerWord < storage.rows(); word++) {
+        BitSet::Word enabled = mecsIteratorEnabledRows(iterator, storage, word);
+        if (word == row / BitSet::kBitsPerWord) {
+            enabled &= ~BitSet::Word(0) << (row % BitSet::kBitsPerWord);
+        }
+        if (enabled != 0) {
+            return std::min(word * BitSet::kBitsPerWord + std::countr_zero(enabled), storage.rows());
+        }
     }
+    return storage.rows();
+}
 
+// Like mecsIteratorAdvanceRow(), visiting the rows at each depth of all the archetypes before the deeper ones
+bool mecsIteratorAdvanceHierarchyRow(MecsIterator* iterator)
+{
     MecsWorld* world = iterator->world;
-    ArchetypeID worldArchetypeIndex = iterator->archetypes[iterator->currentArchetype];
-    const Archetype& currentArchetype = world->archetypes[worldArchetypeIndex];
-    if (iterator->currentRow >= currentArchetype.storage.rows()) {
-
-        ArchetypeID worldArchetypeIndex = iterator->archetypes[iterator->currentArchetype];
+    const MecsSize numArchetypes = iterator->hierarchyCursors.count();
+    for (;;) {
+        for (; iterator->currentArchetype < numArchetypes; iterator->currentArchetype++) {
+            const Archetype& archetype = world->archetypes[iterator->archetypes[iterator->currentArchetype]];
+            MecsSize& cursor = iterator->hierarchyCursors[iterator->currentArchetype];
+            while (cursor < archetype.storage.rows() && mecsWorldEntityDepth(world, archetype.rowToEntity[cursor]) == iterator->currentDepth) {
+                const MecsSize row = cursor++;
+                if (!archetype.storage.hasDisabledRows() || mecsIteratorNextEnabledRow(iterator, archetype.storage, row) == row) {
+                    iterator->currentRow = row + 1;
+                    return true;
+                }
+            }
+        }
 
-        do {
-            iterator->currentArchetype++;
-            if (iterator->currentArchetype >= iterator->archetypes.count()) {
-                return false;
+        // The depth is done in all the archetypes, move to the shallowest row left
+        MecsU32 nextDepth = MECS_INVALID;
+        for (MecsSize i = 0; i < numArchetypes; i++) {
+            const Archetype& archetype = world->archetypes[iterator->archetypes[i]];
+            if (iterator->hierarchyCursors[i] < archetype.storage.rows()) {
+                nextDepth = std::min(nextDepth, mecsWorldEntityDepth(world, archetype.rowToEntity[iterator->hierarchyCursors[i]]));
             }
-            worldArchetypeIndex = iterator->archetypes[iterator->currentArchetype];
-        } while (world->archetypes[worldArchetypeIndex].storage.rows() == 0);
-        iterator->currentRow = 0;
+        }
+        if (nextDepth == MECS_INVALID) {
+            return false;
+        }
+        iterator->currentDepth = nextDepth;
+        iterator->currentArchetype = 0;
     }
+}
 
-    if (iterator->currentArchetype >= iterator->archetypes.count()) {
-        return false;
+// Moves to the next row of the matching archetypes whose arguments are enabled, without looking at the sparse arguments
+bool mecsIteratorAdvanceRow(MecsIterator* iterator)
+{
+    MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
+    MECS_ASSERT(iterator->status == IteratorStatus::eIterating && "Cannot advance an iterator that hasn't begun");
+    if (iterator->hierarchyOrder) {
+        return mecsIteratorAdvanceHierarchyRow(iterator);
     }
 
-    iterator->currentRow += 1;
+    MecsWorld* world = iterator->world;
+    while (iterator->currentArchetype < iterator->archetypes.count()) {
+        const RowStorage& storage = world->archetypes[iterator->archetypes[iterator->currentArchetype]].storage;
+        // The enable bits are only looked at when some rows of the archetype have disabled components
+        const MecsSize row = storage.hasDisabledRows()
+            ? mecsIteratorNextEnabledRow(iterator, storage, iterator->currentRow)
+            : iterator->currentRow;
+        if (row < storage.rows()) {
+            iterator->currentRow = row + 1;
+            return true;
+        }
+        iterator->currentArchetype++;
+        iterator->currentRow = 0;
+    }
+    return false;
+}
+
+// Whether the entity of the current row has the sparse components of the With, Access and Read arguments, and none of
+// the Not ones
+bool mecsIteratorMatchesSparseArguments(MecsIterator* iterator)
+{
+    const MecsWorld* world = iterator->world;
+    const MecsU32 entityIndex = mecsEntityIDToIndex(mecsIteratorGetEntity(iterator));
+    for (MecsSize i = 0; i < iterator->sparseArguments.count(); i++) {
+        const MecsIteratorArgument& arg = iterator->components[iterator->sparseArguments[i]];
+        const bool hasComponent = world->sparseComponents.isValid(arg.argumentID)
+            && world->sparseComponents[arg.argumentID].hasComponent(entityIndex);
+        if (hasComponent == (arg.filter == MecsIteratorFilter::Not)) {
+            return false;
+        }
+    }
     return true;
 }
+
+bool mecsIteratorAdvance(MecsIterator* iterator)
+{
+    while (mecsIteratorAdvanceRow(iterator)) {
+        if (iterator->sparseArguments.empty() || mecsIteratorMatchesSparseArguments(iterator)) {
+            return true;
+        }
+    }
+    return false;
+}
 void* mecsIteratorGetArgument(MecsIterator* iterator, MecsSize argIndex)
 {
     MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
@@ -106,14 +311,116 @@ void* mecsIteratorGetArgument(MecsIterator* iterator, MecsSize argIndex)
     MecsWorld* world = iterator->world;
     MECS_ASSERT(world);
     ArchetypeID worldArchetypeIndex = iterator->archetypes[iterator->currentArchetype];
-    const Archetype& currentArchetype = world->archetypes[worldArchetypeIndex];
+    Archetype& currentArchetype = world->archetypes[worldArchetypeIndex];
     MecsIteratorArgument arg = iterator->components[argIndex];
-    if (arg.filter != MecsIteratorFilter::Access) {
+    if (arg.filter != MecsIteratorFilter::Access && arg.filter != MecsIteratorFilter::Read) {
         return nullptr;
     }
+    if (mecsIsSparseComponent(world->registry, arg.argumentID)) {
+        const MecsEntityID entity = currentArchetype.rowToEntity[iterator->currentRow - 1];
+        return mecsWorldSparseStorage(world, arg.argumentID).getComponent(mecsEntityIDToIndex(entity));
+    }
+    if (arg.filter == MecsIteratorFilter::Access) {
+        currentArchetype.storage.unshareColumn(world->allocators[MecsAllocationTag_ArchetypeColumns], arg.argumentID);
+        if (arg.argumentID == currentArchetype.sortComponent) {
+            mecsArchetypeRowChanged(world, currentArchetype, iterator->currentRow - 1);
+        }
+    }
     return currentArchetype.storage.getRowComponent(arg.argumentID, iterator->currentRow - 1);
 }
 
+// Fills enabledRows with the enabled rows of the storage, it's left empty when all the rows are enabled
+void mecsIteratorComputeEnabledRows(MecsIterator* iterator, const RowStorage& storage)
+{
+    const MecsAllocator& alloc = iterator->world->allocators[MecsAllocationTag_Iterators];
+    const MecsSize numWords = (storage.rows() + BitSet::kBitsPerWord - 1) / BitSet::kBitsPerWord;
+    bool allEnabled = true;
+    iterator->enabledRows.ensureSize(alloc, numWords);
+    for (MecsSize word = 0; word < numWords; word++) {
+        BitSet::Word enabled = mecsIteratorEnabledRows(iterator, storage, word);
+        // The rows past the end are never enabled, so that the callers don't have to check them
+        const MecsSize remainingRows = storage.rows() - word * BitSet::kBitsPerWord;
+        if (remainingRows < BitSet::kBitsPerWord) {
+            enabled &= (BitSet::Word(1) << remainingRows) - 1;
+            allEnabled = allEnabled && enabled == (BitSet::Word(1) << remainingRows) - 1;
+        } else {
+            allEnabled = allEnabled && enabled == ~BitSet::Word(0);
+        }
+        iterator->enabledRows[word] = enabled;
+    }
+    if (allEnabled) {
+        iterator->enabledRows.clear();
+    }
+}
+
+MecsSize mecsIteratorAdvanceArchetype(MecsIterator* iterator)
+{
+    MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
+    MECS_ASSERT(iterator->status == IteratorStatus::eIterating && "Cannot advance an iterator that hasn't begun");
+    MECS_ASSERT(iterator->sparseArguments.empty() && "The iterators with sparse arguments must be advanced with mecsIteratorAdvance()");
+    MECS_ASSERT(!iterator->hierarchyOrder && "The iterators in hierarchy order must be advanced with mecsIteratorAdvance()");
+    MecsWorld* world = iterator->world;
+    MECS_ASSERT(world);
+
+    // currentRow is left past the last row of the current archetype, it's only 0 before the first archetype
+    if (iterator->currentRow > 0) {
+        MECS_ASSERT(iterator->currentRow == world->archetypes[iterator->archetypes[iterator->currentArchetype]].storage.rows()
+            && "Cannot add or remove the entities of an archetype while iterating it");
+        iterator->currentArchetype++;
+    }
+    iterator->enabledRows.clear();
+    for (; iterator->currentArchetype < iterator->archetypes.count(); iterator->currentArchetype++) {
+        const Archetype& archetype = world->archetypes[iterator->archetypes[iterator->currentArchetype]];
+        if (archetype.storage.rows() > 0) {
+            iterator->currentRow = archetype.storage.rows();
+            if (archetype.storage.hasDisabledRows()) {
+                mecsIteratorComputeEnabledRows(iterator, archetype.storage);
+            }
+            return iterator->currentRow;
+        }
+    }
+    return 0;
+}
+void* mecsIteratorGetColumn(MecsIterator* iterator, MecsSize argIndex)
+{
+    MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
+    MECS_ASSERT(iterator->currentRow > 0 && "Must have called mecsIteratorAdvanceArchetype() at least once");
+    MecsWorld* world = iterator->world;
+    MECS_ASSERT(world);
+    Archetype& currentArchetype = world->archetypes[iterator->archetypes[iterator->currentArchetype]];
+    MecsIteratorArgument arg = iterator->components[argIndex];
+    if (arg.filter == MecsIteratorFilter::Access) {
+        currentArchetype.storage.unshareColumn(world->allocators[MecsAllocationTag_ArchetypeColumns], arg.argumentID);
+        // Any row may change: the next sort looks for the keys that did
+        if (arg.argumentID == currentArchetype.sortComponent) {
+            mecsArchetypeSnapshotSortKeys(world, currentArchetype);
+        }
+    } else if (arg.filter != MecsIteratorFilter::Read) {
+        return nullptr;
+    }
+    return currentArchetype.storage.getRowComponent(arg.argumentID, 0);
+}
+const MecsU32* mecsIteratorGetEnabledRows(MecsIterator* iterator)
+{
+    MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
+    MECS_ASSERT(iterator->currentRow > 0 && "Must have called mecsIteratorAdvanceArchetype() at least once");
+    return iterator->enabledRows.empty() ? nullptr : &iterator->enabledRows[0];
+}
+bool mecsIteratorHasSparseArguments(MecsIterator* iterator)
+{
+    MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
+    return !iterator->sparseArguments.empty();
+}
+const MecsEntityID* mecsIteratorGetEntities(MecsIterator* iterator)
+{
+    MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
+    MECS_ASSERT(iterator->currentRow > 0 && "Must have called mecsIteratorAdvanceArchetype() at least once");
+    MecsWorld* world = iterator->world;
+    MECS_ASSERT(world);
+    const Archetype& currentArchetype = world->archetypes[iterator->archetypes[iterator->currentArchetype]];
+    return currentArchetype.rowToEntity.atPtr(0);
+}
+
 MecsWorld* mecsIteratorGetWorld(MecsIterator* iterator)
 {
     MECS_ASSERT(iterator != nullptr && "Cannot pass a null iterator");
@@ -1,6 +1,7 @@
 #include "private.h"
 #include "collections.h"
 #include "mecs/base.h"
+#include <algorithm>
 #include <cstring>
 
 void* mecsDefaultMalloc(void* userData, MecsSize size, MecsSize align) { return malloc(size); }
@@ -14,6 +15,16 @@ void mecsDefaultFree(void* userData, void* ptr)
     free(ptr);
 }
 
+void mecsApplyTaggedAllocators(MecsAllocator* allocators, const MecsAllocator* pTaggedAllocators)
+{
+    if (pTaggedAllocators == nullptr) { return; }
+    for (MecsSize tag = 0; tag < MecsAllocationTag_Count; tag++) {
+        if (pTaggedAllocators[tag].memAlloc != nullptr) {
+            allocators[tag] = pTaggedAllocators[tag];
+        }
+    }
+}
+
 void mecsMemCpy(const char* source, MecsSize sourceSize, char* dest, MecsSize destSize)
 {
     memcpy(dest, source, destSize);
@@ -51,56 +62,113 @@ const char* mecsStrDup(const MecsAllocator& alloc, const char* str)
     return dup;
 }
 
-MecsComponentID ComponentStorage::constructUninitialized(const MecsAllocator& allocator, MecsEntityID owner, void** outPtr)
+void* ComponentStorage::construct(const MecsAllocator& allocator, const ComponentInfo& info, MecsU32 entityIndex)
 {
+    MECS_ASSERT(!mEntityToIndices.contains(entityIndex) && "The entity already has the component");
+    if (!mInitialized) {
+        mComponentStorage = MecsVecUnmanaged(ElementInfo { .size = info.size, .align = info.align });
+        mTag = info.size == 0;
+        mInitialized = true;
+    }
+    if (mTag) {
+        mEntityToIndices.insert(allocator, entityIndex, 0);
+        return mecsTagInstance();
+    }
 
-    MecsSize index;
+    // The free slots hold initialized instances, see destroyInstance()
     if (mFreeIndices.count() > 0) {
-        index = mFreeIndices.pop();
-        mEntityToIndices.insert(allocator, owner, index);
-    } else {
-        index = mComponentStorage.push(allocator, nullptr, {});
-        mEntityToIndices.insert(allocator, owner, index);
+        const MecsSize slot = mFreeIndices.pop();
+        mEntityToIndices.insert(allocator, entityIndex, slot);
+        return mComponentStorage.at(slot);
     }
-    void* storage = mComponentStorage.at(index);
-    if (outPtr != nullptr) { *outPtr = storage; }
-    return index;
+
+    const MecsSize slot = mComponentStorage.push(allocator, nullptr, info);
+    mEntityToIndices.insert(allocator, entityIndex, slot);
+    void* instance = mComponentStorage.at(slot);
+    if (info.init != nullptr) {
+        info.init(instance);
+    }
+    return instance;
 }
 
-bool ComponentStorage::hasComponent(MecsEntityID owner) const
+bool ComponentStorage::hasComponent(MecsU32 entityIndex) const
 {
-    return mEntityToIndices.contains(owner);
+    return mEntityToIndices.contains(entityIndex);
 }
 
-void* ComponentStorage::getComponent(MecsEntityID entity)
+void* ComponentStorage::getComponent(MecsU32 entityIndex) const
 {
-    MECS_ASSERT(mEntityToIndices.contains(entity));
-    MecsSize componentIndex = mEntityToIndices.get(entity);
-    return mComponentStorage.at(componentIndex);
+    MECS_ASSERT(mEntityToIndices.contains(entityIndex));
+    return slotPtr(mEntityToIndices.get(entityIndex));
 }
 
-void ComponentStorage::destroyInstance(const MecsAllocator& allocator, MecsEntityID owner, MecsComponentID component)
+void ComponentStorage::destroyInstance(const MecsAllocator& allocator, const ComponentInfo& info, MecsU32 entityIndex)
 {
-    MECS_ASSERT(mEntityToIndices.contains(owner));
-    MecsSize componentIndex = mEntityToIndices.get(owner);
+    MECS_ASSERT(mEntityToIndices.contains(entityIndex));
+    const MecsSize slot = mEntityToIndices.get(entityIndex);
+    mEntityToIndices.remove(entityIndex);
+    if (mTag) {
+        return;
+    }
 
-    bool removal = mEntityToIndices.remove(owner);
-    MECS_ASSERT(removal);
+    // The slot is left initialized: growing the column moves and destroys all the slots, the free ones included
+    void* instance = mComponentStorage.at(slot);
+    if (info.destroy != nullptr) {
+        info.destroy(instance);
+    }
+    memset(instance, 0, info.size);
+    if (info.init != nullptr) {
+        info.init(instance);
+    }
+    mFreeIndices.push(allocator, slot);
 }
 
-void ComponentStorage::destroy(const MecsAllocator& allocator)
+MecsSize ComponentStorage::count() const
 {
+    return mEntityToIndices.count();
+}
+
+MecsSize ComponentStorage::capacity() const
+{
+    return mTag ? mEntityToIndices.count() : mComponentStorage.capacity();
+}
+
+MecsSize ComponentStorage::allocatedBytes() const
+{
+    return mComponentStorage.allocatedBytes();
+}
+
+MecsSize ComponentStorage::metadataBytes() const
+{
+    return mEntityToIndices.allocatedBytes() + mFreeIndices.allocatedBytes();
+}
+
+void* ComponentStorage::slotPtr(MecsSize slot) const
+{
+    return mTag ? mecsTagInstance() : static_cast<void*>(mComponentStorage.at(slot));
+}
+
+void ComponentStorage::destroy(const MecsAllocator& allocator, const ComponentInfo& info)
+{
+    if (!mTag && info.destroy != nullptr) {
+        for (MecsSize slot = 0; slot < mComponentStorage.count(); slot++) {
+            info.destroy(mComponentStorage.at(slot));
+        }
+    }
     mComponentStorage.destroy(allocator);
     mEntityToIndices.destroy(allocator);
     mFreeIndices.destroy(allocator);
+    mInitialized = false;
+    mTag = false;
 }
 
 ComponentBlob::ComponentBlob(const MecsRegistry* registry, MecsComponentID component) noexcept
     : mComponentID(component)
 {
-    MECS_ASSERT(registry != nullptr && registry->memAllocator.memAlloc != nullptr);
+    MECS_ASSERT(registry != nullptr && registry->allocators[MecsAllocationTag_Prefabs].memAlloc != nullptr);
     const ComponentInfo& componentInfo = registry->components[component];
-    mData = mecsCallocAligned<MecsU8>(registry->memAllocator, componentInfo.size, componentInfo.align);
+    // A tag still gets a byte, so that the blob is never null
+    mData = mecsCallocAligned<MecsU8>(registry->allocators[MecsAllocationTag_Prefabs], std::max<MecsSize>(componentInfo.size, 1), componentInfo.align);
     if (componentInfo.init != nullptr) {
         componentInfo.init(mData);
     }
@@ -136,13 +204,13 @@ void ComponentBlob::destroy(const MecsRegistry* registry)
     if (componentInfo.destroy != nullptr) {
         componentInfo.destroy(mData);
     }
-    mecsFree(registry->memAllocator, mData);
+    mecsFree(registry->allocators[MecsAllocationTag_Prefabs], mData);
     mData = nullptr;
 }
 
 void ComponentBlob::copyOnto(const MecsRegistry* registry, void* dest) const
 {
-    MECS_ASSERT(registry != nullptr && registry->memAllocator.memAlloc != nullptr);
+    MECS_ASSERT(registry != nullptr && registry->allocators[MecsAllocationTag_Prefabs].memAlloc != nullptr);
     MECS_ASSERT(mComponentID != MECS_INVALID);
     const ComponentInfo& componentInfo = registry->components[mComponentID];
     if (componentInfo.copy != nullptr) {
@@ -37,28 +37,57 @@ static_assert(sizeof(TaggedEntity) == sizeof(MecsEntityID));
 
 using ArchetypeID = MecsU32;
 
+// Stores the instances of a component with MecsComponentStorage_Sparse, indexed by entity index.
+// The instances live in a single column whose free slots are reused, so adding or removing an instance never moves
+// the others. Tags have no column, all their instances point to mecsTagInstance()
 class ComponentStorage {
 public:
     ComponentStorage() = default;
-    ComponentStorage(MecsAllocator allocator, ElementInfo info)
-        : mComponentStorage(info)
-    {
-    }
 
-    MecsComponentID constructUninitialized(const MecsAllocator& allocator, MecsEntityID owner, void** outPtr);
+    // Returns the initialized instance of the entity, which must not have one yet
+    void* construct(const MecsAllocator& allocator, const ComponentInfo& info, MecsU32 entityIndex);
+    [[nodiscard]]
+    bool hasComponent(MecsU32 entityIndex) const;
+    [[nodiscard]]
+    void* getComponent(MecsU32 entityIndex) const;
+    void destroyInstance(const MecsAllocator& allocator, const ComponentInfo& info, MecsU32 entityIndex);
+
     [[nodiscard]]
-    bool hasComponent(MecsEntityID owner) const;
-    void* getComponent(MecsEntityID entity);
-    void destroyInstance(const MecsAllocator& allocator, MecsEntityID owner, MecsComponentID component);
+    MecsSize count() const;
+    [[nodiscard]]
+    MecsSize capacity() const;
+    // The bytes of the instances, and of the lookup tables
+    [[nodiscard]]
+    MecsSize allocatedBytes() const;
+    [[nodiscard]]
+    MecsSize metadataBytes() const;
+
+    // Calls func(entityIndex, instance) for each instance
+    template <typename F>
+    void forEach(F&& func) const
+    {
+        mEntityToIndices.forEach([&](MecsSize entityIndex, MecsSize slot) {
+            func(static_cast<MecsU32>(entityIndex), slotPtr(slot));
+        });
+    }
 
-    void destroy(const MecsAllocator& allocator);
+    void destroy(const MecsAllocator& allocator, const ComponentInfo& info);
 
 private:
+    [[nodiscard]]
+    void* slotPtr(MecsSize slot) const;
+
     MecsVecUnmanaged mComponentStorage;
-    SparseSet<MecsEntityID> mEntityToIndices;
+    SparseSet<MecsSize> mEntityToIndices;
     MecsVec<MecsSize> mFreeIndices;
+    // The column is created by the first construct(), when the size of the component is known
+    bool mInitialized = false;
+    bool mTag = false;
 };
 
+// The memory all the instances of the tags point to, it must not be written
+void* mecsTagInstance();
+
 enum class EntityStatus : MecsU8 {
     eNewlySpawned,
     eSpawned,
@@ -93,7 +122,23 @@ struct MecsWorldIterator_t {
     BitSet componentSet;
     BitSet blacklistComponentSet;
     MecsVec<MecsIteratorArgument> components;
+    // The indices of the components with MecsComponentStorage_Sparse, checked for each row of the archetypes
+    MecsVec<MecsSize> sparseArguments;
     MecsVec<ArchetypeID> archetypes;
+    // See mecsIteratorGetEnabledRows()
+    MecsVec<BitSet::Word> enabledRows;
+    // See mecsIteratorGroupBy(), archetypeGroups[i] is the group of archetypes[i]
+    PFNMecsArchetypeGroup groupBy = nullptr;
+    void* groupByUserData = nullptr;
+    MecsVec<MecsU64> archetypeGroups;
+    // See mecsIteratorSortBy()
+    MecsComponentID sortComponent = MECS_INVALID;
+    PFNMecsCompareComponents sortCompare = nullptr;
+    void* sortUserData = nullptr;
+    // See mecsIteratorSetHierarchyOrder(), hierarchyCursors[i] is the next row of archetypes[i] to visit
+    bool hierarchyOrder = false;
+    MecsU32 currentDepth = 0;
+    MecsVec<MecsSize> hierarchyCursors;
     MecsSize currentArchetype { 0 };
     MecsSize currentRow { 0 };
     MecsEntityID currentEntityID = MECS_INVALID;
@@ -124,7 +169,8 @@ Given components A, B, C
  3 | a3| b3| c3|
 
 The rows are tightly packed, and when a row is removed it is swapped with the last one
-to keep the storage tightly packed
+to keep the storage tightly packed: a row is valid if and only if it's less than rows().
+New rows are always appended at the end, while the columns grow in bulk by capacity()
 */
 class RowStorage {
 public:
@@ -139,13 +185,71 @@ class RowStorage {
     [[nodiscard]]
     MecsSize allocateRow(const MecsAllocator& alloc);
 
+    // Appends count initialized rows at once, returns the first one
+    MecsSize allocateRows(const MecsAllocator& alloc, MecsSize count);
+
+    // Appends a copy of all the rows of source, which must have the same components, returns the first new row.
+    // The columns of the components without a copy callback are copied at once
+    MecsSize appendRows(const MecsAllocator& alloc, const RowStorage& source);
+
+    // Makes an empty storage share the rows of source, whose columns were allocated by sourceAlloc: the columns of the
+    // components without copy, move and destroy callbacks are shared until either storage modifies them, the others are
+    // copied. See MecsVecUnmanaged::share()
+    void shareRows(const MecsAllocator& alloc, RowStorage& source, const MecsAllocator& sourceAlloc);
+
+    // Must be called before modifying the components of a column (the rows being appended are not affected),
+    // so that a column shared with another storage is copied first
+    void unshareColumn(const MecsAllocator& alloc, MecsComponentID component);
+
+    // Makes an empty storage use count rows owned by someone else: columnMemory(component) returns the memory of each column.
+    // The columns are copied to alloc the first time they grow, see MecsVecUnmanaged::borrow()
+    template <typename F>
+    void borrowRows(const MecsAllocator& alloc, MecsSize count, F&& columnMemory)
+    {
+        MECS_ASSERT(mCount == 0 && "Only an empty storage can borrow its rows");
+        mColumnSet.forEach([&](MecsComponentID component) {
+            mStorages[component].borrow(alloc, columnMemory(component), count);
+        });
+        mCount = count;
+        mCapacity = count;
+    }
+
     MecsSize freeRow(const MecsAllocator& alloc, MecsSize row);
 
-    void copyRow(MecsSize sourceRow, RowStorage& dest, MecsSize destRow);
+    // Swaps all the components of the two rows, and whether they're enabled
+    void swapRows(const MecsAllocator& alloc, MecsSize lhs, MecsSize rhs);
+
+    // Copies the components (and whether they're enabled) that dest has too
+    void copyRow(const MecsAllocator& alloc, MecsSize sourceRow, RowStorage& dest, MecsSize destRow);
+
+    // A disabled component keeps its row, but the iterators skip it, see mecsWorldSetComponentEnabled()
+    void setRowEnabled(const MecsAllocator& alloc, MecsComponentID component, MecsSize row, bool enabled);
+    [[nodiscard]]
+    bool isRowEnabled(MecsComponentID component, MecsSize row) const;
+    // One bit for each of the rows [word * BitSet::kBitsPerWord, (word + 1) * BitSet::kBitsPerWord) whose component is
+    // disabled
+    [[nodiscard]]
+    BitSet::Word disabledRows(MecsComponentID component, MecsSize word) const;
+    [[nodiscard]]
+    bool hasDisabledRows() const
+    {
+        return mNumDisabledRows > 0;
+    }
 
     [[nodiscard]]
     MecsSize rows() const;
 
+    [[nodiscard]]
+    MecsSize capacity() const;
+
+    // The bytes allocated by the column of the component
+    [[nodiscard]]
+    MecsSize columnBytes(MecsComponentID component) const;
+
+    // The bytes allocated to keep track of the columns
+    [[nodiscard]]
+    MecsSize metadataBytes() const;
+
     [[nodiscard]]
     const BitSet& bitset() const
     {
@@ -155,11 +259,9 @@ class RowStorage {
     template <typename F>
     void forEachCompoonentInRow(MecsSize row, F&& func)
     {
-        MECS_ASSERT(mTakenRows.test(row));
+        MECS_ASSERT(row < mCount);
         mCmponentSet.forEach([&](MecsComponentID component) {
-            MecsVecUnmanaged& storage = mStorages[component];
-            void* ptr = storage.at(row);
-            func(component, ptr);
+            func(component, getRowComponent(component, row));
         });
     }
 
@@ -167,11 +269,18 @@ class RowStorage {
 
 private:
     MecsVecUnmanaged& getStorage(MecsComponentID component) const;
+    // Disables the rows of source in the rows starting at firstRow
+    void copyDisabledRows(const MecsAllocator& alloc, const RowStorage& source, MecsSize firstRow);
     MecsRegistry* mRegistry;
     BitSet mCmponentSet;
-    BitSet mTakenRows;
+    // mCmponentSet without the tags, which only take part in the archetype signature
+    BitSet mColumnSet;
     MecsVec<MecsVecUnmanaged> mStorages;
-    MecsVec<MecsSize> mFreeIndices;
+    // Indexed by component ID like mStorages, a bit is set for each row whose component is disabled.
+    // Nothing is allocated until a component is disabled
+    MecsVec<BitSet> mDisabledRows;
+    // The number of bits set in mDisabledRows, the iterators only look at the bits when it's not zero
+    MecsSize mNumDisabledRows = 0;
     MecsSize mCount = 0;
     MecsSize mCapacity = 0;
 };
@@ -215,15 +324,51 @@ struct MecsComponentInfoInternal : public ComponentInfo {
 };
 
 struct MecsRegistry_t {
-    MecsAllocator memAllocator;
+    MecsAllocator allocators[MecsAllocationTag_Count]; // Indexed by MecsAllocationTag
 
     MecsVec<MecsComponentInfoInternal> components;
     GenArena<MecsPrefab> prefabs;
 };
+// Identifies a system by the schedule it belongs to
+struct MecsSystemRef {
+    MecsScheduleID schedule;
+    MecsSystemID system;
+
+    bool operator==(const MecsSystemRef& other) const = default;
+};
+
+// The systems that gain or lose an entity when it moves between two archetypes
+struct ArchetypeEdge {
+    ArchetypeID target; // MECS_INVALID when the entity is destroyed
+    MecsVec<MecsSystemRef> addedSystems; // Only the systems with an onEntityAdded or onEntitiesAdded callback
+    MecsVec<MecsSystemRef> removedSystems; // Only the systems with an onEntityRemoved or onEntitiesRemoved callback
+};
+
+// The entities waiting to be handed out to a system with batched callbacks
+// A system receives either added or removed entities in a batch, to preserve the order of its notifications
+struct SystemNotificationBatch {
+    MecsSystemRef system;
+    bool added;
+    bool pending; // True if the batch is in MecsWorld::pendingNotificationBatches
+    MecsVec<MecsEntityID> entities;
+};
+
 struct Archetype {
     RowStorage storage;
     MecsVec<MecsComponentID> componentIDs;
     MecsVec<MecsEntityID> rowToEntity; // Tracks to which entity each row belongs;
+    MecsVec<MecsSystemRef> matchingSystems; // The systems whose components are all included in this archetype
+    MecsVec<ArchetypeEdge> edges; // Computed the first time an entity moves from this archetype to edge.target
+
+    // How the rows were sorted by the last iterator that sorted them, see mecsIteratorSortBy()
+    MecsComponentID sortComponent = MECS_INVALID;
+    PFNMecsCompareComponents sortCompare = nullptr;
+    void* sortUserData = nullptr;
+    // The rows [0, sortedRows) are in order apart from the ones in unsortedRows, the rows past them were added since
+    MecsSize sortedRows = 0;
+    BitSet unsortedRows;
+    // The keys of the sorted rows when the sort column was last handed out writable, see mecsArchetypeSnapshotSortKeys()
+    MecsVec<MecsU8> sortKeySnapshot;
 };
 
 enum MecsEntityFlags {
@@ -234,6 +379,17 @@ enum MecsEntityFlags {
     MecsEntityFlags_AliveOneFrame = 1 << 0,
 };
 
+// The links of an entity in the hierarchy, see mecsWorldSetParent()
+struct HierarchyNode {
+    MecsEntityID parent = MECS_INVALID;
+    MecsEntityID firstChild = MECS_INVALID;
+    MecsEntityID previousSibling = MECS_INVALID;
+    MecsEntityID nextSibling = MECS_INVALID;
+    // The number of ancestors, 0 for the roots
+    MecsU32 depth = 0;
+    MecsU32 numChildren = 0;
+};
+
 struct MecsEntity {
     const char* name = nullptr;
     ArchetypeID archetype;
@@ -248,11 +404,23 @@ enum class WorldEventKind : MecsU8 {
     eDestroyEntity, // entityID
     eRecreateEntity, // entityID
     eNewComponent, // entityID componentID archetypeID
-    eUpdateComponent, // entityID componentID
+    eUpdateComponent, // entityID componentID, see mecsWorldEntityComponentChanged()
     eDestroyComponent, // entityID componentID
     eSystemAdded, // entityID -> systemID, componentID -> scheduleID, archetypeID
 };
 
+// The entities of a flush waiting to be handed to an observer, see mecsWorldDefineObserver()
+struct MecsObserver {
+    MecsComponentID component;
+    MecsObserverEvent event;
+    void* observerData;
+    PFNMecsObserve observe;
+    bool pending;
+    MecsVec<MecsEntityID> entities;
+    // Captured when the entities are queued for MecsObserverEvent_Removed, otherwise looked up before the call
+    MecsVec<void*> components;
+};
+
 struct WorldEvent {
     WorldEventKind kind;
     MecsU32 entityID;
@@ -261,23 +429,77 @@ struct WorldEvent {
     MecsU32 newArchetypeID;
 };
 
+// Sort key used by the batched flush to group the pending events by archetype transition
+struct WorldEventBatchKey {
+    MecsU32 phase;
+    MecsU32 first;
+    MecsU32 second;
+    MecsU32 eventIndex;
+};
+
+struct MappedSnapshot {
+    void* address;
+    MecsSize size;
+};
+
 struct MecsWorld_t {
     MecsRegistry* registry;
 
-    MecsAllocator memAllocator;
+    MecsAllocator allocators[MecsAllocationTag_Count]; // Indexed by MecsAllocationTag
+    int worldFlags;
     GenArena<MecsEntity> entities;
     MecsVec<Archetype> archetypes;
+    // Indexed by component ID, only the components with MecsComponentStorage_Sparse have a storage
+    MecsVec<ComponentStorage> sparseComponents;
+    // Indexed by entity index, the entities past the end have neither a parent nor children
+    MecsVec<HierarchyNode> hierarchy;
+    // Indexed by component ID, null for the components the world has no resource of
+    MecsVec<void*> resources;
+    // Indexed by component ID like resources, see mecsWorldGetResourceVersion()
+    MecsVec<MecsU64> resourceVersions;
+    MecsU64 resourceTick;
     MecsVec<MecsSchedule> schedules;
     MecsVec<WorldEvent> newEvents;
     MecsVec<MecsWorldIterator_t*> reusableIterators;
     MecsVec<MecsWorldIterator_t*> acquiredIterators;
 
+    // Scratch storage reused by each batched flush
+    MecsVec<WorldEventBatchKey> batchKeys;
+    MecsVec<WorldEventBatchKey> batchRemovalKeys;
+    MecsVec<MecsSystemRef> batchAddedSystems;
+    MecsVec<MecsSystemRef> batchRemovedSystems;
+
+    // One batch for each system with batched callbacks, delivered at the end of each flush
+    MecsVec<SystemNotificationBatch> notificationBatches;
+    MecsVec<MecsSize> pendingNotificationBatches;
+
+    MecsVec<MecsObserver> observers;
+    // Indexed by component ID, bit (1 << MecsObserverEvent) is set when some observer is interested in the event
+    MecsVec<MecsU8> observedEvents;
+    MecsVec<MecsObserverID> pendingObservers;
+
+    MecsTraceHooks traceHooks;
+
+    // The files mapped by mecsWorldDeserializeMappedFile(), some archetype columns might still point into them
+    MecsVec<MappedSnapshot> mappedSnapshots;
+
     MecsU64 timestamp;
 };
 
 struct MecsSchedule {
     const char* scheduleName;
     MecsVec<MecsSystem> systems;
+    double fixedTimestep;
+    MecsU32 maxCatchUpRuns;
+    double accumulatedTime; // Not yet consumed by a fixed timestep run
+    MecsU64 runCount;
+};
+
+// A component or resource a system reads or writes, see mecsWorldSystemsConflict()
+struct SystemAccess {
+    MecsComponentID component;
+    bool resource;
+    bool write;
 };
 
 struct MecsSystem {
@@ -286,14 +508,67 @@ struct MecsSystem {
     PFNMecsOnEntityAdded onEntityAdded;
     PFNMecsSystemRun systemRun;
     PFNMEcsOnEntityRemoved onEntityRemoved;
+    PFNMecsOnEntitiesAdded onEntitiesAdded;
+    PFNMecsOnEntitiesRemoved onEntitiesRemoved;
+    MecsSize notificationBatch; // MECS_INVALID if the system has no batched callbacks
+    const char* systemName;
     MecsIterator* systemIterator;
     ArchetypeID systemArchetype;
     MecsU64 timestamp;
+    MecsVec<SystemAccess> access;
+    MecsU32 runInterval;
+    int runConditions;
+    PFNMecsSystemRunCondition runCondition;
+    MecsU64 lastRunTick; // The resource tick at the end of the previous run, see MecsSystemRunConditions_ResourcesChanged
 };
 
+// Replaces the allocators of the categories set in pTaggedAllocators (which can be null)
+void mecsApplyTaggedAllocators(MecsAllocator* allocators, const MecsAllocator* pTaggedAllocators);
+
 const char* mecsStrDup(const MecsAllocator& alloc, const char* str);
 bool mecsStrEqual(const char* strA, const char* strB);
 MecsSize mecsStrLen(const char* str);
 void mecsMemCpy(const char* source, MecsSize sourceSize, char* dest, MecsSize destSize);
 
+// Called when the world is freed, after its archetypes are destroyed
+void mecsUnmapSnapshots(MecsWorld* world);
+
+// Spawns an entity without components in the given slot of the entity arena, used to replicate the entities of another world
+MecsEntityID mecsWorldSpawnEntityAt(MecsWorld* world, MecsU32 index, MecsU32 generation, MecsPrefabID prefabID, MecsU8 entityFlags);
+
+// Like mecsWorldEntityGetComponent(), for the components that are only read: a column shared by a copy-on-write clone is
+// not copied
+const void* mecsWorldEntityReadComponent(MecsWorld* world, MecsEntityID entity, MecsComponentID component);
+
+// Pushes an eSystemAdded event for each system of the world, so that at the next flush the systems are handed the
+// entities that were placed in the world without events
+void mecsPushSystemAddedEvents(MecsWorld* world);
+
+ArchetypeID findArchetype(MecsWorld* world, const BitSet& archetypeBitset);
 ArchetypeID findNewArchetype(MecsWorld* world, ArchetypeID source, MecsComponentID component, bool include);
+
+// The returned reference is valid until a new archetype or system is added to the world
+const ArchetypeEdge& findArchetypeEdge(MecsWorld* world, ArchetypeID source, ArchetypeID target);
+
+// Whether the component was registered with MecsComponentStorage_Sparse
+bool mecsIsSparseComponent(const MecsRegistry* registry, MecsComponentID component);
+// The storage of a sparse component, the returned reference is valid until another sparse component is first added
+ComponentStorage& mecsWorldSparseStorage(MecsWorld* world, MecsComponentID component);
+
+// Adds a new archetype to the archetypes of the iterator, at the end of its group when the iterator is grouped
+void mecsIteratorAddArchetype(MecsIterator* iterator, ArchetypeID archetypeID);
+// Marks the row as out of order for the next sort of the archetype, see mecsIteratorSortBy()
+void mecsArchetypeRowChanged(MecsWorld* world, Archetype& archetype, MecsSize row);
+// Copies the keys of the sorted rows before the whole sort column is handed out writable: the next sort only sorts
+// again the rows whose key bytes differ from the copy
+void mecsArchetypeSnapshotSortKeys(MecsWorld* world, Archetype& archetype);
+// Sorts the rows of the archetype, only sorting again the rows that changed when it was already sorted the same way.
+// When component is MECS_INVALID compare gets the MecsEntityID of the rows instead
+void mecsArchetypeSortRows(MecsWorld* world, Archetype& archetype, MecsComponentID component, PFNMecsCompareComponents compare, void* userData);
+
+// Unlinks the entity from its parent and its children before its slot is reused
+void mecsWorldUnlinkHierarchy(MecsWorld* world, MecsEntityID entityID);
+// The depth of the entity in the hierarchy, 0 for the entities without a parent
+MecsU32 mecsWorldEntityDepth(const MecsWorld* world, MecsEntityID entityID);
+// Orders the rows by depth and then by parent, used to sort the archetypes visited in hierarchy order
+int mecsCompareHierarchyRows(const void* lhs, const void* rhs, void* world);
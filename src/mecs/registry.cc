@@ -2,20 +2,28 @@
 #include "mecs/base.h"
 
 #include "private.h"
+#include <cstddef>
 #include <cstring>
 
 MecsRegistry* mecsRegistryCreate(const MecsRegistryCreateInfo* createInfo)
 {
 
-    MecsAllocator allocator;
-    if (createInfo != nullptr && createInfo->memAllocator.memAlloc != nullptr) {
-        allocator = createInfo->memAllocator;
-    } else {
-        allocator = kDefaultAllocator;
+    MecsAllocator allocators[MecsAllocationTag_Count];
+    for (MecsSize tag = 0; tag < MecsAllocationTag_Count; tag++) {
+        if (createInfo != nullptr && createInfo->memAllocator.memAlloc != nullptr) {
+            allocators[tag] = createInfo->memAllocator;
+        } else {
+            allocators[tag] = kDefaultAllocator;
+        }
+    }
+    if (createInfo != nullptr) {
+        mecsApplyTaggedAllocators(allocators, createInfo->pTaggedAllocators);
     }
 
-    MecsRegistry* reg = mecsAlloc<MecsRegistry>(allocator, allocator);
-    reg->memAllocator = allocator;
+    MecsRegistry* reg = mecsAlloc<MecsRegistry>(allocators[MecsAllocationTag_Registry]);
+    for (MecsSize tag = 0; tag < MecsAllocationTag_Count; tag++) {
+        reg->allocators[tag] = allocators[tag];
+    }
 
     return reg;
 }
@@ -32,7 +40,8 @@ mecsRegistryAddRegistration(MecsRegistry* reg,
     const ComponentInfo* vtable)
 {
     MECS_ASSERT(reg != nullptr && vtable != nullptr);
-    MECS_ASSERT(vtable->size > 0 && vtable->align > 0 && vtable->name != nullptr);
+    MECS_ASSERT(vtable->align > 0 && vtable->name != nullptr);
+    MECS_ASSERT((vtable->size > 0 || vtable->align <= alignof(std::max_align_t)) && "A tag cannot be over-aligned");
 
     MecsSize elementCount = reg->components.count();
     for (MecsSize i = 0; i < elementCount; i++) {
@@ -40,6 +49,7 @@ mecsRegistryAddRegistration(MecsRegistry* reg,
 
         if (info.typeID == vtable->typeID) {
             MECS_ASSERT(mecsStrEqual(info.name, vtable->name) && "A component was registered with an already existing typeID, but with a different name: two components sharing the same typeID must have the same name");
+            MECS_ASSERT(info.storage == vtable->storage && "The storage of a component cannot change once it's registered");
 
             updateComponentInfo(info, *vtable);
             return static_cast<MecsComponentID>(i);
@@ -47,12 +57,12 @@ mecsRegistryAddRegistration(MecsRegistry* reg,
     }
 
     MecsComponentInfoInternal info = *vtable;
-    info.name = mecsStrDup(reg->memAllocator, vtable->name);
+    info.name = mecsStrDup(reg->allocators[MecsAllocationTag_Strings], vtable->name);
 
     MECS_ASSERT(info.name != vtable->name);
 
     MecsSize size = reg->components.count();
-    reg->components.push(reg->memAllocator, info);
+    reg->components.push(reg->allocators[MecsAllocationTag_Registry], info);
     return size;
 }
 
@@ -68,25 +78,25 @@ void mecsRegistryFree(MecsRegistry* registry)
         prefab.components.forEach([&](MecsPrefabComponent& component) {
             component.blob.destroy(registry);
         });
-        prefab.components.destroy(registry->memAllocator);
-        prefab.archetypeBitset.destroy(registry->memAllocator);
+        prefab.components.destroy(registry->allocators[MecsAllocationTag_Prefabs]);
+        prefab.archetypeBitset.destroy(registry->allocators[MecsAllocationTag_Prefabs]);
     });
-    registry->prefabs.destroy(registry->memAllocator);
+    registry->prefabs.destroy(registry->allocators[MecsAllocationTag_Prefabs]);
 
     const MecsSize numComponents = registry->components.count();
     for (MecsSize i = 0; i < numComponents; i++) {
         ComponentInfo& info = registry->components[i];
-        mecsFree(registry->memAllocator, info.name);
+        mecsFree(registry->allocators[MecsAllocationTag_Strings], info.name);
     }
-    registry->components.destroy(registry->memAllocator);
+    registry->components.destroy(registry->allocators[MecsAllocationTag_Registry]);
 
-    mecsFree(registry->memAllocator, registry);
+    mecsFree(registry->allocators[MecsAllocationTag_Registry], registry);
 }
 
 MecsPrefabID mecsRegistryCreatePrefab(MecsRegistry* reg)
 {
     MECS_ASSERT(reg != nullptr);
-    return reg->prefabs.push(reg->memAllocator, {});
+    return reg->prefabs.push(reg->allocators[MecsAllocationTag_Prefabs], {});
 }
 
 MecsSize mecsRegistryGetNumPrefabs(MecsRegistry* reg)
@@ -133,7 +143,7 @@ void mecsRegistryPrefabAddComponentWithDefaults(MecsRegistry* reg, MecsPrefabID
     if (blobPtr == nullptr) {
         ComponentBlob blob(reg, componentID);
         blobPtr = blob.get();
-        prefab.components.push(reg->memAllocator, { .component = componentID, .blob = std::move(blob) });
+        prefab.components.push(reg->allocators[MecsAllocationTag_Prefabs], { .component = componentID, .blob = std::move(blob) });
     }
     MECS_ASSERT(blobPtr != nullptr);
     if (defaultValue != nullptr) {
@@ -149,7 +159,10 @@ void mecsRegistryPrefabAddComponentWithDefaults(MecsRegistry* reg, MecsPrefabID
             memset(blobPtr, 0, info.size);
         }
     }
-    prefab.archetypeBitset.set(reg->memAllocator, componentID, true);
+    // The sparse components are not part of the archetype the entities are spawned in
+    if (info.storage != MecsComponentStorage_Sparse) {
+        prefab.archetypeBitset.set(reg->allocators[MecsAllocationTag_Prefabs], componentID, true);
+    }
 }
 void* mecsRegistryPrefabGetComponent(MecsRegistry* reg, MecsPrefabID prefabID, MecsComponentID componentID)
 {
@@ -176,11 +189,11 @@ void mecsRegistryPrefabRemoveComponent(MecsRegistry* reg, MecsPrefabID prefabID,
     MecsPrefab* pPrefab = reg->prefabs.at(prefabID);
     MECS_ASSERT(pPrefab != nullptr);
     MecsPrefab& prefab = *pPrefab;
-    MECS_ASSERT(prefab.archetypeBitset.test(componentID) && "Component not found");
+    MECS_ASSERT(mecsRegistryPrefabHasComponent(reg, prefabID, componentID) && "Component not found");
 
     MecsSize componentCount = prefab.components.count();
     const MecsComponentInfoInternal& info = reg->components[componentID];
-    prefab.archetypeBitset.set(reg->memAllocator, componentID, false);
+    prefab.archetypeBitset.set(reg->allocators[MecsAllocationTag_Prefabs], componentID, false);
     for (MecsSize i = 0; i < componentCount; i++) {
         MecsPrefabComponent& component = prefab.components[i];
         if (component.component == componentID) {
@@ -200,10 +213,10 @@ void mecsRegistryDestroyPrefab(MecsRegistry* reg, MecsPrefabID prefabID)
     prefab.components.forEach([&](MecsPrefabComponent& component) {
         component.blob.destroy(reg);
     });
-    prefab.components.destroy(reg->memAllocator);
-    prefab.archetypeBitset.destroy(reg->memAllocator);
+    prefab.components.destroy(reg->allocators[MecsAllocationTag_Prefabs]);
+    prefab.archetypeBitset.destroy(reg->allocators[MecsAllocationTag_Prefabs]);
 
-    reg->prefabs.remove(reg->memAllocator, prefabID);
+    reg->prefabs.remove(reg->allocators[MecsAllocationTag_Prefabs], prefabID);
 }
 
 MecsSize mecsRegistryGetNumComponents(MecsRegistry* reg)
@@ -0,0 +1,501 @@
+#include "mecs/serialize.h"
+#include "collections.h"
+#include "mecs/base.h"
+#include "private.h"
+#include "stream.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+Snapshot layout, all the values are in the byte order of the machine that wrote the snapshot:
+    header:      magic[8], u32 version, u32 byte order mark, u32 page size (0 if the columns are not page aligned)
+    components:  u32 count, then for each one: u64 typeID, u64 size, u64 align, string name
+    entities:    u32 count, then for each arena entry: u32 generation << 1 | taken,
+                 and for the taken ones: u32 prefabID, u8 entityFlags, string name
+    free list:   u32 count, u32 entry index for each free entry
+    archetypes:  u32 count, then for each non-empty archetype:
+                 u32 component count, u32 index in the components table for each component,
+                 u64 rows, the row to entity column (u32 for each row, aligned to 4 bytes),
+                 then one column for each component: u8 raw followed either by the column bytes (raw)
+                 or by the output of the component serialize callback
+A raw column is aligned to the component alignment, or to the page size if it's at least as large as a page,
+so that the large columns of a mapped snapshot start on their own page
+A string is an u32 length (MECS_INVALID for a null string) followed by the characters, without terminator
+*/
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = { 'M', 'E', 'C', 'S', 'S', 'N', 'A', 'P' };
+constexpr MecsU32 kSnapshotVersion = 2;
+
+// Used for the snapshots written to files, it does not need to match the page size of the machine mapping a snapshot
+constexpr MecsU32 kSnapshotPageSize = 4096;
+
+MecsSize mecsSnapshotColumnAlign(const ComponentInfo& info, MecsSize rows, MecsU32 pageSize)
+{
+    if (pageSize != 0 && rows * info.size >= pageSize) {
+        return std::max<MecsSize>(info.align, pageSize);
+    }
+    return info.align;
+}
+
+MecsU32 mecsPackEntryGeneration(MecsU32 generation, bool taken)
+{
+    return (generation << 1) | (taken ? 1 : 0);
+}
+
+bool mecsSerializeArchetype(const MecsWorld* world, const Archetype& archetype, MecsU32 pageSize, SnapshotWriter& out)
+{
+    const MecsRegistry* registry = world->registry;
+    const RowStorage& storage = archetype.storage;
+    const MecsSize rows = storage.rows();
+
+    out.writeValue(static_cast<MecsU32>(archetype.componentIDs.count()));
+    archetype.componentIDs.forEach([&](MecsComponentID component) {
+        out.writeValue(static_cast<MecsU32>(component));
+    });
+    out.writeValue(static_cast<MecsU64>(rows));
+    out.pad(alignof(MecsEntityID));
+    out.write(&archetype.rowToEntity[0], rows * sizeof(MecsEntityID));
+
+    archetype.componentIDs.forEach([&](MecsComponentID component) {
+        const ComponentInfo& info = registry->components[component];
+        const bool raw = info.serialize == nullptr;
+        out.writeValue(static_cast<MecsU8>(raw));
+        if (raw) {
+            out.pad(mecsSnapshotColumnAlign(info, rows, pageSize));
+            out.write(storage.getRowComponent(component, 0), rows * info.size);
+            return;
+        }
+        for (MecsSize row = 0; row < rows && !out.failed(); row++) {
+            if (!info.serialize(storage.getRowComponent(component, row), out.writer())) {
+                out.fail();
+            }
+        }
+    });
+    return !out.failed();
+}
+
+// Maps the components of the snapshot to the components of the world's registry, by typeID
+bool mecsDeserializeComponentTable(const MecsWorld* world, SnapshotReader& in, MecsVec<MecsComponentID>& outComponents)
+{
+    const MecsRegistry* registry = world->registry;
+    const MecsAllocator& allocator = world->allocators[MecsAllocationTag_World];
+    MecsU32 numComponents = 0;
+    if (!in.readValue(numComponents)) { return false; }
+    for (MecsU32 i = 0; i < numComponents; i++) {
+        MecsU64 typeID = 0;
+        MecsU64 size = 0;
+        MecsU64 align = 0;
+        const char* name = nullptr;
+        if (!in.readValue(typeID) || !in.readValue(size) || !in.readValue(align) || !in.readString(allocator, name)) {
+            return false;
+        }
+        if (name != nullptr) { mecsFree(allocator, name); }
+
+        MecsComponentID component = MECS_INVALID;
+        for (MecsSize c = 0; c < registry->components.count(); c++) {
+            if (registry->components[c].typeID == typeID) {
+                component = static_cast<MecsComponentID>(c);
+                break;
+            }
+        }
+        if (component == MECS_INVALID) { return false; }
+        const ComponentInfo& info = registry->components[component];
+        if (info.size != size || info.align != align) { return false; }
+        outComponents.push(allocator, component);
+    }
+    return true;
+}
+
+bool mecsDeserializeEntities(MecsWorld* world, SnapshotReader& in)
+{
+    MecsU32 numEntries = 0;
+    if (!in.readValue(numEntries)) { return false; }
+    for (MecsU32 i = 0; i < numEntries; i++) {
+        MecsU32 packed = 0;
+        if (!in.readValue(packed)) { return false; }
+
+        using EntryGeneration = GenArena<MecsEntity>::EntryGeneration;
+        const EntryGeneration tagGeneration { .generation = packed >> 1, .taken = (packed & 1) != 0 };
+        MecsEntity entity {};
+        entity.archetype = MECS_INVALID;
+        entity.archetypeRow = MECS_INVALID;
+        entity.prefabID = MECS_INVALID;
+        entity.status = EntityStatus::eSpawned;
+        if (tagGeneration.taken) {
+            if (!in.readValue(entity.prefabID) || !in.readValue(entity.entityFlags)
+                || !in.readString(world->allocators[MecsAllocationTag_Strings], entity.name)) {
+                return false;
+            }
+        }
+        world->entities.restoreEntry(world->allocators[MecsAllocationTag_Entities], tagGeneration, entity);
+    }
+
+    MecsU32 numFree = 0;
+    if (!in.readValue(numFree)) { return false; }
+    for (MecsU32 i = 0; i < numFree; i++) {
+        MecsU32 index = 0;
+        if (!in.readValue(index)) { return false; }
+        if (index >= world->entities.numEntries() || world->entities.entryAt(index).tagGeneration.taken) { return false; }
+        world->entities.restoreFreeIndex(world->allocators[MecsAllocationTag_Entities], index);
+    }
+    return true;
+}
+
+// Mapped snapshots only: if all the columns of the archetype are raw, the storage borrows them from the mapping.
+// Returns false (without consuming the columns) if a column needs its deserialize callback
+bool mecsBorrowMappedColumns(MecsWorld* world, SnapshotReader& in, Archetype& archetype, const MecsVec<MecsComponentID>& archetypeComponents, MecsSize rows, MecsU32 pageSize)
+{
+    const MecsRegistry* registry = world->registry;
+    const MecsAllocator& allocator = world->allocators[MecsAllocationTag_World];
+    const MecsSize start = in.offset();
+    MecsVec<const MecsU8*> columns;
+    columns.ensureSize(allocator, registry->components.count());
+    bool raw = true;
+    for (MecsSize i = 0; i < archetypeComponents.count() && raw && !in.failed(); i++) {
+        const ComponentInfo& info = registry->components[archetypeComponents[i]];
+        MecsU8 rawFlag = 0;
+        raw = in.readValue(rawFlag) && rawFlag != 0 && in.skipPadding(mecsSnapshotColumnAlign(info, rows, pageSize));
+        columns[archetypeComponents[i]] = raw ? in.view(rows * info.size) : nullptr;
+        raw = raw && columns[archetypeComponents[i]] != nullptr;
+    }
+    if (raw) {
+        // The mapping is copy-on-write, so the columns can be written to like any other
+        archetype.storage.borrowRows(world->allocators[MecsAllocationTag_ArchetypeColumns], rows, [&](MecsComponentID component) {
+            return const_cast<char*>(reinterpret_cast<const char*>(columns[component]));
+        });
+        in.onArchetypeBorrowed();
+    } else if (!in.failed()) {
+        in.rewind(start);
+    }
+    columns.destroy(allocator);
+    return raw;
+}
+
+bool mecsDeserializeArchetype(MecsWorld* world, SnapshotReader& in, const MecsVec<MecsComponentID>& components, MecsU32 pageSize)
+{
+    const MecsRegistry* registry = world->registry;
+    const MecsAllocator& allocator = world->allocators[MecsAllocationTag_World];
+
+    MecsU32 numComponents = 0;
+    if (!in.readValue(numComponents)) { return false; }
+    MecsVec<MecsComponentID> archetypeComponents;
+    BitSet archetypeBitset;
+    bool valid = true;
+    for (MecsU32 i = 0; i < numComponents && valid; i++) {
+        MecsU32 fileComponent = 0;
+        valid = in.readValue(fileComponent) && fileComponent < components.count();
+        if (valid) {
+            archetypeComponents.push(allocator, components[fileComponent]);
+            archetypeBitset.set(allocator, components[fileComponent], true);
+        }
+    }
+    MecsU64 rows = 0;
+    valid = valid && in.readValue(rows) && rows > 0 && in.skipPadding(alignof(MecsEntityID));
+    if (!valid) {
+        archetypeComponents.destroy(allocator);
+        archetypeBitset.destroy(allocator);
+        return false;
+    }
+
+    const ArchetypeID archetypeID = findArchetype(world, archetypeBitset);
+    archetypeBitset.destroy(allocator);
+    Archetype& archetype = world->archetypes[archetypeID];
+    const MecsAllocator& columnsAllocator = world->allocators[MecsAllocationTag_ArchetypeColumns];
+    const MecsSize firstRow = archetype.storage.rows();
+    archetype.rowToEntity.ensureSize(columnsAllocator, firstRow + rows);
+    valid = in.read(&archetype.rowToEntity[firstRow], rows * sizeof(MecsEntityID));
+
+    for (MecsSize row = firstRow; row < firstRow + rows && valid; row++) {
+        const MecsEntityID entityID = archetype.rowToEntity[row];
+        const MecsU32 index = getIndexFromGenArenaIndex(entityID);
+        valid = index < world->entities.numEntries() && world->entities.entryAt(index).tagGeneration.taken;
+        MecsEntity* entity = valid ? world->entities.at(entityID) : nullptr;
+        valid = entity != nullptr && entity->archetype == MECS_INVALID;
+        if (valid) {
+            entity->archetype = archetypeID;
+            entity->archetypeRow = row;
+        }
+    }
+
+    if (valid && in.isMapped() && firstRow == 0 && mecsBorrowMappedColumns(world, in, archetype, archetypeComponents, rows, pageSize)) {
+        archetypeComponents.destroy(allocator);
+        return true;
+    }
+    valid = valid && !in.failed();
+    if (valid) {
+        archetype.storage.allocateRows(columnsAllocator, rows);
+    }
+
+    for (MecsSize i = 0; i < archetypeComponents.count() && valid; i++) {
+        const MecsComponentID component = archetypeComponents[i];
+        const ComponentInfo& info = registry->components[component];
+        MecsU8 raw = 0;
+        valid = in.readValue(raw);
+        if (!valid) { continue; }
+        if (raw != 0) {
+            valid = in.skipPadding(mecsSnapshotColumnAlign(info, rows, pageSize))
+                && in.read(archetype.storage.getRowComponent(component, firstRow), rows * info.size);
+            continue;
+        }
+        valid = info.deserialize != nullptr;
+        for (MecsSize row = firstRow; row < firstRow + rows && valid; row++) {
+            valid = info.deserialize(archetype.storage.getRowComponent(component, row), in.reader()) && !in.failed();
+        }
+    }
+    archetypeComponents.destroy(allocator);
+    return valid;
+}
+
+// Frees the rows and the entities restored by a failed mecsWorldDeserialize()
+void mecsDiscardRestoredEntities(MecsWorld* world)
+{
+    const MecsAllocator& columnsAllocator = world->allocators[MecsAllocationTag_ArchetypeColumns];
+    // The world had no entities before the restore, so every archetype goes back to being empty
+    world->archetypes.forEach([&](Archetype& archetype) {
+        while (archetype.storage.rows() > 0) {
+            archetype.storage.freeRow(columnsAllocator, archetype.storage.rows() - 1);
+        }
+        archetype.rowToEntity.clear();
+        archetype.sortedRows = 0;
+        archetype.unsortedRows.clear();
+        archetype.sortKeySnapshot.clear();
+    });
+    for (MecsSize i = 0; i < world->entities.numEntries(); i++) {
+        const auto& entry = world->entities.entryAt(i);
+        if (entry.tagGeneration.taken && entry.value.name != nullptr) {
+            mecsFree(world->allocators[MecsAllocationTag_Strings], entry.value.name);
+        }
+    }
+    world->entities.destroy(world->allocators[MecsAllocationTag_Entities]);
+    world->entities = GenArena<MecsEntity> {};
+}
+
+MecsSize mecsFileWrite(void* userData, const void* data, MecsSize size)
+{
+    return fwrite(data, 1, size, static_cast<FILE*>(userData));
+}
+
+MecsSize mecsFileRead(void* userData, void* data, MecsSize size)
+{
+    return fread(data, 1, size, static_cast<FILE*>(userData));
+}
+
+bool mecsSerializeSnapshot(MecsWorld* world, const MecsWriter* writer, MecsU32 pageSize)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(writer != nullptr && writer->write != nullptr && "Cannot pass a null writer");
+    MECS_ASSERT(world->newEvents.empty() && "The events must be flushed before serializing a world");
+
+    SnapshotWriter out(*writer, world->allocators[MecsAllocationTag_World]);
+    out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+    out.writeValue(kSnapshotVersion);
+    out.writeValue(kByteOrderMark);
+    out.writeValue(pageSize);
+
+    const MecsRegistry* registry = world->registry;
+    out.writeValue(static_cast<MecsU32>(registry->components.count()));
+    registry->components.forEach([&](const MecsComponentInfoInternal& info) {
+        out.writeValue(static_cast<MecsU64>(info.typeID));
+        out.writeValue(static_cast<MecsU64>(info.size));
+        out.writeValue(static_cast<MecsU64>(info.align));
+        out.writeString(info.name);
+    });
+
+    const GenArena<MecsEntity>& entities = world->entities;
+    out.writeValue(static_cast<MecsU32>(entities.numEntries()));
+    for (MecsSize i = 0; i < entities.numEntries() && !out.failed(); i++) {
+        const auto& entry = entities.entryAt(i);
+        out.writeValue(mecsPackEntryGeneration(entry.tagGeneration.generation, entry.tagGeneration.taken));
+        if (entry.tagGeneration.taken) {
+            out.writeValue(entry.value.prefabID);
+            out.writeValue(entry.value.entityFlags);
+            out.writeString(entry.value.name);
+        }
+    }
+    out.writeValue(static_cast<MecsU32>(entities.freeIndices().count()));
+    entities.freeIndices().forEach([&](MecsSize index) {
+        out.writeValue(static_cast<MecsU32>(index));
+    });
+
+    MecsU32 numArchetypes = 0;
+    world->archetypes.forEach([&](const Archetype& archetype) {
+        numArchetypes += archetype.storage.rows() > 0 ? 1 : 0;
+    });
+    out.writeValue(numArchetypes);
+    world->archetypes.forEach([&](const Archetype& archetype) {
+        if (archetype.storage.rows() == 0 || out.failed()) { return; }
+        mecsSerializeArchetype(world, archetype, pageSize, out);
+    });
+
+    return out.flush();
+}
+
+void mecsPrepareDeserialize(MecsWorld* world)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(world->entities.count() == 0 && "Snapshots can only be restored into a world without entities");
+    MECS_ASSERT(world->newEvents.empty() && "The events must be flushed before deserializing a world");
+
+    // The arena might still hold the entries of destroyed entities, which would shift the restored IDs
+    world->entities.destroy(world->allocators[MecsAllocationTag_Entities]);
+    world->entities = GenArena<MecsEntity> {};
+}
+
+bool mecsDeserializeSnapshot(MecsWorld* world, SnapshotReader& in)
+{
+    char magic[sizeof(kSnapshotMagic)] = {};
+    MecsU32 version = 0;
+    MecsU32 byteOrderMark = 0;
+    MecsU32 pageSize = 0;
+    bool valid = in.read(magic, sizeof(magic)) && in.readValue(version) && in.readValue(byteOrderMark) && in.readValue(pageSize)
+        && memcmp(magic, kSnapshotMagic, sizeof(magic)) == 0 && version == kSnapshotVersion && byteOrderMark == kByteOrderMark;
+
+    MecsVec<MecsComponentID> components;
+    valid = valid && mecsDeserializeComponentTable(world, in, components);
+    valid = valid && mecsDeserializeEntities(world, in);
+
+    MecsU32 numArchetypes = 0;
+    valid = valid && in.readValue(numArchetypes);
+    for (MecsU32 i = 0; i < numArchetypes && valid; i++) {
+        valid = mecsDeserializeArchetype(world, in, components, pageSize);
+    }
+    components.destroy(world->allocators[MecsAllocationTag_World]);
+
+    // Every live entity must have been placed in an archetype
+    for (MecsSize i = 0; i < world->entities.numEntries() && valid; i++) {
+        const auto& entry = world->entities.entryAt(i);
+        valid = !entry.tagGeneration.taken || entry.value.archetype != MECS_INVALID;
+    }
+    if (!valid) {
+        mecsDiscardRestoredEntities(world);
+        return false;
+    }
+
+    // The systems already know about the (empty) world, so they're handed the restored entities as if they were just added
+    mecsPushSystemAddedEvents(world);
+    return true;
+}
+
+// Maps the whole file copy-on-write: the pages are shared with the page cache (and other processes mapping the
+// same file) until they're written to
+bool mecsMapFile(const char* path, MappedSnapshot& outMapping)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+    LARGE_INTEGER size {};
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    }
+    void* address = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+    if (mapping != nullptr) { CloseHandle(mapping); }
+    CloseHandle(file);
+    if (address == nullptr) { return false; }
+    outMapping = MappedSnapshot { .address = address, .size = static_cast<MecsSize>(size.QuadPart) };
+    return true;
+#else
+    const int file = open(path, O_RDONLY);
+    if (file < 0) { return false; }
+    struct stat fileStat {};
+    void* address = MAP_FAILED;
+    if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0) {
+        address = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (address == MAP_FAILED) { return false; }
+    outMapping = MappedSnapshot { .address = address, .size = static_cast<MecsSize>(fileStat.st_size) };
+    return true;
+#endif
+}
+
+void mecsUnmapFile(const MappedSnapshot& mapping)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(mapping.address);
+#else
+    munmap(mapping.address, mapping.size);
+#endif
+}
+
+}
+
+void mecsUnmapSnapshots(MecsWorld* world)
+{
+    world->mappedSnapshots.forEach([](const MappedSnapshot& mapping) {
+        mecsUnmapFile(mapping);
+    });
+    world->mappedSnapshots.destroy(world->allocators[MecsAllocationTag_World]);
+}
+
+bool mecsWorldSerialize(MecsWorld* world, const MecsWriter* writer)
+{
+    return mecsSerializeSnapshot(world, writer, 0);
+}
+
+bool mecsWorldDeserialize(MecsWorld* world, const MecsReader* reader)
+{
+    MECS_ASSERT(reader != nullptr && reader->read != nullptr && "Cannot pass a null reader");
+    mecsPrepareDeserialize(world);
+    SnapshotReader in(*reader, world->allocators[MecsAllocationTag_World]);
+    return mecsDeserializeSnapshot(world, in);
+}
+
+bool mecsWorldSerializeToFile(MecsWorld* world, const char* path)
+{
+    MECS_ASSERT(path != nullptr && "Cannot pass a null path");
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    // Page aligned, so that the file can also be loaded with mecsWorldDeserializeMappedFile()
+    const MecsWriter writer { .write = mecsFileWrite, .userData = file };
+    const bool written = mecsSerializeSnapshot(world, &writer, kSnapshotPageSize);
+    return fclose(file) == 0 && written;
+}
+
+bool mecsWorldDeserializeFromFile(MecsWorld* world, const char* path)
+{
+    MECS_ASSERT(path != nullptr && "Cannot pass a null path");
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    const MecsReader reader { .read = mecsFileRead, .userData = file };
+    const bool read = mecsWorldDeserialize(world, &reader);
+    fclose(file);
+    return read;
+}
+
+bool mecsWorldDeserializeMappedFile(MecsWorld* world, const char* path)
+{
+    MECS_ASSERT(path != nullptr && "Cannot pass a null path");
+    mecsPrepareDeserialize(world);
+    MappedSnapshot mapping {};
+    if (!mecsMapFile(path, mapping)) {
+        return false;
+    }
+
+    SnapshotReader in(static_cast<const MecsU8*>(mapping.address), mapping.size);
+    const bool read = mecsDeserializeSnapshot(world, in);
+    // A failed read frees its rows, but the columns might still point into the mapping
+    if (in.numBorrowedArchetypes() > 0) {
+        world->mappedSnapshots.push(world->allocators[MecsAllocationTag_World], mapping);
+    } else {
+        mecsUnmapFile(mapping);
+    }
+    return read;
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "collections.h"
+#include "mecs/base.h"
+#include "private.h"
+
+#include <cstring>
+
+// Buffered streams shared by the world snapshots and deltas
+
+// Written in the header of snapshots and deltas, to detect the ones written by a machine with a different byte order
+constexpr MecsU32 kByteOrderMark = 0x01020304;
+constexpr MecsSize kSnapshotBufferSize = 64 * 1024;
+
+// Buffers the small writes, while the large ones (e.g. the columns) go straight to the writer
+class SnapshotWriter {
+public:
+    SnapshotWriter(const MecsWriter& writer, const MecsAllocator& allocator)
+        : mWriter(writer)
+        , mAllocator(allocator)
+        , mBuffer(mecsCalloc<MecsU8>(allocator, kSnapshotBufferSize))
+    {
+        mForwarder.write = &SnapshotWriter::forward;
+        mForwarder.userData = this;
+    }
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    ~SnapshotWriter()
+    {
+        mAllocator.memFree(mAllocator.userData, mBuffer);
+    }
+
+    bool write(const void* data, MecsSize size)
+    {
+        if (mFailed) { return false; }
+        mOffset += size;
+        if (mUsed + size > kSnapshotBufferSize) {
+            flush();
+            if (size >= kSnapshotBufferSize) {
+                mFailed = mFailed || mWriter.write(mWriter.userData, data, size) != size;
+                return !mFailed;
+            }
+        }
+        memcpy(mBuffer + mUsed, data, size);
+        mUsed += size;
+        return !mFailed;
+    }
+
+    template <typename T>
+    bool writeValue(const T& value)
+    {
+        return write(&value, sizeof(T));
+    }
+
+    bool writeString(const char* str)
+    {
+        if (str == nullptr) {
+            return writeValue<MecsU32>(MECS_INVALID);
+        }
+        const MecsU32 length = static_cast<MecsU32>(mecsStrLen(str));
+        return writeValue(length) && write(str, length);
+    }
+
+    // Writes zeroes until the offset is a multiple of align
+    bool pad(MecsSize align)
+    {
+        constexpr MecsU8 kZeroes[64] = {};
+        while (mOffset % align != 0) {
+            const MecsSize padding = std::min(align - (mOffset % align), sizeof(kZeroes));
+            if (!write(kZeroes, padding)) { return false; }
+        }
+        return true;
+    }
+
+    bool flush()
+    {
+        if (mUsed > 0 && !mFailed) {
+            mFailed = mWriter.write(mWriter.userData, mBuffer, mUsed) != mUsed;
+        }
+        mUsed = 0;
+        return !mFailed;
+    }
+
+    // Handed to the component serialize callbacks
+    [[nodiscard]]
+    const MecsWriter* writer() const
+    {
+        return &mForwarder;
+    }
+
+    [[nodiscard]]
+    bool failed() const
+    {
+        return mFailed;
+    }
+
+    void fail()
+    {
+        mFailed = true;
+    }
+
+private:
+    static MecsSize forward(void* userData, const void* data, MecsSize size)
+    {
+        return static_cast<SnapshotWriter*>(userData)->write(data, size) ? size : 0;
+    }
+
+    MecsWriter mWriter;
+    MecsWriter mForwarder;
+    MecsAllocator mAllocator;
+    MecsU8* mBuffer;
+    MecsSize mUsed { 0 };
+    MecsSize mOffset { 0 };
+    bool mFailed { false };
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const MecsReader& reader, const MecsAllocator& allocator)
+        : mReader(reader)
+        , mAllocator(allocator)
+        , mBuffer(mecsCalloc<MecsU8>(allocator, kSnapshotBufferSize))
+    {
+        mForwarder.read = &SnapshotReader::forward;
+        mForwarder.userData = this;
+    }
+
+    // Reads straight from a mapped snapshot, whose raw columns can then be borrowed with view()
+    SnapshotReader(const MecsU8* mapped, MecsSize size)
+        : mReader {}
+        , mAllocator(kNullAllocator)
+        , mBuffer(nullptr)
+        , mMapped(mapped)
+        , mMappedSize(size)
+    {
+        mForwarder.read = &SnapshotReader::forward;
+        mForwarder.userData = this;
+    }
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    ~SnapshotReader()
+    {
+        if (mBuffer != nullptr) {
+            mAllocator.memFree(mAllocator.userData, mBuffer);
+        }
+    }
+
+    bool read(void* data, MecsSize size)
+    {
+        if (mFailed) { return false; }
+        if (mMapped != nullptr) {
+            const MecsU8* source = view(size);
+            if (source != nullptr) { memcpy(data, source, size); }
+            return source != nullptr;
+        }
+        mOffset += size;
+        auto* dest = static_cast<MecsU8*>(data);
+        const MecsSize buffered = std::min(size, mAvailable - mConsumed);
+        memcpy(dest, mBuffer + mConsumed, buffered);
+        mConsumed += buffered;
+        dest += buffered;
+        size -= buffered;
+        if (size == 0) { return true; }
+
+        if (size >= kSnapshotBufferSize) {
+            mFailed = mReader.read(mReader.userData, dest, size) != size;
+            return !mFailed;
+        }
+        mAvailable = mReader.read(mReader.userData, mBuffer, kSnapshotBufferSize);
+        mConsumed = std::min(size, mAvailable);
+        memcpy(dest, mBuffer, mConsumed);
+        mFailed = mConsumed != size;
+        return !mFailed;
+    }
+
+    template <typename T>
+    bool readValue(T& value)
+    {
+        return read(&value, sizeof(T));
+    }
+
+    // Returns false on failure, outString is set to an allocated string or null
+    bool readString(const MecsAllocator& allocator, const char*& outString)
+    {
+        outString = nullptr;
+        MecsU32 length = 0;
+        if (!readValue(length)) { return false; }
+        if (length == MECS_INVALID) { return true; }
+
+        char* str = mecsCallocAligned<char>(allocator, length + 1, alignof(char));
+        str[length] = 0;
+        if (!read(str, length)) {
+            allocator.memFree(allocator.userData, str);
+            return false;
+        }
+        outString = str;
+        return true;
+    }
+
+    // Skips the padding written by SnapshotWriter::pad()
+    bool skipPadding(MecsSize align)
+    {
+        MecsU8 padding[64];
+        while (mOffset % align != 0) {
+            if (!read(padding, std::min(align - (mOffset % align), sizeof(padding)))) { return false; }
+        }
+        return true;
+    }
+
+    // Handed to the component deserialize callbacks
+    [[nodiscard]]
+    const MecsReader* reader() const
+    {
+        return &mForwarder;
+    }
+
+    [[nodiscard]]
+    bool isMapped() const
+    {
+        return mMapped != nullptr;
+    }
+
+    // Only for mapped snapshots: returns the next size bytes without copying them, or null past the end of the snapshot
+    const MecsU8* view(MecsSize size)
+    {
+        MECS_ASSERT(isMapped());
+        if (mFailed || size > mMappedSize - mOffset) {
+            mFailed = true;
+            return nullptr;
+        }
+        const MecsU8* data = mMapped + mOffset;
+        mOffset += size;
+        return data;
+    }
+
+    [[nodiscard]]
+    MecsSize offset() const
+    {
+        return mOffset;
+    }
+
+    void onArchetypeBorrowed()
+    {
+        mNumBorrowedArchetypes++;
+    }
+
+    // The archetypes whose columns point into the mapped snapshot
+    [[nodiscard]]
+    MecsSize numBorrowedArchetypes() const
+    {
+        return mNumBorrowedArchetypes;
+    }
+
+    // Only for mapped snapshots, goes back to an offset returned by offset()
+    void rewind(MecsSize offset)
+    {
+        MECS_ASSERT(isMapped() && offset <= mOffset);
+        mOffset = offset;
+    }
+
+    [[nodiscard]]
+    bool failed() const
+    {
+        return mFailed;
+    }
+
+    void fail()
+    {
+        mFailed = true;
+    }
+
+private:
+    static MecsSize forward(void* userData, void* data, MecsSize size)
+    {
+        return static_cast<SnapshotReader*>(userData)->read(data, size) ? size : 0;
+    }
+
+    MecsReader mReader;
+    MecsReader mForwarder;
+    MecsAllocator mAllocator;
+    MecsU8* mBuffer;
+    const MecsU8* mMapped { nullptr };
+    MecsSize mMappedSize { 0 };
+    MecsSize mNumBorrowedArchetypes { 0 };
+    MecsSize mAvailable { 0 };
+    MecsSize mConsumed { 0 };
+    MecsSize mOffset { 0 };
+    bool mFailed { false };
+};
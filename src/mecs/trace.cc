@@ -0,0 +1,207 @@
+#include "mecs/trace.h"
+#include "collections.h"
+#include "mecs/base.h"
+#include "private.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+struct TraceRecord {
+    MecsTraceScope scope;
+    MecsSize nameIndex; // MECS_INVALID for unnamed schedules and systems
+    MecsScheduleID schedule;
+    MecsSystemID system;
+    MecsSize numItems;
+    MecsU64 beginNs;
+    MecsU64 endNs;
+    bool ended;
+};
+
+}
+
+struct MecsTraceRecorder_t {
+    MecsAllocator memAllocator;
+    std::chrono::steady_clock::time_point origin;
+    MecsVec<TraceRecord> records;
+
+    // The records that began but did not end yet, innermost last
+    MecsVec<MecsSize> openRecords;
+
+    // The event names only live as long as the call, so each distinct name is copied once
+    MecsVec<const char*> names;
+    MecsSize numEnded;
+};
+
+namespace {
+
+MecsU64 mecsTraceNow(const MecsTraceRecorder* recorder)
+{
+    const auto elapsed = std::chrono::steady_clock::now() - recorder->origin;
+    return static_cast<MecsU64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+MecsSize mecsTraceInternName(MecsTraceRecorder* recorder, const char* name)
+{
+    if (name == nullptr) { return MECS_INVALID; }
+    for (MecsSize i = 0; i < recorder->names.count(); i++) {
+        if (mecsStrEqual(recorder->names[i], name)) { return i; }
+    }
+    return recorder->names.push(recorder->memAllocator, mecsStrDup(recorder->memAllocator, name));
+}
+
+void mecsTraceRecorderBegin(void* userData, const MecsTraceEvent* event)
+{
+    auto* recorder = static_cast<MecsTraceRecorder*>(userData);
+    const MecsSize recordIndex = recorder->records.push(recorder->memAllocator, TraceRecord {
+        .scope = event->scope,
+        .nameIndex = mecsTraceInternName(recorder, event->name),
+        .schedule = event->schedule,
+        .system = event->system,
+        .numItems = event->numItems,
+        .beginNs = 0,
+        .endNs = 0,
+        .ended = false,
+    });
+    recorder->openRecords.push(recorder->memAllocator, recordIndex);
+    // Sampled last, so that the bookkeeping above is not part of the scope
+    recorder->records[recordIndex].beginNs = mecsTraceNow(recorder);
+}
+
+void mecsTraceRecorderEnd(void* userData, const MecsTraceEvent* event)
+{
+    auto* recorder = static_cast<MecsTraceRecorder*>(userData);
+    const MecsU64 now = mecsTraceNow(recorder);
+    MECS_ASSERT(!recorder->openRecords.empty() && "A scope ended without beginning");
+    TraceRecord& record = recorder->records[recorder->openRecords.pop()];
+    MECS_ASSERT(record.scope == event->scope && "Trace scopes must nest");
+    record.endNs = now;
+    record.ended = true;
+    recorder->numEnded++;
+}
+
+const char* mecsTraceScopeName(MecsTraceScope scope)
+{
+    switch (scope) {
+    case MecsTraceScope_Schedule:
+        return "schedule";
+    case MecsTraceScope_System:
+        return "system";
+    case MecsTraceScope_Flush:
+        return "flush";
+    case MecsTraceScope_FlushPhase:
+        return "flush_phase";
+    }
+    return "unknown";
+}
+
+void mecsTraceWriteJsonString(FILE* file, const char* str)
+{
+    fputc('"', file);
+    for (const char* c = str; *c != 0; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+            fputc(*c, file);
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            fprintf(file, "\\u%04x", static_cast<unsigned>(*c));
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+void mecsTraceWriteRecordName(FILE* file, const MecsTraceRecorder* recorder, const TraceRecord& record)
+{
+    if (record.nameIndex != MECS_INVALID) {
+        mecsTraceWriteJsonString(file, recorder->names[record.nameIndex]);
+    } else if (record.scope == MecsTraceScope_System) {
+        fprintf(file, "\"system %u\"", record.system);
+    } else {
+        fprintf(file, "\"schedule %u\"", record.schedule);
+    }
+}
+
+}
+
+MecsTraceRecorder* mecsTraceRecorderCreate(const MecsAllocator* allocator)
+{
+    const MecsAllocator memAllocator = allocator != nullptr && allocator->memAlloc != nullptr ? *allocator : kDefaultAllocator;
+    auto* recorder = mecsAlloc<MecsTraceRecorder>(memAllocator);
+    recorder->memAllocator = memAllocator;
+    recorder->origin = std::chrono::steady_clock::now();
+    recorder->numEnded = 0;
+    return recorder;
+}
+
+void mecsTraceRecorderFree(MecsTraceRecorder* recorder)
+{
+    if (recorder == nullptr) {
+        return;
+    }
+    recorder->records.destroy(recorder->memAllocator);
+    recorder->openRecords.destroy(recorder->memAllocator);
+    recorder->names.forEach([recorder](const char* name) {
+        mecsFree(recorder->memAllocator, name);
+    });
+    recorder->names.destroy(recorder->memAllocator);
+    mecsFree(recorder->memAllocator, recorder);
+}
+
+MecsTraceHooks mecsTraceRecorderGetHooks(MecsTraceRecorder* recorder)
+{
+    MECS_ASSERT(recorder != nullptr && "Cannot pass a null recorder");
+    return MecsTraceHooks {
+        .begin = mecsTraceRecorderBegin,
+        .end = mecsTraceRecorderEnd,
+        .userData = recorder,
+    };
+}
+
+MecsSize mecsTraceRecorderGetNumEvents(MecsTraceRecorder* recorder)
+{
+    MECS_ASSERT(recorder != nullptr && "Cannot pass a null recorder");
+    return recorder->numEnded;
+}
+
+void mecsTraceRecorderClear(MecsTraceRecorder* recorder)
+{
+    MECS_ASSERT(recorder != nullptr && "Cannot pass a null recorder");
+    MECS_ASSERT(recorder->openRecords.empty() && "Cannot clear a recorder while a scope is running");
+    recorder->records.clear();
+    recorder->numEnded = 0;
+}
+
+bool mecsTraceRecorderWriteChromeTrace(MecsTraceRecorder* recorder, const char* path)
+{
+    MECS_ASSERT(recorder != nullptr && "Cannot pass a null recorder");
+    MECS_ASSERT(path != nullptr && "Cannot pass a null path");
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    // Each scope becomes a complete ("X") event, timestamps and durations are in microseconds
+    fputs("{\"traceEvents\":[", file);
+    bool first = true;
+    recorder->records.forEach([&](const TraceRecord& record) {
+        if (!record.ended) { return; }
+        fputs(first ? "\n" : ",\n", file);
+        first = false;
+        fputs("{\"name\":", file);
+        mecsTraceWriteRecordName(file, recorder, record);
+        fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"items\":%zu",
+            mecsTraceScopeName(record.scope),
+            static_cast<double>(record.beginNs) / 1000.0,
+            static_cast<double>(record.endNs - record.beginNs) / 1000.0,
+            static_cast<size_t>(record.numItems));
+        if (record.schedule != MECS_INVALID) { fprintf(file, ",\"schedule\":%u", record.schedule); }
+        if (record.system != MECS_INVALID) { fprintf(file, ",\"system\":%u", record.system); }
+        fputs("}}", file);
+    });
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+
+    const bool written = ferror(file) == 0;
+    return fclose(file) == 0 && written;
+}
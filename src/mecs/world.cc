@@ -7,6 +7,7 @@
 #include "private.h"
 
 #include <cassert>
+#include <cmath>
 
 constexpr MecsSize kComponentInstanceIDNumBits = 24;
 constexpr MecsSize kComponentInstanceMask = ((1 << kComponentInstanceIDNumBits) - 1);
@@ -16,7 +17,7 @@ void moveEntityToNewArchetype(MecsWorld* world, MecsEntityID entity, ArchetypeID
 void freeEntityRow(MecsWorld* const world, const MecsEntity& ent)
 {
     Archetype& oldArchetype = world->archetypes[ent.archetype];
-    MecsSize replacementRow = oldArchetype.storage.freeRow(world->memAllocator, ent.archetypeRow);
+    MecsSize replacementRow = oldArchetype.storage.freeRow(world->allocators[MecsAllocationTag_ArchetypeColumns], ent.archetypeRow);
     MecsEntityID entityRowReplaced = oldArchetype.rowToEntity[replacementRow];
     {
         MecsEntity* rowReplacementEntity = world->entities.at(entityRowReplaced);
@@ -24,6 +25,170 @@ void freeEntityRow(MecsWorld* const world, const MecsEntity& ent)
         oldArchetype.rowToEntity[ent.archetypeRow] = entityRowReplaced;
         oldArchetype.rowToEntity.pop();
     }
+
+    // The last row took the place of the freed one
+    if (oldArchetype.sortCompare != nullptr) {
+        const MecsSize rows = oldArchetype.storage.rows();
+        oldArchetype.sortedRows = std::min(oldArchetype.sortedRows, rows);
+        if (oldArchetype.unsortedRows.test(rows)) {
+            oldArchetype.unsortedRows.set(world->allocators[MecsAllocationTag_World], rows, false);
+        }
+        if (ent.archetypeRow < rows) {
+            mecsArchetypeRowChanged(world, oldArchetype, ent.archetypeRow);
+        }
+    }
+}
+
+void mecsArchetypeRowChanged(MecsWorld* world, Archetype& archetype, MecsSize row)
+{
+    // The rows past sortedRows are all sorted again anyway
+    if (archetype.sortCompare != nullptr && row < archetype.sortedRows) {
+        archetype.unsortedRows.set(world->allocators[MecsAllocationTag_World], row, true);
+    }
+}
+
+void mecsArchetypeSnapshotSortKeys(MecsWorld* world, Archetype& archetype)
+{
+    // An older copy is kept: the rows changed since it was taken are already in unsortedRows
+    const MecsSize keySize = world->registry->components[archetype.sortComponent].size;
+    if (!archetype.sortKeySnapshot.empty() || archetype.sortedRows == 0 || keySize == 0) { return; }
+    archetype.sortKeySnapshot.resize(world->allocators[MecsAllocationTag_World], archetype.sortedRows * keySize);
+    memcpy(archetype.sortKeySnapshot.atPtr(0), archetype.storage.getRowComponent(archetype.sortComponent, 0), archetype.sortedRows * keySize);
+}
+
+// Marks the sorted rows whose key isn't the one copied by mecsArchetypeSnapshotSortKeys() anymore
+void mecsArchetypeDiffSortKeys(MecsWorld* world, Archetype& archetype)
+{
+    const MecsSize keySize = world->registry->components[archetype.sortComponent].size;
+    const MecsSize rows = std::min(archetype.sortedRows, archetype.sortKeySnapshot.count() / keySize);
+    const auto* keys = static_cast<const MecsU8*>(archetype.storage.getRowComponent(archetype.sortComponent, 0));
+    for (MecsSize row = 0; row < rows; row++) {
+        if (memcmp(archetype.sortKeySnapshot.atPtr(row * keySize), keys + row * keySize, keySize) != 0) {
+            mecsArchetypeRowChanged(world, archetype, row);
+        }
+    }
+    archetype.sortKeySnapshot.clear();
+}
+
+// Moves the rows so that row i gets the row order[i], order is left as the identity
+void mecsArchetypePermuteRows(MecsWorld* world, Archetype& archetype, MecsVec<MecsSize>& order)
+{
+    const auto swapRows = [&](MecsSize lhs, MecsSize rhs) {
+        archetype.storage.swapRows(world->allocators[MecsAllocationTag_ArchetypeColumns], lhs, rhs);
+        std::swap(archetype.rowToEntity[lhs], archetype.rowToEntity[rhs]);
+        world->entities.at(archetype.rowToEntity[lhs])->archetypeRow = lhs;
+        world->entities.at(archetype.rowToEntity[rhs])->archetypeRow = rhs;
+    };
+    // Each cycle of the permutation takes one swap per row
+    for (MecsSize first = 0; first < order.count(); first++) {
+        MecsSize row = first;
+        while (order[row] != first) {
+            const MecsSize next = order[row];
+            swapRows(row, next);
+            order[row] = row;
+            row = next;
+        }
+        order[row] = row;
+    }
+}
+
+void mecsArchetypeSortRows(MecsWorld* world, Archetype& archetype, MecsComponentID component, PFNMecsCompareComponents compare, void* userData)
+{
+    const MecsAllocator& alloc = world->allocators[MecsAllocationTag_World];
+    if (archetype.sortComponent != component || archetype.sortCompare != compare || archetype.sortUserData != userData) {
+        archetype.sortComponent = component;
+        archetype.sortCompare = compare;
+        archetype.sortUserData = userData;
+        archetype.sortedRows = 0;
+        archetype.sortKeySnapshot.clear();
+    }
+    const MecsSize rows = archetype.storage.rows();
+    archetype.sortedRows = std::min(archetype.sortedRows, rows);
+    if (!archetype.sortKeySnapshot.empty()) {
+        mecsArchetypeDiffSortKeys(world, archetype);
+    }
+    if (archetype.sortedRows == rows && archetype.unsortedRows.allZeroes()) {
+        return;
+    }
+
+    // The rows that stayed in place are still in order: only the others are sorted, then merged with them
+    MecsVec<MecsSize> sorted;
+    MecsVec<MecsSize> unsorted;
+    for (MecsSize row = 0; row < rows; row++) {
+        if (row < archetype.sortedRows && !archetype.unsortedRows.test(row)) {
+            sorted.push(alloc, row);
+        } else {
+            unsorted.push(alloc, row);
+        }
+    }
+    const RowStorage& storage = archetype.storage;
+    const auto rowKey = [&](MecsSize row) -> const void* {
+        return component == MECS_INVALID ? archetype.rowToEntity.atPtr(row) : storage.getRowComponent(component, row);
+    };
+    const auto less = [&](MecsSize lhs, MecsSize rhs) {
+        return compare(rowKey(lhs), rowKey(rhs), userData) < 0;
+    };
+    if (!unsorted.empty()) {
+        std::stable_sort(unsorted.atPtr(0), unsorted.atPtr(0) + unsorted.count(), less);
+        MecsVec<MecsSize> order;
+        order.resize(alloc, rows);
+        const MecsSize* sortedBegin = sorted.empty() ? nullptr : sorted.atPtr(0);
+        std::merge(sortedBegin, sortedBegin + sorted.count(), unsorted.atPtr(0), unsorted.atPtr(0) + unsorted.count(), order.atPtr(0), less);
+        mecsArchetypePermuteRows(world, archetype, order);
+        order.destroy(alloc);
+    }
+    sorted.destroy(alloc);
+    unsorted.destroy(alloc);
+
+    archetype.sortedRows = rows;
+    archetype.unsortedRows.clear();
+}
+
+bool mecsIsSparseComponent(const MecsRegistry* registry, MecsComponentID component)
+{
+    return registry->components[component].storage == MecsComponentStorage_Sparse;
+}
+
+ComponentStorage& mecsWorldSparseStorage(MecsWorld* world, MecsComponentID component)
+{
+    MECS_ASSERT(mecsIsSparseComponent(world->registry, component));
+    world->sparseComponents.ensureSize(world->allocators[MecsAllocationTag_World], component + 1);
+    return world->sparseComponents[component];
+}
+
+// Calls func(componentID, instance) for each sparse component of the entity
+template <typename F>
+void mecsForEachSparseComponent(MecsWorld* world, MecsEntityID entityID, F&& func)
+{
+    const MecsU32 entityIndex = mecsEntityIDToIndex(entityID);
+    for (MecsComponentID component = 0; component < world->sparseComponents.count(); component++) {
+        const ComponentStorage& storage = world->sparseComponents[component];
+        if (storage.hasComponent(entityIndex)) {
+            func(component, storage.getComponent(entityIndex));
+        }
+    }
+}
+
+// Tears down and destroys the instance of a sparse component, unless the entity doesn't have it anymore
+void mecsRemoveSparseComponent(MecsWorld* world, MecsEntityID entityID, MecsComponentID componentID, void* updateData)
+{
+    const MecsU32 entityIndex = mecsEntityIDToIndex(entityID);
+    if (!mecsWorldSparseStorage(world, componentID).hasComponent(entityIndex)) {
+        return;
+    }
+    const ComponentInfo& componentInfo = world->registry->components.at(componentID);
+    if (componentInfo.teardown != nullptr) { componentInfo.teardown(world, entityID, mecsWorldSparseStorage(world, componentID).getComponent(entityIndex), updateData); }
+    // The teardown can add other sparse components, so the storage is looked up again
+    mecsWorldSparseStorage(world, componentID).destroyInstance(world->allocators[MecsAllocationTag_ArchetypeColumns], componentInfo, entityIndex);
+}
+
+void mecsRemoveSparseComponents(MecsWorld* world, MecsEntityID entityID, void* updateData)
+{
+    for (MecsComponentID component = 0; component < world->sparseComponents.count(); component++) {
+        if (mecsIsSparseComponent(world->registry, component)) {
+            mecsRemoveSparseComponent(world, entityID, component, updateData);
+        }
+    }
 }
 
 void mecsOnNewEntitySpawned(MecsWorld* const& world, MecsEntityID entityID, void* updateData)
@@ -38,59 +203,215 @@ void mecsOnNewEntitySpawned(MecsWorld* const& world, MecsEntityID entityID, void
     ent->status = EntityStatus::eSpawned;
 }
 
-void mecsAddEntityToNewMatchingSystems(MecsWorld* world,  void* updateData, MecsEntityID entityID, const BitSet& oldEntityComponentBitset, const BitSet& newEntityBitset)
+bool mecsIsTracing(const MecsWorld* world)
+{
+    return world->traceHooks.begin != nullptr || world->traceHooks.end != nullptr;
+}
+
+void mecsTraceBegin(const MecsWorld* world, const MecsTraceEvent& event)
+{
+    if (world->traceHooks.begin != nullptr) { world->traceHooks.begin(world->traceHooks.userData, &event); }
+}
+
+void mecsTraceEnd(const MecsWorld* world, const MecsTraceEvent& event)
+{
+    if (world->traceHooks.end != nullptr) { world->traceHooks.end(world->traceHooks.userData, &event); }
+}
+
+MecsTraceEvent mecsFlushPhaseEvent(const char* name, MecsSize numItems)
+{
+    return MecsTraceEvent {
+        .scope = MecsTraceScope_FlushPhase,
+        .name = name,
+        .schedule = MECS_INVALID,
+        .system = MECS_INVALID,
+        .numItems = numItems,
+    };
+}
+
+void mecsDeliverNotificationBatch(MecsWorld* world, SystemNotificationBatch& batch, void* updateData)
+{
+    if (batch.entities.empty()) { return; }
+    const MecsSystem& system = world->schedules[batch.system.schedule].systems[batch.system.system];
+    if (batch.added) {
+        system.onEntitiesAdded(system.systemData, updateData, &batch.entities[0], batch.entities.count());
+    } else {
+        system.onEntitiesRemoved(system.systemData, updateData, &batch.entities[0], batch.entities.count());
+    }
+    batch.entities.clear();
+}
+
+void mecsDeliverPendingNotificationBatches(MecsWorld* world, void* updateData)
+{
+    world->pendingNotificationBatches.forEach([&](MecsSize batchIndex) {
+        SystemNotificationBatch& batch = world->notificationBatches[batchIndex];
+        mecsDeliverNotificationBatch(world, batch, updateData);
+        batch.pending = false;
+    });
+    world->pendingNotificationBatches.clear();
+}
+
+bool mecsIsObserved(const MecsWorld* world, MecsComponentID component, MecsObserverEvent event)
+{
+    return world->observedEvents.isValid(component) && (world->observedEvents[component] & (1U << event)) != 0;
+}
+
+// Queues the entity for the observers of the event, instance is only used by the removals
+void mecsQueueObservers(MecsWorld* world, MecsEntityID entityID, MecsComponentID component, MecsObserverEvent event, void* instance)
+{
+    if (!mecsIsObserved(world, component, event)) { return; }
+    const MecsAllocator& allocator = world->allocators[MecsAllocationTag_World];
+    for (MecsObserverID observerID = 0; observerID < world->observers.count(); observerID++) {
+        MecsObserver& observer = world->observers[observerID];
+        if (observer.component != component || observer.event != event) { continue; }
+        if (!observer.pending) {
+            observer.pending = true;
+            world->pendingObservers.push(allocator, observerID);
+        }
+        observer.entities.push(allocator, entityID);
+        if (event == MecsObserverEvent_Removed) {
+            observer.components.push(allocator, instance);
+        }
+    }
+}
+
+bool mecsIsEntityAlive(MecsWorld* world, MecsEntityID entityID)
+{
+    const MecsU32 index = mecsEntityIDToIndex(entityID);
+    return index < world->entities.numEntries() && world->entities.isValidIndex(index) && world->entities.at(entityID) != nullptr;
+}
+
+// Observing a component is not writing it, so a column shared by a copy-on-write clone is not copied and the sorted
+// iteration is not invalidated
+void* mecsObservedComponent(MecsWorld* world, MecsEntityID entityID, MecsComponentID component)
+{
+    return const_cast<void*>(mecsWorldEntityReadComponent(world, entityID, component));
+}
+
+void mecsDeliverObservers(MecsWorld* world, void* updateData)
+{
+    const MecsAllocator& allocator = world->allocators[MecsAllocationTag_World];
+    world->pendingObservers.forEach([&](MecsObserverID observerID) {
+        MecsObserver& observer = world->observers[observerID];
+        observer.pending = false;
+        MecsSize count = observer.entities.count();
+        if (observer.event != MecsObserverEvent_Removed) {
+            // The entities might have moved or lost the component since they were queued
+            count = 0;
+            observer.components.clear();
+            observer.entities.forEach([&](MecsEntityID entityID) {
+                if (!mecsIsEntityAlive(world, entityID) || !mecsWorldEntityHasComponent(world, entityID, observer.component)) { return; }
+                observer.entities[count++] = entityID;
+                observer.components.push(allocator, mecsObservedComponent(world, entityID, observer.component));
+            });
+        }
+        if (count > 0) {
+            observer.observe(observer.observerData, updateData, observer.entities.atPtr(0), observer.components.atPtr(0), count);
+        }
+        observer.entities.clear();
+        observer.components.clear();
+    });
+    world->pendingObservers.clear();
+}
+
+// Queues the Removed events of the component of the entity, or of all its components when component is MECS_INVALID
+void mecsQueueRemovals(MecsWorld* world, MecsEntityID entityID, MecsComponentID component)
+{
+    if (component != MECS_INVALID) {
+        if (mecsIsObserved(world, component, MecsObserverEvent_Removed) && mecsWorldEntityHasComponent(world, entityID, component)) {
+            mecsQueueObservers(world, entityID, component, MecsObserverEvent_Removed, mecsObservedComponent(world, entityID, component));
+        }
+        return;
+    }
+    const MecsEntity* ent = world->entities.at(entityID);
+    world->archetypes[ent->archetype].componentIDs.forEach([&](MecsComponentID archetypeComponent) {
+        if (!mecsIsObserved(world, archetypeComponent, MecsObserverEvent_Removed)) { return; }
+        mecsQueueObservers(world, entityID, archetypeComponent, MecsObserverEvent_Removed, mecsObservedComponent(world, entityID, archetypeComponent));
+    });
+    mecsForEachSparseComponent(world, entityID, [&](MecsComponentID sparseComponent, void* instance) {
+        mecsQueueObservers(world, entityID, sparseComponent, MecsObserverEvent_Removed, instance);
+    });
+}
+
+// Hands the Removed events of the entity to the observers right away, after the pending Added and Changed ones since
+// their entities might be about to lose the component
+void mecsObserveRemovals(MecsWorld* world, MecsEntityID entityID, MecsComponentID component, void* updateData)
+{
+    if (world->observers.empty()) { return; }
+    mecsDeliverObservers(world, updateData);
+    mecsQueueRemovals(world, entityID, component);
+    mecsDeliverObservers(world, updateData);
+}
+
+void mecsNotifySystem(MecsWorld* world, const MecsSystem& system, void* updateData, MecsEntityID entityID, bool added)
+{
+    if (system.notificationBatch == MECS_INVALID) {
+        if (added) {
+            system.onEntityAdded(system.systemData, updateData, entityID);
+        } else {
+            system.onEntityRemoved(system.systemData, updateData, entityID);
+        }
+        return;
+    }
+
+    // Hand out the pending entities first if the kind of notification changes, so that the system
+    // is always notified in order (e.g. an entity added and then removed in the same flush)
+    SystemNotificationBatch& batch = world->notificationBatches[system.notificationBatch];
+    if (batch.added != added) {
+        mecsDeliverNotificationBatch(world, batch, updateData);
+        batch.added = added;
+    }
+
+    const bool batched = added ? system.onEntitiesAdded != nullptr : system.onEntitiesRemoved != nullptr;
+    if (!batched) {
+        if (added) {
+            system.onEntityAdded(system.systemData, updateData, entityID);
+        } else {
+            system.onEntityRemoved(system.systemData, updateData, entityID);
+        }
+        return;
+    }
+
+    if (!batch.pending) {
+        batch.pending = true;
+        world->pendingNotificationBatches.push(world->allocators[MecsAllocationTag_World], system.notificationBatch);
+    }
+    batch.entities.push(world->allocators[MecsAllocationTag_World], entityID);
+}
+
+void mecsAddEntityToNewMatchingSystems(MecsWorld* world,  void* updateData, MecsEntityID entityID, ArchetypeID oldArchetypeID, ArchetypeID newArchetypeID)
 {
 
     const auto* entity = world->entities.at(entityID);
     if (entity->status == EntityStatus::eDestroying) { return; }
 
-    world->schedules.forEach([&](MecsSchedule& schedule) {
-        schedule.systems.forEach([&](MecsSystem& system) {
-            if (system.onEntityAdded == nullptr) { return; }
-
-            const Archetype& systemArchetype = world->archetypes[system.systemArchetype];
-            const BitSet& systemBitset = systemArchetype.storage.bitset();
-
-            // If a system archetype did not include the old entity archetype
-            // but does include the new entity archetype
-            // it means the system now matches the entity
-            const bool entityWasNotIncludedBefore = !systemBitset.contains(oldEntityComponentBitset);
-            const bool entityIsIncludedNow = systemBitset.contains(newEntityBitset);
-            if (entityWasNotIncludedBefore && entityIsIncludedNow) {
-                // Check if we're trying to add an entity to a system that has just been added
-                // If the timestamp is MECS_INVALID, the system hasn't been initialized yet (the initial entities will be filled during mecsOnNewSystemAdded())
-                if (system.timestamp == MECS_INVALID) { return; }
-                system.onEntityAdded(system.systemData, updateData, entityID);
-            }
-        });
+    // The edge lists the systems whose archetype did not include the old entity archetype
+    // but does include the new entity archetype: these systems now match the entity
+    const ArchetypeEdge& edge = findArchetypeEdge(world, oldArchetypeID, newArchetypeID);
+    edge.addedSystems.forEach([&](const MecsSystemRef& ref) {
+        const MecsSystem& system = world->schedules[ref.schedule].systems[ref.system];
+        // Check if we're trying to add an entity to a system that has just been added
+        // If the timestamp is MECS_INVALID, the system hasn't been initialized yet (the initial entities will be filled during mecsOnNewSystemAdded())
+        if (system.timestamp == MECS_INVALID) { return; }
+        mecsNotifySystem(world, system, updateData, entityID, true);
     });
 }
 
-void mecsRemoveEntityFromUnmatchingSystems(MecsWorld* world,  void* updateData, MecsEntityID entityID, const BitSet& oldEntityComponentBitset, const BitSet& newEntityBitset)
+void mecsRemoveEntityFromUnmatchingSystems(MecsWorld* world,  void* updateData, MecsEntityID entityID, ArchetypeID oldArchetypeID, ArchetypeID newArchetypeID)
 {
     const auto* entity = world->entities.at(entityID);
     if ((entity->entityFlags & MecsEntityFlags_AliveOneFrame) != 0) { return; }
-    world->schedules.forEach([&](MecsSchedule& schedule) {
-        schedule.systems.forEach([&](MecsSystem& system) {
-            if (system.onEntityRemoved == nullptr) { return; }
-
-
-            const Archetype& systemArchetype = world->archetypes[system.systemArchetype];
-            const BitSet& systemBitset = systemArchetype.storage.bitset();
-
-            // If a system archetype did include the old entity archetype
-            // but does not include the new entity archetype anymore
-            // it means the system does not match the entity anymore
-            const bool entityWasIncludedBefore = systemBitset.contains(oldEntityComponentBitset);
-            const bool entityIsNotIncludedNow = !systemBitset.contains(newEntityBitset);
-            if (entityWasIncludedBefore && entityIsNotIncludedNow) {
-                // Check if we're trying to remove an entity from a system that has just been added
-                // If the timestamp is MECS_INVALID, the system hasn't been initialized yet (the initial entities haven't been added to the system)
-                // If the timestamp is the same as the world's timestamp, the system just got initialized but the entity has not been added to the system (it got skipped in mecsOnNewSystemAdded())
-                if (system.timestamp == MECS_INVALID || system.timestamp == world->timestamp) { return; }
-                system.onEntityRemoved(system.systemData, updateData, entityID);
-            }
-        });
+
+    // The edge lists the systems whose archetype did include the old entity archetype
+    // but does not include the new entity archetype anymore: these systems do not match the entity anymore
+    const ArchetypeEdge& edge = findArchetypeEdge(world, oldArchetypeID, newArchetypeID);
+    edge.removedSystems.forEach([&](const MecsSystemRef& ref) {
+        const MecsSystem& system = world->schedules[ref.schedule].systems[ref.system];
+        // Check if we're trying to remove an entity from a system that has just been added
+        // If the timestamp is MECS_INVALID, the system hasn't been initialized yet (the initial entities haven't been added to the system)
+        // If the timestamp is the same as the world's timestamp, the system just got initialized but the entity has not been added to the system (it got skipped in mecsOnNewSystemAdded())
+        if (system.timestamp == MECS_INVALID || system.timestamp == world->timestamp) { return; }
+        mecsNotifySystem(world, system, updateData, entityID, false);
     });
 }
 
@@ -100,16 +421,23 @@ void mecsOnComponentAddedToEntity(MecsWorld* const& world, MecsEntityID entityID
     MECS_ASSERT(ent != nullptr && "Invalid index passed to mecsOnComponentAddedToEntity");
     auto& componentInfo = world->registry->components.at(componentID);
     if (componentInfo.setup != nullptr) { componentInfo.setup(world, entityID, mecsWorldEntityGetComponent(world, entityID, componentID), updateData); }
-    const Archetype& oldArchetype = world->archetypes[oldArchetypeID];
-    const Archetype& newArchetype = world->archetypes[newArchetypeID];
-    mecsAddEntityToNewMatchingSystems(world, updateData, entityID, oldArchetype.storage.bitset(), newArchetype.storage.bitset());
+    mecsQueueObservers(world, entityID, componentID, MecsObserverEvent_Added, nullptr);
+    if (componentInfo.storage == MecsComponentStorage_Sparse) {
+        return; // The entity stays in its archetype
+    }
+    mecsAddEntityToNewMatchingSystems(world, updateData, entityID, oldArchetypeID, newArchetypeID);
 }
 
 void mecsOnComponentRemovedFromEntity(MecsWorld* const& world, MecsEntityID entityID, MecsComponentID componentID, void* updateData)
 {
     MecsEntity* ent = world->entities.at(entityID);
     MECS_ASSERT(ent != nullptr && "Invalid index passed to destroyEntity");
+    mecsObserveRemovals(world, entityID, componentID, updateData);
     const MecsRegistry* registry = world->registry;
+    if (mecsIsSparseComponent(registry, componentID)) {
+        mecsRemoveSparseComponent(world, entityID, componentID, updateData);
+        return;
+    }
     auto& componentInfo = registry->components.at(componentID);
     if (componentInfo.teardown != nullptr) { componentInfo.teardown(world, entityID, mecsWorldEntityGetComponent(world, entityID, componentID), updateData); }
 
@@ -119,9 +447,7 @@ void mecsOnComponentRemovedFromEntity(MecsWorld* const& world, MecsEntityID enti
         return; // The entity does not have the component;
     }
 
-    const Archetype& oldArchetype = world->archetypes[oldArchetypeID];
-    const Archetype& newArchetype = world->archetypes[newArchetypeID];
-    mecsRemoveEntityFromUnmatchingSystems(world, updateData, entityID, oldArchetype.storage.bitset(), newArchetype.storage.bitset());
+    mecsRemoveEntityFromUnmatchingSystems(world, updateData, entityID, oldArchetypeID, newArchetypeID);
 
 
     moveEntityToNewArchetype(world, entityID, newArchetypeID);
@@ -136,28 +462,49 @@ void mecsOnNewSystemAdded(MecsWorld* world, MecsSystemID systemID, MecsScheduleI
     MecsSystem& system = schedule.systems[systemID];
     system.timestamp = world->timestamp;
 
-    if (system.onEntityAdded == nullptr) {
+    if (system.onEntityAdded == nullptr && system.onEntitiesAdded == nullptr) {
         return;
     }
 
-    const Archetype& systemArchetype = world->archetypes[archetypeID];
-    const BitSet& systemBitset = systemArchetype.storage.bitset();
+    const BitSet& systemBitset = world->archetypes[archetypeID].storage.bitset();
 
-    world->entities.forEach([&](MecsEntityID entityID, const MecsEntity& entity) {
-        if (entity.status != EntityStatus::eSpawned) {
+    // Hands out the entities in rows [begin, end) of the archetype
+    auto notifyRows = [&](const Archetype& archetype, MecsSize begin, MecsSize end) {
+        if (begin == end) { return; }
+        if (system.onEntitiesAdded != nullptr) {
+            system.onEntitiesAdded(system.systemData, updateData, &archetype.rowToEntity[begin], end - begin);
             return;
         }
-        const Archetype& entityArchetype = world->archetypes[entity.archetype];
-        const BitSet& entityBitset = entityArchetype.storage.bitset();
+        for (MecsSize row = begin; row < end; row++) {
+            system.onEntityAdded(system.systemData, updateData, archetype.rowToEntity[row]);
+        }
+    };
 
-        if (systemBitset.contains(entityBitset)) {
-            system.onEntityAdded(system.systemData, updateData, entityID);
+    // Only the archetypes matching the system are visited, instead of testing each entity's archetype
+    for (ArchetypeID entityArchetypeID = 0; entityArchetypeID < world->archetypes.count(); entityArchetypeID++) {
+        const Archetype& entityArchetype = world->archetypes[entityArchetypeID];
+        if (!systemBitset.contains(entityArchetype.storage.bitset())) {
+            continue;
         }
-    });
+
+        // The entities that aren't spawned yet (or are being destroyed) are skipped,
+        // the others are handed out in runs of contiguous rows
+        MecsSize runBegin = 0;
+        for (MecsSize row = 0; row < entityArchetype.rowToEntity.count(); row++) {
+            const MecsEntity* entity = world->entities.at(entityArchetype.rowToEntity[row]);
+            if (entity->status == EntityStatus::eSpawned) {
+                continue;
+            }
+            notifyRows(entityArchetype, runBegin, row);
+            runBegin = row + 1;
+        }
+        notifyRows(entityArchetype, runBegin, entityArchetype.rowToEntity.count());
+    }
 }
 
 void mecsOnEntityDestroyed(MecsWorld* world, MecsEntityID entityID, void* updateData)
 {
+    mecsObserveRemovals(world, entityID, MECS_INVALID, updateData);
     MecsEntity* ent = world->entities.at(entityID);
     const ArchetypeID archetypeID = ent->archetype;
     const Archetype& entityArchetype = world->archetypes.at(archetypeID);
@@ -166,14 +513,19 @@ void mecsOnEntityDestroyed(MecsWorld* world, MecsEntityID entityID, void* update
         auto& componentInfo = registry->components.at(componentID);
         if (componentInfo.teardown != nullptr) { componentInfo.teardown(world, entityID, mecsWorldEntityGetComponent(world, entityID, componentID), updateData); }
     });
+    mecsRemoveSparseComponents(world, entityID, updateData);
 
-    const Archetype& oldArchetype = world->archetypes[archetypeID];
-    BitSet emptyBitset;
-    mecsRemoveEntityFromUnmatchingSystems(world, updateData, entityID, oldArchetype.storage.bitset(), emptyBitset);
-    emptyBitset.destroy(world->memAllocator);
+    mecsRemoveEntityFromUnmatchingSystems(world, updateData, entityID, archetypeID, MECS_INVALID);
 
     freeEntityRow(world, *ent);
-    world->entities.remove(world->memAllocator, entityID);
+    mecsWorldUnlinkHierarchy(world, entityID);
+    world->entities.remove(world->allocators[MecsAllocationTag_Entities], entityID);
+}
+
+bool mecsSystemMatchesArchetype(const MecsWorld* world, const MecsSystem& system, const Archetype& archetype)
+{
+    const BitSet& systemBitset = world->archetypes[system.systemArchetype].storage.bitset();
+    return systemBitset.contains(archetype.storage.bitset());
 }
 
 void mecsOnNewArchetype(MecsWorld* world, ArchetypeID archetypeID)
@@ -181,9 +533,79 @@ void mecsOnNewArchetype(MecsWorld* world, ArchetypeID archetypeID)
     Archetype& entArchetype = world->archetypes[archetypeID];
     world->acquiredIterators.forEach([&](MecsIterator* iterator) {
         if (iterator->componentSet.contains(entArchetype.storage.bitset())) {
-            iterator->archetypes.pushUnique(world->memAllocator, archetypeID);
+            mecsIteratorAddArchetype(iterator, archetypeID);
         }
     });
+
+    for (MecsScheduleID scheduleID = 0; scheduleID < world->schedules.count(); scheduleID++) {
+        const MecsSchedule& schedule = world->schedules[scheduleID];
+        for (MecsSystemID systemID = 0; systemID < schedule.systems.count(); systemID++) {
+            if (mecsSystemMatchesArchetype(world, schedule.systems[systemID], entArchetype)) {
+                entArchetype.matchingSystems.push(world->allocators[MecsAllocationTag_World], { .schedule = scheduleID, .system = systemID });
+            }
+        }
+    }
+}
+
+void mecsDestroyArchetypeEdges(MecsWorld* world, Archetype& archetype)
+{
+    archetype.edges.forEach([world](ArchetypeEdge& edge) {
+        edge.addedSystems.destroy(world->allocators[MecsAllocationTag_World]);
+        edge.removedSystems.destroy(world->allocators[MecsAllocationTag_World]);
+    });
+    archetype.edges.destroy(world->allocators[MecsAllocationTag_World]);
+}
+
+void mecsOnNewSystemDefined(MecsWorld* world, MecsScheduleID scheduleID, MecsSystemID systemID)
+{
+    const MecsSystem& system = world->schedules[scheduleID].systems[systemID];
+    world->archetypes.forEach([&](Archetype& archetype) {
+        if (mecsSystemMatchesArchetype(world, system, archetype)) {
+            archetype.matchingSystems.push(world->allocators[MecsAllocationTag_World], { .schedule = scheduleID, .system = systemID });
+        }
+
+        // The cached edges don't know about the new system: they will be computed again when needed
+        mecsDestroyArchetypeEdges(world, archetype);
+    });
+}
+
+const ArchetypeEdge& findArchetypeEdge(MecsWorld* world, ArchetypeID source, ArchetypeID target)
+{
+    Archetype& sourceArchetype = world->archetypes[source];
+    for (MecsSize i = 0; i < sourceArchetype.edges.count(); i++) {
+        const ArchetypeEdge& edge = sourceArchetype.edges[i];
+        if (edge.target == target) {
+            return edge;
+        }
+    }
+
+    ArchetypeEdge edge { .target = target };
+    const MecsVec<MecsSystemRef>& sourceSystems = sourceArchetype.matchingSystems;
+    if (target != MECS_INVALID) {
+        const MecsVec<MecsSystemRef>& targetSystems = world->archetypes[target].matchingSystems;
+        targetSystems.forEach([&](const MecsSystemRef& ref) {
+            const MecsSystem& system = world->schedules[ref.schedule].systems[ref.system];
+            if ((system.onEntityAdded != nullptr || system.onEntitiesAdded != nullptr) && !sourceSystems.contains(ref)) {
+                edge.addedSystems.push(world->allocators[MecsAllocationTag_World], ref);
+            }
+        });
+        sourceSystems.forEach([&](const MecsSystemRef& ref) {
+            const MecsSystem& system = world->schedules[ref.schedule].systems[ref.system];
+            if ((system.onEntityRemoved != nullptr || system.onEntitiesRemoved != nullptr) && !targetSystems.contains(ref)) {
+                edge.removedSystems.push(world->allocators[MecsAllocationTag_World], ref);
+            }
+        });
+    } else {
+        sourceSystems.forEach([&](const MecsSystemRef& ref) {
+            const MecsSystem& system = world->schedules[ref.schedule].systems[ref.system];
+            if (system.onEntityRemoved != nullptr || system.onEntitiesRemoved != nullptr) {
+                edge.removedSystems.push(world->allocators[MecsAllocationTag_World], ref);
+            }
+        });
+    }
+
+    const MecsSize edgeIndex = sourceArchetype.edges.push(world->allocators[MecsAllocationTag_World], std::move(edge));
+    return sourceArchetype.edges[edgeIndex];
 }
 
 ArchetypeID findArchetype(MecsWorld* world, const BitSet& archetypeBitset)
@@ -199,12 +621,12 @@ ArchetypeID findArchetype(MecsWorld* world, const BitSet& archetypeBitset)
     ArchetypeID archID = world->archetypes.count();
     MecsVec<MecsComponentID> components;
     archetypeBitset.forEach([&](MecsSize idx) {
-        components.push(world->memAllocator, static_cast<MecsComponentID>(idx));
+        components.push(world->allocators[MecsAllocationTag_World], static_cast<MecsComponentID>(idx));
     });
 
-    RowStorage storage = RowStorage { std::move(archetypeBitset.clone(world->memAllocator)), world };
+    RowStorage storage = RowStorage { std::move(archetypeBitset.clone(world->allocators[MecsAllocationTag_ArchetypeColumns])), world };
 
-    world->archetypes.push(world->memAllocator, { .storage = std::move(storage), .componentIDs = std::move(components) });
+    world->archetypes.push(world->allocators[MecsAllocationTag_World], { .storage = std::move(storage), .componentIDs = std::move(components) });
 
     mecsOnNewArchetype(world, archID);
 
@@ -217,12 +639,12 @@ ArchetypeID findNewArchetype(MecsWorld* world, ArchetypeID source, MecsComponent
 
     if (source != MECS_INVALID) {
         Archetype& sourceArchetype = world->archetypes[source];
-        archetypeBitset = sourceArchetype.storage.bitset().clone(world->memAllocator);
+        archetypeBitset = sourceArchetype.storage.bitset().clone(world->allocators[MecsAllocationTag_World]);
     }
-    archetypeBitset.set(world->memAllocator, component, include);
+    archetypeBitset.set(world->allocators[MecsAllocationTag_World], component, include);
 
     ArchetypeID archetypeID = findArchetype(world, archetypeBitset);
-    archetypeBitset.destroy(world->memAllocator);
+    archetypeBitset.destroy(world->allocators[MecsAllocationTag_World]);
 
     return archetypeID;
 }
@@ -240,15 +662,15 @@ void moveEntityToNewArchetype(MecsWorld* const world, MecsEntityID entity, Arche
 
     Archetype& newArchetype = world->archetypes[newArchetypeID];
 
-    MecsSize newRow = newArchetype.storage.allocateRow(world->memAllocator);
+    MecsSize newRow = newArchetype.storage.allocateRow(world->allocators[MecsAllocationTag_ArchetypeColumns]);
 
     if (ent->archetype != MECS_INVALID) {
         Archetype& oldArchetype = world->archetypes[ent->archetype];
-        oldArchetype.storage.copyRow(ent->archetypeRow, newArchetype.storage, newRow);
+        oldArchetype.storage.copyRow(world->allocators[MecsAllocationTag_ArchetypeColumns], ent->archetypeRow, newArchetype.storage, newRow);
 
         freeEntityRow(world, *ent);
     }
-    newArchetype.rowToEntity.ensureSize(world->memAllocator, newRow + 1);
+    newArchetype.rowToEntity.ensureSize(world->allocators[MecsAllocationTag_ArchetypeColumns], newRow + 1);
     newArchetype.rowToEntity[newRow] = entity;
 
     ent->archetype = newArchetypeID;
@@ -260,18 +682,27 @@ mecsWorldCreate(MecsRegistry* registry, const MecsWorldCreateInfo* const mecsWor
 {
     assert(registry != nullptr);
 
-    MecsAllocator allocator;
-    if (mecsWorldCreateInfo != nullptr && mecsWorldCreateInfo->memAllocator.memAlloc != nullptr) {
-        allocator = mecsWorldCreateInfo->memAllocator;
-    } else {
-        allocator = registry->memAllocator;
+    MecsAllocator allocators[MecsAllocationTag_Count];
+    for (MecsSize tag = 0; tag < MecsAllocationTag_Count; tag++) {
+        if (mecsWorldCreateInfo != nullptr && mecsWorldCreateInfo->memAllocator.memAlloc != nullptr) {
+            allocators[tag] = mecsWorldCreateInfo->memAllocator;
+        } else {
+            allocators[tag] = registry->allocators[tag];
+        }
+    }
+    if (mecsWorldCreateInfo != nullptr) {
+        mecsApplyTaggedAllocators(allocators, mecsWorldCreateInfo->pTaggedAllocators);
     }
 
-    auto* world = mecsAlloc<MecsWorld>(allocator);
+    auto* world = mecsAlloc<MecsWorld>(allocators[MecsAllocationTag_World]);
 
     world->registry = registry;
-    world->memAllocator = allocator;
+    for (MecsSize tag = 0; tag < MecsAllocationTag_Count; tag++) {
+        world->allocators[tag] = allocators[tag];
+    }
+    world->worldFlags = mecsWorldCreateInfo != nullptr ? mecsWorldCreateInfo->worldFlags : MecsWorldFlags_None;
     world->timestamp = 0;
+    world->resourceTick = 0;
 
     return world;
 }
@@ -279,6 +710,10 @@ mecsWorldCreate(MecsRegistry* registry, const MecsWorldCreateInfo* const mecsWor
 void mecsIteratorReleaseResources(const MecsAllocator& alloc, MecsIterator* iter)
 {
     iter->components.destroy(alloc);
+    iter->sparseArguments.destroy(alloc);
+    iter->enabledRows.destroy(alloc);
+    iter->archetypeGroups.destroy(alloc);
+    iter->hierarchyCursors.destroy(alloc);
     iter->componentSet.destroy(alloc);
     iter->blacklistComponentSet.destroy(alloc);
     iter->archetypes.destroy(alloc);
@@ -294,39 +729,77 @@ void mecsWorldFree(MecsWorld* world)
     world->schedules.forEach([world](MecsSchedule& schedule) {
         schedule.systems.forEach([world](MecsSystem& system) {
             mecsWorldReleaseIterator(world, system.systemIterator);
+            system.access.destroy(world->allocators[MecsAllocationTag_World]);
+            if (system.systemName != nullptr) {
+                mecsFree(world->allocators[MecsAllocationTag_Strings], system.systemName);
+                system.systemName = nullptr;
+            }
         });
         if (schedule.scheduleName != nullptr) {
-            mecsFree(world->memAllocator, schedule.scheduleName);
+            mecsFree(world->allocators[MecsAllocationTag_Strings], schedule.scheduleName);
             schedule.scheduleName = nullptr;
         }
-        schedule.systems.destroy(world->memAllocator);
+        schedule.systems.destroy(world->allocators[MecsAllocationTag_World]);
     });
-    world->schedules.destroy(world->memAllocator);
+    world->schedules.destroy(world->allocators[MecsAllocationTag_World]);
     world->archetypes.forEach([world](Archetype& bucket) {
-        bucket.storage.destroy(world->memAllocator);
-        bucket.componentIDs.destroy(world->memAllocator);
-        bucket.rowToEntity.destroy(world->memAllocator);
+        bucket.storage.destroy(world->allocators[MecsAllocationTag_ArchetypeColumns]);
+        bucket.componentIDs.destroy(world->allocators[MecsAllocationTag_World]);
+        bucket.rowToEntity.destroy(world->allocators[MecsAllocationTag_ArchetypeColumns]);
+        bucket.matchingSystems.destroy(world->allocators[MecsAllocationTag_World]);
+        bucket.unsortedRows.destroy(world->allocators[MecsAllocationTag_World]);
+        bucket.sortKeySnapshot.destroy(world->allocators[MecsAllocationTag_World]);
+        mecsDestroyArchetypeEdges(world, bucket);
     });
-    world->archetypes.destroy(world->memAllocator);
-    world->entities.destroy(world->memAllocator);
+    world->archetypes.destroy(world->allocators[MecsAllocationTag_World]);
+    for (MecsComponentID component = 0; component < world->sparseComponents.count(); component++) {
+        world->sparseComponents[component].destroy(world->allocators[MecsAllocationTag_ArchetypeColumns], world->registry->components[component]);
+    }
+    world->sparseComponents.destroy(world->allocators[MecsAllocationTag_World]);
+    world->hierarchy.destroy(world->allocators[MecsAllocationTag_World]);
+    for (MecsComponentID component = 0; component < world->resources.count(); component++) {
+        if (world->resources[component] != nullptr) {
+            mecsWorldRemoveResource(world, component);
+        }
+    }
+    world->resources.destroy(world->allocators[MecsAllocationTag_World]);
+    world->resourceVersions.destroy(world->allocators[MecsAllocationTag_World]);
+    world->entities.destroy(world->allocators[MecsAllocationTag_Entities]);
+    mecsUnmapSnapshots(world);
 
     world->acquiredIterators.forEach([world](auto& iter) {
-        mecsIteratorReleaseResources(world->memAllocator, iter);
+        mecsIteratorReleaseResources(world->allocators[MecsAllocationTag_Iterators], iter);
     });
 
     world->reusableIterators.forEach([world](auto& iter) {
-        mecsIteratorReleaseResources(world->memAllocator, iter);
+        mecsIteratorReleaseResources(world->allocators[MecsAllocationTag_Iterators], iter);
     });
 
-    world->acquiredIterators.destroy(world->memAllocator);
-    world->reusableIterators.destroy(world->memAllocator);
-    world->newEvents.destroy(world->memAllocator);
-    mecsFree(world->memAllocator, world);
+    world->acquiredIterators.destroy(world->allocators[MecsAllocationTag_Iterators]);
+    world->reusableIterators.destroy(world->allocators[MecsAllocationTag_Iterators]);
+    world->newEvents.destroy(world->allocators[MecsAllocationTag_Events]);
+    world->batchKeys.destroy(world->allocators[MecsAllocationTag_Events]);
+    world->batchRemovalKeys.destroy(world->allocators[MecsAllocationTag_Events]);
+    world->batchAddedSystems.destroy(world->allocators[MecsAllocationTag_World]);
+    world->batchRemovedSystems.destroy(world->allocators[MecsAllocationTag_World]);
+    world->notificationBatches.forEach([world](SystemNotificationBatch& batch) {
+        batch.entities.destroy(world->allocators[MecsAllocationTag_World]);
+    });
+    world->notificationBatches.destroy(world->allocators[MecsAllocationTag_World]);
+    world->pendingNotificationBatches.destroy(world->allocators[MecsAllocationTag_World]);
+    world->observers.forEach([world](MecsObserver& observer) {
+        observer.entities.destroy(world->allocators[MecsAllocationTag_World]);
+        observer.components.destroy(world->allocators[MecsAllocationTag_World]);
+    });
+    world->observers.destroy(world->allocators[MecsAllocationTag_World]);
+    world->observedEvents.destroy(world->allocators[MecsAllocationTag_World]);
+    world->pendingObservers.destroy(world->allocators[MecsAllocationTag_World]);
+    mecsFree(world->allocators[MecsAllocationTag_World], world);
 }
 MECS_API MecsAllocator mecsWorldGetAllocator(MecsWorld* world)
 {
     MECS_ASSERT(world);
-    return world->memAllocator;
+    return world->allocators[MecsAllocationTag_User];
 }
 
 MecsEntityID mecsWorldSpawnEntity(MecsWorld* const world, const MecsEntityInfo* entityInfo)
@@ -345,49 +818,67 @@ void setupEntityThroughPrefab(MecsWorld*& world, MecsPrefabID& prefabID, MecsEnt
     ent.archetype = entityArchetype;
     if (entityArchetype != MECS_INVALID) {
         Archetype& archetype = world->archetypes[entityArchetype];
-        MecsSize row = archetype.storage.allocateRow(world->memAllocator);
+        MecsSize row = archetype.storage.allocateRow(world->allocators[MecsAllocationTag_ArchetypeColumns]);
         prefab.components.forEach([&](const MecsPrefabComponent& component) {
+            if (mecsIsSparseComponent(world->registry, component.component)) {
+                return;
+            }
             void* componentPtr = archetype.storage.getRowComponent(component.component, row);
             component.blob.copyOnto(world->registry, componentPtr);
         });
         ent.archetypeRow = row;
-        archetype.rowToEntity.ensureSize(world->memAllocator, row + 1);
+        archetype.rowToEntity.ensureSize(world->allocators[MecsAllocationTag_ArchetypeColumns], row + 1);
         archetype.rowToEntity[row] = entityID;
     }
+
+    const MecsU32 entityIndex = mecsEntityIDToIndex(entityID);
+    prefab.components.forEach([&](const MecsPrefabComponent& component) {
+        if (!mecsIsSparseComponent(world->registry, component.component)) {
+            return;
+        }
+        const ComponentInfo& info = world->registry->components[component.component];
+        void* componentPtr = mecsWorldSparseStorage(world, component.component).construct(world->allocators[MecsAllocationTag_ArchetypeColumns], info, entityIndex);
+        component.blob.copyOnto(world->registry, componentPtr);
+    });
+}
+void setupEntityWithoutComponents(MecsWorld* world, MecsEntityID entityID, MecsEntity& ent)
+{
+    BitSet bitset;
+    const ArchetypeID defaultArchetype = findArchetype(world, bitset);
+    bitset.destroy(world->allocators[MecsAllocationTag_World]);
+
+    Archetype& archetype = world->archetypes[defaultArchetype];
+    const MecsSize row = archetype.storage.allocateRow(world->allocators[MecsAllocationTag_ArchetypeColumns]);
+    ent.archetypeRow = row;
+    ent.archetype = defaultArchetype;
+    archetype.rowToEntity.ensureSize(world->allocators[MecsAllocationTag_ArchetypeColumns], row + 1);
+    archetype.rowToEntity[row] = entityID;
 }
+
 MecsEntityID mecsWorldSpawnEntityPrefab(MecsWorld* world, MecsPrefabID prefabID, const MecsEntityInfo* entityInfo)
 {
     MECS_ASSERT(world != nullptr && "Cannot pass a null world");
     MecsEntity ent = {};
     if (entityInfo != nullptr) {
         if (ent.name != nullptr) {
-            ent.name = mecsStrDup(world->memAllocator, ent.name);
+            ent.name = mecsStrDup(world->allocators[MecsAllocationTag_Strings], ent.name);
         }
     }
     ent.status = EntityStatus::eNewlySpawned;
     ent.archetype = MECS_INVALID;
     ent.archetypeRow = MECS_INVALID;
     ent.prefabID = prefabID;
-    MecsEntityID entityID = world->entities.push(world->memAllocator, {});
+    MecsEntityID entityID = world->entities.push(world->allocators[MecsAllocationTag_Entities], {});
 
     if (prefabID != MECS_INVALID) {
         setupEntityThroughPrefab(world, prefabID, entityID, ent);
     } else {
-        BitSet bitset;
-        const ArchetypeID defaultArchetype = findArchetype(world, bitset);
-        bitset.destroy(world->memAllocator);
-
-        Archetype& archetype = world->archetypes[defaultArchetype];
-        const MecsSize row = archetype.storage.allocateRow(world->memAllocator);
-        ent.archetypeRow = row;
-        ent.archetype = defaultArchetype;
-        archetype.rowToEntity.ensureSize(world->memAllocator, row + 1);
-        archetype.rowToEntity[row] = entityID;
+        setupEntityWithoutComponents(world, entityID, ent);
     }
 
     *world->entities.at(entityID) = ent;
 
-    world->newEvents.push(world->memAllocator, WorldEvent {
+    world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
                                                    .kind = WorldEventKind::eNewEntity,
                                                    .entityID = entityID,
                                                });
@@ -395,12 +886,32 @@ MecsEntityID mecsWorldSpawnEntityPrefab(MecsWorld* world, MecsPrefabID prefabID,
     return entityID;
 }
 
+MecsEntityID mecsWorldSpawnEntityAt(MecsWorld* world, MecsU32 index, MecsU32 generation, MecsPrefabID prefabID, MecsU8 entityFlags)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MecsEntity ent = {};
+    ent.status = EntityStatus::eNewlySpawned;
+    ent.archetype = MECS_INVALID;
+    ent.archetypeRow = MECS_INVALID;
+    ent.prefabID = prefabID;
+    ent.entityFlags = entityFlags;
+    MecsEntityID entityID = world->entities.pushAt(world->allocators[MecsAllocationTag_Entities], index, generation, {});
+    setupEntityWithoutComponents(world, entityID, ent);
+    *world->entities.at(entityID) = ent;
+
+    world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
+                                                   .kind = WorldEventKind::eNewEntity,
+                                                   .entityID = entityID,
+                                               });
+    return entityID;
+}
+
 MECS_API MecsEntityID mecsWorldDuplicateEntity(MecsWorld* world, MecsWorld* destinationWorld, MecsEntityID entity)
 {
     MECS_ASSERT(mecsWorldGetRegistry(world) == mecsWorldGetRegistry(destinationWorld) && "source and destination worlds must have been spawned by the same registry");
 
     MecsRegistry* registry = mecsWorldGetRegistry(world);
-    MecsEntityID newEntityID = destinationWorld->entities.push(destinationWorld->memAllocator, {});
+    MecsEntityID newEntityID = destinationWorld->entities.push(destinationWorld->allocators[MecsAllocationTag_Entities], {});
 
     ArchetypeID destArchetypeID;
     MecsSize destEntityRow;
@@ -414,8 +925,8 @@ MECS_API MecsEntityID mecsWorldDuplicateEntity(MecsWorld* world, MecsWorld* dest
 
         destArchetypeID = findArchetype(destinationWorld, sourceArch.storage.bitset());
         Archetype& destArch = destinationWorld->archetypes.at(destArchetypeID);
-        destEntityRow = destArch.storage.allocateRow(destinationWorld->memAllocator);
-        destArch.rowToEntity.ensureSize(world->memAllocator, destEntityRow + 1);
+        destEntityRow = destArch.storage.allocateRow(destinationWorld->allocators[MecsAllocationTag_ArchetypeColumns]);
+        destArch.rowToEntity.ensureSize(destinationWorld->allocators[MecsAllocationTag_ArchetypeColumns], destEntityRow + 1);
         destArch.rowToEntity[destEntityRow] = newEntityID;
     }
 
@@ -423,7 +934,7 @@ MECS_API MecsEntityID mecsWorldDuplicateEntity(MecsWorld* world, MecsWorld* dest
         MecsEntity* source = world->entities.at(entity);
         MecsEntity destEntity = {};
         if (source->name != nullptr) {
-            destEntity.name = mecsStrDup(world->memAllocator, source->name);
+            destEntity.name = mecsStrDup(destinationWorld->allocators[MecsAllocationTag_Strings], source->name);
         }
         destEntity.status = EntityStatus::eNewlySpawned;
         destEntity.prefabID = source->prefabID;
@@ -433,11 +944,11 @@ MECS_API MecsEntityID mecsWorldDuplicateEntity(MecsWorld* world, MecsWorld* dest
         MecsVec<MecsComponentID> componentIDS;
         {
             const Archetype& sourceArch = world->archetypes.at(source->archetype);
-            destinationWorld->newEvents.push(world->memAllocator, WorldEvent {
+            destinationWorld->newEvents.push(destinationWorld->allocators[MecsAllocationTag_Events], WorldEvent {
                                                                       .kind = WorldEventKind::eNewEntity,
                                                                       .entityID = newEntityID,
                                                                   });
-            componentIDS.resize(world->memAllocator, sourceArch.componentIDs.count());
+            componentIDS.resize(world->allocators[MecsAllocationTag_World], sourceArch.componentIDs.count());
             for (MecsSize i = 0; i < sourceArch.componentIDs.count(); i++) {
                 componentIDS[i] = sourceArch.componentIDs[i];
             }
@@ -457,10 +968,13 @@ MECS_API MecsEntityID mecsWorldDuplicateEntity(MecsWorld* world, MecsWorld* dest
             } else {
                 mecsMemCpy(static_cast<const char*>(sourceRow), info.size, static_cast<char*>(destRow), info.size);
             }
-            tempBitSet.set(world->memAllocator, component, true);
+            if (!sourceArch.storage.isRowEnabled(component, source->archetypeRow)) {
+                destinationWorld->archetypes.at(destArchetypeID).storage.setRowEnabled(destinationWorld->allocators[MecsAllocationTag_ArchetypeColumns], component, destEntity.archetypeRow, false);
+            }
+            tempBitSet.set(world->allocators[MecsAllocationTag_World], component, true);
 
             ArchetypeID newArchetypeID = findArchetype(destinationWorld, tempBitSet);
-            destinationWorld->newEvents.push(world->memAllocator, WorldEvent {
+            destinationWorld->newEvents.push(destinationWorld->allocators[MecsAllocationTag_Events], WorldEvent {
                                                                       .kind = WorldEventKind::eNewComponent,
                                                                       .entityID = newEntityID,
                                                                       .componentID = component,
@@ -469,8 +983,34 @@ MECS_API MecsEntityID mecsWorldDuplicateEntity(MecsWorld* world, MecsWorld* dest
                                                                   });
             oldArchetypeID = newArchetypeID;
         });
-        tempBitSet.destroy(world->memAllocator);
-        componentIDS.destroy(world->memAllocator);
+        tempBitSet.destroy(world->allocators[MecsAllocationTag_World]);
+
+        // The sparse components don't change the archetype of the new entity
+        componentIDS.clear();
+        mecsForEachSparseComponent(world, entity, [&](MecsComponentID component, void*) {
+            componentIDS.push(world->allocators[MecsAllocationTag_World], component);
+        });
+        const MecsU32 sourceIndex = mecsEntityIDToIndex(entity);
+        const MecsU32 destIndex = mecsEntityIDToIndex(newEntityID);
+        componentIDS.forEach([&](MecsComponentID component) {
+            MecsComponentInfoInternal& info = registry->components.at(component);
+            void* destInstance = mecsWorldSparseStorage(destinationWorld, component).construct(destinationWorld->allocators[MecsAllocationTag_ArchetypeColumns], info, destIndex);
+            // Constructing the copy can move the instances when world == destinationWorld
+            const void* sourceInstance = mecsWorldSparseStorage(world, component).getComponent(sourceIndex);
+            if (info.copy) {
+                info.copy(sourceInstance, destInstance, info.size);
+            } else {
+                mecsMemCpy(static_cast<const char*>(sourceInstance), info.size, static_cast<char*>(destInstance), info.size);
+            }
+            destinationWorld->newEvents.push(destinationWorld->allocators[MecsAllocationTag_Events], WorldEvent {
+                                                                      .kind = WorldEventKind::eNewComponent,
+                                                                      .entityID = newEntityID,
+                                                                      .componentID = component,
+                                                                      .archetypeID = destArchetypeID,
+                                                                      .newArchetypeID = destArchetypeID,
+                                                                  });
+        });
+        componentIDS.destroy(world->allocators[MecsAllocationTag_World]);
 
         *destinationWorld->entities.at(newEntityID) = destEntity;
 
@@ -478,33 +1018,207 @@ MECS_API MecsEntityID mecsWorldDuplicateEntity(MecsWorld* world, MecsWorld* dest
     }
 }
 
-void* mecsWorldAddComponent(MecsWorld* const world, MecsEntityID entity, MecsComponentID component)
+void mecsPushSystemAddedEvents(MecsWorld* world)
 {
-    MECS_ASSERT(world && world->registry);
-    MECS_ASSERT(entity != MECS_INVALID && "Invalid entity ID");
-    MecsEntity* ent = world->entities.at(entity);
-    MECS_ASSERT(ent->status != EntityStatus::eDestroying);
-    MecsComponentInfoInternal info = world->registry->components[component];
+    for (MecsScheduleID scheduleID = 0; scheduleID < world->schedules.count(); scheduleID++) {
+        const MecsSchedule& schedule = world->schedules[scheduleID];
+        for (MecsSystemID systemID = 0; systemID < schedule.systems.count(); systemID++) {
+            const MecsSystem& system = schedule.systems[systemID];
+            if (system.timestamp == MECS_INVALID) { continue; }
+            world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
+                .kind = WorldEventKind::eSystemAdded,
+                .entityID = systemID,
+                .componentID = scheduleID,
+                .archetypeID = system.systemArchetype,
+                .newArchetypeID = MECS_INVALID,
+            });
+        }
+    }
+}
 
-    void* outPtr = nullptr;
-    if (ent->archetype == MECS_INVALID) {
-        ArchetypeID newArchetypeID = findNewArchetype(world, ent->archetype, component, true);
-        moveEntityToNewArchetype(world, entity, newArchetypeID);
-        Archetype& newArchetype = world->archetypes[newArchetypeID];
-        outPtr = newArchetype.storage.getRowComponent(component, ent->archetypeRow);
+// Pushes the events mecsWorldDuplicateEntity() would push for every entity of the archetype: the archetypes the entities
+// go through while their components are added one at a time are the same for all of them, so they're looked up once
+void mecsPushClonedArchetypeEvents(MecsWorld* world, ArchetypeID archetypeID)
+{
+    const MecsAllocator& allocator = world->allocators[MecsAllocationTag_World];
+    MecsVec<ArchetypeID> transitions;
+    BitSet partialBitset;
+    transitions.push(allocator, findArchetype(world, partialBitset));
+    for (MecsSize i = 0; i < world->archetypes[archetypeID].componentIDs.count(); i++) {
+        partialBitset.set(allocator, world->archetypes[archetypeID].componentIDs[i], true);
+        transitions.push(allocator, findArchetype(world, partialBitset));
+    }
+    partialBitset.destroy(allocator);
+
+    const Archetype& archetype = world->archetypes[archetypeID];
+    for (MecsSize row = 0; row < archetype.storage.rows(); row++) {
+        const MecsEntityID entityID = archetype.rowToEntity[row];
+        world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
+            .kind = WorldEventKind::eNewEntity,
+            .entityID = entityID,
+        });
+        for (MecsSize i = 0; i < archetype.componentIDs.count(); i++) {
+            world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
+                .kind = WorldEventKind::eNewComponent,
+                .entityID = entityID,
+                .componentID = archetype.componentIDs[i],
+                .archetypeID = transitions[i],
+                .newArchetypeID = transitions[i + 1],
+            });
+        }
+    }
+    transitions.destroy(allocator);
+}
 
-        world->newEvents.push(world->memAllocator, WorldEvent {
-                                                       .kind = WorldEventKind::eNewComponent,
-                                                       .entityID = entity,
-                                                       .componentID = component,
-                                                       .archetypeID = MECS_INVALID,
-                                                   });
-    } else {
-        ArchetypeID oldArchetypeID = ent->archetype;
-        Archetype& oldArchetype = world->archetypes[oldArchetypeID];
+void mecsWorldClone(MecsWorld* world, MecsWorld* destinationWorld, int cloneFlags)
+{
+    MECS_ASSERT(world != nullptr && destinationWorld != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(world != destinationWorld && "A world cannot be cloned into itself");
+    MECS_ASSERT(world->registry == destinationWorld->registry && "source and destination worlds must have been spawned by the same registry");
+    MECS_ASSERT(world->newEvents.empty() && "The events must be flushed before cloning a world");
+    MECS_ASSERT(destinationWorld->entities.count() == 0 && "A world can only be cloned into a world without entities");
+    MECS_ASSERT(destinationWorld->newEvents.empty() && "The events of the destination world must be flushed before cloning");
+
+    const bool entityEvents = (cloneFlags & MecsWorldCloneFlags_EntityEvents) != 0;
+    const bool copyOnWrite = (cloneFlags & MecsWorldCloneFlags_CopyOnWrite) != 0;
+    const MecsAllocator& allocator = world->allocators[MecsAllocationTag_World];
+    const MecsAllocator& columnsAllocator = destinationWorld->allocators[MecsAllocationTag_ArchetypeColumns];
+
+    // The archetypes are created in the same order, but the destination might already have some of them under another ID
+    MecsVec<ArchetypeID> archetypeMap;
+    archetypeMap.resize(allocator, world->archetypes.count());
+    for (ArchetypeID archetypeID = 0; archetypeID < world->archetypes.count(); archetypeID++) {
+        const Archetype& source = world->archetypes[archetypeID];
+        const ArchetypeID destArchetypeID = findArchetype(destinationWorld, source.storage.bitset());
+        archetypeMap[archetypeID] = destArchetypeID;
+        if (source.storage.rows() == 0) { continue; }
+
+        Archetype& dest = destinationWorld->archetypes[destArchetypeID];
+        MECS_ASSERT(dest.storage.rows() == 0);
+        if (copyOnWrite) {
+            dest.storage.shareRows(columnsAllocator, world->archetypes[archetypeID].storage, world->allocators[MecsAllocationTag_ArchetypeColumns]);
+        } else {
+            dest.storage.appendRows(columnsAllocator, source.storage);
+        }
+        dest.rowToEntity.ensureSize(columnsAllocator, source.storage.rows());
+        memcpy(dest.rowToEntity.atPtr(0), source.rowToEntity.atPtr(0), source.storage.rows() * sizeof(MecsEntityID));
+    }
+
+    // The entity IDs are preserved, free slots included, so the two worlds keep handing out the same IDs
+    GenArena<MecsEntity>& entities = destinationWorld->entities;
+    entities.cloneFrom(destinationWorld->allocators[MecsAllocationTag_Entities], world->entities, [&](MecsEntity& entity) {
+        entity.archetype = archetypeMap[entity.archetype];
+        entity.status = entityEvents ? EntityStatus::eNewlySpawned : EntityStatus::eSpawned;
+        if (entity.name != nullptr) {
+            entity.name = mecsStrDup(destinationWorld->allocators[MecsAllocationTag_Strings], entity.name);
+        }
+    });
+    archetypeMap.destroy(allocator);
+
+    // The sparse components are always copied, their instances are not shared
+    for (MecsComponentID component = 0; component < world->sparseComponents.count(); component++) {
+        const ComponentInfo& info = world->registry->components[component];
+        world->sparseComponents[component].forEach([&](MecsU32 entityIndex, const void* sourceInstance) {
+            void* destInstance = mecsWorldSparseStorage(destinationWorld, component).construct(columnsAllocator, info, entityIndex);
+            if (info.copy != nullptr) {
+                info.copy(sourceInstance, destInstance, info.size);
+            } else {
+                mecsMemCpy(static_cast<const char*>(sourceInstance), info.size, static_cast<char*>(destInstance), info.size);
+            }
+        });
+    }
+
+    // The entities keep their indices, so the hierarchy is copied as is
+    destinationWorld->hierarchy.resize(destinationWorld->allocators[MecsAllocationTag_World], world->hierarchy.count());
+    for (MecsSize i = 0; i < world->hierarchy.count(); i++) {
+        destinationWorld->hierarchy[i] = world->hierarchy[i];
+    }
+
+    // The resources the destination already has are overwritten
+    for (MecsComponentID component = 0; component < world->resources.count(); component++) {
+        const void* sourceResource = world->resources[component];
+        if (sourceResource == nullptr) { continue; }
+        const ComponentInfo& info = world->registry->components[component];
+        void* destResource = mecsWorldHasResource(destinationWorld, component)
+            ? mecsWorldGetResource(destinationWorld, component)
+            : mecsWorldAddResource(destinationWorld, component);
+        if (info.copy != nullptr) {
+            info.copy(sourceResource, destResource, info.size);
+        } else {
+            mecsMemCpy(static_cast<const char*>(sourceResource), info.size, static_cast<char*>(destResource), info.size);
+        }
+    }
+
+    if (!entityEvents) {
+        // The systems are handed the cloned entities as if they were just added, see mecsWorldDeserialize()
+        mecsPushSystemAddedEvents(destinationWorld);
+        return;
+    }
+    for (ArchetypeID archetypeID = 0; archetypeID < destinationWorld->archetypes.count(); archetypeID++) {
+        if (destinationWorld->archetypes[archetypeID].storage.rows() == 0) { continue; }
+        mecsPushClonedArchetypeEvents(destinationWorld, archetypeID);
+    }
+    for (MecsComponentID component = 0; component < destinationWorld->sparseComponents.count(); component++) {
+        destinationWorld->sparseComponents[component].forEach([&](MecsU32 entityIndex, void*) {
+            const MecsEntityID entityID = destinationWorld->entities.idAtIndex(entityIndex);
+            const ArchetypeID archetypeID = destinationWorld->entities.at(entityID)->archetype;
+            destinationWorld->newEvents.push(destinationWorld->allocators[MecsAllocationTag_Events], WorldEvent {
+                .kind = WorldEventKind::eNewComponent,
+                .entityID = entityID,
+                .componentID = component,
+                .archetypeID = archetypeID,
+                .newArchetypeID = archetypeID,
+            });
+        });
+    }
+}
+
+void* mecsWorldAddComponent(MecsWorld* const world, MecsEntityID entity, MecsComponentID component)
+{
+    MECS_ASSERT(world && world->registry);
+    MECS_ASSERT(entity != MECS_INVALID && "Invalid entity ID");
+    MecsEntity* ent = world->entities.at(entity);
+    MECS_ASSERT(ent->status != EntityStatus::eDestroying);
+    MecsComponentInfoInternal info = world->registry->components[component];
+
+    if (info.storage == MecsComponentStorage_Sparse) {
+        // The instance is created right away, but it's set up at the next flush like the other components
+        ComponentStorage& storage = mecsWorldSparseStorage(world, component);
+        const MecsU32 entityIndex = mecsEntityIDToIndex(entity);
+        if (storage.hasComponent(entityIndex)) {
+            return storage.getComponent(entityIndex);
+        }
+        void* outPtr = storage.construct(world->allocators[MecsAllocationTag_ArchetypeColumns], info, entityIndex);
+        world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
+                                                       .kind = WorldEventKind::eNewComponent,
+                                                       .entityID = entity,
+                                                       .componentID = component,
+                                                       .archetypeID = ent->archetype,
+                                                       .newArchetypeID = ent->archetype,
+                                                   });
+        return outPtr;
+    }
+
+    void* outPtr = nullptr;
+    if (ent->archetype == MECS_INVALID) {
+        ArchetypeID newArchetypeID = findNewArchetype(world, ent->archetype, component, true);
+        moveEntityToNewArchetype(world, entity, newArchetypeID);
+        Archetype& newArchetype = world->archetypes[newArchetypeID];
+        outPtr = newArchetype.storage.getRowComponent(component, ent->archetypeRow);
+
+        world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
+                                                       .kind = WorldEventKind::eNewComponent,
+                                                       .entityID = entity,
+                                                       .componentID = component,
+                                                       .archetypeID = MECS_INVALID,
+                                                   });
+    } else {
+        ArchetypeID oldArchetypeID = ent->archetype;
+        Archetype& oldArchetype = world->archetypes[oldArchetypeID];
 
         if (oldArchetype.storage.hasComponent(component)) {
             // We're re-adding an existing component
+            oldArchetype.storage.unshareColumn(world->allocators[MecsAllocationTag_ArchetypeColumns], component);
             outPtr = oldArchetype.storage.getRowComponent(component, ent->archetypeRow);
             return outPtr;
         } else {
@@ -512,7 +1226,7 @@ void* mecsWorldAddComponent(MecsWorld* const world, MecsEntityID entity, MecsCom
             moveEntityToNewArchetype(world, entity, newArchetypeID);
             Archetype& newArchetype = world->archetypes[newArchetypeID];
             outPtr = newArchetype.storage.getRowComponent(component, ent->archetypeRow);
-            world->newEvents.push(world->memAllocator, WorldEvent {
+            world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
                                                            .kind = WorldEventKind::eNewComponent,
                                                            .entityID = entity,
                                                            .componentID = component,
@@ -536,6 +1250,9 @@ bool mecsWorldEntityHasComponent(MecsWorld* world, MecsEntityID entity, MecsComp
 
     MecsEntity* ent = world->entities.at(entity);
     MecsComponentInfoInternal& info = world->registry->components[component];
+    if (info.storage == MecsComponentStorage_Sparse) {
+        return world->sparseComponents.isValid(component) && world->sparseComponents[component].hasComponent(mecsEntityIDToIndex(entity));
+    }
     const Archetype& archetype = world->archetypes[ent->archetype];
     return archetype.storage.hasComponent(component);
 }
@@ -546,10 +1263,285 @@ void* mecsWorldEntityGetComponent(MecsWorld* world, MecsEntityID entity, MecsCom
 
     MecsEntity* ent = world->entities.at(entity);
     MecsComponentInfoInternal& info = world->registry->components[component];
+    if (info.storage == MecsComponentStorage_Sparse) {
+        return mecsWorldSparseStorage(world, component).getComponent(mecsEntityIDToIndex(entity));
+    }
+    Archetype& archetype = world->archetypes[ent->archetype];
+    MECS_ASSERT(archetype.storage.hasComponent(component));
+    archetype.storage.unshareColumn(world->allocators[MecsAllocationTag_ArchetypeColumns], component);
+    if (component == archetype.sortComponent) {
+        mecsArchetypeRowChanged(world, archetype, ent->archetypeRow);
+    }
+    return archetype.storage.getRowComponent(component, ent->archetypeRow);
+}
+const void* mecsWorldEntityReadComponent(MecsWorld* world, MecsEntityID entity, MecsComponentID component)
+{
+    MECS_ASSERT(world && world->registry);
+    MECS_ASSERT(entity != MECS_INVALID && "Invalid entity ID");
+
+    const MecsEntity* ent = world->entities.at(entity);
+    if (mecsIsSparseComponent(world->registry, component)) {
+        return mecsWorldSparseStorage(world, component).getComponent(mecsEntityIDToIndex(entity));
+    }
     const Archetype& archetype = world->archetypes[ent->archetype];
     MECS_ASSERT(archetype.storage.hasComponent(component));
     return archetype.storage.getRowComponent(component, ent->archetypeRow);
 }
+void mecsWorldSetComponentEnabled(MecsWorld* world, MecsEntityID entity, MecsComponentID component, bool enabled)
+{
+    MECS_ASSERT(world && world->registry);
+    MECS_ASSERT(entity != MECS_INVALID && "Invalid entity ID");
+    MECS_ASSERT(!mecsIsSparseComponent(world->registry, component) && "The sparse components cannot be disabled, remove them instead");
+
+    const MecsEntity* ent = world->entities.at(entity);
+    MECS_ASSERT(ent->archetype != MECS_INVALID && "The component must have been added by a flush");
+    Archetype& archetype = world->archetypes[ent->archetype];
+    archetype.storage.setRowEnabled(world->allocators[MecsAllocationTag_ArchetypeColumns], component, ent->archetypeRow, enabled);
+}
+bool mecsWorldIsComponentEnabled(MecsWorld* world, MecsEntityID entity, MecsComponentID component)
+{
+    MECS_ASSERT(world && world->registry);
+    MECS_ASSERT(entity != MECS_INVALID && "Invalid entity ID");
+    MECS_ASSERT(mecsWorldEntityHasComponent(world, entity, component));
+
+    if (mecsIsSparseComponent(world->registry, component)) {
+        return true;
+    }
+    const MecsEntity* ent = world->entities.at(entity);
+    return world->archetypes[ent->archetype].storage.isRowEnabled(component, ent->archetypeRow);
+}
+
+// The node of the entity, creating the nodes up to it
+HierarchyNode& mecsWorldHierarchyNode(MecsWorld* world, MecsEntityID entityID)
+{
+    const MecsU32 index = mecsEntityIDToIndex(entityID);
+    const MecsSize oldCount = world->hierarchy.count();
+    if (index >= oldCount) {
+        world->hierarchy.ensureSize(world->allocators[MecsAllocationTag_World], index + 1);
+        // The new nodes are zeroed, but an unlinked node is made of MECS_INVALID
+        for (MecsSize i = oldCount; i < world->hierarchy.count(); i++) {
+            world->hierarchy[i] = HierarchyNode {};
+        }
+    }
+    return world->hierarchy[index];
+}
+
+const HierarchyNode* mecsWorldFindHierarchyNode(const MecsWorld* world, MecsEntityID entityID)
+{
+    const MecsU32 index = mecsEntityIDToIndex(entityID);
+    return world->hierarchy.isValid(index) ? &world->hierarchy[index] : nullptr;
+}
+
+MecsU32 mecsWorldEntityDepth(const MecsWorld* world, MecsEntityID entityID)
+{
+    const HierarchyNode* node = mecsWorldFindHierarchyNode(world, entityID);
+    return node != nullptr ? node->depth : 0;
+}
+
+int mecsCompareHierarchyRows(const void* lhs, const void* rhs, void* world)
+{
+    const HierarchyNode* lhsNode = mecsWorldFindHierarchyNode(static_cast<const MecsWorld*>(world), *static_cast<const MecsEntityID*>(lhs));
+    const HierarchyNode* rhsNode = mecsWorldFindHierarchyNode(static_cast<const MecsWorld*>(world), *static_cast<const MecsEntityID*>(rhs));
+    const MecsU32 lhsDepth = lhsNode != nullptr ? lhsNode->depth : 0;
+    const MecsU32 rhsDepth = rhsNode != nullptr ? rhsNode->depth : 0;
+    if (lhsDepth != rhsDepth) {
+        return lhsDepth < rhsDepth ? -1 : 1;
+    }
+    // The siblings are kept next to each other
+    const MecsEntityID lhsParent = lhsNode != nullptr ? lhsNode->parent : MECS_INVALID;
+    const MecsEntityID rhsParent = rhsNode != nullptr ? rhsNode->parent : MECS_INVALID;
+    return lhsParent < rhsParent ? -1 : (lhsParent > rhsParent ? 1 : 0);
+}
+
+// Unlinks the entity from its parent and siblings, keeping its children
+void mecsWorldDetachFromParent(MecsWorld* world, HierarchyNode& node)
+{
+    if (node.parent == MECS_INVALID) {
+        return;
+    }
+    HierarchyNode& parent = world->hierarchy[mecsEntityIDToIndex(node.parent)];
+    if (node.previousSibling != MECS_INVALID) {
+        world->hierarchy[mecsEntityIDToIndex(node.previousSibling)].nextSibling = node.nextSibling;
+    } else {
+        parent.firstChild = node.nextSibling;
+    }
+    if (node.nextSibling != MECS_INVALID) {
+        world->hierarchy[mecsEntityIDToIndex(node.nextSibling)].previousSibling = node.previousSibling;
+    }
+    parent.numChildren--;
+    node.parent = MECS_INVALID;
+    node.previousSibling = MECS_INVALID;
+    node.nextSibling = MECS_INVALID;
+}
+
+// Sets the depth of the entity and of its descendants, their rows move in the hierarchy order
+void mecsWorldUpdateDepths(MecsWorld* world, MecsEntityID entityID, MecsU32 depth)
+{
+    const MecsAllocator& alloc = world->allocators[MecsAllocationTag_World];
+    MecsVec<MecsEntityID> pending;
+    world->hierarchy[mecsEntityIDToIndex(entityID)].depth = depth;
+    pending.push(alloc, entityID);
+    while (!pending.empty()) {
+        const MecsEntityID current = pending.pop();
+        const HierarchyNode& node = world->hierarchy[mecsEntityIDToIndex(current)];
+        const MecsEntity* ent = world->entities.at(current);
+        if (ent->archetype != MECS_INVALID) {
+            mecsArchetypeRowChanged(world, world->archetypes[ent->archetype], ent->archetypeRow);
+        }
+        for (MecsEntityID child = node.firstChild; child != MECS_INVALID; child = world->hierarchy[mecsEntityIDToIndex(child)].nextSibling) {
+            world->hierarchy[mecsEntityIDToIndex(child)].depth = node.depth + 1;
+            pending.push(alloc, child);
+        }
+    }
+    pending.destroy(alloc);
+}
+
+void mecsWorldEntitySetParent(MecsWorld* world, MecsEntityID child, MecsEntityID parent)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(world->entities.at(child) != nullptr && "Invalid entity ID");
+    MECS_ASSERT(world->entities.at(child)->status != EntityStatus::eDestroying && "Cannot move an entity that is being destroyed");
+    MECS_ASSERT((parent == MECS_INVALID || world->entities.at(parent) != nullptr) && "Invalid parent ID");
+    for (MecsEntityID ancestor = parent; ancestor != MECS_INVALID; ancestor = mecsWorldEntityGetParent(world, ancestor)) {
+        MECS_ASSERT(ancestor != child && "An entity cannot be its own ancestor");
+    }
+
+    // Both nodes are created before taking references to them
+    if (parent != MECS_INVALID) {
+        mecsWorldHierarchyNode(world, parent);
+    }
+    HierarchyNode& node = mecsWorldHierarchyNode(world, child);
+    if (node.parent == parent) {
+        return;
+    }
+
+    mecsWorldDetachFromParent(world, node);
+    MecsU32 depth = 0;
+    if (parent != MECS_INVALID) {
+        HierarchyNode& parentNode = world->hierarchy[mecsEntityIDToIndex(parent)];
+        node.parent = parent;
+        node.nextSibling = parentNode.firstChild;
+        if (parentNode.firstChild != MECS_INVALID) {
+            world->hierarchy[mecsEntityIDToIndex(parentNode.firstChild)].previousSibling = child;
+        }
+        parentNode.firstChild = child;
+        parentNode.numChildren++;
+        depth = parentNode.depth + 1;
+    }
+    mecsWorldUpdateDepths(world, child, depth);
+}
+
+MecsEntityID mecsWorldEntityGetParent(MecsWorld* world, MecsEntityID entity)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    const HierarchyNode* node = mecsWorldFindHierarchyNode(world, entity);
+    return node != nullptr ? node->parent : MECS_INVALID;
+}
+
+MecsSize mecsWorldEntityGetNumChildren(MecsWorld* world, MecsEntityID entity)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    const HierarchyNode* node = mecsWorldFindHierarchyNode(world, entity);
+    return node != nullptr ? node->numChildren : 0;
+}
+
+MecsEntityID mecsWorldEntityGetFirstChild(MecsWorld* world, MecsEntityID entity)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    const HierarchyNode* node = mecsWorldFindHierarchyNode(world, entity);
+    return node != nullptr ? node->firstChild : MECS_INVALID;
+}
+
+MecsEntityID mecsWorldEntityGetNextSibling(MecsWorld* world, MecsEntityID entity)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    const HierarchyNode* node = mecsWorldFindHierarchyNode(world, entity);
+    return node != nullptr ? node->nextSibling : MECS_INVALID;
+}
+
+MecsU32 mecsWorldEntityGetDepth(MecsWorld* world, MecsEntityID entity)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    return mecsWorldEntityDepth(world, entity);
+}
+
+void mecsWorldUnlinkHierarchy(MecsWorld* world, MecsEntityID entityID)
+{
+    const MecsU32 index = mecsEntityIDToIndex(entityID);
+    if (!world->hierarchy.isValid(index)) {
+        return;
+    }
+    HierarchyNode& node = world->hierarchy[index];
+    mecsWorldDetachFromParent(world, node);
+    // The children are being destroyed too, see mecsWorldDestroyEntity()
+    MecsEntityID child = node.firstChild;
+    while (child != MECS_INVALID) {
+        HierarchyNode& childNode = world->hierarchy[mecsEntityIDToIndex(child)];
+        child = childNode.nextSibling;
+        childNode.parent = MECS_INVALID;
+        childNode.previousSibling = MECS_INVALID;
+        childNode.nextSibling = MECS_INVALID;
+    }
+    node = HierarchyNode {};
+}
+
+void* mecsWorldAddResource(MecsWorld* world, MecsComponentID component)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(world->registry->components.isValid(component) && "Invalid component ID");
+    const ComponentInfo& info = world->registry->components[component];
+    MECS_ASSERT(info.size > 0 && "A tag cannot be a resource");
+    if (!world->resources.isValid(component)) {
+        world->resources.resize(world->allocators[MecsAllocationTag_World], component + 1);
+    }
+    MECS_ASSERT(world->resources[component] == nullptr && "The world already has this resource");
+
+    char* resource = mecsCallocAligned<char>(world->allocators[MecsAllocationTag_World], info.size, info.align);
+    memset(resource, 0, info.size);
+    if (info.init != nullptr) { info.init(resource); }
+    world->resources[component] = resource;
+    world->resourceVersions.ensureSize(world->allocators[MecsAllocationTag_World], component + 1);
+    world->resourceVersions[component] = ++world->resourceTick;
+    return resource;
+}
+
+void* mecsWorldGetResource(MecsWorld* world, MecsComponentID component)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    if (!world->resources.isValid(component) || world->resources[component] == nullptr) {
+        return nullptr;
+    }
+    world->resourceVersions[component] = ++world->resourceTick;
+    return world->resources[component];
+}
+
+MecsU64 mecsWorldGetResourceVersion(MecsWorld* world, MecsComponentID component)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    return world->resourceVersions.isValid(component) ? world->resourceVersions[component] : 0;
+}
+
+const void* mecsWorldReadResource(MecsWorld* world, MecsComponentID component)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    return world->resources.isValid(component) ? world->resources[component] : nullptr;
+}
+
+bool mecsWorldHasResource(MecsWorld* world, MecsComponentID component)
+{
+    return mecsWorldReadResource(world, component) != nullptr;
+}
+
+void mecsWorldRemoveResource(MecsWorld* world, MecsComponentID component)
+{
+    MECS_ASSERT(mecsWorldHasResource(world, component) && "The world doesn't have this resource");
+    const ComponentInfo& info = world->registry->components[component];
+    char* resource = static_cast<char*>(world->resources[component]);
+    if (info.destroy != nullptr) { info.destroy(resource); }
+    mecsFree(world->allocators[MecsAllocationTag_World], resource);
+    world->resources[component] = nullptr;
+}
+
 void mecsWorldRemoveComponent(MecsWorld* world, MecsEntityID entity, MecsComponentID component)
 {
     MECS_ASSERT(world && world->registry);
@@ -560,7 +1552,7 @@ void mecsWorldRemoveComponent(MecsWorld* world, MecsEntityID entity, MecsCompone
     }
 
     // Component removal is deferred to the next flushUpdates
-    world->newEvents.push(world->memAllocator, WorldEvent {
+    world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
                                                    .kind = WorldEventKind::eDestroyComponent,
                                                    .entityID = entity,
                                                    .componentID = component,
@@ -572,7 +1564,9 @@ MecsSize mecsWorldEntityGetNumComponents(MecsWorld* world, MecsEntityID entity)
 
     MecsEntity* ent = world->entities.at(entity);
     const Archetype& archetype = world->archetypes[ent->archetype];
-    return archetype.componentIDs.count();
+    MecsSize numComponents = archetype.componentIDs.count();
+    mecsForEachSparseComponent(world, entity, [&](MecsComponentID, void*) { numComponents++; });
+    return numComponents;
 }
 
 MecsPrefabID mecsWorldEntityGetPrefabID(MecsWorld* world, MecsEntityID entity)
@@ -587,8 +1581,15 @@ MecsComponentID mecsWorldEntityGetComponentByIndex(MecsWorld* world, MecsEntityI
 {
     MecsEntity* ent = world->entities.at(entity);
     const Archetype& archetype = world->archetypes[ent->archetype];
-    if (!archetype.componentIDs.isValid(index)) { return MECS_INVALID; }
-    return archetype.componentIDs[index];
+    if (archetype.componentIDs.isValid(index)) { return archetype.componentIDs[index]; }
+
+    // The sparse components come after the components of the archetype
+    MecsSize sparseIndex = index - archetype.componentIDs.count();
+    MecsComponentID found = MECS_INVALID;
+    mecsForEachSparseComponent(world, entity, [&](MecsComponentID component, void*) {
+        if (sparseIndex-- == 0) { found = component; }
+    });
+    return found;
 }
 
 void mecsWorldDestroyEntity(MecsWorld* const world, MecsEntityID entityID)
@@ -598,10 +1599,32 @@ void mecsWorldDestroyEntity(MecsWorld* const world, MecsEntityID entityID)
     MECS_ASSERT(ent != nullptr);
     if (ent->status == EntityStatus::eDestroying) { return; }
     ent->status = EntityStatus::eDestroying;
-    world->newEvents.push(world->memAllocator, WorldEvent {
+    world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
                                                    .kind = WorldEventKind::eDestroyEntity,
                                                    .entityID = entityID,
                                                });
+
+    // The descendants are destroyed with the entity, without recursing so that deep hierarchies don't overflow the stack
+    if (mecsWorldEntityGetFirstChild(world, entityID) == MECS_INVALID) {
+        return;
+    }
+    const MecsAllocator& alloc = world->allocators[MecsAllocationTag_World];
+    MecsVec<MecsEntityID> pending;
+    pending.push(alloc, entityID);
+    while (!pending.empty()) {
+        const MecsEntityID parent = pending.pop();
+        for (MecsEntityID child = mecsWorldEntityGetFirstChild(world, parent); child != MECS_INVALID; child = mecsWorldEntityGetNextSibling(world, child)) {
+            MecsEntity* childEnt = world->entities.at(child);
+            if (childEnt->status == EntityStatus::eDestroying) { continue; }
+            childEnt->status = EntityStatus::eDestroying;
+            world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
+                                                           .kind = WorldEventKind::eDestroyEntity,
+                                                           .entityID = child,
+                                                       });
+            pending.push(alloc, child);
+        }
+    }
+    pending.destroy(alloc);
 }
 
 void mecsWorldEntityChanged(MecsWorld* world, MecsEntityID entityID)
@@ -610,7 +1633,10 @@ void mecsWorldEntityChanged(MecsWorld* world, MecsEntityID entityID)
     MecsEntity* ent = world->entities.at(entityID);
     MECS_ASSERT(ent != nullptr && "Invalid entity ID");
     if (ent->status == EntityStatus::eDestroying) { return; }
-    world->newEvents.push(world->memAllocator, WorldEvent { .kind = WorldEventKind::eRecreateEntity, .entityID = entityID });
+    if (ent->archetype != MECS_INVALID) {
+        mecsArchetypeRowChanged(world, world->archetypes[ent->archetype], ent->archetypeRow);
+    }
+    world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent { .kind = WorldEventKind::eRecreateEntity, .entityID = entityID });
 }
 
 void mecsOnEntityRecreate(MecsWorld* world, MecsEntityID entityID, void* updateData)
@@ -624,26 +1650,320 @@ void mecsOnEntityRecreate(MecsWorld* world, MecsEntityID entityID, void* updateD
     MecsRegistry* registry = world->registry;
     MECS_ASSERT(registry);
 
-    const Archetype& arch = world->archetypes[ent->archetype];
+    Archetype& arch = world->archetypes[ent->archetype];
     arch.componentIDs.forEach([&](MecsComponentID component) {
-        void* pComponent = arch.storage.getRowComponent(component, ent->archetypeRow);
         const ComponentInfo& info = registry->components[component];
         if (info.teardown != nullptr) {
-            info.teardown(world, entityID, pComponent, updateData);
+            arch.storage.unshareColumn(world->allocators[MecsAllocationTag_ArchetypeColumns], component);
+            info.teardown(world, entityID, arch.storage.getRowComponent(component, ent->archetypeRow), updateData);
         }
     });
+    mecsForEachSparseComponent(world, entityID, [&](MecsComponentID component, void* instance) {
+        const ComponentInfo& info = registry->components[component];
+        if (info.teardown != nullptr) { info.teardown(world, entityID, instance, updateData); }
+    });
 
     arch.componentIDs.forEach([&](MecsComponentID component) {
-        void* pComponent = arch.storage.getRowComponent(component, ent->archetypeRow);
         const ComponentInfo& info = registry->components[component];
         if (info.setup != nullptr) {
-            info.setup(world, entityID, pComponent, updateData);
+            arch.storage.unshareColumn(world->allocators[MecsAllocationTag_ArchetypeColumns], component);
+            info.setup(world, entityID, arch.storage.getRowComponent(component, ent->archetypeRow), updateData);
         }
     });
+    mecsForEachSparseComponent(world, entityID, [&](MecsComponentID component, void* instance) {
+        const ComponentInfo& info = registry->components[component];
+        if (info.setup != nullptr) { info.setup(world, entityID, instance, updateData); }
+    });
 }
-void mecsWorldFlushEvents(MecsWorld* world, void* updateData)
+// The order in which the batched flush processes each kind of event
+enum WorldEventBatchPhase : MecsU32 {
+    WorldEventBatchPhase_SpawnEntity,
+    WorldEventBatchPhase_AddComponent,
+    WorldEventBatchPhase_ChangeComponent,
+    WorldEventBatchPhase_RecreateEntity,
+    WorldEventBatchPhase_RemoveComponent,
+    WorldEventBatchPhase_DestroyEntity,
+    WorldEventBatchPhase_Count,
+};
+
+// Reported to the trace hooks as the flush phase names
+constexpr const char* kWorldEventBatchPhaseNames[WorldEventBatchPhase_Count] = {
+    "spawn entities",
+    "add components",
+    "change components",
+    "recreate entities",
+    "remove components",
+    "destroy entities",
+};
+
+// Queues the Removed events of the removal keys in [begin, end). A component removed twice before the flush is handed to
+// the observers once, as the in-order flush does
+void mecsQueueBatchRemovals(MecsWorld* world, const MecsVec<WorldEventBatchKey>& keys, MecsSize begin, MecsSize end)
 {
-    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    // The removals are sorted by entity and component to find the repeated ones, then back in the order of the keys
+    MecsVec<WorldEventBatchKey>& removals = world->batchRemovalKeys;
+    removals.clear();
+    for (MecsSize i = begin; i < end; i++) {
+        const WorldEvent& event = world->newEvents[keys[i].eventIndex];
+        const MecsComponentID component = event.kind == WorldEventKind::eDestroyComponent ? event.componentID : MECS_INVALID;
+        removals.push(world->allocators[MecsAllocationTag_Events], WorldEventBatchKey {
+                                                                  .phase = 0,
+                                                                  .first = event.entityID,
+                                                                  .second = component,
+                                                                  .eventIndex = static_cast<MecsU32>(i),
+                                                              });
+    }
+    WorldEventBatchKey* first = removals.atPtr(0);
+    WorldEventBatchKey* last = first + removals.count();
+    std::sort(first, last, [](const WorldEventBatchKey& lhs, const WorldEventBatchKey& rhs) {
+        if (lhs.first != rhs.first) { return lhs.first < rhs.first; }
+        if (lhs.second != rhs.second) { return lhs.second < rhs.second; }
+        return lhs.eventIndex < rhs.eventIndex;
+    });
+    last = std::unique(first, last, [](const WorldEventBatchKey& lhs, const WorldEventBatchKey& rhs) {
+        return lhs.first == rhs.first && lhs.second == rhs.second;
+    });
+    std::sort(first, last, [](const WorldEventBatchKey& lhs, const WorldEventBatchKey& rhs) { return lhs.eventIndex < rhs.eventIndex; });
+    for (const WorldEventBatchKey* removal = first; removal != last; removal++) {
+        mecsQueueRemovals(world, removal->first, removal->second);
+    }
+}
+
+// Flushes the events in [begin, end), which must not contain any eSystemAdded event
+void mecsFlushEventSegmentBatched(MecsWorld* world, MecsSize begin, MecsSize end, void* updateData)
+{
+    if (begin == end) { return; }
+
+    MecsVec<WorldEventBatchKey>& keys = world->batchKeys;
+    keys.clear();
+    MecsSize phaseCounts[WorldEventBatchPhase_Count] = {};
+    for (MecsSize i = begin; i < end; i++) {
+        const WorldEvent& event = world->newEvents[i];
+        WorldEventBatchKey key { .phase = 0, .first = 0, .second = 0, .eventIndex = static_cast<MecsU32>(i) };
+        switch (event.kind) {
+        case WorldEventKind::eNewEntity: {
+            key.phase = WorldEventBatchPhase_SpawnEntity;
+            break;
+        }
+        case WorldEventKind::eNewComponent: {
+            key.phase = WorldEventBatchPhase_AddComponent;
+            key.first = event.archetypeID;
+            key.second = event.newArchetypeID;
+            break;
+        }
+        case WorldEventKind::eUpdateComponent: {
+            key.phase = WorldEventBatchPhase_ChangeComponent;
+            key.first = event.componentID;
+            break;
+        }
+        case WorldEventKind::eRecreateEntity: {
+            key.phase = WorldEventBatchPhase_RecreateEntity;
+            break;
+        }
+        case WorldEventKind::eDestroyComponent: {
+            key.phase = WorldEventBatchPhase_RemoveComponent;
+            key.first = world->entities.at(event.entityID)->archetype;
+            key.second = event.componentID;
+            break;
+        }
+        case WorldEventKind::eDestroyEntity: {
+            key.phase = WorldEventBatchPhase_DestroyEntity;
+            key.first = world->entities.at(event.entityID)->archetype;
+            break;
+        }
+        case WorldEventKind::eSystemAdded: {
+            MECS_ASSERT(false && "eSystemAdded events must split the flush in segments");
+            break;
+        }
+        }
+        keys.push(world->allocators[MecsAllocationTag_Events], key);
+        phaseCounts[key.phase]++;
+    }
+
+    // The event index is part of the key, so events belonging to the same group keep their relative order
+    std::sort(keys.atPtr(0), keys.atPtr(0) + keys.count(), [](const WorldEventBatchKey& lhs, const WorldEventBatchKey& rhs) {
+        if (lhs.phase != rhs.phase) { return lhs.phase < rhs.phase; }
+        if (lhs.first != rhs.first) { return lhs.first < rhs.first; }
+        if (lhs.second != rhs.second) { return lhs.second < rhs.second; }
+        return lhs.eventIndex < rhs.eventIndex;
+    });
+
+    // The systems delta only depends on the archetype transition, so it's fetched again only when the transition changes
+    // A newArchetype of MECS_INVALID stands for a destroyed entity
+    ArchetypeID transitionOld = MECS_INVALID;
+    ArchetypeID transitionNew = MECS_INVALID;
+    bool transitionResolved = false;
+    auto resolveTransition = [&](ArchetypeID oldArchetype, ArchetypeID newArchetype) {
+        if (transitionResolved && transitionOld == oldArchetype && transitionNew == newArchetype) { return; }
+
+        // See mecsAddEntityToNewMatchingSystems() and mecsRemoveEntityFromUnmatchingSystems()
+        const ArchetypeEdge& edge = findArchetypeEdge(world, oldArchetype, newArchetype);
+        world->batchAddedSystems.clear();
+        world->batchRemovedSystems.clear();
+        edge.addedSystems.forEach([&](const MecsSystemRef& ref) {
+            const MecsSystem& system = world->schedules[ref.schedule].systems[ref.system];
+            if (system.timestamp == MECS_INVALID) { return; }
+            world->batchAddedSystems.push(world->allocators[MecsAllocationTag_World], ref);
+        });
+        edge.removedSystems.forEach([&](const MecsSystemRef& ref) {
+            const MecsSystem& system = world->schedules[ref.schedule].systems[ref.system];
+            if (system.timestamp == MECS_INVALID || system.timestamp == world->timestamp) { return; }
+            world->batchRemovedSystems.push(world->allocators[MecsAllocationTag_World], ref);
+        });
+        transitionOld = oldArchetype;
+        transitionNew = newArchetype;
+        transitionResolved = true;
+    };
+    auto notifyAdded = [&](MecsEntityID entityID) {
+        world->batchAddedSystems.forEach([&](const MecsSystemRef& ref) {
+            const MecsSystem& system = world->schedules[ref.schedule].systems[ref.system];
+            mecsNotifySystem(world, system, updateData, entityID, true);
+        });
+    };
+    auto notifyRemoved = [&](MecsEntityID entityID) {
+        world->batchRemovedSystems.forEach([&](const MecsSystemRef& ref) {
+            const MecsSystem& system = world->schedules[ref.schedule].systems[ref.system];
+            mecsNotifySystem(world, system, updateData, entityID, false);
+        });
+    };
+
+    // Removing the same component from entities of the same archetype always leads to the same archetype
+    ArchetypeID removalSource = MECS_INVALID;
+    MecsComponentID removalComponent = MECS_INVALID;
+    ArchetypeID removalTarget = MECS_INVALID;
+
+    // The keys are sorted by phase, so a phase ends when the next key belongs to another one
+    const bool tracing = mecsIsTracing(world);
+    MecsU32 tracedPhase = WorldEventBatchPhase_Count;
+    MecsTraceEvent phaseEvent {};
+
+    // The Removed events of a phase are handed to the observers together, before any component of the phase is torn down
+    MecsU32 observedPhase = WorldEventBatchPhase_Count;
+    MecsSize keyIndex = 0;
+
+    const MecsRegistry* registry = world->registry;
+    keys.forEach([&](const WorldEventBatchKey& key) {
+        if (tracing && key.phase != tracedPhase) {
+            if (tracedPhase != WorldEventBatchPhase_Count) { mecsTraceEnd(world, phaseEvent); }
+            tracedPhase = key.phase;
+            phaseEvent = mecsFlushPhaseEvent(kWorldEventBatchPhaseNames[key.phase], phaseCounts[key.phase]);
+            mecsTraceBegin(world, phaseEvent);
+        }
+        if (key.phase != observedPhase && !world->observers.empty()) {
+            observedPhase = key.phase;
+            if (key.phase == WorldEventBatchPhase_RemoveComponent || key.phase == WorldEventBatchPhase_DestroyEntity) {
+                mecsDeliverObservers(world, updateData);
+                mecsQueueBatchRemovals(world, keys, keyIndex, keyIndex + phaseCounts[key.phase]);
+                mecsDeliverObservers(world, updateData);
+            }
+        }
+        keyIndex++;
+
+        const WorldEvent& event = world->newEvents[key.eventIndex];
+        switch (event.kind) {
+        case WorldEventKind::eNewEntity: {
+            mecsOnNewEntitySpawned(world, event.entityID, updateData);
+            break;
+        }
+        case WorldEventKind::eNewComponent: {
+            const ComponentInfo& componentInfo = registry->components.at(event.componentID);
+            if (componentInfo.setup != nullptr) { componentInfo.setup(world, event.entityID, mecsWorldEntityGetComponent(world, event.entityID, event.componentID), updateData); }
+            mecsQueueObservers(world, event.entityID, event.componentID, MecsObserverEvent_Added, nullptr);
+            if (componentInfo.storage == MecsComponentStorage_Sparse) {
+                break; // The entity stays in its archetype
+            }
+
+            resolveTransition(event.archetypeID, event.newArchetypeID);
+            if (world->entities.at(event.entityID)->status != EntityStatus::eDestroying) {
+                notifyAdded(event.entityID);
+            }
+            break;
+        }
+        case WorldEventKind::eUpdateComponent: {
+            mecsQueueObservers(world, event.entityID, event.componentID, MecsObserverEvent_Changed, nullptr);
+            break;
+        }
+        case WorldEventKind::eRecreateEntity: {
+            mecsOnEntityRecreate(world, event.entityID, updateData);
+            break;
+        }
+        case WorldEventKind::eDestroyComponent: {
+            const ComponentInfo& componentInfo = registry->components.at(event.componentID);
+            if (componentInfo.storage == MecsComponentStorage_Sparse) {
+                mecsRemoveSparseComponent(world, event.entityID, event.componentID, updateData);
+                break;
+            }
+            if (componentInfo.teardown != nullptr) { componentInfo.teardown(world, event.entityID, mecsWorldEntityGetComponent(world, event.entityID, event.componentID), updateData); }
+
+            const ArchetypeID oldArchetypeID = world->entities.at(event.entityID)->archetype;
+            if (oldArchetypeID != removalSource || event.componentID != removalComponent) {
+                removalSource = oldArchetypeID;
+                removalComponent = event.componentID;
+                removalTarget = findNewArchetype(world, oldArchetypeID, event.componentID, false);
+            }
+            if (oldArchetypeID == removalTarget) {
+                break; // The entity does not have the component
+            }
+
+            resolveTransition(oldArchetypeID, removalTarget);
+            if ((world->entities.at(event.entityID)->entityFlags & MecsEntityFlags_AliveOneFrame) == 0) {
+                notifyRemoved(event.entityID);
+            }
+            moveEntityToNewArchetype(world, event.entityID, removalTarget);
+            break;
+        }
+        case WorldEventKind::eDestroyEntity: {
+            MecsEntity* ent = world->entities.at(event.entityID);
+            const Archetype& entityArchetype = world->archetypes[ent->archetype];
+            entityArchetype.componentIDs.forEach([&](MecsComponentID componentID) {
+                const ComponentInfo& componentInfo = registry->components.at(componentID);
+                if (componentInfo.teardown != nullptr) { componentInfo.teardown(world, event.entityID, mecsWorldEntityGetComponent(world, event.entityID, componentID), updateData); }
+            });
+            mecsRemoveSparseComponents(world, event.entityID, updateData);
+
+            resolveTransition(ent->archetype, MECS_INVALID);
+            if ((ent->entityFlags & MecsEntityFlags_AliveOneFrame) == 0) {
+                notifyRemoved(event.entityID);
+            }
+
+            freeEntityRow(world, *ent);
+            mecsWorldUnlinkHierarchy(world, event.entityID);
+            world->entities.remove(world->allocators[MecsAllocationTag_Entities], event.entityID);
+            break;
+        }
+        case WorldEventKind::eSystemAdded: {
+            break;
+        }
+        }
+    });
+    if (tracedPhase != WorldEventBatchPhase_Count) { mecsTraceEnd(world, phaseEvent); }
+}
+
+void mecsWorldFlushEventsBatched(MecsWorld* world, void* updateData)
+{
+    // Adding a system changes which systems an archetype transition affects,
+    // so the events are batched only between two eSystemAdded events
+    const MecsSize numEvents = world->newEvents.count();
+    MecsSize segmentBegin = 0;
+    for (MecsSize i = 0; i < numEvents; i++) {
+        const WorldEvent& event = world->newEvents[i];
+        if (event.kind != WorldEventKind::eSystemAdded) { continue; }
+
+        mecsFlushEventSegmentBatched(world, segmentBegin, i, updateData);
+        const MecsTraceEvent phaseEvent = mecsFlushPhaseEvent("add system", 1);
+        mecsTraceBegin(world, phaseEvent);
+        mecsOnNewSystemAdded(world, event.entityID, event.componentID, event.archetypeID, updateData);
+        mecsTraceEnd(world, phaseEvent);
+        segmentBegin = i + 1;
+    }
+    mecsFlushEventSegmentBatched(world, segmentBegin, numEvents, updateData);
+    MECS_ASSERT(world->newEvents.count() == numEvents && "Events were pushed during a flush! This is not allowed");
+}
+
+void mecsWorldFlushEventsInOrder(MecsWorld* world, void* updateData)
+{
+    const MecsTraceEvent phaseEvent = mecsFlushPhaseEvent("events", world->newEvents.count());
+    mecsTraceBegin(world, phaseEvent);
     world->newEvents.forEach([&](const WorldEvent& event) {
         switch (event.kind) {
         case WorldEventKind::eNewEntity: {
@@ -658,11 +1978,14 @@ void mecsWorldFlushEvents(MecsWorld* world, void* updateData)
             mecsOnEntityRecreate(world, event.entityID, updateData);
             break;
         }
-        case WorldEventKind::eNewComponent:
-        case WorldEventKind::eUpdateComponent: {
+        case WorldEventKind::eNewComponent: {
             mecsOnComponentAddedToEntity(world, event.entityID, event.componentID, event.archetypeID, event.newArchetypeID, updateData);
             break;
         }
+        case WorldEventKind::eUpdateComponent: {
+            mecsQueueObservers(world, event.entityID, event.componentID, MecsObserverEvent_Changed, nullptr);
+            break;
+        }
         case WorldEventKind::eDestroyComponent: {
             mecsOnComponentRemovedFromEntity(world, event.entityID, event.componentID, updateData);
             break;
@@ -673,8 +1996,42 @@ void mecsWorldFlushEvents(MecsWorld* world, void* updateData)
         }
         }
     });
+    mecsTraceEnd(world, phaseEvent);
+}
+
+void mecsWorldFlushEvents(MecsWorld* world, void* updateData)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    const MecsTraceEvent flushEvent {
+        .scope = MecsTraceScope_Flush,
+        .name = "flush",
+        .schedule = MECS_INVALID,
+        .system = MECS_INVALID,
+        .numItems = world->newEvents.count(),
+    };
+    mecsTraceBegin(world, flushEvent);
+
+    if ((world->worldFlags & MecsWorldFlags_BatchedFlush) != 0) {
+        mecsWorldFlushEventsBatched(world, updateData);
+    } else {
+        mecsWorldFlushEventsInOrder(world, updateData);
+    }
+
+    const MecsTraceEvent observeEvent = mecsFlushPhaseEvent("notify observers", world->pendingObservers.count());
+    mecsTraceBegin(world, observeEvent);
+    const MecsSize numEvents = world->newEvents.count();
+    mecsDeliverObservers(world, updateData);
+    MECS_ASSERT(world->newEvents.count() == numEvents && "Observers must not push events");
+    mecsTraceEnd(world, observeEvent);
+
+    const MecsTraceEvent notifyEvent = mecsFlushPhaseEvent("notify systems", world->pendingNotificationBatches.count());
+    mecsTraceBegin(world, notifyEvent);
+    mecsDeliverPendingNotificationBatches(world, updateData);
+    mecsTraceEnd(world, notifyEvent);
+
     world->newEvents.clear();
     world->timestamp ++;
+    mecsTraceEnd(world, flushEvent);
 }
 
 MecsIterator* mecsWorldAcquireIterator(MecsWorld* world)
@@ -684,11 +2041,11 @@ MecsIterator* mecsWorldAcquireIterator(MecsWorld* world)
     if (!world->reusableIterators.empty()) {
         itr = world->reusableIterators.pop();
     } else {
-        itr = mecsAlloc<MecsIterator>(world->memAllocator);
+        itr = mecsAlloc<MecsIterator>(world->allocators[MecsAllocationTag_Iterators]);
         itr->world = world;
     }
 
-    world->acquiredIterators.push(world->memAllocator, itr);
+    world->acquiredIterators.push(world->allocators[MecsAllocationTag_Iterators], itr);
     MECS_ASSERT(itr->status == IteratorStatus::eReleased);
     itr->status = IteratorStatus::eInitializing;
     return itr;
@@ -701,10 +2058,20 @@ void mecsWorldReleaseIterator(MecsWorld* world, MecsIterator* iterator)
     iterator->status = IteratorStatus::eReleased;
 
     iterator->components.clear();
+    iterator->sparseArguments.clear();
+    iterator->enabledRows.clear();
+    iterator->archetypeGroups.clear();
+    iterator->groupBy = nullptr;
+    iterator->groupByUserData = nullptr;
+    iterator->sortComponent = MECS_INVALID;
+    iterator->sortCompare = nullptr;
+    iterator->sortUserData = nullptr;
+    iterator->hierarchyOrder = false;
+    iterator->hierarchyCursors.clear();
     iterator->componentSet.clear();
     iterator->blacklistComponentSet.clear();
     iterator->archetypes.clear();
-    world->reusableIterators.push(world->memAllocator, iterator);
+    world->reusableIterators.push(world->allocators[MecsAllocationTag_Iterators], iterator);
     bool removed = world->acquiredIterators.remove(iterator);
     MECS_ASSERT(removed);
 }
@@ -726,6 +2093,10 @@ MecsSystemID mecsWorldDefineSystem(MecsWorld* world, const MecsDefineSystemInfo*
     system.onEntityAdded = systemInfo->onEntityAdded;
     system.systemRun = systemInfo->systemRun;
     system.onEntityRemoved = systemInfo->onEntityRemoved;
+    system.onEntitiesAdded = systemInfo->onEntitiesAdded;
+    system.onEntitiesRemoved = systemInfo->onEntitiesRemoved;
+    system.notificationBatch = MECS_INVALID;
+    system.systemName = mecsStrDup(world->allocators[MecsAllocationTag_Strings], systemInfo->systemName);
 
     system.systemIterator = mecsWorldAcquireIterator(world);
     BitSet systemArchetypeBitset;
@@ -735,30 +2106,117 @@ MecsSystemID mecsWorldDefineSystem(MecsWorld* world, const MecsDefineSystemInfo*
         if (component == MECS_INVALID) { continue; }
         MecsIteratorFilter filter = systemInfo->pFilters[i];
         mecsIterComponentFilter(system.systemIterator, component, filter, i);
+        if (filter == Access || filter == Read) {
+            system.access.push(world->allocators[MecsAllocationTag_World], SystemAccess { .component = component, .resource = false, .write = filter == Access });
+        }
 
-        if (filter == With || filter == Access) {
-            systemArchetypeBitset.set(world->memAllocator, component, true);
+        // The sparse components are not part of the archetypes, the iterator checks them for each entity
+        if ((filter == With || filter == Access || filter == Read) && !mecsIsSparseComponent(world->registry, component)) {
+            systemArchetypeBitset.set(world->allocators[MecsAllocationTag_World], component, true);
         }
     }
+    if (systemInfo->numResources > 0) {
+        MECS_ASSERT(systemInfo->pResources != nullptr && "if systemInfo->numResources is not 0, systemInfo->pResources must not be null");
+        MECS_ASSERT(systemInfo->pResourceFilters != nullptr && "if systemInfo->numResources is not 0, systemInfo->pResourceFilters must not be null");
+    }
+    for (MecsU32 i = 0; i < systemInfo->numResources; i++) {
+        const MecsIteratorFilter filter = systemInfo->pResourceFilters[i];
+        MECS_ASSERT((filter == Access || filter == Read) && "A resource can only be accessed with Access or Read");
+        system.access.push(world->allocators[MecsAllocationTag_World], SystemAccess { .component = systemInfo->pResources[i], .resource = true, .write = filter == Access });
+    }
+    MECS_ASSERT(((systemInfo->runConditions & MecsSystemRunConditions_ResourcesChanged) == 0 || systemInfo->numResources > 0) && "MecsSystemRunConditions_ResourcesChanged needs the system to have resources");
+    system.runInterval = systemInfo->runInterval;
+    system.runConditions = systemInfo->runConditions;
+    system.runCondition = systemInfo->runCondition;
+    system.lastRunTick = 0;
     mecsIteratorFinalize(system.systemIterator);
     system.systemArchetype = findArchetype(world, systemArchetypeBitset);
     system.timestamp = MECS_INVALID;
-    systemArchetypeBitset.destroy(world->memAllocator);
+    systemArchetypeBitset.destroy(world->allocators[MecsAllocationTag_World]);
 
     MecsSchedule& sched = world->schedules[scheduleID];
 
-    const MecsSystemID systemID = sched.systems.push(world->memAllocator, system);
+    const bool batched = system.onEntitiesAdded != nullptr || system.onEntitiesRemoved != nullptr;
+    const ArchetypeID systemArchetype = system.systemArchetype;
+    const MecsSystemID systemID = sched.systems.push(world->allocators[MecsAllocationTag_World], std::move(system));
+    if (batched) {
+        sched.systems[systemID].notificationBatch = world->notificationBatches.push(world->allocators[MecsAllocationTag_World], SystemNotificationBatch {
+            .system = { .schedule = scheduleID, .system = systemID },
+            .added = true,
+            .pending = false,
+            .entities = {},
+        });
+    }
+    mecsOnNewSystemDefined(world, scheduleID, systemID);
 
-    world->newEvents.push(world->memAllocator, WorldEvent {
+    world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
         .kind = WorldEventKind::eSystemAdded,
         .entityID = systemID,
         .componentID = scheduleID,
-        .archetypeID = system.systemArchetype,
+        .archetypeID = systemArchetype,
         .newArchetypeID = MECS_INVALID
     });
     return systemID;
 }
 
+bool mecsWorldSystemsConflict(MecsWorld* world, MecsScheduleID scheduleA, MecsSystemID systemA, MecsScheduleID scheduleB, MecsSystemID systemB)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(world->schedules.isValid(scheduleA) && world->schedules.isValid(scheduleB));
+    const MecsSystem& lhs = world->schedules[scheduleA].systems[systemA];
+    const MecsSystem& rhs = world->schedules[scheduleB].systems[systemB];
+    if (((lhs.systemFlags | rhs.systemFlags) & MecsSystemFlags_Exclusive) != 0) {
+        return true;
+    }
+    // Systems access a handful of components and resources, so a quadratic check is fine
+    for (MecsSize i = 0; i < lhs.access.count(); i++) {
+        for (MecsSize j = 0; j < rhs.access.count(); j++) {
+            const SystemAccess& a = lhs.access[i];
+            const SystemAccess& b = rhs.access[j];
+            if (a.component == b.component && a.resource == b.resource && (a.write || b.write)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+MecsObserverID mecsWorldDefineObserver(MecsWorld* world, const MecsDefineObserverInfo* observerInfo)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(observerInfo != nullptr && "observerInfo must not be null");
+    MECS_ASSERT(observerInfo->observe != nullptr && "observerInfo->observe must not be null");
+    MECS_ASSERT(world->registry->components.isValid(observerInfo->component) && "Invalid component ID");
+
+    const MecsAllocator& allocator = world->allocators[MecsAllocationTag_World];
+    const MecsObserverID observerID = world->observers.push(allocator, MecsObserver {
+        .component = observerInfo->component,
+        .event = observerInfo->event,
+        .observerData = observerInfo->observerData,
+        .observe = observerInfo->observe,
+        .pending = false,
+        .entities = {},
+        .components = {},
+    });
+    world->observedEvents.ensureSize(allocator, observerInfo->component + 1);
+    world->observedEvents[observerInfo->component] |= 1U << observerInfo->event;
+    return observerID;
+}
+
+void mecsWorldEntityComponentChanged(MecsWorld* world, MecsEntityID entity, MecsComponentID component)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(mecsWorldEntityHasComponent(world, entity, component));
+    // Nobody would be told, so there's no need for an event
+    if (!mecsIsObserved(world, component, MecsObserverEvent_Changed)) { return; }
+    world->newEvents.push(world->allocators[MecsAllocationTag_Events], WorldEvent {
+        .kind = WorldEventKind::eUpdateComponent,
+        .entityID = entity,
+        .componentID = component,
+        .archetypeID = MECS_INVALID,
+        .newArchetypeID = MECS_INVALID,
+    });
+}
 
 MecsU32 mecsEntityIDToIndex(MecsEntityID entityID)
 {
@@ -785,22 +2243,283 @@ MecsRegistry* mecsWorldGetRegistry(MecsWorld* world)
 MecsScheduleID mecsWorldDefineSchedule(MecsWorld* world, const MecsDefineScheduleInfo* scheduleInfo)
 {
     MECS_ASSERT(world);
-    const MecsSize scheduleID = world->schedules.push(world->memAllocator, {});
+    const MecsSize scheduleID = world->schedules.push(world->allocators[MecsAllocationTag_World], {});
 
     MecsSchedule& schedule = world->schedules.at(scheduleID);
     if (scheduleInfo && scheduleInfo->scheduleName != nullptr) {
-        schedule.scheduleName = mecsStrDup(world->memAllocator, scheduleInfo->scheduleName);
+        schedule.scheduleName = mecsStrDup(world->allocators[MecsAllocationTag_Strings], scheduleInfo->scheduleName);
+    }
+    if (scheduleInfo != nullptr) {
+        MECS_ASSERT(scheduleInfo->fixedTimestep >= 0.0 && "The fixed timestep cannot be negative");
+        schedule.fixedTimestep = scheduleInfo->fixedTimestep;
+        schedule.maxCatchUpRuns = scheduleInfo->maxCatchUpRuns;
     }
     return scheduleID;
 }
+// The number of entities the iterator is going to visit, an upper bound when it has sparse arguments
+MecsSize mecsIteratorCountRows(const MecsIterator* iterator)
+{
+    MecsSize rows = 0;
+    iterator->archetypes.forEach([&](ArchetypeID archetypeID) {
+        rows += iterator->world->archetypes[archetypeID].storage.rows();
+    });
+    return rows;
+}
+
+// Whether the iterator has at least one archetype with entities, without beginning it
+bool mecsIteratorHasRows(const MecsIterator* iterator)
+{
+    for (MecsSize i = 0; i < iterator->archetypes.count(); i++) {
+        if (iterator->world->archetypes[iterator->archetypes[i]].storage.rows() > 0) { return true; }
+    }
+    return false;
+}
+
+bool mecsShouldRunSystem(MecsWorld* world, const MecsSchedule& sched, const MecsSystem& system, void* updateData)
+{
+    if (system.runInterval > 1 && sched.runCount % system.runInterval != 0) {
+        return false;
+    }
+    if ((system.runConditions & MecsSystemRunConditions_HasEntities) != 0 && !mecsIteratorHasRows(system.systemIterator)) {
+        return false;
+    }
+    if ((system.runConditions & MecsSystemRunConditions_ResourcesChanged) != 0) {
+        bool changed = false;
+        system.access.forEach([&](const SystemAccess& access) {
+            changed = changed || (access.resource && mecsWorldGetResourceVersion(world, access.component) > system.lastRunTick);
+        });
+        if (!changed) { return false; }
+    }
+    return system.runCondition == nullptr || system.runCondition(system.systemData, updateData, world);
+}
+
 void mecsWorldRunSchedule(MecsWorld* world, MecsScheduleID scheduleID, void* updateData)
 {
     MECS_ASSERT(world != nullptr);
     MECS_ASSERT(world->schedules.count() > scheduleID);
     MecsSchedule& sched = world->schedules[scheduleID];
-    sched.systems.forEach([updateData](MecsSystem& system) {
+    const bool tracing = mecsIsTracing(world);
+    const MecsTraceEvent scheduleEvent {
+        .scope = MecsTraceScope_Schedule,
+        .name = sched.scheduleName,
+        .schedule = scheduleID,
+        .system = MECS_INVALID,
+        .numItems = sched.systems.count(),
+    };
+    mecsTraceBegin(world, scheduleEvent);
+    for (MecsSystemID systemID = 0; systemID < sched.systems.count(); systemID++) {
+        MecsSystem& system = sched.systems[systemID];
         MECS_ASSERT(system.systemRun);
+        if (!mecsShouldRunSystem(world, sched, system, updateData)) { continue; }
         mecsIteratorBegin(system.systemIterator);
+        const MecsTraceEvent systemEvent {
+            .scope = MecsTraceScope_System,
+            .name = system.systemName,
+            .schedule = scheduleID,
+            .system = systemID,
+            .numItems = tracing ? mecsIteratorCountRows(system.systemIterator) : 0,
+        };
+        mecsTraceBegin(world, systemEvent);
         system.systemRun(system.systemData, updateData, system.systemIterator);
+        system.lastRunTick = world->resourceTick;
+        mecsTraceEnd(world, systemEvent);
+    }
+    sched.runCount++;
+    mecsTraceEnd(world, scheduleEvent);
+}
+
+MecsU32 mecsWorldUpdateSchedule(MecsWorld* world, MecsScheduleID scheduleID, double deltaSeconds, void* updateData)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(world->schedules.count() > scheduleID);
+    MECS_ASSERT(deltaSeconds >= 0.0 && "Time cannot go backwards");
+    if (world->schedules[scheduleID].fixedTimestep == 0.0) {
+        mecsWorldRunSchedule(world, scheduleID, updateData);
+        return 1;
+    }
+
+    world->schedules[scheduleID].accumulatedTime += deltaSeconds;
+    MecsU32 runs = 0;
+    while (world->schedules[scheduleID].accumulatedTime >= world->schedules[scheduleID].fixedTimestep) {
+        MecsSchedule& sched = world->schedules[scheduleID];
+        if (sched.maxCatchUpRuns != 0 && runs == sched.maxCatchUpRuns) {
+            // Too far behind: drop the backlog instead of running more steps on each update
+            sched.accumulatedTime = std::fmod(sched.accumulatedTime, sched.fixedTimestep);
+            break;
+        }
+        sched.accumulatedTime -= sched.fixedTimestep;
+        mecsWorldRunSchedule(world, scheduleID, updateData);
+        runs++;
+    }
+    return runs;
+}
+
+double mecsWorldGetScheduleInterpolation(MecsWorld* world, MecsScheduleID scheduleID)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(world->schedules.count() > scheduleID);
+    const MecsSchedule& sched = world->schedules[scheduleID];
+    return sched.fixedTimestep == 0.0 ? 0.0 : sched.accumulatedTime / sched.fixedTimestep;
+}
+
+void mecsWorldSetTraceHooks(MecsWorld* world, const MecsTraceHooks* hooks)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    world->traceHooks = hooks != nullptr ? *hooks : MecsTraceHooks {};
+}
+
+MecsSize mecsIteratorAllocatedBytes(const MecsIterator* iterator)
+{
+    return sizeof(MecsIterator)
+        + iterator->componentSet.allocatedBytes()
+        + iterator->blacklistComponentSet.allocatedBytes()
+        + iterator->components.allocatedBytes()
+        + iterator->sparseArguments.allocatedBytes()
+        + iterator->enabledRows.allocatedBytes()
+        + iterator->archetypeGroups.allocatedBytes()
+        + iterator->hierarchyCursors.allocatedBytes()
+        + iterator->archetypes.allocatedBytes();
+}
+
+void mecsWorldGetStats(MecsWorld* world, MecsWorldStats* outStats)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(outStats != nullptr && "outStats must not be null");
+
+    MecsWorldStats stats {};
+    stats.numEntities = world->entities.count();
+    stats.numArchetypes = world->archetypes.count();
+    stats.numAcquiredIterators = world->acquiredIterators.count();
+    stats.numReusableIterators = world->reusableIterators.count();
+    stats.numPendingEvents = world->newEvents.count();
+    stats.numSchedules = world->schedules.count();
+
+    MecsSize metadataBytes = sizeof(MecsWorld) + world->entities.allocatedBytes() + world->archetypes.allocatedBytes();
+    world->archetypes.forEach([&](const Archetype& archetype) {
+        const MecsSize rows = archetype.storage.rows();
+        if (rows == 0) {
+            stats.numEmptyArchetypes++;
+        }
+        stats.numRows += rows;
+        stats.rowCapacity += archetype.storage.capacity();
+        archetype.componentIDs.forEach([&](MecsComponentID component) {
+            stats.columnBytes += archetype.storage.columnBytes(component);
+        });
+
+        metadataBytes += archetype.storage.metadataBytes()
+            + archetype.componentIDs.allocatedBytes()
+            + archetype.rowToEntity.allocatedBytes()
+            + archetype.matchingSystems.allocatedBytes()
+            + archetype.edges.allocatedBytes()
+            + archetype.unsortedRows.allocatedBytes()
+            + archetype.sortKeySnapshot.allocatedBytes();
+        archetype.edges.forEach([&](const ArchetypeEdge& edge) {
+            metadataBytes += edge.addedSystems.allocatedBytes() + edge.removedSystems.allocatedBytes();
+        });
+    });
+
+    // Each system owns an acquired iterator, so the iterators are counted only once here
+    world->acquiredIterators.forEach([&](const MecsIterator* iterator) {
+        metadataBytes += mecsIteratorAllocatedBytes(iterator);
+    });
+    world->reusableIterators.forEach([&](const MecsIterator* iterator) {
+        metadataBytes += mecsIteratorAllocatedBytes(iterator);
+    });
+    metadataBytes += world->acquiredIterators.allocatedBytes() + world->reusableIterators.allocatedBytes();
+
+    metadataBytes += world->schedules.allocatedBytes();
+    world->schedules.forEach([&](const MecsSchedule& schedule) {
+        stats.numSystems += schedule.systems.count();
+        metadataBytes += schedule.systems.allocatedBytes();
+        schedule.systems.forEach([&](const MecsSystem& system) {
+            metadataBytes += system.access.allocatedBytes();
+        });
+        if (schedule.scheduleName != nullptr) {
+            metadataBytes += mecsStrLen(schedule.scheduleName) + 1;
+        }
+    });
+
+    metadataBytes += world->newEvents.allocatedBytes()
+        + world->batchKeys.allocatedBytes()
+        + world->batchRemovalKeys.allocatedBytes()
+        + world->batchAddedSystems.allocatedBytes()
+        + world->batchRemovedSystems.allocatedBytes()
+        + world->notificationBatches.allocatedBytes()
+        + world->pendingNotificationBatches.allocatedBytes();
+    world->notificationBatches.forEach([&](const SystemNotificationBatch& batch) {
+        metadataBytes += batch.entities.allocatedBytes();
+    });
+    metadataBytes += world->observers.allocatedBytes() + world->observedEvents.allocatedBytes() + world->pendingObservers.allocatedBytes();
+    world->observers.forEach([&](const MecsObserver& observer) {
+        metadataBytes += observer.entities.allocatedBytes() + observer.components.allocatedBytes();
+    });
+
+    metadataBytes += world->sparseComponents.allocatedBytes() + world->hierarchy.allocatedBytes();
+    metadataBytes += world->resources.allocatedBytes() + world->resourceVersions.allocatedBytes();
+    for (MecsComponentID component = 0; component < world->resources.count(); component++) {
+        if (world->resources[component] != nullptr) {
+            metadataBytes += world->registry->components[component].size;
+        }
+    }
+    world->sparseComponents.forEach([&](const ComponentStorage& storage) {
+        stats.columnBytes += storage.allocatedBytes();
+        metadataBytes += storage.metadataBytes();
+    });
+
+    stats.metadataBytes = metadataBytes;
+    *outStats = stats;
+}
+
+void mecsWorldGetArchetypeStats(MecsWorld* world, MecsSize archetypeIndex, MecsArchetypeStats* outStats)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(outStats != nullptr && "outStats must not be null");
+    MECS_ASSERT(archetypeIndex < world->archetypes.count() && "Invalid archetype index");
+
+    const Archetype& archetype = world->archetypes[archetypeIndex];
+    MecsArchetypeStats stats {};
+    stats.numComponents = archetype.componentIDs.count();
+    stats.numRows = archetype.storage.rows();
+    stats.rowCapacity = archetype.storage.capacity();
+    archetype.componentIDs.forEach([&](MecsComponentID component) {
+        stats.columnBytes += archetype.storage.columnBytes(component);
+    });
+    *outStats = stats;
+}
+
+MecsComponentID mecsWorldGetArchetypeComponentByIndex(MecsWorld* world, MecsSize archetypeIndex, MecsSize index)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(archetypeIndex < world->archetypes.count() && "Invalid archetype index");
+    return world->archetypes[archetypeIndex].componentIDs[index];
+}
+
+void mecsWorldGetComponentStats(MecsWorld* world, MecsComponentID component, MecsComponentStats* outStats)
+{
+    MECS_ASSERT(world != nullptr && "Cannot pass a null world");
+    MECS_ASSERT(outStats != nullptr && "outStats must not be null");
+    MECS_ASSERT(component < world->registry->components.count() && "Invalid component");
+
+    MecsComponentStats stats {};
+    stats.name = world->registry->components[component].name;
+    if (mecsIsSparseComponent(world->registry, component)) {
+        if (world->sparseComponents.isValid(component)) {
+            const ComponentStorage& storage = world->sparseComponents[component];
+            stats.numInstances = storage.count();
+            stats.instanceCapacity = storage.capacity();
+            stats.columnBytes = storage.allocatedBytes();
+        }
+        *outStats = stats;
+        return;
+    }
+    world->archetypes.forEach([&](const Archetype& archetype) {
+        if (!archetype.storage.hasComponent(component)) {
+            return;
+        }
+        stats.numArchetypes++;
+        stats.numInstances += archetype.storage.rows();
+        stats.instanceCapacity += archetype.storage.capacity();
+        stats.columnBytes += archetype.storage.columnBytes(component);
     });
+    *outStats = stats;
 }
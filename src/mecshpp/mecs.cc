@@ -112,6 +112,14 @@ void World::runSchedule(ScheduleID scheduleID)
 {
     mecsWorldRunSchedule(mHandle, scheduleID.mID, this);
 }
+MecsU32 World::updateSchedule(ScheduleID scheduleID, double deltaSeconds)
+{
+    return mecsWorldUpdateSchedule(mHandle, scheduleID.mID, deltaSeconds, this);
+}
+double World::getScheduleInterpolation(ScheduleID scheduleID) const
+{
+    return mecsWorldGetScheduleInterpolation(mHandle, scheduleID.mID);
+}
 
 EntityBuilder World::spawnEntity(const MecsEntityInfo& entityInfo)
 {
@@ -126,6 +134,11 @@ EntityBuilder World::duplicateEntity(World& destinationWorld, EntityID sourceEnt
     return { mHandle, mecsWorldDuplicateEntity(mHandle, destinationWorld.getHandle(), sourceEntity.id()) };
 }
 
+void World::clone(World& destinationWorld, int cloneFlags)
+{
+    mecsWorldClone(mHandle, destinationWorld.getHandle(), cloneFlags);
+}
+
 bool World::entityHasComponent(EntityID entity, ComponentID component) const
 {
     return mecsWorldEntityHasComponent(mHandle, entity.id(), component.id());
@@ -145,6 +158,26 @@ void World::entityRemoveComponent(EntityID entity, ComponentID component)
 {
     mecsWorldRemoveComponent(mHandle, entity.id(), component.id());
 }
+void World::entitySetComponentEnabled(EntityID entity, ComponentID component, bool enabled)
+{
+    mecsWorldSetComponentEnabled(mHandle, entity.id(), component.id(), enabled);
+}
+bool World::entityIsComponentEnabled(EntityID entity, ComponentID component) const
+{
+    return mecsWorldIsComponentEnabled(mHandle, entity.id(), component.id());
+}
+void World::entitySetParent(EntityID child, EntityID parent)
+{
+    mecsWorldEntitySetParent(mHandle, child.id(), parent.id());
+}
+EntityID World::entityGetParent(EntityID entity) const
+{
+    return { mecsWorldEntityGetParent(mHandle, entity.id()) };
+}
+MecsSize World::entityGetNumChildren(EntityID entity) const
+{
+    return mecsWorldEntityGetNumChildren(mHandle, entity.id());
+}
 PrefabID World::entityGetPrefabID(EntityID entity) const
 {
     return {mecsWorldEntityGetPrefabID(mHandle, entity.id())};
@@ -153,6 +186,10 @@ void World::entityChanged(EntityID entity)
 {
     mecsWorldEntityChanged(mHandle, entity.id());
 }
+void World::entityComponentChanged(EntityID entity, ComponentID component)
+{
+    mecsWorldEntityComponentChanged(mHandle, entity.id(), component.id());
+}
 MecsSize World::entityGetNumComponents(EntityID entity) const
 {
     return mecsWorldEntityGetNumComponents(mHandle, entity.id());
@@ -170,3 +207,23 @@ void World::flushEvents()
 {
     mecsWorldFlushEvents(mHandle, this);
 }
+void* World::addResource(ComponentID component)
+{
+    return mecsWorldAddResource(mHandle, component.id());
+}
+void* World::getResource(ComponentID component)
+{
+    return mecsWorldGetResource(mHandle, component.id());
+}
+bool World::hasResource(ComponentID component) const
+{
+    return mecsWorldHasResource(mHandle, component.id());
+}
+void World::removeResource(ComponentID component)
+{
+    mecsWorldRemoveResource(mHandle, component.id());
+}
+bool World::systemsConflict(ScheduleID scheduleA, MecsSystemID systemA, ScheduleID scheduleB, MecsSystemID systemB) const
+{
+    return mecsWorldSystemsConflict(mHandle, scheduleA.id(), systemA, scheduleB.id(), systemB);
+}
@@ -0,0 +1,207 @@
+#include "mecshpp/serializer.hpp"
+#include "mecs/base.h"
+
+#include <limits>
+#include <string>
+
+using namespace mecs;
+
+namespace {
+bool writeBytes(const MecsWriter& writer, const void* data, MecsSize size)
+{
+    return size == 0 || writer.write(writer.userData, data, size) == size;
+}
+
+bool readBytes(const MecsReader& reader, void* data, MecsSize size)
+{
+    return size == 0 || reader.read(reader.userData, data, size) == size;
+}
+
+bool writeCount(const MecsWriter& writer, MecsSize count)
+{
+    MECS_ASSERT(count <= std::numeric_limits<MecsU32>::max());
+    const auto count32 = static_cast<MecsU32>(count);
+    return writeBytes(writer, &count32, sizeof(count32));
+}
+}
+
+Serializer::Serializer(const RTTI& rtti)
+{
+    mRoot = compile(rtti);
+}
+
+std::span<const SerializeOp> Serializer::ops() const
+{
+    return { mOps.data() + mRoot.first, mRoot.count };
+}
+
+bool Serializer::serialize(const void* value, const MecsWriter& writer) const
+{
+    return write(mRoot, value, writer);
+}
+
+bool Serializer::deserialize(void* value, const MecsReader& reader) const
+{
+    return read(mRoot, value, reader);
+}
+
+Serializer::OpRange Serializer::compile(const RTTI& rtti)
+{
+    // The ops of the vector elements are appended to mOps while flattening, so the ops of this type are collected
+    // separately to keep them contiguous
+    std::vector<SerializeOp> ops;
+    flatten(rtti, 0, ops);
+
+    const OpRange range { .first = static_cast<MecsU32>(mOps.size()), .count = static_cast<MecsU32>(ops.size()) };
+    mOps.insert(mOps.end(), ops.begin(), ops.end());
+    return range;
+}
+
+void Serializer::flatten(const RTTI& rtti, MecsSize offset, std::vector<SerializeOp>& outOps)
+{
+    if (rtti.triviallyCopyable) {
+        // Merge with the previous copy when there's no padding in between
+        if (!outOps.empty() && outOps.back().kind == SerializeOpKind::eBytes
+            && outOps.back().offset + outOps.back().size == offset) {
+            outOps.back().size += rtti.size;
+        } else {
+            outOps.push_back({ .kind = SerializeOpKind::eBytes, .offset = offset, .size = rtti.size });
+        }
+        return;
+    }
+
+    switch (rtti.kind) {
+    case RttiKind::eStruct: {
+        const auto& rttiStruct = static_cast<const RTTIStruct&>(rtti);
+        MECS_ASSERT(rttiStruct.defaultValue != nullptr);
+        const auto* base = static_cast<const char*>(rttiStruct.defaultValue);
+        for (const Member& member : rttiStruct.members) {
+            const auto* memberPtr = static_cast<const char*>(member.getMemberConst(base));
+            flatten(*member.memberRtti, offset + (memberPtr - base), outOps);
+        }
+        break;
+    }
+    case RttiKind::eVec: {
+        const auto& rttiVec = static_cast<const RTTIVec&>(rtti);
+        const RTTI& elementRtti = *rttiVec.elementRtti;
+        const OpRange element = compile(elementRtti);
+        outOps.push_back({
+            .kind = SerializeOpKind::eVec,
+            .offset = offset,
+            .size = elementRtti.size,
+            .vec = &rttiVec,
+            .firstOp = element.first,
+            .numOps = element.count,
+            .packed = elementRtti.triviallyCopyable,
+        });
+        break;
+    }
+    case RttiKind::eField:
+        MECS_ASSERT(rtti.typeID == typeIdOf<std::string>() && "Only std::string is supported among the non trivially copyable fields");
+        outOps.push_back({ .kind = SerializeOpKind::eString, .offset = offset });
+        break;
+    default:
+        MECS_ASSERT(false && "Unsupported RTTI kind");
+    }
+}
+
+bool Serializer::write(OpRange range, const void* value, const MecsWriter& writer) const
+{
+    const auto* base = static_cast<const char*>(value);
+    for (MecsU32 i = range.first; i < range.first + range.count; i++) {
+        const SerializeOp& op = mOps[i];
+        const void* ptr = base + op.offset;
+        switch (op.kind) {
+        case SerializeOpKind::eBytes:
+            if (!writeBytes(writer, ptr, op.size)) {
+                return false;
+            }
+            break;
+        case SerializeOpKind::eString: {
+            const auto& str = *static_cast<const std::string*>(ptr);
+            if (!writeCount(writer, str.size()) || !writeBytes(writer, str.data(), str.size())) {
+                return false;
+            }
+            break;
+        }
+        case SerializeOpKind::eVec: {
+            const MecsSize count = op.vec->getCount(ptr);
+            if (!writeCount(writer, count)) {
+                return false;
+            }
+            if (count == 0) {
+                break;
+            }
+            if (op.packed) {
+                if (!writeBytes(writer, op.vec->getElemConst(ptr, 0), count * op.size)) {
+                    return false;
+                }
+                break;
+            }
+            const OpRange element { .first = op.firstOp, .count = op.numOps };
+            for (MecsSize elem = 0; elem < count; elem++) {
+                if (!write(element, op.vec->getElemConst(ptr, elem), writer)) {
+                    return false;
+                }
+            }
+            break;
+        }
+        }
+    }
+    return true;
+}
+
+bool Serializer::read(OpRange range, void* value, const MecsReader& reader) const
+{
+    auto* base = static_cast<char*>(value);
+    for (MecsU32 i = range.first; i < range.first + range.count; i++) {
+        const SerializeOp& op = mOps[i];
+        void* ptr = base + op.offset;
+        switch (op.kind) {
+        case SerializeOpKind::eBytes:
+            if (!readBytes(reader, ptr, op.size)) {
+                return false;
+            }
+            break;
+        case SerializeOpKind::eString: {
+            MecsU32 length = 0;
+            if (!readBytes(reader, &length, sizeof(length))) {
+                return false;
+            }
+            auto& str = *static_cast<std::string*>(ptr);
+            str.resize(length);
+            if (!readBytes(reader, str.data(), length)) {
+                return false;
+            }
+            break;
+        }
+        case SerializeOpKind::eVec: {
+            MecsU32 count = 0;
+            if (!readBytes(reader, &count, sizeof(count))) {
+                return false;
+            }
+            op.vec->clear(ptr);
+            for (MecsU32 elem = 0; elem < count; elem++) {
+                op.vec->pushBack(ptr, nullptr);
+            }
+            if (count == 0) {
+                break;
+            }
+            if (op.packed) {
+                if (!readBytes(reader, op.vec->getElem(ptr, 0), static_cast<MecsSize>(count) * op.size)) {
+                    return false;
+                }
+                break;
+            }
+            const OpRange element { .first = op.firstOp, .count = op.numOps };
+            for (MecsU32 elem = 0; elem < count; elem++) {
+                if (!read(element, op.vec->getElem(ptr, elem), reader)) {
+                    return false;
+                }
+            }
+            break;
+        }
+        }
+    }
+    return true;
+}
@@ -7,6 +7,13 @@
 
 #include "mecshpp/mecs.hpp"
 #include "test_private.hpp"
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <unordered_map>
 #include <vector>
 // NOLINTBEGIN this is a test file
 
@@ -244,6 +251,1142 @@ TEST_CASE("Simple loop")
     mecsRegistryFree(registry);
 }
 
+TEST_CASE("World statistics")
+{
+    struct Foo {
+        MecsU64 value;
+    };
+
+    struct Bar {
+        MecsU32 value;
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+    MECS_REGISTER_COMPONENT(registry, Bar);
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+
+    for (int i = 0; i < 10; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, ent, Foo);
+        if (i % 2 == 0) {
+            MECS_COMPONENT(world, ent, Bar);
+        }
+    }
+
+    MecsWorldStats stats;
+    mecsWorldGetStats(world, &stats);
+    REQUIRE(stats.numEntities == 10);
+    REQUIRE(stats.numPendingEvents > 0);
+    REQUIRE(stats.numRows == 10);
+    REQUIRE(stats.rowCapacity >= stats.numRows);
+    REQUIRE(stats.metadataBytes > 0);
+
+    mecsWorldFlushEvents(world, nullptr);
+    mecsWorldGetStats(world, &stats);
+    REQUIRE(stats.numPendingEvents == 0);
+
+    // The entities went through the empty archetype and the Foo archetype on their way to Foo + Bar
+    REQUIRE(stats.numArchetypes == 3);
+    REQUIRE(stats.numEmptyArchetypes == 1);
+
+    MecsSize totalRows = 0;
+    MecsSize totalColumnBytes = 0;
+    for (MecsSize i = 0; i < stats.numArchetypes; i++) {
+        MecsArchetypeStats archetypeStats;
+        mecsWorldGetArchetypeStats(world, i, &archetypeStats);
+        REQUIRE(archetypeStats.rowCapacity >= archetypeStats.numRows);
+        for (MecsSize c = 0; c < archetypeStats.numComponents; c++) {
+            const MecsComponentID component = mecsWorldGetArchetypeComponentByIndex(world, i, c);
+            REQUIRE((component == Component_Foo || component == Component_Bar));
+        }
+        totalRows += archetypeStats.numRows;
+        totalColumnBytes += archetypeStats.columnBytes;
+    }
+    REQUIRE(totalRows == stats.numRows);
+    REQUIRE(totalColumnBytes == stats.columnBytes);
+
+    MecsComponentStats fooStats;
+    mecsWorldGetComponentStats(world, Component_Foo, &fooStats);
+    REQUIRE(mecsStrEqual(fooStats.name, "Foo"));
+    REQUIRE(fooStats.numArchetypes == 2);
+    REQUIRE(fooStats.numInstances == 10);
+    REQUIRE(fooStats.columnBytes >= 10 * sizeof(Foo));
+
+    MecsComponentStats barStats;
+    mecsWorldGetComponentStats(world, Component_Bar, &barStats);
+    REQUIRE(barStats.numArchetypes == 1);
+    REQUIRE(barStats.numInstances == 5);
+    REQUIRE(barStats.instanceCapacity >= 5);
+    REQUIRE(fooStats.columnBytes + barStats.columnBytes == stats.columnBytes);
+
+    MecsIterator* iterator = mecsWorldAcquireIterator(world);
+    mecsWorldGetStats(world, &stats);
+    REQUIRE(stats.numAcquiredIterators == 1);
+    mecsWorldReleaseIterator(world, iterator);
+    mecsWorldGetStats(world, &stats);
+    REQUIRE(stats.numAcquiredIterators == 0);
+    REQUIRE(stats.numReusableIterators == 1);
+
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Tags")
+{
+    struct Foo {
+        MecsU64 value;
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+    MECS_REGISTER_TAG(registry, Frozen);
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+
+    MecsEntityID entities[100];
+    for (int i = 0; i < 100; i++) {
+        entities[i] = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, entities[i], Foo) = Foo { static_cast<MecsU64>(i) };
+        if (i % 2 == 0) {
+            REQUIRE(mecsWorldAddComponent(world, entities[i], Component_Frozen) != nullptr);
+        }
+    }
+    mecsWorldFlushEvents(world, nullptr);
+
+    // The tag is part of the archetype, but takes no memory
+    MecsComponentStats frozenStats;
+    mecsWorldGetComponentStats(world, Component_Frozen, &frozenStats);
+    REQUIRE(frozenStats.numArchetypes == 1);
+    REQUIRE(frozenStats.numInstances == 50);
+    REQUIRE(frozenStats.columnBytes == 0);
+
+    MecsIterator* frozen = mecsWorldAcquireIterator(world);
+    mecsIterComponent(frozen, Component_Foo, 0);
+    mecsIterComponentFilter(frozen, Component_Frozen, MecsIteratorFilter::With, 1);
+    mecsIteratorFinalize(frozen);
+    MecsSize sum = 0;
+    mecsIteratorBegin(frozen);
+    while (mecsIteratorAdvance(frozen)) {
+        sum += static_cast<Foo*>(mecsIteratorGetArgument(frozen, 0))->value;
+    }
+    REQUIRE(sum == 2450);
+
+    // Moving the entities between the archetypes with and without the tag keeps their components
+    for (int i = 0; i < 100; i += 4) {
+        mecsWorldRemoveComponent(world, entities[i], Component_Frozen);
+    }
+    MecsEntityID duplicate = mecsWorldDuplicateEntity(world, world, entities[2]);
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(mecsUtilIteratorCount(frozen) == 26);
+    REQUIRE(mecsWorldEntityHasComponent(world, duplicate, Component_Frozen));
+    for (int i = 0; i < 100; i++) {
+        REQUIRE(mecsWorldEntityHasComponent(world, entities[i], Component_Frozen) == (i % 4 == 2));
+        REQUIRE(static_cast<Foo*>(mecsWorldEntityGetComponent(world, entities[i], Component_Foo))->value == i);
+    }
+
+    mecsWorldReleaseIterator(world, frozen);
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Sparse components")
+{
+    struct Foo {
+        MecsU64 value;
+    };
+    struct Stunned {
+        MecsU64 turns;
+    };
+    static int numTeardowns = 0;
+    numTeardowns = 0;
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+    MECS_REGISTER_SPARSE_COMPONENT(registry, Stunned);
+    ComponentInfo stunnedInfo = *mecsGetComponentInfoByComponentID(registry, Component_Stunned);
+    stunnedInfo.teardown = [](MecsWorld*, MecsEntityID, void*, void*) { numTeardowns++; };
+    mecsRegistryAddRegistration(registry, &stunnedInfo);
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+
+    MecsEntityID entities[100];
+    for (int i = 0; i < 100; i++) {
+        entities[i] = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, entities[i], Foo) = Foo { static_cast<MecsU64>(i) };
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    MecsWorldStats before;
+    mecsWorldGetStats(world, &before);
+
+    // Adding and removing a sparse component doesn't move the entities to another archetype
+    for (int i = 0; i < 100; i += 3) {
+        MECS_COMPONENT(world, entities[i], Stunned) = Stunned { static_cast<MecsU64>(i) };
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    MecsWorldStats after;
+    mecsWorldGetStats(world, &after);
+    REQUIRE(after.numArchetypes == before.numArchetypes);
+    MecsComponentStats stunnedStats;
+    mecsWorldGetComponentStats(world, Component_Stunned, &stunnedStats);
+    REQUIRE(stunnedStats.numArchetypes == 0);
+    REQUIRE(stunnedStats.numInstances == 34);
+    REQUIRE(mecsWorldEntityGetNumComponents(world, entities[3]) == 2);
+    REQUIRE(mecsWorldEntityGetComponentByIndex(world, entities[3], 1) == Component_Stunned);
+    REQUIRE(mecsWorldEntityGetNumComponents(world, entities[4]) == 1);
+
+    // The iterators join the archetype columns with the sparse components
+    MecsIterator* stunned = mecsWorldAcquireIterator(world);
+    mecsIterComponent(stunned, Component_Foo, 0);
+    mecsIterComponent(stunned, Component_Stunned, 1);
+    mecsIteratorFinalize(stunned);
+    REQUIRE(mecsIteratorHasSparseArguments(stunned));
+    MecsSize sum = 0;
+    mecsIteratorBegin(stunned);
+    while (mecsIteratorAdvance(stunned)) {
+        const Foo* foo = static_cast<Foo*>(mecsIteratorGetArgument(stunned, 0));
+        const Stunned* stun = static_cast<Stunned*>(mecsIteratorGetArgument(stunned, 1));
+        REQUIRE(foo->value == stun->turns);
+        sum += foo->value;
+    }
+    REQUIRE(sum == 1683);
+
+    MecsIterator* active = mecsWorldAcquireIterator(world);
+    mecsIterComponent(active, Component_Foo, 0);
+    mecsIterComponentFilter(active, Component_Stunned, MecsIteratorFilter::Not, 1);
+    mecsIteratorFinalize(active);
+    REQUIRE(mecsUtilIteratorCount(active) == 66);
+
+    for (int i = 0; i < 100; i += 6) {
+        mecsWorldRemoveComponent(world, entities[i], Component_Stunned);
+    }
+    mecsWorldDestroyEntity(world, entities[3]);
+    MecsEntityID duplicate = mecsWorldDuplicateEntity(world, world, entities[9]);
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(numTeardowns == 18);
+    REQUIRE(mecsUtilIteratorCount(stunned) == 17);
+    REQUIRE(mecsUtilIteratorCount(active) == 83);
+    REQUIRE(static_cast<Stunned*>(mecsWorldEntityGetComponent(world, duplicate, Component_Stunned))->turns == 9);
+
+    // The index of the destroyed entity is reused without its sparse components
+    MecsEntityID respawned = mecsWorldSpawnEntity(world, nullptr);
+    REQUIRE(!mecsWorldEntityHasComponent(world, respawned, Component_Stunned));
+    for (int i = 4; i < 100; i++) {
+        REQUIRE(mecsWorldEntityHasComponent(world, entities[i], Component_Stunned) == (i % 3 == 0 && i % 6 != 0));
+        REQUIRE(static_cast<Foo*>(mecsWorldEntityGetComponent(world, entities[i], Component_Foo))->value == i);
+    }
+
+    mecsWorldReleaseIterator(world, stunned);
+    mecsWorldReleaseIterator(world, active);
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Disabled components")
+{
+    struct Foo {
+        MecsU64 value;
+    };
+    struct Bar {
+        MecsU64 value;
+    };
+    static int numTeardowns = 0;
+    numTeardowns = 0;
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+    MECS_REGISTER_COMPONENT(registry, Bar);
+    ComponentInfo fooInfo = *mecsGetComponentInfoByComponentID(registry, Component_Foo);
+    fooInfo.teardown = [](MecsWorld*, MecsEntityID, void*, void*) { numTeardowns++; };
+    mecsRegistryAddRegistration(registry, &fooInfo);
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+
+    MecsEntityID entities[100];
+    for (int i = 0; i < 100; i++) {
+        entities[i] = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, entities[i], Foo) = Foo { static_cast<MecsU64>(i) };
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    MecsWorldStats before;
+    mecsWorldGetStats(world, &before);
+
+    // Disabling a component doesn't move the entity to another archetype, nor tears the component down
+    for (int i = 0; i < 100; i += 3) {
+        mecsWorldSetComponentEnabled(world, entities[i], Component_Foo, false);
+    }
+    MecsWorldStats after;
+    mecsWorldGetStats(world, &after);
+    REQUIRE(after.numArchetypes == before.numArchetypes);
+    REQUIRE(numTeardowns == 0);
+    REQUIRE(!mecsWorldIsComponentEnabled(world, entities[3], Component_Foo));
+    REQUIRE(mecsWorldIsComponentEnabled(world, entities[4], Component_Foo));
+    REQUIRE(mecsWorldEntityHasComponent(world, entities[3], Component_Foo));
+
+    MecsIterator* foos = mecsWorldAcquireIterator(world);
+    mecsIterComponent(foos, Component_Foo, 0);
+    mecsIteratorFinalize(foos);
+    MecsSize sum = 0;
+    mecsIteratorBegin(foos);
+    while (mecsIteratorAdvance(foos)) {
+        const Foo* foo = static_cast<Foo*>(mecsIteratorGetArgument(foos, 0));
+        REQUIRE(foo->value % 3 != 0);
+        REQUIRE(mecsIteratorGetEntity(foos) == entities[foo->value]);
+        sum += foo->value;
+    }
+    REQUIRE(sum == 4950 - 1683);
+
+    // The bulk iteration exposes the enabled rows as a bitmask
+    mecsIteratorBegin(foos);
+    MecsSize numEnabled = 0;
+    while (const MecsSize rows = mecsIteratorAdvanceArchetype(foos)) {
+        const MecsU32* enabledRows = mecsIteratorGetEnabledRows(foos);
+        REQUIRE(enabledRows != nullptr);
+        const MecsEntityID* rowEntities = mecsIteratorGetEntities(foos);
+        for (MecsSize row = 0; row < rows; row++) {
+            const bool enabled = (enabledRows[row / 32] >> (row % 32)) & 1;
+            REQUIRE(enabled == mecsWorldIsComponentEnabled(world, rowEntities[row], Component_Foo));
+            numEnabled += enabled;
+        }
+    }
+    REQUIRE(numEnabled == 66);
+
+    // Disabling a component that isn't iterated, or filtered out with Not, doesn't change what the iterator sees
+    MecsIterator* noBars = mecsWorldAcquireIterator(world);
+    mecsIterComponent(noBars, Component_Foo, 0);
+    mecsIterComponentFilter(noBars, Component_Bar, MecsIteratorFilter::Not, 1);
+    mecsIteratorFinalize(noBars);
+    MecsIterator* all = mecsWorldAcquireIterator(world);
+    mecsIteratorFinalize(all);
+    REQUIRE(mecsUtilIteratorCount(noBars) == 66);
+    REQUIRE(mecsUtilIteratorCount(all) == 100);
+
+    // The bits follow the entities when the rows are swapped on removal, and when they change archetype
+    mecsWorldDestroyEntity(world, entities[0]);
+    mecsWorldDestroyEntity(world, entities[1]);
+    for (int i = 50; i < 100; i++) {
+        MECS_COMPONENT(world, entities[i], Bar) = Bar { static_cast<MecsU64>(i) };
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    for (int i = 2; i < 100; i++) {
+        REQUIRE(mecsWorldIsComponentEnabled(world, entities[i], Component_Foo) == (i % 3 != 0));
+        REQUIRE(static_cast<Foo*>(mecsWorldEntityGetComponent(world, entities[i], Component_Foo))->value == i);
+    }
+    REQUIRE(mecsUtilIteratorCount(foos) == 65);
+
+    // The duplicates keep the disabled components
+    MecsEntityID duplicate = mecsWorldDuplicateEntity(world, world, entities[60]);
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(!mecsWorldIsComponentEnabled(world, duplicate, Component_Foo));
+    REQUIRE(mecsWorldIsComponentEnabled(world, duplicate, Component_Bar));
+
+    // Disabling a component that isn't an argument doesn't hide the entity
+    mecsWorldSetComponentEnabled(world, entities[61], Component_Bar, false);
+    REQUIRE(mecsUtilIteratorCount(foos) == 65);
+    mecsWorldSetComponentEnabled(world, entities[61], Component_Foo, false);
+    REQUIRE(mecsUtilIteratorCount(foos) == 64);
+
+    for (int i = 2; i < 100; i++) {
+        mecsWorldSetComponentEnabled(world, entities[i], Component_Foo, true);
+    }
+    mecsWorldSetComponentEnabled(world, duplicate, Component_Foo, true);
+    REQUIRE(mecsUtilIteratorCount(foos) == 99);
+    mecsIteratorBegin(foos);
+    while (mecsIteratorAdvanceArchetype(foos)) {
+        REQUIRE(mecsIteratorGetEnabledRows(foos) == nullptr);
+    }
+    REQUIRE(numTeardowns == 2);
+
+    mecsWorldReleaseIterator(world, foos);
+    mecsWorldReleaseIterator(world, noBars);
+    mecsWorldReleaseIterator(world, all);
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Sorted and grouped iteration")
+{
+    struct Depth {
+        MecsU64 value;
+    };
+    struct Foo {
+        MecsU64 value;
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Depth);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+    MECS_REGISTER_TAG(registry, Opaque);
+    MECS_REGISTER_TAG(registry, Transparent);
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+
+    // Four archetypes: (Depth, Opaque), (Depth, Transparent), (Depth, Foo, Opaque), (Depth, Foo, Transparent)
+    MecsEntityID entities[200];
+    std::unordered_map<MecsEntityID, MecsU64> expectedDepths;
+    for (int i = 0; i < 200; i++) {
+        entities[i] = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, entities[i], Depth) = Depth { static_cast<MecsU64>((i * 37) % 200) };
+        expectedDepths[entities[i]] = (i * 37) % 200;
+        mecsWorldAddComponent(world, entities[i], i % 2 == 0 ? Component_Opaque : Component_Transparent);
+        if (i % 3 == 0) {
+            MECS_COMPONENT(world, entities[i], Foo) = Foo { static_cast<MecsU64>(i) };
+        }
+    }
+    mecsWorldFlushEvents(world, nullptr);
+
+    // Depth is only read, so that checking the order doesn't change any row
+    MecsIterator* iterator = mecsWorldAcquireIterator(world);
+    mecsIterComponentFilter(iterator, Component_Depth, MecsIteratorFilter::Read, 0);
+    mecsIteratorFinalize(iterator);
+    // The transparent entities go after the opaque ones, the entities with neither come first
+    mecsIteratorGroupBy(iterator, [](const MecsComponentID* components, MecsSize numComponents, void*) -> MecsU64 {
+        const auto has = [&](MecsComponentID component) {
+            return std::find(components, components + numComponents, component) != components + numComponents;
+        };
+        return has(Component_Transparent) ? 2 : (has(Component_Opaque) ? 1 : 0);
+    }, nullptr);
+    MecsSize numCompares = 0;
+    mecsIteratorSortBy(iterator, Component_Depth, [](const void* lhs, const void* rhs, void* userData) -> int {
+        (*static_cast<MecsSize*>(userData))++;
+        const MecsU64 lhsDepth = static_cast<const Depth*>(lhs)->value;
+        const MecsU64 rhsDepth = static_cast<const Depth*>(rhs)->value;
+        return lhsDepth < rhsDepth ? -1 : (lhsDepth > rhsDepth ? 1 : 0);
+    }, &numCompares);
+
+    // Checks that the transparent entities come last, and that the depths grow within each archetype
+    const auto checkOrder = [&](MecsSize expectedCount) {
+        MecsSize count = 0;
+        bool transparent = false;
+        mecsIteratorBegin(iterator);
+        while (const MecsSize rows = mecsIteratorAdvanceArchetype(iterator)) {
+            const Depth* depths = static_cast<const Depth*>(mecsIteratorGetColumn(iterator, 0));
+            const MecsEntityID* rowEntities = mecsIteratorGetEntities(iterator);
+            const bool archetypeTransparent = mecsWorldEntityHasComponent(world, rowEntities[0], Component_Transparent);
+            REQUIRE((!transparent || archetypeTransparent));
+            transparent = archetypeTransparent;
+            for (MecsSize row = 0; row < rows; row++) {
+                REQUIRE((row == 0 || depths[row - 1].value <= depths[row].value));
+                REQUIRE(depths[row].value == expectedDepths[rowEntities[row]]);
+            }
+            count += rows;
+        }
+        REQUIRE(count == expectedCount);
+    };
+    checkOrder(200);
+    // Nothing changed: the archetypes aren't sorted again
+    numCompares = 0;
+    checkOrder(200);
+    REQUIRE(numCompares == 0);
+
+    // Changing, removing and adding rows only re-sorts those
+    for (int i = 0; i < 200; i += 7) {
+        static_cast<Depth*>(mecsWorldEntityGetComponent(world, entities[i], Component_Depth))->value = 1000 - i;
+        expectedDepths[entities[i]] = 1000 - i;
+    }
+    for (int i = 1; i < 200; i += 10) {
+        mecsWorldDestroyEntity(world, entities[i]);
+    }
+    for (int i = 0; i < 20; i++) {
+        MecsEntityID entity = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, entity, Depth) = Depth { static_cast<MecsU64>(i * 13) };
+        expectedDepths[entity] = i * 13;
+        mecsWorldAddComponent(world, entity, Component_Opaque);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    checkOrder(200);
+
+    // Writing a few rows through an Access column only re-sorts the rows whose key changed:
+    // sorting 200 rows from scratch takes way more comparisons than merging them
+    MecsIterator* writer = mecsWorldAcquireIterator(world);
+    mecsIterComponent(writer, Component_Depth, 0);
+    mecsIteratorFinalize(writer);
+    mecsIteratorBegin(writer);
+    MecsSize numWritten = 0;
+    while (const MecsSize rows = mecsIteratorAdvanceArchetype(writer)) {
+        auto* depths = static_cast<Depth*>(mecsIteratorGetColumn(writer, 0));
+        const MecsEntityID* rowEntities = mecsIteratorGetEntities(writer);
+        depths[0].value = 500;
+        expectedDepths[rowEntities[0]] = 500;
+        depths[rows / 2].value = 1;
+        expectedDepths[rowEntities[rows / 2]] = 1;
+        numWritten += 2;
+    }
+    mecsWorldReleaseIterator(world, writer);
+    numCompares = 0;
+    checkOrder(200);
+    REQUIRE(numCompares > 0);
+    REQUIRE(numCompares < 200 + numWritten * 4);
+
+    // A new archetype is put in its group
+    MecsEntityID untagged = mecsWorldSpawnEntity(world, nullptr);
+    MECS_COMPONENT(world, untagged, Depth) = Depth { 5 };
+    expectedDepths[untagged] = 5;
+    mecsWorldFlushEvents(world, nullptr);
+    mecsIteratorBegin(iterator);
+    REQUIRE(mecsIteratorAdvance(iterator));
+    REQUIRE(mecsIteratorGetEntity(iterator) == untagged);
+    checkOrder(201);
+
+    mecsWorldReleaseIterator(world, iterator);
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Hierarchy")
+{
+    struct Transform {
+        MecsU64 local;
+        MecsU64 global;
+    };
+    struct Foo {
+        MecsU64 value;
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Transform);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+
+    // 10 roots with 3 children each, with 3 children each, spawned deepest first and spread over two archetypes
+    MecsEntityID entities[130];
+    for (int i = 129; i >= 0; i--) {
+        entities[i] = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, entities[i], Transform) = Transform { .local = static_cast<MecsU64>(i), .global = 0 };
+        if (i % 2 == 0) {
+            MECS_COMPONENT(world, entities[i], Foo) = Foo { static_cast<MecsU64>(i) };
+        }
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    for (int i = 10; i < 130; i++) {
+        mecsWorldEntitySetParent(world, entities[i], entities[(i - 10) / 3]);
+    }
+    REQUIRE(mecsWorldEntityGetDepth(world, entities[0]) == 0);
+    REQUIRE(mecsWorldEntityGetDepth(world, entities[10]) == 1);
+    REQUIRE(mecsWorldEntityGetDepth(world, entities[40]) == 2);
+    REQUIRE(mecsWorldEntityGetParent(world, entities[40]) == entities[10]);
+    REQUIRE(mecsWorldEntityGetParent(world, entities[0]) == MECS_INVALID);
+    REQUIRE(mecsWorldEntityGetNumChildren(world, entities[10]) == 3);
+    MecsSize numChildren = 0;
+    for (MecsEntityID child = mecsWorldEntityGetFirstChild(world, entities[10]); child != MECS_INVALID; child = mecsWorldEntityGetNextSibling(world, child)) {
+        REQUIRE(mecsWorldEntityGetParent(world, child) == entities[10]);
+        numChildren++;
+    }
+    REQUIRE(numChildren == 3);
+
+    // Propagates the transforms, each parent must come before its children
+    MecsIterator* iterator = mecsWorldAcquireIterator(world);
+    mecsIterComponent(iterator, Component_Transform, 0);
+    mecsIteratorFinalize(iterator);
+    mecsIteratorSetHierarchyOrder(iterator, true);
+    const auto propagate = [&]() {
+        std::vector<MecsEntityID> visited;
+        MecsU32 lastDepth = 0;
+        mecsIteratorBegin(iterator);
+        while (mecsIteratorAdvance(iterator)) {
+            const MecsEntityID entity = mecsIteratorGetEntity(iterator);
+            Transform* transform = static_cast<Transform*>(mecsIteratorGetArgument(iterator, 0));
+            const MecsEntityID parent = mecsWorldEntityGetParent(world, entity);
+            const MecsU32 depth = mecsWorldEntityGetDepth(world, entity);
+            REQUIRE(depth >= lastDepth);
+            lastDepth = depth;
+            transform->global = transform->local;
+            if (parent != MECS_INVALID) {
+                const Transform* parentTransform = static_cast<Transform*>(mecsWorldEntityGetComponent(world, parent, Component_Transform));
+                REQUIRE(std::find(visited.begin(), visited.end(), parent) != visited.end());
+                transform->global += parentTransform->global;
+            }
+            visited.push_back(entity);
+        }
+        return visited.size();
+    };
+    const auto expectedGlobal = [&](int i) {
+        MecsU64 global = 0;
+        for (MecsEntityID entity = entities[i]; entity != MECS_INVALID; entity = mecsWorldEntityGetParent(world, entity)) {
+            global += static_cast<Transform*>(mecsWorldEntityGetComponent(world, entity, Component_Transform))->local;
+        }
+        return global;
+    };
+    REQUIRE(propagate() == 130);
+    for (int i = 0; i < 130; i++) {
+        REQUIRE(static_cast<Transform*>(mecsWorldEntityGetComponent(world, entities[i], Component_Transform))->global == expectedGlobal(i));
+    }
+
+    // Moving a subtree moves its descendants to the new depths
+    mecsWorldEntitySetParent(world, entities[11], entities[129]);
+    REQUIRE(mecsWorldEntityGetNumChildren(world, entities[0]) == 2);
+    REQUIRE(mecsWorldEntityGetDepth(world, entities[11]) == 3);
+    REQUIRE(mecsWorldEntityGetDepth(world, entities[43]) == 4);
+    REQUIRE(propagate() == 130);
+    for (int i = 0; i < 130; i++) {
+        REQUIRE(static_cast<Transform*>(mecsWorldEntityGetComponent(world, entities[i], Component_Transform))->global == expectedGlobal(i));
+    }
+
+    // The clones keep the hierarchy
+    MecsWorld* clone = mecsWorldCreate(registry, nullptr);
+    mecsWorldClone(world, clone, MecsWorldCloneFlags_None);
+    REQUIRE(mecsWorldEntityGetParent(clone, entities[11]) == entities[129]);
+    REQUIRE(mecsWorldEntityGetDepth(clone, entities[43]) == 4);
+    mecsWorldFree(clone);
+
+    // Destroying an entity destroys its descendants
+    mecsWorldDestroyEntity(world, entities[3]);
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(mecsUtilIteratorCount(iterator) == 130 - 13);
+    REQUIRE(mecsWorldEntityGetNumChildren(world, entities[0]) == 2);
+    mecsWorldEntitySetParent(world, entities[11], MECS_INVALID);
+    REQUIRE(mecsWorldEntityGetDepth(world, entities[43]) == 1);
+    REQUIRE(propagate() == 117);
+
+    mecsWorldReleaseIterator(world, iterator);
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Resources")
+{
+    struct Gravity {
+        MecsU64 strength;
+    };
+    struct Score {
+        MecsU64 points;
+    };
+    struct Foo {
+        MecsU64 value;
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Gravity);
+    MECS_REGISTER_COMPONENT(registry, Score);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+    REQUIRE_FALSE(mecsWorldHasResource(world, Component_Score));
+    REQUIRE(mecsWorldGetResource(world, Component_Score) == nullptr);
+
+    static_cast<Gravity*>(mecsWorldAddResource(world, Component_Gravity))->strength = 10;
+    static_cast<Score*>(mecsWorldAddResource(world, Component_Score))->points = 0;
+    REQUIRE(mecsWorldHasResource(world, Component_Gravity));
+    REQUIRE_FALSE(mecsWorldHasResource(world, Component_Foo));
+
+    // The resources are not entities: the iterators don't see them
+    for (int i = 0; i < 10; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, ent, Foo) = Foo { static_cast<MecsU64>(i) };
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    MecsIterator* gravityIterator = mecsWorldAcquireIterator(world);
+    mecsIterComponent(gravityIterator, Component_Gravity, 0);
+    mecsIteratorFinalize(gravityIterator);
+    REQUIRE(mecsUtilIteratorCount(gravityIterator) == 0);
+    mecsWorldReleaseIterator(world, gravityIterator);
+
+    // Fall reads Gravity and writes Foo, Count reads Foo and writes Score, Report only checks Foo and reads Score
+    MecsScheduleID schedule = mecsWorldDefineSchedule(world, nullptr);
+    auto defineSystem = [&](MecsIteratorFilter fooFilter, MecsComponentID resource, MecsIteratorFilter resourceFilter, PFNMecsSystemRun run) {
+        MecsComponentID components[] = { Component_Foo };
+        MecsIteratorFilter filters[] = { fooFilter };
+        MecsComponentID resources[] = { resource };
+        MecsIteratorFilter resourceFilters[] = { resourceFilter };
+        MecsDefineSystemInfo systemInfo {};
+        systemInfo.numComponents = 1;
+        systemInfo.pComponents = components;
+        systemInfo.pFilters = filters;
+        systemInfo.numResources = 1;
+        systemInfo.pResources = resources;
+        systemInfo.pResourceFilters = resourceFilters;
+        systemInfo.systemRun = run;
+        return mecsWorldDefineSystem(world, &systemInfo, schedule);
+    };
+    const MecsSystemID fall = defineSystem(MecsIteratorFilter::Access, Component_Gravity, MecsIteratorFilter::Read, [](void*, void*, MecsIterator* iterator) {
+        const auto* gravity = static_cast<const Gravity*>(mecsWorldReadResource(mecsIteratorGetWorld(iterator), Component_Gravity));
+        mecsIteratorBegin(iterator);
+        while (mecsIteratorAdvance(iterator)) {
+            static_cast<Foo*>(mecsIteratorGetArgument(iterator, 0))->value += gravity->strength;
+        }
+    });
+    const MecsSystemID count = defineSystem(MecsIteratorFilter::Read, Component_Score, MecsIteratorFilter::Access, [](void*, void*, MecsIterator* iterator) {
+        auto* score = static_cast<Score*>(mecsWorldGetResource(mecsIteratorGetWorld(iterator), Component_Score));
+        mecsIteratorBegin(iterator);
+        while (mecsIteratorAdvance(iterator)) {
+            score->points += static_cast<const Foo*>(mecsIteratorGetArgument(iterator, 0))->value;
+        }
+    });
+    const MecsSystemID report = defineSystem(MecsIteratorFilter::With, Component_Score, MecsIteratorFilter::Read, [](void*, void*, MecsIterator*) { });
+    mecsWorldFlushEvents(world, nullptr);
+
+    REQUIRE(mecsWorldSystemsConflict(world, schedule, fall, schedule, count));
+    REQUIRE(mecsWorldSystemsConflict(world, schedule, count, schedule, report));
+    REQUIRE_FALSE(mecsWorldSystemsConflict(world, schedule, report, schedule, report));
+    REQUIRE_FALSE(mecsWorldSystemsConflict(world, schedule, fall, schedule, report));
+
+    mecsWorldRunSchedule(world, schedule, nullptr);
+    // (0 + 1 + ... + 9) + 10 * 10
+    REQUIRE(static_cast<const Score*>(mecsWorldReadResource(world, Component_Score))->points == 145);
+
+    // The clones get a copy of the resources
+    MecsWorld* clone = mecsWorldCreate(registry, nullptr);
+    mecsWorldClone(world, clone, MecsWorldCloneFlags_None);
+    REQUIRE(static_cast<Score*>(mecsWorldGetResource(clone, Component_Score))->points == 145);
+    static_cast<Score*>(mecsWorldGetResource(clone, Component_Score))->points = 0;
+    REQUIRE(static_cast<const Score*>(mecsWorldReadResource(world, Component_Score))->points == 145);
+    mecsWorldFree(clone);
+
+    mecsWorldRemoveResource(world, Component_Gravity);
+    REQUIRE_FALSE(mecsWorldHasResource(world, Component_Gravity));
+    static_cast<Gravity*>(mecsWorldAddResource(world, Component_Gravity))->strength = 1;
+    REQUIRE(static_cast<const Gravity*>(mecsWorldReadResource(world, Component_Gravity))->strength == 1);
+
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Observers")
+{
+    struct Body {
+        MecsU64 handle;
+    };
+    struct Foo {
+        MecsU64 value;
+    };
+    struct ObserverLog {
+        int calls = 0;
+        std::vector<MecsEntityID> entities;
+        std::vector<MecsU64> handles;
+
+        static void observe(void* observerData, void*, const MecsEntityID* pEntities, void* const* pComponents, MecsSize count)
+        {
+            auto* log = static_cast<ObserverLog*>(observerData);
+            log->calls++;
+            for (MecsSize i = 0; i < count; i++) {
+                log->entities.push_back(pEntities[i]);
+                log->handles.push_back(static_cast<const Body*>(pComponents[i])->handle);
+            }
+        }
+        void reset()
+        {
+            calls = 0;
+            entities.clear();
+            handles.clear();
+        }
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Body);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+
+    MecsWorldCreateInfo worldInfo {};
+    SECTION("In order flush") { worldInfo.worldFlags = MecsWorldFlags_None; }
+    SECTION("Batched flush") { worldInfo.worldFlags = MecsWorldFlags_BatchedFlush; }
+    const bool batched = worldInfo.worldFlags == MecsWorldFlags_BatchedFlush;
+    MecsWorld* world = mecsWorldCreate(registry, &worldInfo);
+
+    ObserverLog added;
+    ObserverLog removed;
+    ObserverLog changed;
+    MecsDefineObserverInfo observerInfo {};
+    observerInfo.component = Component_Body;
+    observerInfo.observe = ObserverLog::observe;
+    observerInfo.event = MecsObserverEvent_Added;
+    observerInfo.observerData = &added;
+    mecsWorldDefineObserver(world, &observerInfo);
+    observerInfo.event = MecsObserverEvent_Removed;
+    observerInfo.observerData = &removed;
+    mecsWorldDefineObserver(world, &observerInfo);
+    observerInfo.event = MecsObserverEvent_Changed;
+    observerInfo.observerData = &changed;
+    mecsWorldDefineObserver(world, &observerInfo);
+
+    // The bodies are handed out all at once, even if they end up in different archetypes
+    MecsEntityID entities[100];
+    for (int i = 0; i < 100; i++) {
+        entities[i] = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, entities[i], Body) = Body { static_cast<MecsU64>(i) };
+        if (i % 2 == 0) {
+            MECS_COMPONENT(world, entities[i], Foo) = Foo { static_cast<MecsU64>(i) };
+        }
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(added.calls == 1);
+    REQUIRE(added.entities.size() == 100);
+    for (size_t i = 0; i < added.entities.size(); i++) {
+        REQUIRE(entities[added.handles[i]] == added.entities[i]);
+    }
+    REQUIRE(removed.calls == 0);
+
+    // Only the observed components are worth an event
+    mecsWorldEntityComponentChanged(world, entities[0], Component_Foo);
+    MecsWorldStats stats {};
+    mecsWorldGetStats(world, &stats);
+    REQUIRE(stats.numPendingEvents == 0);
+    for (int i = 0; i < 10; i++) {
+        static_cast<Body*>(mecsWorldEntityGetComponent(world, entities[i], Component_Body))->handle += 1000;
+        mecsWorldEntityComponentChanged(world, entities[i], Component_Body);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(changed.calls == 1);
+    REQUIRE(changed.entities.size() == 10);
+    REQUIRE(changed.handles[9] == 1009);
+    REQUIRE(added.calls == 1);
+
+    // The removed bodies are still readable, a batched flush hands them out once for the removals and once for the
+    // destructions
+    added.reset();
+    for (int i = 10; i < 30; i++) {
+        mecsWorldRemoveComponent(world, entities[i], Component_Body);
+    }
+    for (int i = 30; i < 40; i++) {
+        mecsWorldDestroyEntity(world, entities[i]);
+    }
+    MecsEntityID shortLived = mecsWorldSpawnEntity(world, nullptr);
+    MECS_COMPONENT(world, shortLived, Body) = Body { 12345 };
+    mecsWorldDestroyEntity(world, shortLived);
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(removed.entities.size() == 31);
+    REQUIRE(removed.calls == (batched ? 2 : 31));
+    for (size_t i = 0; i < removed.entities.size(); i++) {
+        if (removed.entities[i] == shortLived) {
+            REQUIRE(removed.handles[i] == 12345);
+        } else {
+            REQUIRE(entities[removed.handles[i]] == removed.entities[i]);
+        }
+    }
+    // The body of the short lived entity was added before being removed
+    REQUIRE(added.entities.size() == 1);
+    REQUIRE(added.entities[0] == shortLived);
+
+    // A change is handed out before the removal that follows it
+    changed.reset();
+    removed.reset();
+    mecsWorldEntityComponentChanged(world, entities[50], Component_Body);
+    mecsWorldRemoveComponent(world, entities[50], Component_Body);
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(changed.entities.size() == 1);
+    REQUIRE(removed.entities.size() == 1);
+    REQUIRE(removed.handles[0] == 50);
+
+    // A component removed twice is handed out once
+    removed.reset();
+    mecsWorldRemoveComponent(world, entities[60], Component_Body);
+    mecsWorldRemoveComponent(world, entities[62], Component_Body);
+    mecsWorldRemoveComponent(world, entities[60], Component_Body);
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(removed.entities == std::vector<MecsEntityID> { entities[60], entities[62] });
+
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Schedule runner")
+{
+    struct Clock {
+        MecsU64 ticks;
+    };
+    struct Foo {
+        MecsU64 value;
+    };
+    struct UpdateData {
+        bool customEnabled;
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Clock);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+    mecsWorldAddResource(world, Component_Clock);
+
+    // Four steps per second, at most three steps for each update
+    MecsDefineScheduleInfo scheduleInfo { .scheduleName = "Fixed", .fixedTimestep = 0.25, .maxCatchUpRuns = 3 };
+    MecsScheduleID schedule = mecsWorldDefineSchedule(world, &scheduleInfo);
+
+    // Each system counts its runs in its systemData
+    enum : MecsU32 { Always, EveryThird, HasEntities, ClockChanged, Custom, NumSystems };
+    std::array<int, NumSystems> runs {};
+    auto defineSystem = [&](MecsU32 index, MecsU32 runInterval, int runConditions, PFNMecsSystemRunCondition runCondition) {
+        MecsComponentID components[] = { Component_Foo };
+        MecsIteratorFilter filters[] = { MecsIteratorFilter::Read };
+        MecsComponentID resources[] = { Component_Clock };
+        MecsIteratorFilter resourceFilters[] = { MecsIteratorFilter::Read };
+        MecsDefineSystemInfo systemInfo {};
+        systemInfo.numComponents = 1;
+        systemInfo.pComponents = components;
+        systemInfo.pFilters = filters;
+        systemInfo.numResources = 1;
+        systemInfo.pResources = resources;
+        systemInfo.pResourceFilters = resourceFilters;
+        systemInfo.systemData = &runs[index];
+        systemInfo.systemRun = [](void* systemData, void*, MecsIterator*) { (*static_cast<int*>(systemData))++; };
+        systemInfo.runInterval = runInterval;
+        systemInfo.runConditions = runConditions;
+        systemInfo.runCondition = runCondition;
+        mecsWorldDefineSystem(world, &systemInfo, schedule);
+    };
+    defineSystem(Always, 0, MecsSystemRunConditions_None, nullptr);
+    defineSystem(EveryThird, 3, MecsSystemRunConditions_None, nullptr);
+    defineSystem(HasEntities, 0, MecsSystemRunConditions_HasEntities, nullptr);
+    defineSystem(ClockChanged, 0, MecsSystemRunConditions_ResourcesChanged, nullptr);
+    defineSystem(Custom, 0, MecsSystemRunConditions_None, [](void*, void* updateData, MecsWorld*) {
+        return static_cast<UpdateData*>(updateData)->customEnabled;
+    });
+    mecsWorldFlushEvents(world, nullptr);
+
+    UpdateData updateData { .customEnabled = false };
+    REQUIRE(mecsWorldUpdateSchedule(world, schedule, 0.125, &updateData) == 0);
+    REQUIRE(mecsWorldGetScheduleInterpolation(world, schedule) == 0.5);
+    REQUIRE(runs == std::array<int, NumSystems> { 0, 0, 0, 0, 0 });
+
+    // No entities yet and the custom condition is false
+    REQUIRE(mecsWorldUpdateSchedule(world, schedule, 0.125, &updateData) == 1);
+    REQUIRE(mecsWorldGetScheduleInterpolation(world, schedule) == 0.0);
+    REQUIRE(runs == std::array<int, NumSystems> { 1, 1, 0, 1, 0 });
+
+    MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+    MECS_COMPONENT(world, ent, Foo);
+    mecsWorldFlushEvents(world, nullptr);
+    updateData.customEnabled = true;
+
+    // Reading the resource doesn't change it
+    const MecsU64 clockVersion = mecsWorldGetResourceVersion(world, Component_Clock);
+    REQUIRE(static_cast<const Clock*>(mecsWorldReadResource(world, Component_Clock))->ticks == 0);
+    REQUIRE(mecsWorldGetResourceVersion(world, Component_Clock) == clockVersion);
+
+    // A long frame is capped to three steps, the time left is dropped
+    REQUIRE(mecsWorldUpdateSchedule(world, schedule, 1.125, &updateData) == 3);
+    REQUIRE(mecsWorldGetScheduleInterpolation(world, schedule) == 0.5);
+    REQUIRE(runs == std::array<int, NumSystems> { 4, 2, 3, 1, 3 });
+
+    static_cast<Clock*>(mecsWorldGetResource(world, Component_Clock))->ticks++;
+    REQUIRE(mecsWorldGetResourceVersion(world, Component_Clock) > clockVersion);
+    REQUIRE(mecsWorldUpdateSchedule(world, schedule, 0.25, &updateData) == 1);
+    REQUIRE(runs == std::array<int, NumSystems> { 5, 2, 4, 2, 4 });
+
+    // A schedule without a fixed timestep runs once for each update
+    MecsScheduleID variable = mecsWorldDefineSchedule(world, nullptr);
+    REQUIRE(mecsWorldUpdateSchedule(world, variable, 10.0, nullptr) == 1);
+    REQUIRE(mecsWorldGetScheduleInterpolation(world, variable) == 0.0);
+
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Tracking allocator")
+{
+    struct Foo {
+        MecsU64 value;
+    };
+
+    MecsTrackingAllocator* tracker = mecsTrackingAllocatorCreate(&kDebugAllocator);
+    MecsAllocator allocators[MecsAllocationTag_Count];
+    mecsTrackingAllocatorGetAllocators(tracker, allocators);
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.pTaggedAllocators = allocators;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+    MecsPrefabID prefab = mecsRegistryCreatePrefab(registry);
+    mecsRegistryPrefabAddComponent(registry, prefab, Component_Foo);
+
+    // The world inherits the allocators of the registry
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+    for (int i = 0; i < 100; i++) {
+        mecsWorldSpawnEntityPrefab(world, prefab, nullptr);
+    }
+
+    auto stats = [&](MecsAllocationTag tag) {
+        MecsAllocationStats stats;
+        mecsTrackingAllocatorGetStats(tracker, tag, &stats);
+        return stats;
+    };
+    REQUIRE(stats(MecsAllocationTag_World).currentBytes > 0);
+    REQUIRE(stats(MecsAllocationTag_ArchetypeColumns).currentBytes >= 100 * sizeof(Foo));
+    REQUIRE(stats(MecsAllocationTag_Entities).currentBytes > 0);
+    REQUIRE(stats(MecsAllocationTag_Events).currentBytes > 0);
+    REQUIRE(stats(MecsAllocationTag_Registry).currentBytes > 0);
+    REQUIRE(stats(MecsAllocationTag_Prefabs).currentBytes >= sizeof(Foo));
+    REQUIRE(stats(MecsAllocationTag_Strings).currentBytes >= sizeof("Foo"));
+    REQUIRE(stats(MecsAllocationTag_User).currentBytes == 0);
+
+    MecsAllocationStats total;
+    mecsTrackingAllocatorGetTotalStats(tracker, &total);
+    MecsSize sum = 0;
+    for (MecsSize tag = 0; tag < MecsAllocationTag_Count; tag++) {
+        sum += stats(static_cast<MecsAllocationTag>(tag)).currentBytes;
+        REQUIRE(mecsAllocationTagName(static_cast<MecsAllocationTag>(tag)) != nullptr);
+    }
+    REQUIRE(total.currentBytes == sum);
+    REQUIRE(total.peakBytes >= total.currentBytes);
+
+    // The events are kept for the next flush, but they only go away with the world
+    const MecsSize eventBytes = stats(MecsAllocationTag_Events).currentBytes;
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(stats(MecsAllocationTag_Events).currentBytes == eventBytes);
+
+    mecsWorldFree(world);
+    REQUIRE(stats(MecsAllocationTag_ArchetypeColumns).currentBytes == 0);
+    REQUIRE(stats(MecsAllocationTag_ArchetypeColumns).peakBytes >= 100 * sizeof(Foo));
+    REQUIRE(stats(MecsAllocationTag_Events).currentBytes == 0);
+    REQUIRE(stats(MecsAllocationTag_Registry).currentBytes > 0);
+
+    mecsRegistryFree(registry);
+    mecsTrackingAllocatorGetTotalStats(tracker, &total);
+    REQUIRE(total.currentBytes == 0);
+    REQUIRE(total.numAllocations == 0);
+    REQUIRE(total.totalAllocations > 0);
+    mecsTrackingAllocatorFree(tracker);
+}
+
+struct TraceLog {
+    struct Entry {
+        bool begin;
+        MecsTraceScope scope;
+        std::string name;
+        MecsSize numItems;
+    };
+    std::vector<Entry> entries;
+
+    static void onBegin(void* userData, const MecsTraceEvent* event)
+    {
+        static_cast<TraceLog*>(userData)->entries.push_back({ true, event->scope, event->name != nullptr ? event->name : "", event->numItems });
+    }
+
+    static void onEnd(void* userData, const MecsTraceEvent* event)
+    {
+        static_cast<TraceLog*>(userData)->entries.push_back({ false, event->scope, event->name != nullptr ? event->name : "", event->numItems });
+    }
+
+    const Entry* find(MecsTraceScope scope, const char* name) const
+    {
+        for (const Entry& entry : entries) {
+            if (entry.begin && entry.scope == scope && entry.name == name) { return &entry; }
+        }
+        return nullptr;
+    }
+};
+
+TEST_CASE("Tracing")
+{
+    struct Foo {
+        MecsU32 value;
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+
+    MecsWorldCreateInfo worldInfo {};
+    SECTION("In order flush") { worldInfo.worldFlags = MecsWorldFlags_None; }
+    SECTION("Batched flush") { worldInfo.worldFlags = MecsWorldFlags_BatchedFlush; }
+    MecsWorld* world = mecsWorldCreate(registry, &worldInfo);
+
+    TraceLog log;
+    MecsTraceHooks hooks { .begin = TraceLog::onBegin, .end = TraceLog::onEnd, .userData = &log };
+    mecsWorldSetTraceHooks(world, &hooks);
+
+    MecsDefineScheduleInfo scheduleInfo { .scheduleName = "Update" };
+    MecsScheduleID schedule = mecsWorldDefineSchedule(world, &scheduleInfo);
+    MecsComponentID components[] = { Component_Foo };
+    MecsIteratorFilter filters[] = { MecsIteratorFilter::Access };
+    MecsDefineSystemInfo systemInfo {};
+    systemInfo.numComponents = 1;
+    systemInfo.pComponents = components;
+    systemInfo.pFilters = filters;
+    systemInfo.systemRun = [](void*, void*, MecsIterator*) { };
+    systemInfo.systemName = "Move";
+    mecsWorldDefineSystem(world, &systemInfo, schedule);
+
+    for (int i = 0; i < 10; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+        MECS_COMPONENT(world, ent, Foo);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    mecsWorldRunSchedule(world, schedule, nullptr);
+
+    // Every begin is matched by an end of the same scope
+    std::vector<MecsTraceScope> stack;
+    for (const TraceLog::Entry& entry : log.entries) {
+        if (entry.begin) {
+            stack.push_back(entry.scope);
+        } else {
+            REQUIRE(!stack.empty());
+            REQUIRE(stack.back() == entry.scope);
+            stack.pop_back();
+        }
+    }
+    REQUIRE(stack.empty());
+
+    // One system added, 10 entities spawned and 10 components added
+    const TraceLog::Entry* flush = log.find(MecsTraceScope_Flush, "flush");
+    REQUIRE(flush != nullptr);
+    REQUIRE(flush->numItems == 21);
+    if (worldInfo.worldFlags == MecsWorldFlags_BatchedFlush) {
+        REQUIRE(log.find(MecsTraceScope_FlushPhase, "add system") != nullptr);
+        REQUIRE(log.find(MecsTraceScope_FlushPhase, "spawn entities")->numItems == 10);
+        REQUIRE(log.find(MecsTraceScope_FlushPhase, "add components")->numItems == 10);
+    } else {
+        REQUIRE(log.find(MecsTraceScope_FlushPhase, "events")->numItems == 21);
+    }
+    REQUIRE(log.find(MecsTraceScope_FlushPhase, "notify systems") != nullptr);
+
+    const TraceLog::Entry* update = log.find(MecsTraceScope_Schedule, "Update");
+    REQUIRE(update != nullptr);
+    REQUIRE(update->numItems == 1);
+    const TraceLog::Entry* move = log.find(MecsTraceScope_System, "Move");
+    REQUIRE(move != nullptr);
+    REQUIRE(move->numItems == 10);
+
+    // The recorder collects the same scopes
+    MecsTraceRecorder* recorder = mecsTraceRecorderCreate(&kDebugAllocator);
+    MecsTraceHooks recorderHooks = mecsTraceRecorderGetHooks(recorder);
+    mecsWorldSetTraceHooks(world, &recorderHooks);
+    mecsWorldRunSchedule(world, schedule, nullptr);
+    REQUIRE(mecsTraceRecorderGetNumEvents(recorder) == 2);
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(mecsTraceRecorderGetNumEvents(recorder) > 2);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "mecs_trace_test.json").string();
+    REQUIRE(mecsTraceRecorderWriteChromeTrace(recorder, path.c_str()));
+    std::ifstream file(path);
+    const std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(path);
+    REQUIRE(json.starts_with("{\"traceEvents\":["));
+    REQUIRE(json.find("\"name\":\"Move\",\"cat\":\"system\",\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(json.find("\"items\":10") != std::string::npos);
+
+    mecsTraceRecorderClear(recorder);
+    REQUIRE(mecsTraceRecorderGetNumEvents(recorder) == 0);
+
+    mecsWorldSetTraceHooks(world, nullptr);
+    mecsWorldRunSchedule(world, schedule, nullptr);
+    REQUIRE(mecsTraceRecorderGetNumEvents(recorder) == 0);
+
+    mecsTraceRecorderFree(recorder);
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
 TEST_CASE("Spawning components in a loop")
 {
 
@@ -366,91 +1509,880 @@ TEST_CASE("Spawning components in a loop")
         mecsIterComponent(bulletCounter, Component_Bullet, 0);
         mecsIteratorFinalize(bulletCounter);
 
-        MecsSize numBullets = 0;
-        mecsIteratorBegin(bulletCounter);
-        while (mecsIteratorAdvance(bulletCounter)) {
-            numBullets++;
+        MecsSize numBullets = 0;
+        mecsIteratorBegin(bulletCounter);
+        while (mecsIteratorAdvance(bulletCounter)) {
+            numBullets++;
+        }
+        REQUIRE(numBullets == 0);
+        mecsWorldReleaseIterator(world, bulletCounter);
+    }
+
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+struct SystemAB {
+    int numEntities;
+};
+
+struct SystemACD {
+    int numEntities;
+};
+
+void onEntityAdded_SystemAB(void* data, void* update, MecsEntityID entity)
+{
+    SystemAB* system = (SystemAB*)data;
+    system->numEntities++;
+}
+
+void systemRun_SystemAB(void* data, void* update, MecsIterator* iterator)
+{
+
+}
+
+
+void onEntityRemoved_SystemAB(void* data, void* update, MecsEntityID entity)
+{
+    SystemAB* system = (SystemAB*)data;
+    system->numEntities--;
+}
+void onEntitiesAdded_SystemAB(void* data, void* update, const MecsEntityID* entities, MecsSize numEntities)
+{
+    SystemAB* system = (SystemAB*)data;
+    system->numEntities += (int)numEntities;
+}
+struct SystemLog {
+    // +N for N entities added, -N for N entities removed
+    std::vector<int> calls;
+    // The entities handed out by each call
+    std::vector<std::vector<MecsEntityID>> entities;
+};
+
+void onEntitiesAdded_SystemLog(void* data, void* update, const MecsEntityID* entities, MecsSize numEntities)
+{
+    SystemLog* system = (SystemLog*)data;
+    system->calls.push_back((int)numEntities);
+    system->entities.emplace_back(entities, entities + numEntities);
+}
+
+void onEntitiesRemoved_SystemLog(void* data, void* update, const MecsEntityID* entities, MecsSize numEntities)
+{
+    SystemLog* system = (SystemLog*)data;
+    system->calls.push_back(-(int)numEntities);
+    system->entities.emplace_back(entities, entities + numEntities);
+}
+
+void onEntityAdded_SystemACD(void* data, void* update, MecsEntityID entity)
+{
+    SystemACD* system = (SystemACD*)data;
+    system->numEntities++;
+}
+
+void systemRun_SystemACD(void* data, void* update, MecsIterator* iterator)
+{
+}
+
+void onEntityRemoved_SystemACD(void* data, void* update, MecsEntityID entity)
+
+{
+    SystemACD* system = (SystemACD*)data;
+    system->numEntities--;
+}
+
+struct ComponentA {
+};
+struct ComponentB {
+};
+struct ComponentC {
+};
+struct ComponentD {
+};
+
+struct Transform{};
+struct Mesh {};
+
+struct DirectionalLight{};
+struct PointLight{};
+struct SpotLight{};
+
+MECS_RTTI_SIMPLE(ComponentA);
+MECS_RTTI_SIMPLE(ComponentB);
+MECS_RTTI_SIMPLE(ComponentC);
+MECS_RTTI_SIMPLE(ComponentD);
+
+MECS_RTTI_SIMPLE(Transform);
+MECS_RTTI_SIMPLE(Mesh);
+
+MECS_RTTI_SIMPLE(DirectionalLight);
+MECS_RTTI_SIMPLE(PointLight);
+MECS_RTTI_SIMPLE(SpotLight);
+
+struct SnapshotBuffer {
+    std::vector<MecsU8> bytes;
+    MecsSize readOffset = 0;
+
+    static MecsSize write(void* userData, const void* data, MecsSize size)
+    {
+        auto* buffer = static_cast<SnapshotBuffer*>(userData);
+        buffer->bytes.insert(buffer->bytes.end(), static_cast<const MecsU8*>(data), static_cast<const MecsU8*>(data) + size);
+        return size;
+    }
+
+    static MecsSize read(void* userData, void* data, MecsSize size)
+    {
+        auto* buffer = static_cast<SnapshotBuffer*>(userData);
+        size = std::min(size, buffer->bytes.size() - buffer->readOffset);
+        memcpy(data, buffer->bytes.data() + buffer->readOffset, size);
+        buffer->readOffset += size;
+        return size;
+    }
+};
+
+// Only stores an index into a table, so it can't be written as raw bytes
+struct SnapshotSprite {
+    const char* path;
+};
+static const char* kSnapshotSpritePaths[] = { "player.png", "enemy.png" };
+
+static bool serializeSnapshotSprite(const void* mem, const MecsWriter* writer)
+{
+    const auto* sprite = static_cast<const SnapshotSprite*>(mem);
+    const MecsU8 index = sprite->path == kSnapshotSpritePaths[0] ? 0 : 1;
+    return writer->write(writer->userData, &index, sizeof(index)) == sizeof(index);
+}
+
+static bool deserializeSnapshotSprite(void* mem, const MecsReader* reader)
+{
+    MecsU8 index = 0;
+    if (reader->read(reader->userData, &index, sizeof(index)) != sizeof(index) || index > 1) {
+        return false;
+    }
+    static_cast<SnapshotSprite*>(mem)->path = kSnapshotSpritePaths[index];
+    return true;
+}
+
+TEST_CASE("World snapshots")
+{
+    struct Position {
+        float x, y;
+    };
+    struct Velocity {
+        double dx, dy;
+    };
+
+    MecsWorldCreateInfo worldInfo {};
+    worldInfo.worldFlags = GENERATE(MecsWorldFlags_None, MecsWorldFlags_BatchedFlush);
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Position);
+    MECS_REGISTER_COMPONENT(registry, Velocity);
+    MecsComponentID Component_Sprite = MECS_INVALID;
+    {
+        ComponentInfo info = MECS_COMPONENTINFO(SnapshotSprite);
+        info.serialize = serializeSnapshotSprite;
+        info.deserialize = deserializeSnapshotSprite;
+        Component_Sprite = mecsRegistryAddRegistration(registry, &info);
+    }
+
+    MecsWorld* world = mecsWorldCreate(registry, &worldInfo);
+    std::vector<MecsEntityID> entities;
+    for (int i = 0; i < 200; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+        auto* position = static_cast<Position*>(mecsWorldAddComponent(world, ent, Component_Position));
+        *position = Position { static_cast<float>(i), static_cast<float>(-i) };
+        if (i % 2 == 0) {
+            auto* velocity = static_cast<Velocity*>(mecsWorldAddComponent(world, ent, Component_Velocity));
+            *velocity = Velocity { i * 0.5, i * 2.0 };
+        }
+        if (i % 3 == 0) {
+            auto* sprite = static_cast<SnapshotSprite*>(mecsWorldAddComponent(world, ent, Component_Sprite));
+            sprite->path = kSnapshotSpritePaths[i % 2];
+        }
+        entities.push_back(ent);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+
+    // Leave some holes in the entity arena, the free slots must be reused in the same order after a restore
+    for (int i = 0; i < 200; i += 10) {
+        mecsWorldDestroyEntity(world, entities[i]);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+
+    SnapshotBuffer buffer;
+    const MecsWriter writer { .write = SnapshotBuffer::write, .userData = &buffer };
+    REQUIRE(mecsWorldSerialize(world, &writer));
+
+    MecsWorld* restored = mecsWorldCreate(registry, &worldInfo);
+    MecsScheduleID schedule = mecsWorldDefineSchedule(restored, nullptr);
+    SystemAB positionSystem;
+    positionSystem.numEntities = 0;
+    {
+        MecsComponentID components[] = { Component_Position, Component_Velocity };
+        MecsIteratorFilter filters[] = { MecsIteratorFilter::Access, MecsIteratorFilter::Access };
+        MecsDefineSystemInfo systemInfo {};
+        systemInfo.numComponents = 2;
+        systemInfo.pComponents = components;
+        systemInfo.pFilters = filters;
+        systemInfo.onEntityAdded = onEntityAdded_SystemAB;
+        systemInfo.systemRun = systemRun_SystemAB;
+        systemInfo.onEntityRemoved = onEntityRemoved_SystemAB;
+        systemInfo.systemData = &positionSystem;
+        mecsWorldDefineSystem(restored, &systemInfo, schedule);
+    }
+    mecsWorldFlushEvents(restored, nullptr);
+
+    const MecsReader reader { .read = SnapshotBuffer::read, .userData = &buffer };
+    REQUIRE(mecsWorldDeserialize(restored, &reader));
+    REQUIRE(buffer.readOffset == buffer.bytes.size());
+
+    // The systems are notified at the next flush, the destroyed entities 0, 10, 20... are even and had a velocity
+    REQUIRE(positionSystem.numEntities == 0);
+    mecsWorldFlushEvents(restored, nullptr);
+    REQUIRE(positionSystem.numEntities == 80);
+
+    for (int i = 0; i < 200; i++) {
+        const MecsEntityID ent = entities[i];
+        if (i % 10 == 0) {
+            continue;
+        }
+        REQUIRE(mecsWorldEntityGetNumComponents(restored, ent) == mecsWorldEntityGetNumComponents(world, ent));
+        const auto* position = static_cast<Position*>(mecsWorldEntityGetComponent(restored, ent, Component_Position));
+        REQUIRE(position->x == static_cast<float>(i));
+        REQUIRE(position->y == static_cast<float>(-i));
+        REQUIRE(mecsWorldEntityHasComponent(restored, ent, Component_Velocity) == (i % 2 == 0));
+        if (i % 2 == 0) {
+            const auto* velocity = static_cast<Velocity*>(mecsWorldEntityGetComponent(restored, ent, Component_Velocity));
+            REQUIRE(velocity->dx == i * 0.5);
+            REQUIRE(velocity->dy == i * 2.0);
+        }
+        REQUIRE(mecsWorldEntityHasComponent(restored, ent, Component_Sprite) == (i % 3 == 0));
+        if (i % 3 == 0) {
+            const auto* sprite = static_cast<SnapshotSprite*>(mecsWorldEntityGetComponent(restored, ent, Component_Sprite));
+            REQUIRE(sprite->path == kSnapshotSpritePaths[i % 2]);
+        }
+    }
+
+    // Both worlds hand out the same IDs for the next entities
+    for (int i = 0; i < 25; i++) {
+        REQUIRE(mecsWorldSpawnEntity(restored, nullptr) == mecsWorldSpawnEntity(world, nullptr));
+    }
+    mecsWorldFree(restored);
+
+    // A truncated snapshot is rejected, leaving the world empty. The last archetype is cut short,
+    // after the rows of the others were already restored
+    SnapshotBuffer truncated;
+    truncated.bytes.assign(buffer.bytes.begin(), buffer.bytes.end() - 1);
+    const MecsReader truncatedReader { .read = SnapshotBuffer::read, .userData = &truncated };
+    MecsWorld* broken = mecsWorldCreate(registry, &worldInfo);
+    REQUIRE_FALSE(mecsWorldDeserialize(broken, &truncatedReader));
+    MecsWorldStats stats;
+    mecsWorldGetStats(broken, &stats);
+    REQUIRE(stats.numEntities == 0);
+
+    // ...and usable: the rows restored before the failure are gone from the archetypes too
+    std::vector<MecsEntityID> survivors;
+    for (int i = 0; i < 6; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(broken, nullptr);
+        MECS_COMPONENT(broken, ent, Position) = Position { static_cast<float>(i), 0.0f };
+        if (i % 2 == 0) {
+            MECS_COMPONENT(broken, ent, Velocity) = Velocity { 1.0, 1.0 };
+        }
+        if (i % 3 == 0) {
+            mecsWorldAddComponent(broken, ent, Component_Sprite);
+        }
+        survivors.push_back(ent);
+    }
+    mecsWorldFlushEvents(broken, nullptr);
+    int numAdded = 0;
+    {
+        MecsComponentID components[] = { Component_Position, Component_Velocity };
+        MecsIteratorFilter filters[] = { MecsIteratorFilter::Read, MecsIteratorFilter::Read };
+        MecsDefineSystemInfo systemInfo {};
+        systemInfo.numComponents = 2;
+        systemInfo.pComponents = components;
+        systemInfo.pFilters = filters;
+        systemInfo.systemData = &numAdded;
+        systemInfo.systemRun = [](void*, void*, MecsIterator*) { };
+        systemInfo.onEntityAdded = [](void* systemData, void*, MecsEntityID) { (*static_cast<int*>(systemData))++; };
+        mecsWorldDefineSystem(broken, &systemInfo, mecsWorldDefineSchedule(broken, nullptr));
+    }
+    mecsWorldFlushEvents(broken, nullptr);
+    REQUIRE(numAdded == 3);
+    MecsIterator* positions = mecsWorldAcquireIterator(broken);
+    mecsIterComponent(positions, Component_Position, 0);
+    mecsIteratorFinalize(positions);
+    REQUIRE(mecsUtilIteratorCount(positions) == 6);
+    mecsWorldReleaseIterator(broken, positions);
+    for (int i = 0; i < 6; i++) {
+        REQUIRE(static_cast<const Position*>(mecsWorldEntityGetComponent(broken, survivors[i], Component_Position))->x == static_cast<float>(i));
+    }
+    mecsWorldGetStats(broken, &stats);
+    REQUIRE(stats.numEntities == 6);
+    mecsWorldFree(broken);
+
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
+
+TEST_CASE("Mapped world snapshots")
+{
+    struct Position {
+        float x, y;
+    };
+    struct Velocity {
+        double dx, dy;
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Position);
+    MECS_REGISTER_COMPONENT(registry, Velocity);
+    MecsComponentID Component_Sprite = MECS_INVALID;
+    {
+        ComponentInfo info = MECS_COMPONENTINFO(SnapshotSprite);
+        info.serialize = serializeSnapshotSprite;
+        info.deserialize = deserializeSnapshotSprite;
+        Component_Sprite = mecsRegistryAddRegistration(registry, &info);
+    }
+
+    // Large enough for the columns to span some pages
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+    std::vector<MecsEntityID> entities;
+    for (int i = 0; i < 2000; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+        *static_cast<Position*>(mecsWorldAddComponent(world, ent, Component_Position)) = Position { static_cast<float>(i), 1.0f };
+        if (i % 2 == 0) {
+            *static_cast<Velocity*>(mecsWorldAddComponent(world, ent, Component_Velocity)) = Velocity { 1.0, static_cast<double>(i) };
+        }
+        if (i % 5 == 0) {
+            static_cast<SnapshotSprite*>(mecsWorldAddComponent(world, ent, Component_Sprite))->path = kSnapshotSpritePaths[0];
+        }
+        entities.push_back(ent);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "mecs_snapshot_test.bin").string();
+    REQUIRE(mecsWorldSerializeToFile(world, path.c_str()));
+
+    auto checkWorld = [&](MecsWorld* mapped) {
+        for (int i = 0; i < 2000; i++) {
+            const auto* position = static_cast<Position*>(mecsWorldEntityGetComponent(mapped, entities[i], Component_Position));
+            REQUIRE(position->x == static_cast<float>(i));
+            if (i % 2 == 0) {
+                const auto* velocity = static_cast<Velocity*>(mecsWorldEntityGetComponent(mapped, entities[i], Component_Velocity));
+                REQUIRE(velocity->dy == static_cast<double>(i));
+            }
+            REQUIRE(mecsWorldEntityHasComponent(mapped, entities[i], Component_Sprite) == (i % 5 == 0));
+        }
+    };
+
+    MecsWorld* mapped = mecsWorldCreate(registry, nullptr);
+    REQUIRE(mecsWorldDeserializeMappedFile(mapped, path.c_str()));
+    mecsWorldFlushEvents(mapped, nullptr);
+    checkWorld(mapped);
+
+    // The mapped columns are not allocated by the world
+    MecsComponentStats positionStats;
+    mecsWorldGetComponentStats(mapped, Component_Position, &positionStats);
+    MecsComponentStats spriteStats;
+    mecsWorldGetComponentStats(mapped, Component_Sprite, &spriteStats);
+    REQUIRE(positionStats.columnBytes < 2000 * sizeof(Position));
+    REQUIRE(spriteStats.columnBytes >= 400 * sizeof(SnapshotSprite));
+
+    // Writes go to private copies of the pages, and growing a column moves it out of the mapping
+    static_cast<Position*>(mecsWorldEntityGetComponent(mapped, entities[1], Component_Position))->x = -1.0f;
+    mecsWorldDestroyEntity(mapped, entities[3]);
+    for (int i = 0; i < 100; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(mapped, nullptr);
+        mecsWorldAddComponent(mapped, ent, Component_Position);
+    }
+    mecsWorldFlushEvents(mapped, nullptr);
+    REQUIRE(static_cast<Position*>(mecsWorldEntityGetComponent(mapped, entities[1], Component_Position))->x == -1.0f);
+    REQUIRE(static_cast<Position*>(mecsWorldEntityGetComponent(mapped, entities[5], Component_Position))->x == 5.0f);
+
+    // The file itself is left untouched
+    MecsWorld* second = mecsWorldCreate(registry, nullptr);
+    REQUIRE(mecsWorldDeserializeFromFile(second, path.c_str()));
+    mecsWorldFlushEvents(second, nullptr);
+    checkWorld(second);
+
+    mecsWorldFree(second);
+    mecsWorldFree(mapped);
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("World deltas")
+{
+    struct Position {
+        float x, y;
+    };
+    struct Velocity {
+        double dx, dy;
+    };
+
+    MecsWorldCreateInfo worldInfo {};
+    worldInfo.worldFlags = GENERATE(MecsWorldFlags_None, MecsWorldFlags_BatchedFlush);
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Position);
+    MECS_REGISTER_COMPONENT(registry, Velocity);
+    MecsComponentID Component_Sprite = MECS_INVALID;
+    {
+        ComponentInfo info = MECS_COMPONENTINFO(SnapshotSprite);
+        info.serialize = serializeSnapshotSprite;
+        info.deserialize = deserializeSnapshotSprite;
+        Component_Sprite = mecsRegistryAddRegistration(registry, &info);
+    }
+
+    MecsWorld* world = mecsWorldCreate(registry, &worldInfo);
+    MecsWorldSnapshot* snapshot = mecsWorldSnapshotCreate(world);
+
+    MecsWorld* replica = mecsWorldCreate(registry, &worldInfo);
+    MecsScheduleID schedule = mecsWorldDefineSchedule(replica, nullptr);
+    SystemAB movingSystem;
+    movingSystem.numEntities = 0;
+    {
+        MecsComponentID components[] = { Component_Position, Component_Velocity };
+        MecsIteratorFilter filters[] = { MecsIteratorFilter::Access, MecsIteratorFilter::Access };
+        MecsDefineSystemInfo systemInfo {};
+        systemInfo.numComponents = 2;
+        systemInfo.pComponents = components;
+        systemInfo.pFilters = filters;
+        systemInfo.onEntityAdded = onEntityAdded_SystemAB;
+        systemInfo.systemRun = systemRun_SystemAB;
+        systemInfo.onEntityRemoved = onEntityRemoved_SystemAB;
+        systemInfo.systemData = &movingSystem;
+        mecsWorldDefineSystem(replica, &systemInfo, schedule);
+    }
+    mecsWorldFlushEvents(replica, nullptr);
+
+    std::vector<MecsEntityID> entities;
+    auto replicate = [&]() {
+        mecsWorldFlushEvents(world, nullptr);
+        SnapshotBuffer buffer;
+        const MecsWriter writer { .write = SnapshotBuffer::write, .userData = &buffer };
+        REQUIRE(mecsWorldWriteDelta(world, snapshot, &writer));
+        mecsWorldSnapshotUpdate(snapshot, world);
+
+        const MecsReader reader { .read = SnapshotBuffer::read, .userData = &buffer };
+        REQUIRE(mecsWorldApplyDelta(replica, &reader, nullptr));
+        REQUIRE(buffer.readOffset == buffer.bytes.size());
+        mecsWorldFlushEvents(replica, nullptr);
+
+        MecsWorldStats worldStats;
+        MecsWorldStats replicaStats;
+        mecsWorldGetStats(world, &worldStats);
+        mecsWorldGetStats(replica, &replicaStats);
+        REQUIRE(worldStats.numEntities == replicaStats.numEntities);
+        MecsSize numMoving = 0;
+        for (MecsEntityID ent : entities) {
+            REQUIRE(mecsWorldEntityGetNumComponents(replica, ent) == mecsWorldEntityGetNumComponents(world, ent));
+            for (MecsComponentID component : { Component_Position, Component_Velocity, Component_Sprite }) {
+                REQUIRE(mecsWorldEntityHasComponent(replica, ent, component) == mecsWorldEntityHasComponent(world, ent, component));
+                if (mecsWorldEntityHasComponent(world, ent, component)) {
+                    const MecsSize size = component == Component_Position ? sizeof(Position) : component == Component_Velocity ? sizeof(Velocity) : sizeof(SnapshotSprite);
+                    REQUIRE(memcmp(mecsWorldEntityGetComponent(replica, ent, component), mecsWorldEntityGetComponent(world, ent, component), size) == 0);
+                }
+            }
+            numMoving += mecsWorldEntityHasComponent(world, ent, Component_Position) && mecsWorldEntityHasComponent(world, ent, Component_Velocity) ? 1 : 0;
+        }
+        REQUIRE(movingSystem.numEntities == numMoving);
+        return buffer.bytes.size();
+    };
+
+    for (int i = 0; i < 300; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+        *static_cast<Position*>(mecsWorldAddComponent(world, ent, Component_Position)) = Position { static_cast<float>(i), 0.0f };
+        if (i % 2 == 0) {
+            *static_cast<Velocity*>(mecsWorldAddComponent(world, ent, Component_Velocity)) = Velocity { 1.0, -1.0 };
+        }
+        if (i % 3 == 0) {
+            static_cast<SnapshotSprite*>(mecsWorldAddComponent(world, ent, Component_Sprite))->path = kSnapshotSpritePaths[1];
+        }
+        entities.push_back(ent);
+    }
+    const MecsSize fullDeltaSize = replicate();
+
+    // Nothing changed
+    const MecsSize emptyDeltaSize = replicate();
+    REQUIRE(emptyDeltaSize < 100);
+
+    // Only the bytes of x change
+    for (int i = 0; i < 300; i += 2) {
+        static_cast<Position*>(mecsWorldEntityGetComponent(world, entities[i], Component_Position))->x += 1.0f;
+    }
+    const MecsSize moveDeltaSize = replicate();
+    REQUIRE(moveDeltaSize < emptyDeltaSize + 150 * 20);
+    REQUIRE(moveDeltaSize < fullDeltaSize / 2);
+
+    // Structural changes, the destroyed entities leave their slots to the spawned ones
+    for (int i = 1; i < 300; i += 7) {
+        mecsWorldDestroyEntity(world, entities[i]);
+    }
+    for (int i = 0; i < 300; i += 4) {
+        if (i % 7 != 1) {
+            mecsWorldRemoveComponent(world, entities[i], Component_Velocity);
+        }
+    }
+    for (int i = 5; i < 300; i += 10) {
+        if (i % 7 != 1 && !mecsWorldEntityHasComponent(world, entities[i], Component_Sprite)) {
+            static_cast<SnapshotSprite*>(mecsWorldAddComponent(world, entities[i], Component_Sprite))->path = kSnapshotSpritePaths[0];
+        }
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    std::erase_if(entities, [&](MecsEntityID ent) {
+        return getIndexFromGenArenaIndex(ent) % 7 == 1 && getIndexFromGenArenaIndex(ent) < 300;
+    });
+    for (int i = 0; i < 20; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+        *static_cast<Position*>(mecsWorldAddComponent(world, ent, Component_Position)) = Position { -1.0f, static_cast<float>(i) };
+        *static_cast<Velocity*>(mecsWorldAddComponent(world, ent, Component_Velocity)) = Velocity { 0.0, 0.0 };
+        entities.push_back(ent);
+    }
+    for (size_t i = 0; i < entities.size(); i += 3) {
+        if (mecsWorldEntityHasComponent(world, entities[i], Component_Sprite)) {
+            static_cast<SnapshotSprite*>(mecsWorldEntityGetComponent(world, entities[i], Component_Sprite))->path = kSnapshotSpritePaths[0];
         }
-        REQUIRE(numBullets == 0);
-        mecsWorldReleaseIterator(world, bulletCounter);
     }
+    replicate();
 
+    mecsWorldSnapshotFree(snapshot);
+    mecsWorldFree(replica);
     mecsWorldFree(world);
     mecsRegistryFree(registry);
 }
 
-struct SystemAB {
-    int numEntities;
+// Points to a text owned by someone else: editing the text in place leaves the bytes of the component as they are
+struct DeltaLabel {
+    std::string* text;
 };
+// The texts of the labels read back from a delta
+static std::deque<std::string> gDeltaLabelTexts;
 
-struct SystemACD {
-    int numEntities;
-};
+static bool serializeDeltaLabel(const void* mem, const MecsWriter* writer)
+{
+    const std::string& text = *static_cast<const DeltaLabel*>(mem)->text;
+    const auto length = static_cast<MecsU32>(text.size());
+    return writer->write(writer->userData, &length, sizeof(length)) == sizeof(length)
+        && writer->write(writer->userData, text.data(), length) == length;
+}
 
-void onEntityAdded_SystemAB(void* data, void* update, MecsEntityID entity)
+static bool deserializeDeltaLabel(void* mem, const MecsReader* reader)
 {
-    SystemAB* system = (SystemAB*)data;
-    system->numEntities++;
+    MecsU32 length = 0;
+    if (reader->read(reader->userData, &length, sizeof(length)) != sizeof(length)) {
+        return false;
+    }
+    std::string& text = gDeltaLabelTexts.emplace_back(length, '\0');
+    static_cast<DeltaLabel*>(mem)->text = &text;
+    return reader->read(reader->userData, text.data(), length) == length;
 }
 
-void systemRun_SystemAB(void* data, void* update, MecsIterator* iterator)
+TEST_CASE("World deltas of serialized components")
 {
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MecsComponentID Component_Label = MECS_INVALID;
+    {
+        ComponentInfo info = MECS_COMPONENTINFO(DeltaLabel);
+        info.serialize = serializeDeltaLabel;
+        info.deserialize = deserializeDeltaLabel;
+        Component_Label = mecsRegistryAddRegistration(registry, &info);
+    }
+
+    // Long enough not to fit in the string itself
+    std::string texts[4];
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+    MecsWorldSnapshot* snapshot = mecsWorldSnapshotCreate(world);
+    MecsEntityID entities[4];
+    for (int i = 0; i < 4; i++) {
+        texts[i] = std::string(100, static_cast<char>('a' + i));
+        entities[i] = mecsWorldSpawnEntity(world, nullptr);
+        static_cast<DeltaLabel*>(mecsWorldAddComponent(world, entities[i], Component_Label))->text = &texts[i];
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    MecsWorld* replica = mecsWorldCreate(registry, nullptr);
+
+    auto replicate = [&]() {
+        SnapshotBuffer buffer;
+        const MecsWriter writer { .write = SnapshotBuffer::write, .userData = &buffer };
+        REQUIRE(mecsWorldWriteDelta(world, snapshot, &writer));
+        mecsWorldSnapshotUpdate(snapshot, world);
+        const MecsReader reader { .read = SnapshotBuffer::read, .userData = &buffer };
+        REQUIRE(mecsWorldApplyDelta(replica, &reader, nullptr));
+        mecsWorldFlushEvents(replica, nullptr);
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(*static_cast<DeltaLabel*>(mecsWorldEntityGetComponent(replica, entities[i], Component_Label))->text == texts[i]);
+        }
+        return buffer.bytes.size();
+    };
 
+    // The first delta spawns the entities
+    const MecsSize fullDeltaSize = replicate();
+    const MecsSize emptyDeltaSize = replicate();
+    REQUIRE(emptyDeltaSize < fullDeltaSize);
+
+    // Edited in place: only the characters change, not the pointer held by the component
+    texts[2][50] = 'X';
+    const MecsSize editDeltaSize = replicate();
+    REQUIRE(editDeltaSize > emptyDeltaSize + texts[2].size());
+    REQUIRE(editDeltaSize < emptyDeltaSize + 2 * texts[2].size());
+    REQUIRE(replicate() == emptyDeltaSize);
+
+    mecsWorldSnapshotFree(snapshot);
+    mecsWorldFree(replica);
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+    gDeltaLabelTexts.clear();
 }
 
+struct CloneCounter {
+    int value;
+};
+static int gCloneCounterCopies = 0;
+static int gCloneCounterSetups = 0;
 
-void onEntityRemoved_SystemAB(void* data, void* update, MecsEntityID entity)
+static void copyCloneCounter(const void* source, void* dest, MecsSize size)
 {
-    SystemAB* system = (SystemAB*)data;
-    system->numEntities--;
+    gCloneCounterCopies++;
+    memcpy(dest, source, size);
 }
-void onEntityAdded_SystemACD(void* data, void* update, MecsEntityID entity)
+
+static void setupCloneCounter(MecsWorld* world, MecsEntityID entity, void* ptr, void* userData)
 {
-    SystemACD* system = (SystemACD*)data;
-    system->numEntities++;
+    gCloneCounterSetups++;
 }
 
-void systemRun_SystemACD(void* data, void* update, MecsIterator* iterator)
+TEST_CASE("World cloning")
 {
-}
+    struct Position {
+        float x, y;
+    };
 
-void onEntityRemoved_SystemACD(void* data, void* update, MecsEntityID entity)
+    MecsWorldCreateInfo worldInfo {};
+    worldInfo.worldFlags = GENERATE(MecsWorldFlags_None, MecsWorldFlags_BatchedFlush);
+    const int cloneFlags = GENERATE(MecsWorldCloneFlags_None, MecsWorldCloneFlags_EntityEvents);
 
-{
-    SystemACD* system = (SystemACD*)data;
-    system->numEntities--;
-}
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Position);
+    MecsComponentID Component_CloneCounter = MECS_INVALID;
+    {
+        ComponentInfo info = MECS_COMPONENTINFO(CloneCounter);
+        info.copy = copyCloneCounter;
+        info.setup = setupCloneCounter;
+        Component_CloneCounter = mecsRegistryAddRegistration(registry, &info);
+    }
 
-struct ComponentA {
-};
-struct ComponentB {
-};
-struct ComponentC {
-};
-struct ComponentD {
-};
+    MecsWorld* world = mecsWorldCreate(registry, &worldInfo);
+    std::vector<MecsEntityID> entities;
+    for (int i = 0; i < 1000; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+        *static_cast<Position*>(mecsWorldAddComponent(world, ent, Component_Position)) = Position { static_cast<float>(i), 1.0f };
+        if (i % 4 == 0) {
+            static_cast<CloneCounter*>(mecsWorldAddComponent(world, ent, Component_CloneCounter))->value = i;
+        }
+        entities.push_back(ent);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    // Leave some free slots in the entity arena
+    for (int i = 3; i < 1000; i += 10) {
+        mecsWorldDestroyEntity(world, entities[i]);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    std::erase_if(entities, [](MecsEntityID ent) { return getIndexFromGenArenaIndex(ent) % 10 == 3; });
 
-struct Transform{};
-struct Mesh {};
+    MecsWorld* clone = mecsWorldCreate(registry, &worldInfo);
+    MecsScheduleID schedule = mecsWorldDefineSchedule(clone, nullptr);
+    SystemACD counterSystem;
+    counterSystem.numEntities = 0;
+    {
+        MecsComponentID components[] = { Component_Position, Component_CloneCounter };
+        MecsIteratorFilter filters[] = { MecsIteratorFilter::Access, MecsIteratorFilter::Access };
+        MecsDefineSystemInfo systemInfo {};
+        systemInfo.numComponents = 2;
+        systemInfo.pComponents = components;
+        systemInfo.pFilters = filters;
+        systemInfo.onEntityAdded = onEntityAdded_SystemACD;
+        systemInfo.systemRun = systemRun_SystemACD;
+        systemInfo.onEntityRemoved = onEntityRemoved_SystemACD;
+        systemInfo.systemData = &counterSystem;
+        mecsWorldDefineSystem(clone, &systemInfo, schedule);
+    }
+    mecsWorldFlushEvents(clone, nullptr);
+
+    gCloneCounterCopies = 0;
+    gCloneCounterSetups = 0;
+    mecsWorldClone(world, clone, cloneFlags);
+    mecsWorldFlushEvents(clone, nullptr);
+
+    const int numCounters = 250;
+    // The components with a copy callback are copied one at a time, the others at once
+    REQUIRE(gCloneCounterCopies == numCounters);
+    REQUIRE(gCloneCounterSetups == ((cloneFlags & MecsWorldCloneFlags_EntityEvents) != 0 ? numCounters : 0));
+    REQUIRE(counterSystem.numEntities == numCounters);
+
+    MecsWorldStats worldStats;
+    MecsWorldStats cloneStats;
+    mecsWorldGetStats(world, &worldStats);
+    mecsWorldGetStats(clone, &cloneStats);
+    REQUIRE(cloneStats.numEntities == worldStats.numEntities);
+    for (MecsEntityID ent : entities) {
+        const auto* position = static_cast<const Position*>(mecsWorldEntityGetComponent(clone, ent, Component_Position));
+        REQUIRE(position->x == static_cast<const Position*>(mecsWorldEntityGetComponent(world, ent, Component_Position))->x);
+        REQUIRE(mecsWorldEntityHasComponent(clone, ent, Component_CloneCounter) == mecsWorldEntityHasComponent(world, ent, Component_CloneCounter));
+        if (mecsWorldEntityHasComponent(world, ent, Component_CloneCounter)) {
+            REQUIRE(static_cast<const CloneCounter*>(mecsWorldEntityGetComponent(clone, ent, Component_CloneCounter))->value == static_cast<int>(getIndexFromGenArenaIndex(ent)));
+        }
+    }
 
-struct DirectionalLight{};
-struct PointLight{};
-struct SpotLight{};
+    // The worlds hand out the same IDs, and are independent from each other
+    MecsEntityID spawned = mecsWorldSpawnEntity(world, nullptr);
+    REQUIRE(mecsWorldSpawnEntity(clone, nullptr) == spawned);
+    static_cast<Position*>(mecsWorldEntityGetComponent(world, entities[0], Component_Position))->x = -1.0f;
+    mecsWorldDestroyEntity(clone, entities[1]);
+    mecsWorldFlushEvents(world, nullptr);
+    mecsWorldFlushEvents(clone, nullptr);
+    REQUIRE(static_cast<Position*>(mecsWorldEntityGetComponent(clone, entities[0], Component_Position))->x == 0.0f);
+    REQUIRE(mecsWorldEntityHasComponent(world, entities[1], Component_Position));
 
-MECS_RTTI_SIMPLE(ComponentA);
-MECS_RTTI_SIMPLE(ComponentB);
-MECS_RTTI_SIMPLE(ComponentC);
-MECS_RTTI_SIMPLE(ComponentD);
+    mecsWorldFree(clone);
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
 
-MECS_RTTI_SIMPLE(Transform);
-MECS_RTTI_SIMPLE(Mesh);
+TEST_CASE("Copy-on-write world cloning")
+{
+    struct Position {
+        float x, y;
+    };
+    struct Velocity {
+        double dx, dy;
+    };
 
-MECS_RTTI_SIMPLE(DirectionalLight);
-MECS_RTTI_SIMPLE(PointLight);
-MECS_RTTI_SIMPLE(SpotLight);
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Position);
+    MECS_REGISTER_COMPONENT(registry, Velocity);
+    MecsComponentID Component_CloneCounter = MECS_INVALID;
+    {
+        ComponentInfo info = MECS_COMPONENTINFO(CloneCounter);
+        info.copy = copyCloneCounter;
+        Component_CloneCounter = mecsRegistryAddRegistration(registry, &info);
+    }
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+    std::vector<MecsEntityID> entities;
+    for (int i = 0; i < 2000; i++) {
+        MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+        *static_cast<Position*>(mecsWorldAddComponent(world, ent, Component_Position)) = Position { static_cast<float>(i), 0.0f };
+        *static_cast<Velocity*>(mecsWorldAddComponent(world, ent, Component_Velocity)) = Velocity { 1.0, 2.0 };
+        if (i % 4 == 0) {
+            static_cast<CloneCounter*>(mecsWorldAddComponent(world, ent, Component_CloneCounter))->value = i;
+        }
+        entities.push_back(ent);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+
+    MecsWorldStats stats;
+    mecsWorldGetStats(world, &stats);
+    const MecsSize fullColumnBytes = stats.columnBytes;
+
+    MecsWorld* fork = mecsWorldCreate(registry, nullptr);
+    gCloneCounterCopies = 0;
+    mecsWorldClone(world, fork, MecsWorldCloneFlags_CopyOnWrite);
+    mecsWorldFlushEvents(fork, nullptr);
+
+    // Only the components with a copy callback are copied
+    REQUIRE(gCloneCounterCopies == 500);
+    mecsWorldGetStats(fork, &stats);
+    REQUIRE(stats.numEntities == 2000);
+    const MecsSize forkColumnBytes = stats.columnBytes;
+    REQUIRE(forkColumnBytes == 500 * sizeof(CloneCounter));
+    REQUIRE(forkColumnBytes < fullColumnBytes / 10);
+
+    // Reading does not copy anything
+    MecsIterator* iterator = mecsWorldAcquireIterator(fork);
+    mecsIterComponentFilter(iterator, Component_Position, MecsIteratorFilter::Read, 0);
+    mecsIterComponentFilter(iterator, Component_Velocity, MecsIteratorFilter::Read, 1);
+    mecsIteratorFinalize(iterator);
+    mecsIteratorBegin(iterator);
+    MecsSize numRead = 0;
+    while (mecsIteratorAdvance(iterator)) {
+        const MecsEntityID ent = mecsIteratorGetEntity(iterator);
+        const auto* position = static_cast<const Position*>(mecsIteratorGetArgument(iterator, 0));
+        const auto* velocity = static_cast<const Velocity*>(mecsIteratorGetArgument(iterator, 1));
+        REQUIRE(position->x == static_cast<float>(getIndexFromGenArenaIndex(ent)));
+        REQUIRE(velocity->dy == 2.0);
+        numRead++;
+    }
+    mecsWorldReleaseIterator(fork, iterator);
+    REQUIRE(numRead == 2000);
+    mecsWorldGetStats(fork, &stats);
+    REQUIRE(stats.columnBytes == forkColumnBytes);
+
+    // Neither does observing
+    float observedX = 0.0f;
+    MecsDefineObserverInfo observerInfo {};
+    observerInfo.component = Component_Position;
+    observerInfo.event = MecsObserverEvent_Changed;
+    observerInfo.observerData = &observedX;
+    observerInfo.observe = [](void* observerData, void*, const MecsEntityID*, void* const* pComponents, MecsSize count) {
+        for (MecsSize i = 0; i < count; i++) {
+            *static_cast<float*>(observerData) += static_cast<const Position*>(pComponents[i])->x;
+        }
+    };
+    mecsWorldDefineObserver(fork, &observerInfo);
+    mecsWorldEntityComponentChanged(fork, entities[3], Component_Position);
+    mecsWorldFlushEvents(fork, nullptr);
+    REQUIRE(observedX == 3.0f);
+    mecsWorldGetStats(fork, &stats);
+    REQUIRE(stats.columnBytes == forkColumnBytes);
+
+    // Writing copies the written column of that archetype only, the other world does not see the change
+    static_cast<Position*>(mecsWorldEntityGetComponent(fork, entities[1], Component_Position))->x = -1.0f;
+    mecsWorldGetStats(fork, &stats);
+    REQUIRE(stats.columnBytes == forkColumnBytes + 1500 * sizeof(Position));
+    REQUIRE(static_cast<const Position*>(mecsWorldEntityGetComponent(world, entities[1], Component_Position))->x == 1.0f);
+
+    static_cast<Velocity*>(mecsWorldEntityGetComponent(world, entities[4], Component_Velocity))->dx = -1.0;
+    REQUIRE(static_cast<const Velocity*>(mecsWorldEntityGetComponent(fork, entities[4], Component_Velocity))->dx == 1.0);
+
+    // Structural changes copy the columns they modify
+    mecsWorldDestroyEntity(fork, entities[0]);
+    mecsWorldRemoveComponent(fork, entities[8], Component_Velocity);
+    mecsWorldFlushEvents(fork, nullptr);
+    REQUIRE(mecsWorldEntityHasComponent(world, entities[8], Component_Velocity));
+    REQUIRE(static_cast<const Position*>(mecsWorldEntityGetComponent(world, entities[0], Component_Position))->x == 0.0f);
+
+    // The shared columns outlive the world they were cloned from
+    mecsWorldFree(world);
+    for (size_t i = 1; i < entities.size(); i++) {
+        const auto* position = static_cast<const Position*>(mecsWorldEntityGetComponent(fork, entities[i], Component_Position));
+        REQUIRE(position->x == (i == 1 ? -1.0f : static_cast<float>(i)));
+    }
+
+    mecsWorldFree(fork);
+    mecsRegistryFree(registry);
+}
 
 TEST_CASE("Systems")
 {
+    // The systems must observe the same entities regardless of how the events are flushed
+    MecsWorldCreateInfo worldInfo {};
+    worldInfo.worldFlags = GENERATE(MecsWorldFlags_None, MecsWorldFlags_BatchedFlush);
+
     SECTION("C system API") {
         MecsRegistryCreateInfo regInfo {};
         regInfo.memAllocator = kDebugAllocator;
@@ -460,7 +2392,7 @@ TEST_CASE("Systems")
         MECS_REGISTER_COMPONENT(registry, ComponentC);
         MECS_REGISTER_COMPONENT(registry, ComponentD);
 
-        MecsWorld* world = mecsWorldCreate(registry, nullptr);
+        MecsWorld* world = mecsWorldCreate(registry, &worldInfo);
 
         SystemAB abSystem;
         abSystem.numEntities = 0;
@@ -564,6 +2496,209 @@ TEST_CASE("Systems")
         mecsRegistryFree(registry);
     }
 
+    SECTION("C system API - Many transitions in a single flush") {
+        MecsRegistryCreateInfo regInfo {};
+        regInfo.memAllocator = kDebugAllocator;
+        MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+        MECS_REGISTER_COMPONENT(registry, ComponentA);
+        MECS_REGISTER_COMPONENT(registry, ComponentB);
+        MECS_REGISTER_COMPONENT(registry, ComponentC);
+
+        MecsWorld* world = mecsWorldCreate(registry, &worldInfo);
+        MecsScheduleID defaultSchedule = mecsWorldDefineSchedule(world, nullptr);
+
+        SystemAB abSystem;
+        abSystem.numEntities = 0;
+        {
+            MecsComponentID components[] = {Component_ComponentA, Component_ComponentB};
+            MecsIteratorFilter filters[] = {MecsIteratorFilter::Access, MecsIteratorFilter::Access};
+            MecsDefineSystemInfo systemInfo {};
+            systemInfo.numComponents = 2;
+            systemInfo.pComponents = components;
+            systemInfo.pFilters = filters;
+            systemInfo.onEntityAdded = onEntityAdded_SystemAB;
+            systemInfo.systemRun = systemRun_SystemAB;
+            systemInfo.onEntityRemoved = onEntityRemoved_SystemAB;
+            systemInfo.systemData = &abSystem;
+            mecsWorldDefineSystem(world, &systemInfo, defaultSchedule);
+        }
+        mecsWorldFlushEvents(world, nullptr);
+
+        std::vector<MecsEntityID> entities;
+        for (int i = 0; i < 100; i++) {
+            MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+            mecsWorldAddComponent(world, ent, Component_ComponentA);
+            if (i % 2 == 0) {
+                mecsWorldAddComponent(world, ent, Component_ComponentC);
+            }
+            mecsWorldAddComponent(world, ent, Component_ComponentB);
+            entities.push_back(ent);
+        }
+        // Spawned and destroyed in the same frame: never seen by the system
+        MecsEntityID shortLived = mecsWorldSpawnEntity(world, nullptr);
+        mecsWorldAddComponent(world, shortLived, Component_ComponentA);
+        mecsWorldAddComponent(world, shortLived, Component_ComponentB);
+        mecsWorldDestroyEntity(world, shortLived);
+        mecsWorldFlushEvents(world, nullptr);
+        REQUIRE(abSystem.numEntities == 100);
+
+        // Removing both components in the same frame must notify the system only once
+        for (int i = 0; i < 50; i++) {
+            mecsWorldRemoveComponent(world, entities[i], Component_ComponentA);
+            mecsWorldRemoveComponent(world, entities[i], Component_ComponentB);
+        }
+        for (int i = 50; i < 60; i++) {
+            mecsWorldRemoveComponent(world, entities[i], Component_ComponentB);
+            mecsWorldDestroyEntity(world, entities[i]);
+        }
+        mecsWorldFlushEvents(world, nullptr);
+        REQUIRE(abSystem.numEntities == 40);
+        for (int i = 0; i < 50; i++) {
+            REQUIRE(mecsWorldEntityGetNumComponents(world, entities[i]) == (i % 2 == 0 ? 1 : 0));
+        }
+
+        mecsWorldFree(world);
+        mecsRegistryFree(registry);
+    }
+
+    SECTION("C system API - System added to a populated world") {
+        MecsRegistryCreateInfo regInfo {};
+        regInfo.memAllocator = kDebugAllocator;
+        MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+        MECS_REGISTER_COMPONENT(registry, ComponentA);
+        MECS_REGISTER_COMPONENT(registry, ComponentB);
+        MECS_REGISTER_COMPONENT(registry, ComponentC);
+
+        MecsWorld* world = mecsWorldCreate(registry, &worldInfo);
+        MecsScheduleID defaultSchedule = mecsWorldDefineSchedule(world, nullptr);
+
+        std::vector<MecsEntityID> entities;
+        for (int i = 0; i < 100; i++) {
+            MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+            mecsWorldAddComponent(world, ent, Component_ComponentA);
+            if (i % 2 == 0) {
+                mecsWorldAddComponent(world, ent, Component_ComponentB);
+            }
+            if (i % 3 == 0) {
+                mecsWorldAddComponent(world, ent, Component_ComponentC);
+            }
+            entities.push_back(ent);
+        }
+        mecsWorldFlushEvents(world, nullptr);
+
+        // Entities being destroyed in the same frame the system is added must be skipped
+        for (int i = 0; i < 10; i++) {
+            mecsWorldDestroyEntity(world, entities[i]);
+        }
+
+        const bool bulk = GENERATE(false, true);
+        SystemAB abSystem;
+        abSystem.numEntities = 0;
+        {
+            MecsComponentID components[] = {Component_ComponentA, Component_ComponentB};
+            MecsIteratorFilter filters[] = {MecsIteratorFilter::Access, MecsIteratorFilter::Access};
+            MecsDefineSystemInfo systemInfo {};
+            systemInfo.numComponents = 2;
+            systemInfo.pComponents = components;
+            systemInfo.pFilters = filters;
+            systemInfo.onEntityAdded = onEntityAdded_SystemAB;
+            systemInfo.onEntitiesAdded = bulk ? onEntitiesAdded_SystemAB : nullptr;
+            systemInfo.systemRun = systemRun_SystemAB;
+            systemInfo.onEntityRemoved = onEntityRemoved_SystemAB;
+            systemInfo.systemData = &abSystem;
+            mecsWorldDefineSystem(world, &systemInfo, defaultSchedule);
+        }
+        mecsWorldFlushEvents(world, nullptr);
+        // Entities 0, 2, 4, 6 and 8 have both components but are destroyed
+        REQUIRE(abSystem.numEntities == 45);
+
+        mecsWorldRemoveComponent(world, entities[10], Component_ComponentB);
+        mecsWorldFlushEvents(world, nullptr);
+        REQUIRE(abSystem.numEntities == 44);
+
+        mecsWorldFree(world);
+        mecsRegistryFree(registry);
+    }
+
+    SECTION("C system API - Batched callbacks") {
+        MecsRegistryCreateInfo regInfo {};
+        regInfo.memAllocator = kDebugAllocator;
+        MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+        MECS_REGISTER_COMPONENT(registry, ComponentA);
+        MECS_REGISTER_COMPONENT(registry, ComponentB);
+
+        MecsWorld* world = mecsWorldCreate(registry, &worldInfo);
+        MecsScheduleID defaultSchedule = mecsWorldDefineSchedule(world, nullptr);
+
+        SystemLog logSystem;
+        {
+            MecsComponentID components[] = {Component_ComponentA, Component_ComponentB};
+            MecsIteratorFilter filters[] = {MecsIteratorFilter::Access, MecsIteratorFilter::Access};
+            MecsDefineSystemInfo systemInfo {};
+            systemInfo.numComponents = 2;
+            systemInfo.pComponents = components;
+            systemInfo.pFilters = filters;
+            systemInfo.systemRun = systemRun_SystemAB;
+            systemInfo.onEntitiesAdded = onEntitiesAdded_SystemLog;
+            systemInfo.onEntitiesRemoved = onEntitiesRemoved_SystemLog;
+            systemInfo.systemData = &logSystem;
+            mecsWorldDefineSystem(world, &systemInfo, defaultSchedule);
+        }
+        mecsWorldFlushEvents(world, nullptr);
+
+        std::vector<MecsEntityID> entities;
+        for (int i = 0; i < 20; i++) {
+            MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+            mecsWorldAddComponent(world, ent, Component_ComponentA);
+            mecsWorldAddComponent(world, ent, Component_ComponentB);
+            entities.push_back(ent);
+        }
+        mecsWorldFlushEvents(world, nullptr);
+        // All the entities are handed out at once
+        REQUIRE(logSystem.calls == std::vector<int> { 20 });
+
+        logSystem.calls.clear();
+        for (int i = 0; i < 5; i++) {
+            mecsWorldDestroyEntity(world, entities[i]);
+        }
+        mecsWorldFlushEvents(world, nullptr);
+        REQUIRE(logSystem.calls == std::vector<int> { -5 });
+
+        // Removals and additions in the same flush, spawned[1] even enters and leaves the system in it:
+        // the consecutive notifications of the same kind are handed out in a single call
+        logSystem.calls.clear();
+        logSystem.entities.clear();
+        for (int i = 5; i < 8; i++) {
+            mecsWorldRemoveComponent(world, entities[i], Component_ComponentB);
+            mecsWorldDestroyEntity(world, entities[i + 10]);
+        }
+        std::vector<MecsEntityID> spawned;
+        for (int i = 0; i < 2; i++) {
+            MecsEntityID ent = mecsWorldSpawnEntity(world, nullptr);
+            mecsWorldAddComponent(world, ent, Component_ComponentA);
+            mecsWorldAddComponent(world, ent, Component_ComponentB);
+            spawned.push_back(ent);
+        }
+        mecsWorldRemoveComponent(world, spawned[1], Component_ComponentB);
+        mecsWorldFlushEvents(world, nullptr);
+        const std::vector<MecsEntityID>& e = entities;
+        if (worldInfo.worldFlags == MecsWorldFlags_BatchedFlush) {
+            // The additions are flushed first, then the removed components and then the destroyed entities
+            REQUIRE(logSystem.calls == std::vector<int> { 2, -7 });
+            REQUIRE(logSystem.entities[0] == std::vector<MecsEntityID> { spawned[0], spawned[1] });
+            REQUIRE(logSystem.entities[1] == std::vector<MecsEntityID> { e[5], e[6], e[7], spawned[1], e[15], e[16], e[17] });
+        } else {
+            // Each change of kind hands out the entities collected so far
+            REQUIRE(logSystem.calls == std::vector<int> { -6, 2, -1 });
+            REQUIRE(logSystem.entities[0] == std::vector<MecsEntityID> { e[5], e[15], e[6], e[16], e[7], e[17] });
+            REQUIRE(logSystem.entities[1] == std::vector<MecsEntityID> { spawned[0], spawned[1] });
+            REQUIRE(logSystem.entities[2] == std::vector<MecsEntityID> { spawned[1] });
+        }
+
+        mecsWorldFree(world);
+        mecsRegistryFree(registry);
+    }
+
     SECTION("C++ system API")
     {
         MecsRegistryCreateInfo regInfo {};
@@ -673,7 +2808,7 @@ TEST_CASE("Systems")
         } renderingSystem {};
 
         SECTION("Simulating a real-use case scenario") {
-            mecs::World world(registry);
+            mecs::World world(registry, worldInfo);
 
             mecs::ScheduleID defaultSchedule = world.defineSchedule({});
             /** Simple API: binding a system that will interact with only one component set
@@ -821,9 +2956,56 @@ TEST_CASE("Systems")
             REQUIRE(renderingSystem.numSpotLights == 0);
             REQUIRE(renderingSystem.numPointLights == 0);
         }
+        SECTION("Batched callbacks")
+        {
+            class BatchedSystemAB {
+            public:
+                int counter {0};
+                int numCalls {0};
+
+                void onEntitiesAdded(mecs::World& world, std::span<const mecs::EntityID> entities)
+                {
+                    counter += (int)entities.size();
+                    numCalls++;
+                }
+
+                void systemRun(mecs::World& world, mecs::Iterator<ComponentA&, ComponentB&>& iterator)
+                {
+
+                }
+
+                void onEntitiesRemoved(mecs::World& world, std::span<const mecs::EntityID> entities)
+                {
+                    counter -= (int)entities.size();
+                    numCalls++;
+                }
+            } batchedSystem {};
+
+            mecs::World world(registry, worldInfo);
+            mecs::ScheduleID defaultSchedule = world.defineSchedule({});
+            world.addSystem<BatchedSystemAB>(&batchedSystem, defaultSchedule);
+            world.flushEvents();
+
+            std::vector<mecs::EntityID> entities;
+            for (int i = 0; i < 10; i ++) {
+                entities.push_back(world.spawnEntity()
+                    .withComponent<ComponentA>()
+                    .withComponent<ComponentB>());
+            }
+            world.flushEvents();
+            REQUIRE(batchedSystem.counter == 10);
+            REQUIRE(batchedSystem.numCalls == 1);
+
+            for (mecs::EntityID entity : entities) {
+                world.destroyEntity(entity);
+            }
+            world.flushEvents();
+            REQUIRE(batchedSystem.counter == 0);
+            REQUIRE(batchedSystem.numCalls == 2);
+        }
         SECTION("Edge cases - Adding a system to a world with existing entities")
         {
-            mecs::World world(registry);
+            mecs::World world(registry, worldInfo);
 
             mecs::ScheduleID defaultSchedule = world.defineSchedule({});
 
@@ -856,7 +3038,7 @@ TEST_CASE("Systems")
         }
         SECTION("Edge cases - Adding a system to a world with pending destroy entities")
         {
-            mecs::World world(registry);
+            mecs::World world(registry, worldInfo);
 
             mecs::ScheduleID defaultSchedule = world.defineSchedule({});
             SystemAB_Cpp systemAB;
@@ -896,7 +3078,7 @@ TEST_CASE("Systems")
         SECTION("Edge cases - Messing with spawning entities before/after/before&after adding a matching system")
         {
             {
-                mecs::World world(registry);
+                mecs::World world(registry, worldInfo);
 
                 mecs::ScheduleID defaultSchedule = world.defineSchedule({});
                 SystemAB_Cpp systemAB;
@@ -910,7 +3092,7 @@ TEST_CASE("Systems")
                 REQUIRE(systemAB.counter == 0);
             }
             {
-                mecs::World world(registry);
+                mecs::World world(registry, worldInfo);
 
                 mecs::ScheduleID defaultSchedule = world.defineSchedule({});
                 SystemAB_Cpp systemAB;
@@ -925,7 +3107,7 @@ TEST_CASE("Systems")
                 REQUIRE(systemAB.counter == 10);
             }
             {
-                mecs::World world(registry);
+                mecs::World world(registry, worldInfo);
 
                 mecs::ScheduleID defaultSchedule = world.defineSchedule({});
                 SystemAB_Cpp systemAB;
@@ -940,7 +3122,7 @@ TEST_CASE("Systems")
                 REQUIRE(systemAB.counter == 10);
             }
             {
-                mecs::World world(registry);
+                mecs::World world(registry, worldInfo);
 
                 mecs::ScheduleID defaultSchedule = world.defineSchedule({});
                 SystemAB_Cpp systemAB;
@@ -51,4 +51,58 @@ TEST_CASE("Bitset")
     bitset2.destroy(alloc);
     empty.destroy(alloc);
     empty.destroy(alloc);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Packed row storage")
+{
+    struct Foo {
+        int value;
+    };
+
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    MecsRegistry* registry = mecsRegistryCreate(&regInfo);
+    MECS_REGISTER_COMPONENT(registry, Foo);
+    MecsPrefabID prefab = mecsRegistryCreatePrefab(registry);
+    mecsRegistryPrefabAddComponent(registry, prefab, Component_Foo);
+
+    MecsWorld* world = mecsWorldCreate(registry, nullptr);
+
+    constexpr int kNumEntities = 100;
+    MecsEntityID entities[kNumEntities];
+    for (int i = 0; i < kNumEntities; i++) {
+        entities[i] = mecsWorldSpawnEntityPrefab(world, prefab, nullptr);
+        static_cast<Foo*>(mecsWorldEntityGetComponent(world, entities[i], Component_Foo))->value = i;
+    }
+    mecsWorldFlushEvents(world, nullptr);
+
+    const MecsEntity* first = world->entities.at(entities[0]);
+    const RowStorage& storage = world->archetypes[first->archetype].storage;
+    REQUIRE(storage.rows() == kNumEntities);
+    REQUIRE(storage.capacity() >= storage.rows());
+
+    // Destroy every even entity: the odd ones must be swapped into the freed rows
+    for (int i = 0; i < kNumEntities; i += 2) {
+        mecsWorldDestroyEntity(world, entities[i]);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(storage.rows() == kNumEntities / 2);
+
+    for (int i = 1; i < kNumEntities; i += 2) {
+        const MecsEntity* ent = world->entities.at(entities[i]);
+        REQUIRE(ent->archetypeRow < storage.rows());
+        REQUIRE(static_cast<Foo*>(mecsWorldEntityGetComponent(world, entities[i], Component_Foo))->value == i);
+    }
+
+    // Reusing the rows does not need to grow the columns
+    const MecsSize capacity = storage.capacity();
+    for (int i = 0; i < kNumEntities / 2; i++) {
+        mecsWorldSpawnEntityPrefab(world, prefab, nullptr);
+    }
+    mecsWorldFlushEvents(world, nullptr);
+    REQUIRE(storage.rows() == kNumEntities);
+    REQUIRE(storage.capacity() == capacity);
+
+    mecsWorldFree(world);
+    mecsRegistryFree(registry);
+}
@@ -8,6 +8,7 @@
 #include "mecshpp/mecsrtti.hpp"
 #include "test_private.hpp"
 #include <cstddef>
+#include <cstring>
 struct Foo {
     int foo;
     float bar;
@@ -34,6 +35,55 @@ MECS_RTTI_STRUCT_BEGIN(Bar)
 MECS_RTTI_STRUCT_MEMBER(name)
 MECS_RTTI_STRUCT_END()
 
+enum class Team {
+    eRed,
+    eBlue,
+};
+
+struct Inventory {
+    std::string owner;
+    int gold;
+    float weight;
+    std::vector<Foo> items;
+    std::vector<std::string> tags;
+    Team team;
+};
+
+MECS_RTTI_ENUM_BEGIN(Team)
+MECS_RTTI_ENUM_VARIANT(eRed, "Red")
+MECS_RTTI_ENUM_VARIANT(eBlue, "Blue")
+MECS_RTTI_ENUM_END()
+
+MECS_RTTI_STRUCT_BEGIN(Inventory)
+MECS_RTTI_STRUCT_MEMBER(owner)
+MECS_RTTI_STRUCT_MEMBER(gold)
+MECS_RTTI_STRUCT_MEMBER(weight)
+MECS_RTTI_STRUCT_MEMBER(items)
+MECS_RTTI_STRUCT_MEMBER(tags)
+MECS_RTTI_STRUCT_MEMBER(team)
+MECS_RTTI_STRUCT_END()
+
+struct ByteBuffer {
+    std::vector<MecsU8> bytes;
+    MecsSize readOffset = 0;
+
+    static MecsSize write(void* userData, const void* data, MecsSize size)
+    {
+        auto* buffer = static_cast<ByteBuffer*>(userData);
+        buffer->bytes.insert(buffer->bytes.end(), static_cast<const MecsU8*>(data), static_cast<const MecsU8*>(data) + size);
+        return size;
+    }
+
+    static MecsSize read(void* userData, void* data, MecsSize size)
+    {
+        auto* buffer = static_cast<ByteBuffer*>(userData);
+        size = std::min(size, buffer->bytes.size() - buffer->readOffset);
+        memcpy(data, buffer->bytes.data() + buffer->readOffset, size);
+        buffer->readOffset += size;
+        return size;
+    }
+};
+
 TEST_CASE("C++ reflection sample")
 {
 
@@ -66,4 +116,89 @@ TEST_CASE("C++ reflection sample")
     REQUIRE(*reinterpret_cast<float*>(fooMembers[1].getMemberFn(foo)) == 3.14F);
     REQUIRE(*reinterpret_cast<std::string*>(barMembers[0].getMemberFn(bar)) == "DuffyDuck");
 }
-// NOLINTEND
\ No newline at end of file
+// NOLINTEND
+TEST_CASE("C++ reflection serializer")
+{
+    const mecs::Serializer& fooSerializer = mecs::serializerOf<Foo>();
+    const mecs::Serializer& inventorySerializer = mecs::serializerOf<Inventory>();
+
+    // Trivially copyable types are a single copy, the contiguous members of the others are merged
+    REQUIRE(fooSerializer.ops().size() == 1);
+    REQUIRE(fooSerializer.ops()[0].size == sizeof(Foo));
+
+    const auto inventoryOps = inventorySerializer.ops();
+    REQUIRE(inventoryOps.size() == 5);
+    REQUIRE(inventoryOps[0].kind == mecs::SerializeOpKind::eString);
+    REQUIRE(inventoryOps[1].kind == mecs::SerializeOpKind::eBytes);
+    REQUIRE(inventoryOps[1].offset == offsetof(Inventory, gold));
+    REQUIRE(inventoryOps[1].size == sizeof(int) + sizeof(float));
+    REQUIRE(inventoryOps[2].kind == mecs::SerializeOpKind::eVec);
+    REQUIRE(inventoryOps[2].packed);
+    REQUIRE(inventoryOps[3].kind == mecs::SerializeOpKind::eVec);
+    REQUIRE_FALSE(inventoryOps[3].packed);
+    REQUIRE(inventoryOps[4].offset == offsetof(Inventory, team));
+
+    const Inventory inventory {
+        .owner = "DuffyDuck",
+        .gold = 250,
+        .weight = 12.5F,
+        .items = { { 1, 0.5F }, { 2, 1.5F }, { 3, 2.5F } },
+        .tags = { "merchant", "", "a tag long enough to not fit in the small string buffer" },
+        .team = Team::eBlue,
+    };
+
+    ByteBuffer buffer;
+    const MecsWriter writer { .write = ByteBuffer::write, .userData = &buffer };
+    const MecsReader reader { .read = ByteBuffer::read, .userData = &buffer };
+
+    REQUIRE(inventorySerializer.serialize(&inventory, writer));
+    const MecsSize expectedSize = (sizeof(MecsU32) + inventory.owner.size()) + sizeof(int) + sizeof(float)
+        + (sizeof(MecsU32) + (inventory.items.size() * sizeof(Foo)))
+        + (sizeof(MecsU32) * 4 + inventory.tags[0].size() + inventory.tags[2].size()) + sizeof(Team);
+    REQUIRE(buffer.bytes.size() == expectedSize);
+
+    // The destination is overwritten, vectors included
+    Inventory readBack { .owner = "Someone", .gold = 1, .items = { { 9, 9.0F } }, .tags = { "old" } };
+    REQUIRE(inventorySerializer.deserialize(&readBack, reader));
+    REQUIRE(buffer.readOffset == buffer.bytes.size());
+    REQUIRE(readBack.owner == inventory.owner);
+    REQUIRE(readBack.gold == inventory.gold);
+    REQUIRE(readBack.weight == inventory.weight);
+    REQUIRE(readBack.items.size() == inventory.items.size());
+    for (MecsSize i = 0; i < inventory.items.size(); i++) {
+        REQUIRE(readBack.items[i].foo == inventory.items[i].foo);
+        REQUIRE(readBack.items[i].bar == inventory.items[i].bar);
+    }
+    REQUIRE(readBack.tags == inventory.tags);
+    REQUIRE(readBack.team == inventory.team);
+
+    // A truncated stream fails instead of reading past its end
+    buffer.bytes.resize(buffer.bytes.size() - 1);
+    buffer.readOffset = 0;
+    REQUIRE_FALSE(inventorySerializer.deserialize(&readBack, reader));
+
+    // Components registered from C++ use the serializer in world snapshots
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    mecs::Registry registry(regInfo);
+    registry.addRegistration<Foo>();
+    registry.addRegistration<Inventory>();
+
+    mecs::World world(registry);
+    mecs::EntityID entity = world.spawnEntity()
+                                .withComponent<Foo>(42, 3.14F)
+                                .withComponent<Inventory>(inventory);
+    world.flushEvents();
+
+    buffer = {};
+    REQUIRE(world.serialize(writer));
+
+    mecs::World restored(registry);
+    REQUIRE(restored.deserialize(reader));
+    REQUIRE(restored.entityHasComponent<Inventory>(entity));
+    const Inventory& restoredInventory = restored.entityGetComponent<Inventory>(entity);
+    REQUIRE(restoredInventory.owner == inventory.owner);
+    REQUIRE(restoredInventory.items.size() == inventory.items.size());
+    REQUIRE(restoredInventory.tags == inventory.tags);
+    REQUIRE(restored.entityGetComponent<Foo>(entity).foo == 42);
+}
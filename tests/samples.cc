@@ -243,6 +243,11 @@ MECS_RTTI_SIMPLE(Player);
 MECS_RTTI_SIMPLE(Enemy);
 MECS_RTTI_SIMPLE(NamedMesh);
 
+struct Selected {
+    int order;
+};
+MECS_RTTI_SIMPLE(Selected);
+
 TEST_CASE("C++ sample")
 {
 
@@ -343,4 +348,360 @@ TEST_CASE("C++ sample")
     // 100 meshes + 1 enemies + 1 player
     REQUIRE(mecs::utils::count(allEntities) == 102);
 }
+TEST_CASE("C++ forEach")
+{
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    mecs::Registry registry(regInfo);
+    registry.addRegistration<Player>();
+    registry.addRegistration<Enemy>();
+    registry.addRegistration<Position>();
+    registry.addRegistration<Velocity>();
+    registry.addRegistration<Selected>(MecsComponentStorage_Sparse);
+
+    mecs::World world(registry);
+    std::vector<mecs::EntityID> entities;
+    // Spread the entities over four archetypes, one of them without a Velocity
+    for (int i = 0; i < 400; i++) {
+        auto builder = world.spawnEntity().withComponent<Position>(i, 0, 0);
+        if (i % 4 != 3) {
+            builder.withComponent<Velocity>(1, 2, 3);
+        }
+        if (i % 4 == 1) {
+            builder.withComponent<Player>();
+        }
+        if (i % 4 == 2) {
+            builder.withComponent<Enemy>();
+        }
+        if (i % 5 == 0) {
+            builder.withComponent<Selected>(i);
+        }
+        entities.push_back(builder);
+    }
+    world.flushEvents();
+
+    mecs::Iterator moving = world.acquireIterator<mecs::EntityID, Position&, const Velocity&>();
+    std::vector<mecs::EntityID> visited;
+    moving.forEach([&](mecs::EntityID entity, Position& position, const Velocity& velocity) {
+        REQUIRE(world.entityGetComponent<Position>(entity).x == position.x);
+        position.x += velocity.x;
+        position.y += velocity.y;
+        position.z += velocity.z;
+        visited.push_back(entity);
+    });
+    REQUIRE(visited.size() == 300);
+
+    // forEach visits the entities in the same order as advance()
+    MecsSize index = 0;
+    moving.begin();
+    while (moving.advance()) {
+        REQUIRE(moving.getEntityID() == visited[index++]);
+    }
+
+    for (int i = 0; i < 400; i++) {
+        const Position& position = world.entityGetComponent<Position>(entities[i]);
+        REQUIRE(position.x == (i % 4 != 3 ? i + 1 : i));
+        REQUIRE(position.y == (i % 4 != 3 ? 2 : 0));
+    }
+
+    int numPlayers = 0;
+    world.acquireIterator<Position*, mecs::With<Player>, mecs::Not<Enemy>>().forEach([&](Position* position, mecs::With<Player>, mecs::Not<Enemy>) {
+        position->z = -1;
+        numPlayers++;
+    });
+    REQUIRE(numPlayers == 100);
+
+    int numStill = 0;
+    world.acquireIterator<const Position*, mecs::Not<Velocity>>().forEach([&](const Position* position, mecs::Not<Velocity>) {
+        REQUIRE(position->x % 4 == 3);
+        numStill++;
+    });
+    REQUIRE(numStill == 100);
+
+    // The iterators with sparse components check each entity instead of looping over the columns
+    int numSelected = 0;
+    world.acquireIterator<const Selected&, mecs::Not<Player>>().forEach([&](const Selected& selected, mecs::Not<Player>) {
+        REQUIRE(selected.order % 5 == 0);
+        REQUIRE(selected.order % 4 != 1);
+        numSelected++;
+    });
+    REQUIRE(numSelected == 60);
+
+    // The entities with disabled components are skipped by the column loop too
+    for (int i = 0; i < 400; i += 8) {
+        world.entitySetComponentEnabled<Velocity>(entities[i], false);
+    }
+    visited.clear();
+    moving.forEach([&](mecs::EntityID entity, Position&, const Velocity&) {
+        REQUIRE(world.entityIsComponentEnabled<Velocity>(entity));
+        visited.push_back(entity);
+    });
+    REQUIRE(visited.size() == 250);
+    index = 0;
+    moving.begin();
+    while (moving.advance()) {
+        REQUIRE(moving.getEntityID() == visited[index++]);
+    }
+    REQUIRE(index == 250);
+    for (int i = 0; i < 400; i += 8) {
+        world.entitySetComponentEnabled<Velocity>(entities[i], true);
+    }
+
+    // The rows can be kept sorted by a field of a component
+    struct ByDescendingX {
+        bool operator()(const Position& lhs, const Position& rhs) const { return lhs.x > rhs.x; }
+    };
+    auto still = world.acquireIterator<const Position&, mecs::Not<Velocity>>();
+    still.sortBy<Position, ByDescendingX>();
+    int lastX = 400;
+    still.forEach([&](const Position& position, mecs::Not<Velocity>) {
+        REQUIRE(position.x < lastX);
+        lastX = position.x;
+    });
+    REQUIRE(lastX == 3);
+
+    // In hierarchy order the children come after all the roots
+    world.entitySetParent(entities[0], entities[399]);
+    REQUIRE(world.entityGetParent(entities[0]) == entities[399]);
+    REQUIRE(world.entityGetNumChildren(entities[399]) == 1);
+    auto ordered = world.acquireIterator<mecs::EntityID, const Position&>();
+    ordered.hierarchyOrder();
+    std::vector<mecs::EntityID> orderedEntities;
+    ordered.forEach([&](mecs::EntityID entity, const Position&) {
+        orderedEntities.push_back(entity);
+    });
+    REQUIRE(orderedEntities.size() == 400);
+    REQUIRE(orderedEntities.back() == entities[0]);
+    world.entitySetParent(entities[0], mecs::EntityID::invalid());
+
+    // Destroying entities is deferred, so it's allowed while iterating
+    world.acquireIterator<mecs::EntityID, const Enemy&>().forEach([&](mecs::EntityID entity, const Enemy&) {
+        world.destroyEntity(entity);
+    });
+    world.flushEvents();
+    REQUIRE(mecs::utils::count(moving) == 200);
+}
+struct StaticPosition {
+    int x, y;
+};
+struct StaticVelocity {
+    int x, y;
+};
+struct StaticTag {
+    int value;
+};
+
+MECS_RTTI_SIMPLE(StaticPosition);
+MECS_RTTI_SIMPLE(StaticVelocity);
+MECS_RTTI_SIMPLE(StaticTag);
+
+using StaticComponents = mecs::ComponentList<StaticPosition, StaticVelocity>;
+MECS_STATIC_COMPONENTS(StaticComponents);
+
+static_assert(mecs::RegistrationInfo<StaticVelocity>::getComponentID() == mecs::ComponentID { 1 });
+static_assert(mecs::queryComponentIDs<mecs::EntityID, StaticPosition&, const StaticVelocity*>()
+    == std::array<MecsComponentID, 3> { MECS_INVALID, 0, 1 });
+
+TEST_CASE("C++ static components")
+{
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    mecs::Registry registry(StaticComponents {}, regInfo);
+    // Components outside of the list are registered at runtime after the static ones
+    REQUIRE(registry.addRegistration<StaticTag>() == mecs::ComponentID { 2 });
+    REQUIRE(registry.getNumComponents() == 3);
+    REQUIRE(registry.getComponentIDByName("StaticPosition") == mecs::ComponentID { 0 });
+    REQUIRE(registry.getComponentIDByName("StaticVelocity") == mecs::ComponentID { 1 });
+
+    mecs::World world(registry);
+    for (int i = 0; i < 10; i++) {
+        auto builder = world.spawnEntity()
+                           .withComponent<StaticPosition>(i, i)
+                           .withComponent<StaticVelocity>(1, -1);
+        if (i % 2 == 0) {
+            builder.withComponent<StaticTag>(i);
+        }
+    }
+    world.flushEvents();
+
+    int numMoved = 0;
+    world.acquireIterator<StaticPosition&, const StaticVelocity&, mecs::With<StaticTag>>().forEach([&](StaticPosition& position, const StaticVelocity& velocity, mecs::With<StaticTag>) {
+        position.x += velocity.x;
+        position.y += velocity.y;
+        REQUIRE(position.x == position.y + 2);
+        numMoved++;
+    });
+    REQUIRE(numMoved == 5);
+}
+
+struct FrameTime {
+    int delta;
+};
+struct Score {
+    int points;
+};
+
+struct MoveSystem {
+    void systemRun(mecs::World& world, mecs::Iterator<Position&, const Velocity&, mecs::Res<FrameTime>>& iterator)
+    {
+        iterator.forEach([](Position& position, const Velocity& velocity, mecs::Res<FrameTime> time) {
+            position.x += velocity.x * time->delta;
+        });
+    }
+};
+
+struct ScoreSystem {
+    void systemRun(mecs::World& world, mecs::Iterator<const Player&, mecs::ResMut<Score>>& iterator)
+    {
+        iterator.forEach([](const Player&, mecs::ResMut<Score> score) {
+            score->points++;
+        });
+    }
+};
+
+MECS_RTTI_SIMPLE(FrameTime);
+MECS_RTTI_SIMPLE(Score);
+
+struct ScoreReportSystem {
+    int lastScore = 0;
+    void systemRun(mecs::World& world, mecs::Iterator<mecs::Res<Score>>& iterator)
+    {
+        lastScore = world.getResource<Score>()->points;
+    }
+};
+
+TEST_CASE("C++ resources")
+{
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    mecs::Registry registry(regInfo);
+    registry.addRegistration<Player>();
+    registry.addRegistration<Position>();
+    registry.addRegistration<Velocity>();
+    registry.addRegistration<FrameTime>();
+    registry.addRegistration<Score>();
+
+    mecs::World world(registry);
+    world.addResource<FrameTime>(2);
+    world.addResource<Score>(0);
+    REQUIRE(world.hasResource<Score>());
+    for (int i = 0; i < 10; i++) {
+        auto builder = world.spawnEntity().withComponent<Position>(0, 0, 0).withComponent<Velocity>(i, 0, 0);
+        if (i < 3) {
+            builder.withComponent<Player>();
+        }
+    }
+
+    mecs::ScheduleID schedule = world.defineSchedule({});
+    MoveSystem move;
+    ScoreSystem score;
+    ScoreReportSystem report;
+    const MecsSystemID moveID = world.addSystem(&move, schedule);
+    const MecsSystemID scoreID = world.addSystem(&score, schedule);
+    const MecsSystemID reportID = world.addSystem(&report, schedule);
+    world.flushEvents();
+
+    // The resources are declared like the components: only Score is written, by ScoreSystem
+    REQUIRE_FALSE(world.systemsConflict(schedule, moveID, schedule, scoreID));
+    REQUIRE_FALSE(world.systemsConflict(schedule, moveID, schedule, reportID));
+    REQUIRE(world.systemsConflict(schedule, scoreID, schedule, reportID));
+
+    world.runSchedule(schedule);
+    world.runSchedule(schedule);
+    REQUIRE(world.getResource<Score>()->points == 6);
+    REQUIRE(report.lastScore == 6);
+    int totalX = 0;
+    world.acquireIterator<const Position&>().forEach([&](const Position& position) {
+        totalX += position.x;
+    });
+    // (0 + 1 + ... + 9) * 2 * 2 runs
+    REQUIRE(totalX == 180);
+
+    world.removeResource<FrameTime>();
+    REQUIRE(world.getResource<FrameTime>() == nullptr);
+}
+
+struct Model {
+    int modelIndex;
+};
+
+struct ModelObserver {
+    int calls = 0;
+    int totalModels = 0;
+    void observe(mecs::World& world, std::span<const mecs::EntityID> entities, std::span<Model* const> models)
+    {
+        calls++;
+        for (size_t i = 0; i < entities.size(); i++) {
+            REQUIRE(&world.entityGetComponent<Model>(entities[i]) == models[i]);
+            totalModels += models[i]->modelIndex;
+        }
+    }
+};
+
+MECS_RTTI_SIMPLE(Model);
+
+TEST_CASE("C++ observers")
+{
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    mecs::Registry registry(regInfo);
+    registry.addRegistration<Model>();
+
+    mecs::World world(registry);
+    ModelObserver added;
+    ModelObserver changed;
+    world.addObserver<Model>(MecsObserverEvent_Added, &added);
+    world.addObserver<Model>(MecsObserverEvent_Changed, &changed);
+
+    std::vector<mecs::EntityID> entities;
+    for (int i = 0; i < 10; i++) {
+        entities.push_back(world.spawnEntity().withComponent<Model>(i));
+    }
+    world.flushEvents();
+    REQUIRE(added.calls == 1);
+    REQUIRE(added.totalModels == 45);
+
+    world.entityGetComponent<Model>(entities[3]).modelIndex = 100;
+    world.entityComponentChanged<Model>(entities[3]);
+    world.flushEvents();
+    REQUIRE(changed.calls == 1);
+    REQUIRE(changed.totalModels == 100);
+}
+
+// Runs every other fixed step, only when there are positions and the simulation isn't paused
+struct PhysicsStepSystem {
+    static constexpr MecsU32 kRunInterval = 2;
+    static constexpr int kRunConditions = MecsSystemRunConditions_HasEntities;
+    bool paused = false;
+    int steps = 0;
+    bool shouldRun(mecs::World& world) { return !paused; }
+    void systemRun(mecs::World& world, mecs::Iterator<Position&>& iterator) { steps++; }
+};
+
+TEST_CASE("C++ schedule runner")
+{
+    MecsRegistryCreateInfo regInfo {};
+    regInfo.memAllocator = kDebugAllocator;
+    mecs::Registry registry(regInfo);
+    registry.addRegistration<Position>();
+
+    mecs::World world(registry);
+    mecs::ScheduleID schedule = world.defineSchedule({ .fixedTimestep = 0.5 });
+    PhysicsStepSystem physics;
+    world.addSystem(&physics, schedule);
+    world.flushEvents();
+
+    REQUIRE(world.updateSchedule(schedule, 1.0) == 2);
+    REQUIRE(physics.steps == 0);
+
+    world.spawnEntity().withComponent<Position>(0, 0, 0);
+    world.flushEvents();
+    REQUIRE(world.updateSchedule(schedule, 2.25) == 4);
+    REQUIRE(world.getScheduleInterpolation(schedule) == 0.5);
+    REQUIRE(physics.steps == 2);
+
+    physics.paused = true;
+    REQUIRE(world.updateSchedule(schedule, 1.0) == 2);
+    REQUIRE(physics.steps == 2);
+}
 /// NOLINTEND